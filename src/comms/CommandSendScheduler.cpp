@@ -0,0 +1,231 @@
+#include "CommandSendScheduler.h"
+
+#include "Tracing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace ulak::comms {
+namespace {
+
+std::size_t Index(CommandPriority priority) {
+  return static_cast<std::size_t>(priority);
+}
+
+}  // namespace
+
+const char* ToString(CommandPriority priority) {
+  switch (priority) {
+    case CommandPriority::kSafety:
+      return "SAFETY";
+    case CommandPriority::kMissionControl:
+      return "MISSION_CONTROL";
+    case CommandPriority::kTuning:
+      return "TUNING";
+  }
+  return "UNKNOWN";
+}
+
+CommandPriority CommandPriorityFor(std::string_view command) {
+  if (command == "STOP_MISSION") {
+    return CommandPriority::kSafety;
+  }
+  if (command == "SET_PARAM" || command == "SET_SIMULATOR_COORD_TRANSFORM") {
+    return CommandPriority::kTuning;
+  }
+  return CommandPriority::kMissionControl;
+}
+
+CommandSendScheduler::CommandSendScheduler(CommandSendConfig config) : config_(config) {
+  for (std::size_t i = 0; i < kCommandPriorityCount; ++i) {
+    classes_[i].stats.priority = static_cast<CommandPriority>(i);
+  }
+}
+
+bool CommandSendScheduler::Attach(int fd, std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what + ": " + std::strerror(errno);
+    }
+    return false;
+  };
+
+  const int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+    return fail("cannot make the command socket non-blocking");
+  }
+  const int on = 1;
+  if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) != 0) {
+    return fail("cannot set TCP_NODELAY");
+  }
+  if (config_.notsent_lowat_bytes > 0 &&
+      setsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &config_.notsent_lowat_bytes,
+                 sizeof(config_.notsent_lowat_bytes)) != 0) {
+    return fail("cannot set TCP_NOTSENT_LOWAT");
+  }
+  fd_ = fd;
+  return true;
+}
+
+void CommandSendScheduler::Detach() {
+  fd_ = -1;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& queue = classes_[Index(batch_.priority)].queue;
+  for (std::size_t i = batch_.messages.size(); i > batch_.done_messages; --i) {
+    queue.push_front(std::move(batch_.messages[i - 1]));
+  }
+  batch_.messages.clear();
+  batch_.done_messages = 0;
+  batch_.done_bytes = 0;
+  batch_pending_ = false;
+}
+
+bool CommandSendScheduler::Enqueue(CommandPriority priority, std::string bytes,
+                                   std::int64_t now_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ClassState& state = classes_[Index(priority)];
+  if (state.queue.size() >= config_.max_queued[Index(priority)]) {
+    ++state.stats.rejected;
+    return false;
+  }
+  state.queue.push_back(Message{std::move(bytes), now_us});
+  return true;
+}
+
+bool CommandSendScheduler::TakeBatchLocked() {
+  batch_.messages.clear();
+  batch_.done_messages = 0;
+  batch_.done_bytes = 0;
+  for (std::size_t i = 0; i < kCommandPriorityCount; ++i) {
+    auto& queue = classes_[i].queue;
+    if (queue.empty()) {
+      continue;
+    }
+    batch_.priority = static_cast<CommandPriority>(i);
+    // Safety commands are never held back to fill a batch.
+    const std::size_t max_messages = batch_.priority == CommandPriority::kSafety
+                                         ? 1
+                                         : std::max<std::size_t>(config_.max_batch_messages, 1);
+    std::size_t bytes = 0;
+    while (!queue.empty() && batch_.messages.size() < max_messages &&
+           (batch_.messages.empty() ||
+            bytes + queue.front().bytes.size() <= config_.max_batch_bytes)) {
+      bytes += queue.front().bytes.size();
+      batch_.messages.push_back(std::move(queue.front()));
+      queue.pop_front();
+    }
+    return true;
+  }
+  return false;
+}
+
+bool CommandSendScheduler::Pump(std::int64_t now_us, std::string* reason) {
+  if (fd_ < 0) {
+    return true;
+  }
+  iovec iov[64];
+  while (true) {
+    if (batch_.done_messages == batch_.messages.size()) {
+      // Re-pick after every batch so a stop queued meanwhile goes next.
+      std::lock_guard<std::mutex> lock(mutex_);
+      batch_pending_ = TakeBatchLocked();
+      if (!batch_pending_) {
+        return true;
+      }
+    }
+
+    std::size_t count = 0;
+    for (std::size_t i = batch_.done_messages;
+         i < batch_.messages.size() && count < std::size(iov); ++i) {
+      std::string& bytes = batch_.messages[i].bytes;
+      const std::size_t skip = i == batch_.done_messages ? batch_.done_bytes : 0;
+      iov[count].iov_base = bytes.data() + skip;
+      iov[count].iov_len = bytes.size() - skip;
+      ++count;
+    }
+    // sendmsg() is writev() with MSG_NOSIGNAL: a dropped peer is an error
+    // return, not SIGPIPE.
+    msghdr header{};
+    header.msg_iov = iov;
+    header.msg_iovlen = count;
+    ssize_t written = 0;
+    {
+      ULAK_TRACE_SCOPE(utils::TraceStage::kGatewaySend);
+      written = sendmsg(fd_, &header, MSG_NOSIGNAL);
+    }
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return true;
+      }
+      if (reason != nullptr) {
+        *reason = std::string("command socket write failed: ") + std::strerror(errno);
+      }
+      return false;
+    }
+
+    std::size_t remaining = static_cast<std::size_t>(written);
+    const std::size_t first_done = batch_.done_messages;
+    while (remaining > 0) {
+      const std::size_t left =
+          batch_.messages[batch_.done_messages].bytes.size() - batch_.done_bytes;
+      if (remaining < left) {
+        batch_.done_bytes += remaining;
+        break;
+      }
+      remaining -= left;
+      ++batch_.done_messages;
+      batch_.done_bytes = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ClassState& state = classes_[Index(batch_.priority)];
+    ++state.stats.writes;
+    state.stats.bytes += static_cast<std::uint64_t>(written);
+    for (std::size_t i = first_done; i < batch_.done_messages; ++i) {
+      ++state.stats.sent;
+      // Against the caller's clock: one Pump() call's writes take microseconds,
+      // far below the queueing delay this measures.
+      const std::int64_t waited_us = now_us - batch_.messages[i].enqueued_us;
+      state.hol_us.Record(static_cast<std::uint64_t>(std::max<std::int64_t>(waited_us, 0)));
+    }
+  }
+}
+
+bool CommandSendScheduler::wants_write() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (batch_pending_) {
+    return true;
+  }
+  return std::any_of(classes_.begin(), classes_.end(),
+                     [](const ClassState& state) { return !state.queue.empty(); });
+}
+
+std::array<CommandClassStats, kCommandPriorityCount> CommandSendScheduler::Stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::array<CommandClassStats, kCommandPriorityCount> stats;
+  for (std::size_t i = 0; i < kCommandPriorityCount; ++i) {
+    const ClassState& state = classes_[i];
+    stats[i] = state.stats;
+    stats[i].queued = state.queue.size();
+    if (state.hol_us.count() > 0) {
+      stats[i].hol_p50_us = state.hol_us.ValueAtPercentile(50.0);
+      stats[i].hol_p99_us = state.hol_us.ValueAtPercentile(99.0);
+      stats[i].hol_max_us = state.hol_us.max();
+    }
+  }
+  return stats;
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "HdrHistogram.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ulak::comms {
+
+// Send classes on `network.command_endpoint`, highest first.
+enum class CommandPriority : std::uint8_t {
+  kSafety,          // STOP_MISSION (PANIC_RTL goes over MAVLink, not here)
+  kMissionControl,  // START_MISSION, REQUEST_STATE_SNAPSHOT
+  kTuning,          // SET_PARAM, SET_SIMULATOR_COORD_TRANSFORM, tuning frames
+};
+
+inline constexpr std::size_t kCommandPriorityCount = 3;
+
+const char* ToString(CommandPriority priority);
+
+// Class of a PROTOCOL.md §6.5 command name. Unknown commands are treated as
+// mission control: never starved by tuning, never ahead of a stop.
+CommandPriority CommandPriorityFor(std::string_view command);
+
+// Loaded from the active profile's `command_send` section.
+struct CommandSendConfig {
+  // TCP_NOTSENT_LOWAT: unsent bytes the kernel may hold before the socket
+  // stops accepting writes. Keeps a stop command from queueing behind a deep
+  // kernel backlog of tuning traffic; 0 leaves the system default.
+  int notsent_lowat_bytes{4096};
+  // Tuning / mission messages coalesced into one writev().
+  std::size_t max_batch_messages{16};
+  std::size_t max_batch_bytes{16 * 1024};
+  // Per-class queue limit; Enqueue() refuses beyond it.
+  std::array<std::size_t, kCommandPriorityCount> max_queued{{64, 256, 1024}};
+};
+
+struct CommandClassStats {
+  CommandPriority priority{CommandPriority::kSafety};
+  std::size_t queued{0};
+  std::uint64_t sent{0};
+  std::uint64_t rejected{0};
+  std::uint64_t bytes{0};
+  std::uint64_t writes{0};
+  // Head-of-line delay: Enqueue() `now_us` -> `now_us` of the Pump() call
+  // whose write the kernel accepted the message's last byte in.
+  std::uint64_t hol_p50_us{0};
+  std::uint64_t hol_p99_us{0};
+  std::uint64_t hol_max_us{0};
+};
+
+// Orders outgoing commands on the single command TCP connection by class
+// instead of FIFO. Each Pump() round writes the highest non-empty class:
+// safety commands go out one per write, lower classes are batched with
+// writev(). A message already partly written is finished first (the stream
+// cannot interleave), so with TCP_NOTSENT_LOWAT bounding the kernel queue an
+// urgent command waits for at most one batch plus `notsent_lowat_bytes`.
+//
+// Enqueue() may be called from any thread; Attach(), Detach() and Pump() are
+// called by the connection's I/O thread.
+class CommandSendScheduler {
+ public:
+  explicit CommandSendScheduler(CommandSendConfig config = {});
+  CommandSendScheduler(const CommandSendScheduler&) = delete;
+  CommandSendScheduler& operator=(const CommandSendScheduler&) = delete;
+
+  // Takes a connected TCP socket (not owned): sets O_NONBLOCK, TCP_NODELAY and
+  // TCP_NOTSENT_LOWAT.
+  bool Attach(int fd, std::string* reason);
+  // Connection lost: a partly written batch is requeued in front of its class
+  // and resent whole on the next connection.
+  void Detach();
+
+  // `bytes` is one framed message, sent as is. Returns false when the class
+  // queue is full.
+  bool Enqueue(CommandPriority priority, std::string bytes, std::int64_t now_us);
+
+  // Writes until the queues are empty or the socket stops accepting. Returns
+  // false on a socket error (the caller reconnects); EAGAIN is not an error.
+  bool Pump(std::int64_t now_us, std::string* reason);
+
+  // Something is queued or partly written: poll the socket for POLLOUT.
+  bool wants_write() const;
+  int fd() const { return fd_; }
+
+  std::array<CommandClassStats, kCommandPriorityCount> Stats() const;
+
+ private:
+  struct Message {
+    std::string bytes;
+    std::int64_t enqueued_us{0};
+  };
+
+  struct ClassState {
+    std::deque<Message> queue;
+    CommandClassStats stats;
+    utils::HdrHistogram hol_us;
+  };
+
+  // Pump() state: the batch being written and how far it got.
+  struct Batch {
+    CommandPriority priority{CommandPriority::kSafety};
+    std::vector<Message> messages;
+    std::size_t done_messages{0};
+    std::size_t done_bytes{0};
+  };
+
+  bool TakeBatchLocked();
+
+  const CommandSendConfig config_;
+  int fd_{-1};
+  Batch batch_;
+
+  mutable std::mutex mutex_;
+  std::array<ClassState, kCommandPriorityCount> classes_;
+  bool batch_pending_{false};
+};
+
+}  // namespace ulak::comms
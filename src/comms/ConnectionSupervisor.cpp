@@ -0,0 +1,433 @@
+#include "ConnectionSupervisor.h"
+
+#include "CorrelationId.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ulak::comms {
+namespace {
+
+std::int64_t MonotonicUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+std::string FormatAddress(const sockaddr* address) {
+  char host[INET6_ADDRSTRLEN] = {};
+  if (address->sa_family == AF_INET6) {
+    const auto* v6 = reinterpret_cast<const sockaddr_in6*>(address);
+    inet_ntop(AF_INET6, &v6->sin6_addr, host, sizeof(host));
+    return "[" + std::string(host) + "]:" + std::to_string(ntohs(v6->sin6_port));
+  }
+  const auto* v4 = reinterpret_cast<const sockaddr_in*>(address);
+  inet_ntop(AF_INET, &v4->sin_addr, host, sizeof(host));
+  return std::string(host) + ":" + std::to_string(ntohs(v4->sin_port));
+}
+
+// RFC 8305 §4: alternate families, starting with the resolver's first choice.
+std::vector<const addrinfo*> InterleaveFamilies(const addrinfo* list) {
+  std::vector<const addrinfo*> first;
+  std::vector<const addrinfo*> second;
+  const int preferred = list != nullptr ? list->ai_family : AF_UNSPEC;
+  for (const addrinfo* entry = list; entry != nullptr; entry = entry->ai_next) {
+    (entry->ai_family == preferred ? first : second).push_back(entry);
+  }
+  std::vector<const addrinfo*> ordered;
+  for (std::size_t i = 0; i < std::max(first.size(), second.size()); ++i) {
+    if (i < first.size()) {
+      ordered.push_back(first[i]);
+    }
+    if (i < second.size()) {
+      ordered.push_back(second[i]);
+    }
+  }
+  return ordered;
+}
+
+struct Attempt {
+  int fd{-1};
+  const addrinfo* address{nullptr};
+};
+
+}  // namespace
+
+const char* ToString(ConnectionState state) {
+  switch (state) {
+    case ConnectionState::kDisconnected:
+      return "DISCONNECTED";
+    case ConnectionState::kConnecting:
+      return "CONNECTING";
+    case ConnectionState::kConnected:
+      return "CONNECTED";
+  }
+  return "DISCONNECTED";
+}
+
+ConnectionStateMachine::ConnectionStateMachine(LinkChannel channel, ReconnectPolicy policy,
+                                               std::uint64_t seed)
+    : channel_(channel), policy_(policy), random_(seed) {}
+
+bool ConnectionStateMachine::ShouldConnect(std::int64_t now_us) const {
+  return state_ == ConnectionState::kDisconnected && now_us >= next_attempt_us_;
+}
+
+void ConnectionStateMachine::OnConnectStarted(std::int64_t now_us) {
+  Transition(ConnectionState::kConnecting, now_us, {});
+}
+
+void ConnectionStateMachine::OnConnected(std::int64_t now_us) {
+  connected_us_ = now_us;
+  ++connects_;
+  Transition(ConnectionState::kConnected, now_us, {});
+}
+
+void ConnectionStateMachine::OnConnectFailed(std::int64_t now_us, const std::string& reason) {
+  BackOff(now_us);
+  Transition(ConnectionState::kDisconnected, now_us, reason);
+}
+
+void ConnectionStateMachine::OnDisconnected(std::int64_t now_us, const std::string& reason) {
+  if (state_ != ConnectionState::kConnected) {
+    return;
+  }
+  ++drops_;
+  const bool stable = now_us - connected_us_ >= policy_.stable_after_us;
+  if (stable) {
+    failures_ = 0;
+    next_attempt_us_ = now_us;
+    loss_raised_ = false;
+  } else {
+    BackOff(now_us);
+  }
+  Transition(ConnectionState::kDisconnected, now_us, reason);
+  if (!loss_raised_) {
+    loss_raised_ = true;
+    if (loss_sink_) {
+      // A hard drop is known at once; there is no silence to report.
+      loss_sink_(LinkLossEvent{channel_, LossEventCode(channel_), now_us, 0});
+    }
+  }
+}
+
+void ConnectionStateMachine::BackOff(std::int64_t now_us) {
+  const double base = std::min(
+      static_cast<double>(policy_.max_backoff_us),
+      static_cast<double>(policy_.initial_backoff_us) *
+          std::pow(std::max(policy_.multiplier, 1.0), static_cast<double>(failures_)));
+  std::uniform_real_distribution<double> spread(-policy_.jitter, policy_.jitter);
+  const double delay = std::max(0.0, base * (1.0 + spread(random_)));
+  ++failures_;
+  next_attempt_us_ = now_us + static_cast<std::int64_t>(delay);
+}
+
+void ConnectionStateMachine::Transition(ConnectionState to, std::int64_t now_us,
+                                        const std::string& reason) {
+  const ConnectionState from = state_;
+  state_ = to;
+  if (transition_sink_) {
+    transition_sink_(ConnectionTransition{channel_, from, to, now_us, failures_,
+                                          to == ConnectionState::kDisconnected ? next_attempt_us_ : 0,
+                                          reason});
+  }
+}
+
+bool ApplyKeepalive(int fd, const ReconnectPolicy& policy, std::string* reason) {
+  const auto set = [fd, reason](int level, int name, int value, const char* what) {
+    if (setsockopt(fd, level, name, &value, sizeof(value)) == 0) {
+      return true;
+    }
+    if (reason != nullptr) {
+      *reason = std::string("cannot set ") + what + ": " + std::strerror(errno);
+    }
+    return false;
+  };
+
+  if (!set(SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE")) {
+    return false;
+  }
+  if (policy.keepalive_idle_s > 0 &&
+      !set(IPPROTO_TCP, TCP_KEEPIDLE, policy.keepalive_idle_s, "TCP_KEEPIDLE")) {
+    return false;
+  }
+  if (policy.keepalive_interval_s > 0 &&
+      !set(IPPROTO_TCP, TCP_KEEPINTVL, policy.keepalive_interval_s, "TCP_KEEPINTVL")) {
+    return false;
+  }
+  if (policy.keepalive_count > 0 &&
+      !set(IPPROTO_TCP, TCP_KEEPCNT, policy.keepalive_count, "TCP_KEEPCNT")) {
+    return false;
+  }
+  if (policy.user_timeout_ms > 0 &&
+      !set(IPPROTO_TCP, TCP_USER_TIMEOUT, policy.user_timeout_ms, "TCP_USER_TIMEOUT")) {
+    return false;
+  }
+  return true;
+}
+
+bool ConnectTcp(const std::string& host, std::uint16_t port, const ReconnectPolicy& policy,
+                TcpConnectResult* result, std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_NUMERICSERV;
+  addrinfo* resolved = nullptr;
+  const std::string service = std::to_string(port);
+  const int status = getaddrinfo(host.c_str(), service.c_str(), &hints, &resolved);
+  if (status != 0) {
+    return fail("cannot resolve " + host + ": " + gai_strerror(status));
+  }
+  const std::vector<const addrinfo*> addresses = InterleaveFamilies(resolved);
+
+  const std::int64_t started_us = MonotonicUs();
+  const std::int64_t deadline_us = started_us + policy.connect_timeout_us;
+  std::vector<Attempt> pending;
+  std::size_t next = 0;
+  std::int64_t next_start_us = started_us;
+  std::string last_error = "no addresses for " + host;
+  Attempt winner;
+  int attempts = 0;
+
+  while (winner.fd < 0) {
+    const std::int64_t now_us = MonotonicUs();
+    if (now_us >= deadline_us) {
+      last_error = "connect to " + host + ":" + service + " timed out";
+      break;
+    }
+    // Start the next address when its turn has come or nothing is in flight.
+    if (next < addresses.size() && (now_us >= next_start_us || pending.empty())) {
+      const addrinfo* address = addresses[next++];
+      const int fd = socket(address->ai_family,
+                            address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                            address->ai_protocol);
+      if (fd < 0) {
+        last_error = std::string("socket failed: ") + std::strerror(errno);
+        continue;
+      }
+      ++attempts;
+      if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+        winner = Attempt{fd, address};
+        break;
+      }
+      if (errno != EINPROGRESS) {
+        last_error = "connect to " + FormatAddress(address->ai_addr) + " failed: " +
+                     std::strerror(errno);
+        close(fd);
+        continue;
+      }
+      pending.push_back(Attempt{fd, address});
+      next_start_us = now_us + policy.attempt_delay_us;
+    }
+    if (pending.empty()) {
+      if (next >= addresses.size()) {
+        break;
+      }
+      continue;
+    }
+
+    std::int64_t wait_us = deadline_us - now_us;
+    if (next < addresses.size()) {
+      wait_us = std::min(wait_us, next_start_us - now_us);
+    }
+    std::vector<pollfd> polled;
+    for (const Attempt& attempt : pending) {
+      polled.push_back(pollfd{attempt.fd, POLLOUT, 0});
+    }
+    const int ready = poll(polled.data(), polled.size(),
+                           static_cast<int>(std::max<std::int64_t>((wait_us + 999) / 1000, 0)));
+    if (ready < 0 && errno != EINTR) {
+      last_error = std::string("poll failed: ") + std::strerror(errno);
+      break;
+    }
+    std::vector<Attempt> still_pending;
+    for (std::size_t i = 0; i < polled.size(); ++i) {
+      if (polled[i].revents == 0 || winner.fd >= 0) {
+        still_pending.push_back(pending[i]);
+        continue;
+      }
+      int error = 0;
+      socklen_t length = sizeof(error);
+      getsockopt(pending[i].fd, SOL_SOCKET, SO_ERROR, &error, &length);
+      if (error == 0) {
+        winner = pending[i];
+        continue;
+      }
+      last_error = "connect to " + FormatAddress(pending[i].address->ai_addr) + " failed: " +
+                   std::strerror(error);
+      close(pending[i].fd);
+      // A refused address makes room for the next one immediately.
+      next_start_us = MonotonicUs();
+    }
+    pending = std::move(still_pending);
+  }
+
+  for (const Attempt& attempt : pending) {
+    close(attempt.fd);
+  }
+  std::string address_text;
+  if (winner.fd >= 0) {
+    address_text = FormatAddress(winner.address->ai_addr);
+  }
+  freeaddrinfo(resolved);
+  if (winner.fd < 0) {
+    return fail(last_error);
+  }
+
+  const int flags = fcntl(winner.fd, F_GETFL, 0);
+  std::string option_error;
+  if (flags < 0 || fcntl(winner.fd, F_SETFL, flags & ~O_NONBLOCK) != 0 ||
+      !ApplyKeepalive(winner.fd, policy, &option_error)) {
+    close(winner.fd);
+    return fail(option_error.empty() ? std::string("cannot configure the socket: ") +
+                                           std::strerror(errno)
+                                     : option_error);
+  }
+  result->fd = winner.fd;
+  result->address = std::move(address_text);
+  result->attempts = attempts;
+  result->elapsed_us = MonotonicUs() - started_us;
+  return true;
+}
+
+models::WireEnvelope MakeStateSnapshotRequest(std::int64_t timestamp_us) {
+  models::WireEnvelope envelope;
+  envelope.category = models::MessageCategory::kCommandRequest;
+  envelope.source = models::MessageSource::kStation;
+  envelope.timestamp_us = timestamp_us;
+  envelope.correlation_id = utils::GenerateUuidV4();
+  envelope.payload = models::CommandPayload{"REQUEST_STATE_SNAPSHOT", "companion_computer", "{}"};
+  return envelope;
+}
+
+ConnectionSupervisor::ConnectionSupervisor(LinkChannel channel, ConnectionEndpoint endpoint,
+                                           ReconnectPolicy policy, std::uint64_t seed)
+    : endpoint_(std::move(endpoint)), policy_(policy), machine_(channel, policy, seed) {}
+
+ConnectionSupervisor::~ConnectionSupervisor() {
+  Stop();
+}
+
+void ConnectionSupervisor::SetTransitionSink(ConnectionStateMachine::TransitionSink sink) {
+  machine_.SetTransitionSink(std::move(sink));
+}
+
+void ConnectionSupervisor::SetLossSink(ConnectionStateMachine::LossSink sink) {
+  machine_.SetLossSink(std::move(sink));
+}
+
+void ConnectionSupervisor::Start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = false;
+  }
+  thread_ = std::thread([this] { Run(); });
+}
+
+void ConnectionSupervisor::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+void ConnectionSupervisor::ReportDisconnected(const std::string& reason) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drop_pending_ = true;
+    drop_reason_ = reason;
+  }
+  wake_.notify_all();
+}
+
+void ConnectionSupervisor::Run() {
+  // The machine, its sinks and fd_ belong to this thread; mutex_ only guards
+  // the stop / drop flags, so sinks never run under it.
+  while (true) {
+    std::string drop_reason;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      const auto woken = [this] { return stop_ || drop_pending_; };
+      if (machine_.state() == ConnectionState::kConnected) {
+        wake_.wait(lock, woken);
+      } else {
+        const std::int64_t wait_us = machine_.next_attempt_us() - MonotonicUs();
+        wake_.wait_for(lock, std::chrono::microseconds(std::max<std::int64_t>(wait_us, 0)),
+                       woken);
+      }
+      if (stop_) {
+        return;
+      }
+      if (drop_pending_) {
+        drop_pending_ = false;
+        drop_reason = std::move(drop_reason_);
+      }
+    }
+
+    if (machine_.state() == ConnectionState::kConnected && !drop_reason.empty()) {
+      close(fd_);
+      fd_ = -1;
+      machine_.OnDisconnected(MonotonicUs(), drop_reason);
+      state_.store(ConnectionState::kDisconnected, std::memory_order_release);
+    }
+    const std::int64_t now_us = MonotonicUs();
+    if (!machine_.ShouldConnect(now_us)) {
+      continue;
+    }
+
+    machine_.OnConnectStarted(now_us);
+    state_.store(ConnectionState::kConnecting, std::memory_order_release);
+    TcpConnectResult result;
+    std::string reason;
+    if (!ConnectTcp(endpoint_.host, endpoint_.port, policy_, &result, &reason)) {
+      machine_.OnConnectFailed(MonotonicUs(), reason);
+      state_.store(ConnectionState::kDisconnected, std::memory_order_release);
+      continue;
+    }
+    {
+      // A drop reported for the previous connection is stale now.
+      std::lock_guard<std::mutex> lock(mutex_);
+      drop_pending_ = false;
+    }
+    fd_ = result.fd;
+    machine_.OnConnected(MonotonicUs());
+    state_.store(ConnectionState::kConnected, std::memory_order_release);
+    if (connected_handler_) {
+      connected_handler_(result.fd, result);
+    }
+  }
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "LinkHealthMonitor.h"
+#include "WireEnvelope.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace ulak::comms {
+
+enum class ConnectionState : std::uint8_t {
+  kDisconnected,
+  kConnecting,
+  kConnected,
+};
+
+const char* ToString(ConnectionState state);
+
+// Loaded from the active profile's `reconnect` section.
+struct ReconnectPolicy {
+  // Delay before retrying a failed attempt: starts at `initial_backoff_us`,
+  // grows by `multiplier` per consecutive failure up to `max_backoff_us`, and
+  // is spread by +-`jitter` (fraction) so stations do not retry in lockstep.
+  std::int64_t initial_backoff_us{100'000};
+  std::int64_t max_backoff_us{5'000'000};
+  double multiplier{2.0};
+  double jitter{0.2};
+  // A connection must stay up this long before its drop resets the backoff;
+  // a peer that accepts and closes at once (crash loop, proxy) is backed off
+  // like a refusal.
+  std::int64_t stable_after_us{500'000};
+  // Budget for one connect round (resolution excluded), all addresses together.
+  std::int64_t connect_timeout_us{2'000'000};
+  // Happy eyeballs: the next address is tried when the previous one has not
+  // answered after this long (RFC 8305 "connection attempt delay"), or at once
+  // when it fails.
+  std::int64_t attempt_delay_us{250'000};
+  // Dead-peer detection on an established connection. Keepalive probes catch
+  // an idle link after idle + interval * count seconds; TCP_USER_TIMEOUT
+  // bounds how long written data may stay unacknowledged. 0 keeps the default.
+  int keepalive_idle_s{1};
+  int keepalive_interval_s{1};
+  int keepalive_count{3};
+  int user_timeout_ms{3'000};
+};
+
+struct ConnectionTransition {
+  LinkChannel channel{LinkChannel::kCompanionTcp};
+  ConnectionState from{ConnectionState::kDisconnected};
+  ConnectionState to{ConnectionState::kDisconnected};
+  std::int64_t time_us{0};
+  // Consecutive failed attempts before this transition.
+  std::uint32_t failures{0};
+  // When the next attempt is due (kDisconnected only).
+  std::int64_t next_attempt_us{0};
+  std::string reason;
+};
+
+// DISCONNECTED -> CONNECTING -> CONNECTED bookkeeping for one channel. Pure
+// logic with an injected clock, so the backoff schedule is testable; the
+// caller does the I/O. Not synchronized: owned by one thread.
+//
+// A drop of a connection that stayed up for `stable_after_us` is retried at
+// once (the peer was fine a moment ago) and raises the channel's link-loss
+// event immediately, instead of after the health monitor's silence timeout.
+// Failed attempts and drops of short-lived connections back off, and a run of
+// short-lived connections raises the loss event only once.
+class ConnectionStateMachine {
+ public:
+  using TransitionSink = std::function<void(const ConnectionTransition&)>;
+  using LossSink = std::function<void(const LinkLossEvent&)>;
+
+  ConnectionStateMachine(LinkChannel channel, ReconnectPolicy policy, std::uint64_t seed);
+
+  void SetTransitionSink(TransitionSink sink) { transition_sink_ = std::move(sink); }
+  void SetLossSink(LossSink sink) { loss_sink_ = std::move(sink); }
+
+  // Disconnected and the backoff has elapsed.
+  bool ShouldConnect(std::int64_t now_us) const;
+
+  void OnConnectStarted(std::int64_t now_us);
+  // The caller requests a state snapshot next.
+  void OnConnected(std::int64_t now_us);
+  void OnConnectFailed(std::int64_t now_us, const std::string& reason);
+  // Read/write error, EOF or keepalive timeout on an established connection.
+  void OnDisconnected(std::int64_t now_us, const std::string& reason);
+
+  ConnectionState state() const { return state_; }
+  LinkChannel channel() const { return channel_; }
+  std::uint32_t failures() const { return failures_; }
+  std::int64_t next_attempt_us() const { return next_attempt_us_; }
+  std::uint64_t connects() const { return connects_; }
+  std::uint64_t drops() const { return drops_; }
+
+ private:
+  void Transition(ConnectionState to, std::int64_t now_us, const std::string& reason);
+  // Schedules the next attempt after a failure and counts it.
+  void BackOff(std::int64_t now_us);
+
+  const LinkChannel channel_;
+  const ReconnectPolicy policy_;
+  std::mt19937_64 random_;
+  ConnectionState state_{ConnectionState::kDisconnected};
+  std::uint32_t failures_{0};
+  std::int64_t next_attempt_us_{0};
+  std::int64_t connected_us_{0};
+  // The loss event for the current outage has been raised.
+  bool loss_raised_{false};
+  std::uint64_t connects_{0};
+  std::uint64_t drops_{0};
+  TransitionSink transition_sink_;
+  LossSink loss_sink_;
+};
+
+struct TcpConnectResult {
+  int fd{-1};
+  // Numeric address of the winning attempt, e.g. "[::1]:5760" or "10.0.0.2:5760".
+  std::string address;
+  // Connect attempts started (one per address tried).
+  int attempts{0};
+  std::int64_t elapsed_us{0};
+};
+
+// Resolves `host` and connects with staggered parallel attempts, IPv6 and IPv4
+// interleaved (RFC 8305): a black-holed address costs `attempt_delay_us`, not
+// a full SYN timeout. The winner is returned blocking with keepalive applied;
+// the other attempts are closed. Fails after `connect_timeout_us`.
+bool ConnectTcp(const std::string& host, std::uint16_t port, const ReconnectPolicy& policy,
+                TcpConnectResult* result, std::string* reason);
+
+// SO_KEEPALIVE, TCP_KEEPIDLE/KEEPINTVL/KEEPCNT and TCP_USER_TIMEOUT from `policy`.
+bool ApplyKeepalive(int fd, const ReconnectPolicy& policy, std::string* reason);
+
+// `REQUEST_STATE_SNAPSHOT` for the companion computer (PROTOCOL.md §6.5): the
+// reply is an ACK followed at once by the current `mission/state` and
+// `perception/output`, so a reconnect recovers state in one round trip.
+models::WireEnvelope MakeStateSnapshotRequest(std::int64_t timestamp_us);
+
+struct ConnectionEndpoint {
+  std::string host;
+  std::uint16_t port{0};
+};
+
+// Keeps one TCP channel connected on its own thread: connects, hands the
+// socket to the channel's I/O worker, waits for the worker to report the
+// drop, backs off and reconnects.
+//
+// The connected handler runs on the supervisor thread and should send
+// MakeStateSnapshotRequest() before anything else. The supervisor owns the
+// socket: ReportDisconnected() (worker thread, after it stopped using the fd)
+// and Stop() close it.
+class ConnectionSupervisor {
+ public:
+  using ConnectedHandler = std::function<void(int fd, const TcpConnectResult& result)>;
+
+  ConnectionSupervisor(LinkChannel channel, ConnectionEndpoint endpoint, ReconnectPolicy policy,
+                       std::uint64_t seed);
+  ~ConnectionSupervisor();
+  ConnectionSupervisor(const ConnectionSupervisor&) = delete;
+  ConnectionSupervisor& operator=(const ConnectionSupervisor&) = delete;
+
+  // Set before Start(); called on the supervisor thread.
+  void SetConnectedHandler(ConnectedHandler handler) { connected_handler_ = std::move(handler); }
+  void SetTransitionSink(ConnectionStateMachine::TransitionSink sink);
+  void SetLossSink(ConnectionStateMachine::LossSink sink);
+
+  void Start();
+  // Returns once the thread has exited; an attempt in progress finishes first
+  // (at most `connect_timeout_us`).
+  void Stop();
+
+  // `reason` must be non-empty; it becomes the transition reason.
+  void ReportDisconnected(const std::string& reason);
+
+  ConnectionState state() const { return state_.load(std::memory_order_acquire); }
+
+ private:
+  void Run();
+
+  const ConnectionEndpoint endpoint_;
+  const ReconnectPolicy policy_;
+  ConnectedHandler connected_handler_;
+  ConnectionStateMachine machine_;
+  int fd_{-1};
+  std::atomic<ConnectionState> state_{ConnectionState::kDisconnected};
+  std::thread thread_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stop_{false};
+  bool drop_pending_{false};
+  std::string drop_reason_;
+};
+
+}  // namespace ulak::comms
@@ -0,0 +1,511 @@
+#include "FrameScaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define ULAK_PIXEL_X86 1
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ULAK_PIXEL_NEON 1
+#endif
+
+namespace ulak::comms {
+namespace {
+
+// Kernels share integer formulas so every path is bit-exact with the scalar
+// reference:
+//   lerp:    (a * (128 - w) + b * w + 64) >> 7
+//   convert: c = y - 16, d = u - 128, e = v - 128, l = 74c + 32
+//            r = sat16(l + 102e) >> 6, g = (l - 25d - 52e) >> 6,
+//            b = sat16(l + 129d) >> 6, each clamped to [0, 255]
+// (BT.601 limited range with coefficients scaled by 64.)
+using LerpFn = void (*)(const std::uint8_t* a, const std::uint8_t* b, int weight,
+                        std::uint8_t* out, int count);
+using ConvertFn = void (*)(const std::uint8_t* y, const std::uint8_t* u, const std::uint8_t* v,
+                           std::uint8_t* rgba, int count);
+
+struct Kernels {
+  LerpFn lerp;
+  ConvertFn convert;
+};
+
+std::uint8_t Clamp8(int value) {
+  return static_cast<std::uint8_t>(std::clamp(value, 0, 255));
+}
+
+int Saturate16(int value) {
+  return std::clamp(value, -32768, 32767);
+}
+
+void LerpScalar(const std::uint8_t* a, const std::uint8_t* b, int weight, std::uint8_t* out,
+                int count) {
+  const int inverse = 128 - weight;
+  for (int index = 0; index < count; ++index) {
+    out[index] = static_cast<std::uint8_t>((a[index] * inverse + b[index] * weight + 64) >> 7);
+  }
+}
+
+void ConvertPixelScalar(int y, int u, int v, std::uint8_t* rgba) {
+  const int c = y - 16;
+  const int d = u - 128;
+  const int e = v - 128;
+  const int l = 74 * c + 32;
+  rgba[0] = Clamp8(Saturate16(l + 102 * e) >> 6);
+  rgba[1] = Clamp8((l - 25 * d - 52 * e) >> 6);
+  rgba[2] = Clamp8(Saturate16(l + 129 * d) >> 6);
+  rgba[3] = 255;
+}
+
+void ConvertScalar(const std::uint8_t* y, const std::uint8_t* u, const std::uint8_t* v,
+                   std::uint8_t* rgba, int count) {
+  for (int index = 0; index < count; ++index) {
+    ConvertPixelScalar(y[index], u[index], v[index], rgba + 4 * index);
+  }
+}
+
+#ifdef ULAK_PIXEL_X86
+
+void LerpSse2(const std::uint8_t* a, const std::uint8_t* b, int weight, std::uint8_t* out,
+              int count) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wa = _mm_set1_epi16(static_cast<short>(128 - weight));
+  const __m128i wb = _mm_set1_epi16(static_cast<short>(weight));
+  const __m128i round = _mm_set1_epi16(64);
+  int index = 0;
+  for (; index + 16 <= count; index += 16) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + index));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + index));
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 7);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 7);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index), _mm_packus_epi16(lo, hi));
+  }
+  LerpScalar(a + index, b + index, weight, out + index, count - index);
+}
+
+// 8 pixels: 16-bit R/G/B lanes -> interleaved RGBA.
+inline void StoreRgba8(__m128i r, __m128i g, __m128i b, std::uint8_t* rgba) {
+  const __m128i r8 = _mm_packus_epi16(r, r);
+  const __m128i g8 = _mm_packus_epi16(g, g);
+  const __m128i b8 = _mm_packus_epi16(b, b);
+  const __m128i a8 = _mm_set1_epi8(static_cast<char>(-1));
+  const __m128i rg = _mm_unpacklo_epi8(r8, g8);
+  const __m128i ba = _mm_unpacklo_epi8(b8, a8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba), _mm_unpacklo_epi16(rg, ba));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + 16), _mm_unpackhi_epi16(rg, ba));
+}
+
+void ConvertSse2(const std::uint8_t* y, const std::uint8_t* u, const std::uint8_t* v,
+                 std::uint8_t* rgba, int count) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i k16 = _mm_set1_epi16(16);
+  const __m128i k128 = _mm_set1_epi16(128);
+  const __m128i k32 = _mm_set1_epi16(32);
+  int index = 0;
+  for (; index + 8 <= count; index += 8) {
+    const __m128i c = _mm_sub_epi16(
+        _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + index)), zero), k16);
+    const __m128i d = _mm_sub_epi16(
+        _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + index)), zero), k128);
+    const __m128i e = _mm_sub_epi16(
+        _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + index)), zero), k128);
+    const __m128i l = _mm_add_epi16(_mm_mullo_epi16(c, _mm_set1_epi16(74)), k32);
+    const __m128i r = _mm_srai_epi16(_mm_adds_epi16(l, _mm_mullo_epi16(e, _mm_set1_epi16(102))), 6);
+    const __m128i g = _mm_srai_epi16(
+        _mm_sub_epi16(_mm_sub_epi16(l, _mm_mullo_epi16(d, _mm_set1_epi16(25))),
+                      _mm_mullo_epi16(e, _mm_set1_epi16(52))),
+        6);
+    const __m128i b = _mm_srai_epi16(_mm_adds_epi16(l, _mm_mullo_epi16(d, _mm_set1_epi16(129))), 6);
+    StoreRgba8(r, g, b, rgba + 4 * index);
+  }
+  ConvertScalar(y + index, u + index, v + index, rgba + 4 * index, count - index);
+}
+
+__attribute__((target("avx2"))) void LerpAvx2(const std::uint8_t* a, const std::uint8_t* b,
+                                              int weight, std::uint8_t* out, int count) {
+  const __m256i wa = _mm256_set1_epi16(static_cast<short>(128 - weight));
+  const __m256i wb = _mm256_set1_epi16(static_cast<short>(weight));
+  const __m256i round = _mm256_set1_epi16(64);
+  int index = 0;
+  for (; index + 32 <= count; index += 32) {
+    const __m256i a_lo = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + index)));
+    const __m256i a_hi =
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + index + 16)));
+    const __m256i b_lo = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + index)));
+    const __m256i b_hi =
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + index + 16)));
+    __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(a_lo, wa), _mm256_mullo_epi16(b_lo, wb));
+    __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(a_hi, wa), _mm256_mullo_epi16(b_hi, wb));
+    lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 7);
+    hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 7);
+    // packus works per 128-bit lane; restore byte order across lanes.
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + index), packed);
+  }
+  LerpSse2(a + index, b + index, weight, out + index, count - index);
+}
+
+__attribute__((target("avx2"))) void ConvertAvx2(const std::uint8_t* y, const std::uint8_t* u,
+                                                 const std::uint8_t* v, std::uint8_t* rgba,
+                                                 int count) {
+  const __m256i k16 = _mm256_set1_epi16(16);
+  const __m256i k128 = _mm256_set1_epi16(128);
+  const __m256i k32 = _mm256_set1_epi16(32);
+  const __m256i alpha = _mm256_set1_epi8(static_cast<char>(-1));
+  int index = 0;
+  for (; index + 16 <= count; index += 16) {
+    const __m256i c = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + index))), k16);
+    const __m256i d = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u + index))), k128);
+    const __m256i e = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + index))), k128);
+    const __m256i l = _mm256_add_epi16(_mm256_mullo_epi16(c, _mm256_set1_epi16(74)), k32);
+    const __m256i r =
+        _mm256_srai_epi16(_mm256_adds_epi16(l, _mm256_mullo_epi16(e, _mm256_set1_epi16(102))), 6);
+    const __m256i g = _mm256_srai_epi16(
+        _mm256_sub_epi16(_mm256_sub_epi16(l, _mm256_mullo_epi16(d, _mm256_set1_epi16(25))),
+                         _mm256_mullo_epi16(e, _mm256_set1_epi16(52))),
+        6);
+    const __m256i b =
+        _mm256_srai_epi16(_mm256_adds_epi16(l, _mm256_mullo_epi16(d, _mm256_set1_epi16(129))), 6);
+
+    // Per lane: pixels 0-7 in lane 0, 8-15 in lane 1.
+    const __m256i rg = _mm256_unpacklo_epi8(_mm256_packus_epi16(r, r), _mm256_packus_epi16(g, g));
+    const __m256i ba = _mm256_unpacklo_epi8(_mm256_packus_epi16(b, b), alpha);
+    const __m256i first = _mm256_unpacklo_epi16(rg, ba);   // px 0-3 | 8-11
+    const __m256i second = _mm256_unpackhi_epi16(rg, ba);  // px 4-7 | 12-15
+    std::uint8_t* out = rgba + 4 * index;
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32),
+                        _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  ConvertSse2(y + index, u + index, v + index, rgba + 4 * index, count - index);
+}
+
+#endif  // ULAK_PIXEL_X86
+
+#ifdef ULAK_PIXEL_NEON
+
+void LerpNeon(const std::uint8_t* a, const std::uint8_t* b, int weight, std::uint8_t* out,
+              int count) {
+  const uint8x8_t wa = vdup_n_u8(static_cast<std::uint8_t>(128 - weight));
+  const uint8x8_t wb = vdup_n_u8(static_cast<std::uint8_t>(weight));
+  int index = 0;
+  for (; index + 16 <= count; index += 16) {
+    const uint8x16_t va = vld1q_u8(a + index);
+    const uint8x16_t vb = vld1q_u8(b + index);
+    const uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(va), wa), vget_low_u8(vb), wb);
+    const uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(va), wa), vget_high_u8(vb), wb);
+    vst1q_u8(out + index, vcombine_u8(vrshrn_n_u16(lo, 7), vrshrn_n_u16(hi, 7)));
+  }
+  LerpScalar(a + index, b + index, weight, out + index, count - index);
+}
+
+void ConvertNeon(const std::uint8_t* y, const std::uint8_t* u, const std::uint8_t* v,
+                 std::uint8_t* rgba, int count) {
+  int index = 0;
+  for (; index + 8 <= count; index += 8) {
+    const int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + index))), vdupq_n_s16(16));
+    const int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + index))), vdupq_n_s16(128));
+    const int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + index))), vdupq_n_s16(128));
+    const int16x8_t l = vaddq_s16(vmulq_n_s16(c, 74), vdupq_n_s16(32));
+    uint8x8x4_t pixels;
+    pixels.val[0] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(l, vmulq_n_s16(e, 102)), 6));
+    pixels.val[1] = vqmovun_s16(
+        vshrq_n_s16(vsubq_s16(vsubq_s16(l, vmulq_n_s16(d, 25)), vmulq_n_s16(e, 52)), 6));
+    pixels.val[2] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(l, vmulq_n_s16(d, 129)), 6));
+    pixels.val[3] = vdup_n_u8(255);
+    vst4_u8(rgba + 4 * index, pixels);
+  }
+  ConvertScalar(y + index, u + index, v + index, rgba + 4 * index, count - index);
+}
+
+#endif  // ULAK_PIXEL_NEON
+
+bool PathSupported(PixelKernelPath path) {
+  switch (path) {
+    case PixelKernelPath::kScalar:
+      return true;
+#ifdef ULAK_PIXEL_X86
+    case PixelKernelPath::kSse2:
+      return true;
+    case PixelKernelPath::kAvx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+#ifdef ULAK_PIXEL_NEON
+    case PixelKernelPath::kNeon:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+Kernels KernelsFor(PixelKernelPath path) {
+  switch (path) {
+#ifdef ULAK_PIXEL_X86
+    case PixelKernelPath::kSse2:
+      return {LerpSse2, ConvertSse2};
+    case PixelKernelPath::kAvx2:
+      return {LerpAvx2, ConvertAvx2};
+#endif
+#ifdef ULAK_PIXEL_NEON
+    case PixelKernelPath::kNeon:
+      return {LerpNeon, ConvertNeon};
+#endif
+    default:
+      return {LerpScalar, ConvertScalar};
+  }
+}
+
+// Pixel-center aligned source coordinates for each destination index.
+void BuildAxis(int source, int destination, std::vector<std::int32_t>* first,
+               std::vector<std::int32_t>* second, std::vector<std::uint8_t>* weight) {
+  first->resize(static_cast<std::size_t>(destination));
+  second->resize(static_cast<std::size_t>(destination));
+  weight->resize(static_cast<std::size_t>(destination));
+  const double scale = static_cast<double>(source) / destination;
+  for (int index = 0; index < destination; ++index) {
+    const double position = std::max(0.0, (index + 0.5) * scale - 0.5);
+    int lower = static_cast<int>(position);
+    int w = static_cast<int>(std::lround((position - lower) * 128.0));
+    if (lower >= source - 1) {
+      lower = source - 1;
+      w = 0;
+    }
+    (*first)[index] = lower;
+    (*second)[index] = std::min(lower + 1, source - 1);
+    (*weight)[index] = static_cast<std::uint8_t>(w);
+  }
+}
+
+inline std::uint8_t Blend(std::uint8_t a, std::uint8_t b, int weight) {
+  return static_cast<std::uint8_t>((a * (128 - weight) + b * weight + 64) >> 7);
+}
+
+}  // namespace
+
+ImageView ViewOf(const YuvFrame& frame) {
+  ImageView view;
+  view.format = PixelFormat::kI420;
+  view.width = frame.width;
+  view.height = frame.height;
+  for (int plane = 0; plane < 3; ++plane) {
+    view.planes[plane] = frame.planes[plane];
+    view.strides[plane] = frame.strides[plane];
+  }
+  return view;
+}
+
+PixelKernelPath BestPixelKernelPath() {
+  if (PathSupported(PixelKernelPath::kAvx2)) {
+    return PixelKernelPath::kAvx2;
+  }
+  if (PathSupported(PixelKernelPath::kNeon)) {
+    return PixelKernelPath::kNeon;
+  }
+  if (PathSupported(PixelKernelPath::kSse2)) {
+    return PixelKernelPath::kSse2;
+  }
+  return PixelKernelPath::kScalar;
+}
+
+const char* ToString(PixelKernelPath path) {
+  switch (path) {
+    case PixelKernelPath::kScalar:
+      return "scalar";
+    case PixelKernelPath::kSse2:
+      return "sse2";
+    case PixelKernelPath::kAvx2:
+      return "avx2";
+    case PixelKernelPath::kNeon:
+      return "neon";
+  }
+  return "scalar";
+}
+
+FrameScaler::FrameScaler(utils::SliceWorkerPool* pool)
+    : pool_(pool), path_(BestPixelKernelPath()) {}
+
+void FrameScaler::set_path(PixelKernelPath path) {
+  path_ = PathSupported(path) ? path : BestPixelKernelPath();
+}
+
+bool FrameScaler::Convert(const ImageView& source, const RgbaImage& destination,
+                          std::string* reason) {
+  auto fail = [reason](const char* message) {
+    if (reason != nullptr) {
+      *reason = message;
+    }
+    return false;
+  };
+  if (source.width <= 0 || source.height <= 0 || source.planes[0] == nullptr) {
+    return fail("Invalid source image");
+  }
+  if (destination.width <= 0 || destination.height <= 0 || destination.data == nullptr ||
+      destination.stride < destination.width * 4) {
+    return fail("Invalid destination image");
+  }
+  const int chroma_width = (source.width + 1) / 2;
+  switch (source.format) {
+    case PixelFormat::kI420:
+      if (source.planes[1] == nullptr || source.planes[2] == nullptr ||
+          source.strides[0] < source.width || source.strides[1] < chroma_width ||
+          source.strides[2] < chroma_width) {
+        return fail("Invalid I420 planes");
+      }
+      break;
+    case PixelFormat::kNv12:
+      if (source.planes[1] == nullptr || source.strides[0] < source.width ||
+          source.strides[1] < chroma_width * 2) {
+        return fail("Invalid NV12 planes");
+      }
+      break;
+    case PixelFormat::kRgb8:
+    case PixelFormat::kBgr8:
+      if (source.strides[0] < source.width * 3) {
+        return fail("Invalid packed RGB stride");
+      }
+      break;
+  }
+
+  Prepare(source, destination);
+  const int slices = static_cast<int>(scratch_.size());
+  const int rows_per_slice = (destination.height + slices - 1) / slices;
+  auto run_slice = [&](int slice) {
+    const int first_row = slice * rows_per_slice;
+    const int end_row = std::min(destination.height, first_row + rows_per_slice);
+    if (first_row < end_row) {
+      ConvertRows(source, destination, first_row, end_row, &scratch_[static_cast<std::size_t>(slice)]);
+    }
+  };
+  if (pool_ != nullptr) {
+    pool_->Run(slices, run_slice);
+  } else {
+    run_slice(0);
+  }
+  return true;
+}
+
+void FrameScaler::Prepare(const ImageView& source, const RgbaImage& destination) {
+  const bool same = format_ == source.format && source_width_ == source.width &&
+                    source_height_ == source.height && destination_width_ == destination.width &&
+                    destination_height_ == destination.height;
+  const int slices =
+      pool_ == nullptr ? 1 : std::max(1, std::min(pool_->concurrency() * 2, destination.height));
+  if (same && static_cast<int>(scratch_.size()) == slices) {
+    return;
+  }
+
+  format_ = source.format;
+  source_width_ = source.width;
+  source_height_ = source.height;
+  destination_width_ = destination.width;
+  destination_height_ = destination.height;
+  const int chroma_width = (source.width + 1) / 2;
+  const int chroma_height = (source.height + 1) / 2;
+  BuildAxis(source.width, destination.width, &luma_x_.first, &luma_x_.second, &luma_x_.weight);
+  BuildAxis(source.height, destination.height, &luma_y_.first, &luma_y_.second, &luma_y_.weight);
+  BuildAxis(chroma_width, destination.width, &chroma_x_.first, &chroma_x_.second,
+            &chroma_x_.weight);
+  BuildAxis(chroma_height, destination.height, &chroma_y_.first, &chroma_y_.second,
+            &chroma_y_.weight);
+
+  const auto row_bytes = static_cast<std::size_t>(source.width) * 3;
+  const auto width = static_cast<std::size_t>(destination.width);
+  scratch_.assign(static_cast<std::size_t>(slices), Scratch{});
+  for (auto& scratch : scratch_) {
+    for (auto& row : scratch.rows) {
+      row.resize(row_bytes);
+    }
+    scratch.y.resize(width);
+    scratch.u.resize(width);
+    scratch.v.resize(width);
+  }
+}
+
+void FrameScaler::ConvertRows(const ImageView& source, const RgbaImage& destination,
+                              int first_row, int end_row, Scratch* scratch) const {
+  const Kernels kernels = KernelsFor(path_);
+  const int width = destination.width;
+
+  // Vertical pass: the blended source row, or the source row itself when the
+  // weight makes blending a no-op.
+  auto vertical = [&kernels](const std::uint8_t* plane, int stride, const Axis& axis, int row,
+                             int bytes, std::vector<std::uint8_t>* out) -> const std::uint8_t* {
+    const int weight = axis.weight[static_cast<std::size_t>(row)];
+    const std::uint8_t* a = plane + static_cast<std::ptrdiff_t>(axis.first[row]) * stride;
+    if (weight == 0) {
+      return a;
+    }
+    const std::uint8_t* b = plane + static_cast<std::ptrdiff_t>(axis.second[row]) * stride;
+    if (weight == 128) {
+      return b;
+    }
+    kernels.lerp(a, b, weight, out->data(), bytes);
+    return out->data();
+  };
+
+  const int chroma_width = (source.width + 1) / 2;
+  for (int row = first_row; row < end_row; ++row) {
+    std::uint8_t* out = destination.data + static_cast<std::ptrdiff_t>(row) * destination.stride;
+
+    if (source.format == PixelFormat::kRgb8 || source.format == PixelFormat::kBgr8) {
+      const std::uint8_t* line = vertical(source.planes[0], source.strides[0], luma_y_, row,
+                                          source.width * 3, &scratch->rows[0]);
+      const int red = source.format == PixelFormat::kRgb8 ? 0 : 2;
+      for (int x = 0; x < width; ++x) {
+        const std::uint8_t* a = line + 3 * luma_x_.first[x];
+        const std::uint8_t* b = line + 3 * luma_x_.second[x];
+        const int w = luma_x_.weight[x];
+        out[4 * x + 0] = Blend(a[red], b[red], w);
+        out[4 * x + 1] = Blend(a[1], b[1], w);
+        out[4 * x + 2] = Blend(a[2 - red], b[2 - red], w);
+        out[4 * x + 3] = 255;
+      }
+      continue;
+    }
+
+    const std::uint8_t* luma = vertical(source.planes[0], source.strides[0], luma_y_, row,
+                                        source.width, &scratch->rows[0]);
+    for (int x = 0; x < width; ++x) {
+      scratch->y[x] = Blend(luma[luma_x_.first[x]], luma[luma_x_.second[x]], luma_x_.weight[x]);
+    }
+
+    if (source.format == PixelFormat::kI420) {
+      const std::uint8_t* u = vertical(source.planes[1], source.strides[1], chroma_y_, row,
+                                       chroma_width, &scratch->rows[1]);
+      const std::uint8_t* v = vertical(source.planes[2], source.strides[2], chroma_y_, row,
+                                       chroma_width, &scratch->rows[2]);
+      for (int x = 0; x < width; ++x) {
+        const int a = chroma_x_.first[x];
+        const int b = chroma_x_.second[x];
+        const int w = chroma_x_.weight[x];
+        scratch->u[x] = Blend(u[a], u[b], w);
+        scratch->v[x] = Blend(v[a], v[b], w);
+      }
+    } else {
+      const std::uint8_t* uv = vertical(source.planes[1], source.strides[1], chroma_y_, row,
+                                        chroma_width * 2, &scratch->rows[1]);
+      for (int x = 0; x < width; ++x) {
+        const int a = 2 * chroma_x_.first[x];
+        const int b = 2 * chroma_x_.second[x];
+        const int w = chroma_x_.weight[x];
+        scratch->u[x] = Blend(uv[a], uv[b], w);
+        scratch->v[x] = Blend(uv[a + 1], uv[b + 1], w);
+      }
+    }
+
+    kernels.convert(scratch->y.data(), scratch->u.data(), scratch->v.data(), out, width);
+  }
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "SliceWorkerPool.h"
+#include "YuvFramePool.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ulak::comms {
+
+enum class PixelFormat {
+  kI420,
+  kNv12,
+  kRgb8,  // rosbridge sensor_msgs/Image "rgb8"
+  kBgr8,  // rosbridge sensor_msgs/Image "bgr8"
+};
+
+// Non-owning source image. Planes: I420 = Y, U, V; NV12 = Y, UV; RGB/BGR = one
+// packed plane.
+struct ImageView {
+  PixelFormat format{PixelFormat::kI420};
+  int width{0};
+  int height{0};
+  const std::uint8_t* planes[3]{nullptr, nullptr, nullptr};
+  int strides[3]{0, 0, 0};
+};
+
+ImageView ViewOf(const YuvFrame& frame);
+
+// Caller-owned RGBA8 destination (e.g. a pooled texture staging buffer).
+struct RgbaImage {
+  std::uint8_t* data{nullptr};
+  int width{0};
+  int height{0};
+  int stride{0};
+};
+
+enum class PixelKernelPath {
+  kScalar,
+  kSse2,
+  kAvx2,
+  kNeon,
+};
+
+// Fastest kernel set supported by this CPU.
+PixelKernelPath BestPixelKernelPath();
+const char* ToString(PixelKernelPath path);
+
+// Colorspace conversion (BT.601 limited range for YUV) fused with bilinear
+// scaling, written straight into the destination: no full-size intermediate
+// image. Rows are split into slices across `pool` when one is given.
+// Not thread-safe; use one scaler per stream.
+class FrameScaler {
+ public:
+  explicit FrameScaler(utils::SliceWorkerPool* pool = nullptr);
+
+  // Selects a kernel set (unsupported paths fall back to the best one);
+  // kScalar is the reference the SIMD paths are tested against.
+  void set_path(PixelKernelPath path);
+  PixelKernelPath path() const { return path_; }
+
+  bool Convert(const ImageView& source, const RgbaImage& destination, std::string* reason);
+
+ private:
+  struct Axis {
+    std::vector<std::int32_t> first;
+    std::vector<std::int32_t> second;
+    std::vector<std::uint8_t> weight;  // 0..128, weight of `second`
+  };
+
+  struct Scratch {
+    std::vector<std::uint8_t> rows[3];
+    std::vector<std::uint8_t> y;
+    std::vector<std::uint8_t> u;
+    std::vector<std::uint8_t> v;
+  };
+
+  void Prepare(const ImageView& source, const RgbaImage& destination);
+  void ConvertRows(const ImageView& source, const RgbaImage& destination, int first_row,
+                   int end_row, Scratch* scratch) const;
+
+  utils::SliceWorkerPool* pool_;
+  PixelKernelPath path_;
+
+  // Tables for the current geometry; rebuilt only when it changes.
+  PixelFormat format_{PixelFormat::kI420};
+  int source_width_{0};
+  int source_height_{0};
+  int destination_width_{0};
+  int destination_height_{0};
+  Axis luma_x_;
+  Axis luma_y_;
+  Axis chroma_x_;
+  Axis chroma_y_;
+  std::vector<Scratch> scratch_;
+};
+
+}  // namespace ulak::comms
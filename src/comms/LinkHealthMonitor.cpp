@@ -0,0 +1,261 @@
+#include "LinkHealthMonitor.h"
+
+#include <cstdio>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace ulak::comms {
+namespace {
+
+constexpr std::uint8_t kMaxForwardSequenceGap = 128;
+
+LinkHealthThresholds& ThresholdsFor(LinkHealthPolicy* policy, LinkChannel channel) {
+  return policy->channels[static_cast<std::size_t>(channel)];
+}
+
+std::string FormatDouble(double value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+  return buffer;
+}
+
+}  // namespace
+
+LinkHealthPolicy DefaultLinkHealthPolicy() {
+  LinkHealthPolicy policy;
+
+  auto& mavlink = ThresholdsFor(&policy, LinkChannel::kMavlinkUdp);
+  mavlink.loss_timeout_us = 2'000'000;
+  mavlink.degraded_jitter_us = 250'000;
+  mavlink.degraded_loss_ratio = 0.10;
+
+  auto& companion = ThresholdsFor(&policy, LinkChannel::kCompanionTcp);
+  companion.loss_timeout_us = 3'000'000;
+  companion.degraded_jitter_us = 500'000;
+
+  // The command link is legitimately idle between commands; judge it by RTT only.
+  auto& command = ThresholdsFor(&policy, LinkChannel::kCommandTcp);
+  command.degraded_rtt_us = 800'000;
+
+  auto& stream = ThresholdsFor(&policy, LinkChannel::kStream);
+  stream.loss_timeout_us = 2'000'000;
+  stream.degraded_jitter_us = 200'000;
+
+  return policy;
+}
+
+LinkHealthMonitor::LinkHealthMonitor(LinkHealthPolicy policy) : policy_(std::move(policy)) {}
+
+void LinkHealthMonitor::SetFrameSink(FrameSink sink) {
+  std::lock_guard<std::mutex> lock(config_mutex_);
+  frame_sink_ = std::move(sink);
+}
+
+void LinkHealthMonitor::SetLossSink(LossSink sink) {
+  std::lock_guard<std::mutex> lock(config_mutex_);
+  loss_sink_ = std::move(sink);
+}
+
+void LinkHealthMonitor::SetPolicy(const LinkHealthPolicy& policy) {
+  std::lock_guard<std::mutex> lock(config_mutex_);
+  policy_ = policy;
+}
+
+void LinkHealthMonitor::OnPacket(LinkChannel channel,
+                                 std::int64_t receive_time_us,
+                                 std::size_t size_bytes) {
+  auto& state = StateFor(channel);
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.seen && receive_time_us >= state.last_packet_us) {
+    state.interarrival.Record(static_cast<std::uint64_t>(receive_time_us - state.last_packet_us));
+  }
+  if (!state.seen || receive_time_us > state.last_packet_us) {
+    state.last_packet_us = receive_time_us;
+  }
+  if (!state.seen && state.window_start_us == 0) {
+    state.window_start_us = receive_time_us;
+  }
+  state.seen = true;
+  ++state.total_packets;
+  ++state.window_packets;
+  state.window_bytes += size_bytes;
+}
+
+void LinkHealthMonitor::OnMavlinkSequence(std::uint8_t system_id,
+                                          std::uint8_t component_id,
+                                          std::uint8_t sequence) {
+  auto& state = StateFor(LinkChannel::kMavlinkUdp);
+  const auto sender = static_cast<std::uint16_t>(system_id << 8 | component_id);
+  std::lock_guard<std::mutex> lock(state.mutex);
+  const auto [last, first] = state.last_sequences.try_emplace(sender, sequence);
+  if (!first) {
+    const auto gap = static_cast<std::uint8_t>(sequence - last->second - 1);
+    if (gap < kMaxForwardSequenceGap) {
+      state.window_lost += gap;
+      state.total_lost += gap;
+    }
+    last->second = sequence;
+  }
+  ++state.window_sequenced;
+}
+
+void LinkHealthMonitor::OnRoundTrip(LinkChannel channel, std::int64_t rtt_us) {
+  if (rtt_us < 0) {
+    return;
+  }
+  auto& state = StateFor(channel);
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.rtt.Record(static_cast<std::uint64_t>(rtt_us));
+}
+
+std::array<LinkHealthFrame, kLinkChannelCount> LinkHealthMonitor::Evaluate(std::int64_t now_us) {
+  LinkHealthPolicy policy;
+  FrameSink frame_sink;
+  LossSink loss_sink;
+  {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    policy = policy_;
+    frame_sink = frame_sink_;
+    loss_sink = loss_sink_;
+  }
+
+  std::array<LinkHealthFrame, kLinkChannelCount> frames;
+  std::vector<LinkLossEvent> losses;
+
+  for (std::size_t index = 0; index < kLinkChannelCount; ++index) {
+    const auto channel = static_cast<LinkChannel>(index);
+    const auto& limits = policy.channels[index];
+    auto& state = channels_[index];
+    auto& frame = frames[index];
+    frame.channel = channel;
+    frame.sample_time_us = now_us;
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    const std::int64_t window_us = now_us - state.window_start_us;
+    if (state.window_start_us != 0 && window_us > 0) {
+      const double window_s = static_cast<double>(window_us) / 1e6;
+      frame.rate_hz = static_cast<double>(state.window_packets) / window_s;
+      frame.throughput_bps = static_cast<double>(state.window_bytes) * 8.0 / window_s;
+    }
+    frame.total_packets = state.total_packets;
+    frame.interarrival_p50_us = state.interarrival.ValueAtPercentile(50.0);
+    frame.interarrival_p99_us = state.interarrival.ValueAtPercentile(99.0);
+    frame.jitter_us = frame.interarrival_p99_us > frame.interarrival_p50_us
+                          ? frame.interarrival_p99_us - frame.interarrival_p50_us
+                          : 0;
+    const std::uint64_t expected = state.window_sequenced + state.window_lost;
+    frame.loss_ratio =
+        expected == 0 ? 0.0 : static_cast<double>(state.window_lost) / static_cast<double>(expected);
+    frame.total_lost = state.total_lost;
+    frame.rtt_p50_us = state.rtt.ValueAtPercentile(50.0);
+    frame.rtt_p99_us = state.rtt.ValueAtPercentile(99.0);
+    frame.last_packet_age_us = state.seen ? now_us - state.last_packet_us : 0;
+
+    LinkHealthState next = LinkHealthState::kWaiting;
+    if (state.seen) {
+      next = LinkHealthState::kOk;
+      if (limits.loss_timeout_us > 0 && frame.last_packet_age_us > limits.loss_timeout_us) {
+        next = LinkHealthState::kLost;
+      } else if ((limits.degraded_jitter_us > 0 &&
+                  frame.jitter_us > static_cast<std::uint64_t>(limits.degraded_jitter_us)) ||
+                 (limits.degraded_loss_ratio > 0.0 &&
+                  frame.loss_ratio > limits.degraded_loss_ratio) ||
+                 (limits.degraded_rtt_us > 0 &&
+                  frame.rtt_p99_us > static_cast<std::uint64_t>(limits.degraded_rtt_us))) {
+        next = LinkHealthState::kDegraded;
+      }
+    }
+    if (next == LinkHealthState::kLost && state.state != LinkHealthState::kLost) {
+      LinkLossEvent event;
+      event.channel = channel;
+      event.code = LossEventCode(channel);
+      event.raised_time_us = now_us;
+      event.silence_us = frame.last_packet_age_us;
+      losses.push_back(std::move(event));
+    }
+    state.state = next;
+    frame.state = next;
+
+    state.window_start_us = now_us;
+    state.window_packets = 0;
+    state.window_bytes = 0;
+    state.window_sequenced = 0;
+    state.window_lost = 0;
+    state.interarrival.Reset();
+    state.rtt.Reset();
+  }
+
+  if (frame_sink) {
+    for (const auto& frame : frames) {
+      frame_sink(frame);
+    }
+  }
+  if (loss_sink) {
+    for (const auto& loss : losses) {
+      loss_sink(loss);
+    }
+  }
+  return frames;
+}
+
+const char* ToString(LinkChannel channel) {
+  switch (channel) {
+    case LinkChannel::kMavlinkUdp:
+      return "mavlink_udp";
+    case LinkChannel::kCompanionTcp:
+      return "companion_tcp";
+    case LinkChannel::kCommandTcp:
+      return "command_tcp";
+    case LinkChannel::kStream:
+      return "stream";
+  }
+  return "mavlink_udp";
+}
+
+const char* ToString(LinkHealthState state) {
+  switch (state) {
+    case LinkHealthState::kWaiting:
+      return "WAITING";
+    case LinkHealthState::kOk:
+      return "OK";
+    case LinkHealthState::kDegraded:
+      return "DEGRADED";
+    case LinkHealthState::kLost:
+      return "LOST";
+  }
+  return "WAITING";
+}
+
+const char* LossEventCode(LinkChannel channel) {
+  switch (channel) {
+    case LinkChannel::kMavlinkUdp:
+      return "TELEMETRY_LOSS";
+    case LinkChannel::kCompanionTcp:
+    case LinkChannel::kCommandTcp:
+      return "CC_LINK_LOSS";
+    case LinkChannel::kStream:
+      return "STREAM_LOSS";
+  }
+  return "TELEMETRY_LOSS";
+}
+
+std::string SerializeLinkHealthPayload(const LinkHealthFrame& frame) {
+  std::ostringstream out;
+  out << "{\"channel\":\"" << ToString(frame.channel) << "\""
+      << ",\"interarrival_p50_us\":" << frame.interarrival_p50_us
+      << ",\"interarrival_p99_us\":" << frame.interarrival_p99_us
+      << ",\"jitter_us\":" << frame.jitter_us
+      << ",\"last_packet_age_us\":" << frame.last_packet_age_us
+      << ",\"loss_ratio\":" << FormatDouble(frame.loss_ratio)
+      << ",\"rate_hz\":" << FormatDouble(frame.rate_hz)
+      << ",\"rtt_p50_us\":" << frame.rtt_p50_us
+      << ",\"rtt_p99_us\":" << frame.rtt_p99_us
+      << ",\"state\":\"" << ToString(frame.state) << "\""
+      << ",\"throughput_bps\":" << FormatDouble(frame.throughput_bps)
+      << ",\"total_lost\":" << frame.total_lost
+      << ",\"total_packets\":" << frame.total_packets << "}";
+  return out.str();
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "HdrHistogram.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ulak::comms {
+
+enum class LinkChannel : std::uint8_t {
+  kMavlinkUdp,
+  kCompanionTcp,
+  kCommandTcp,
+  kStream,
+};
+
+inline constexpr std::size_t kLinkChannelCount = 4;
+
+enum class LinkHealthState : std::uint8_t {
+  kWaiting,
+  kOk,
+  kDegraded,
+  kLost,
+};
+
+// Per-channel limits. Loaded from the active profile's `link_health` section;
+// a zero loss timeout disables loss detection for that channel.
+struct LinkHealthThresholds {
+  std::int64_t loss_timeout_us{0};
+  std::int64_t degraded_jitter_us{0};
+  double degraded_loss_ratio{0.0};
+  std::int64_t degraded_rtt_us{0};
+};
+
+struct LinkHealthPolicy {
+  std::array<LinkHealthThresholds, kLinkChannelCount> channels{};
+};
+
+// Built-in values used when the active profile has no `link_health` section.
+LinkHealthPolicy DefaultLinkHealthPolicy();
+
+// One `telemetry/health` sample for a channel, covering the window since the
+// previous Evaluate().
+struct LinkHealthFrame {
+  LinkChannel channel{LinkChannel::kMavlinkUdp};
+  LinkHealthState state{LinkHealthState::kWaiting};
+  std::int64_t sample_time_us{0};
+  std::uint64_t total_packets{0};
+  double rate_hz{0.0};
+  double throughput_bps{0.0};
+  std::uint64_t interarrival_p50_us{0};
+  std::uint64_t interarrival_p99_us{0};
+  // p99 - p50 of packet inter-arrival time.
+  std::uint64_t jitter_us{0};
+  // MAVLink sequence-gap loss; 0 for channels without sequence numbers.
+  double loss_ratio{0.0};
+  std::uint64_t total_lost{0};
+  std::uint64_t rtt_p50_us{0};
+  std::uint64_t rtt_p99_us{0};
+  std::int64_t last_packet_age_us{0};
+};
+
+// Raised once per loss edge; `code` is the ExceptionClassifier event code.
+struct LinkLossEvent {
+  LinkChannel channel{LinkChannel::kMavlinkUdp};
+  std::string code;
+  std::int64_t raised_time_us{0};
+  // Silence observed when the loss was detected; the detection latency.
+  std::int64_t silence_us{0};
+};
+
+// Measures every station link and turns silence into safety events, so
+// link-loss detection latency is a configured, measured number instead of a
+// side effect of socket timeouts.
+//
+// On*() hooks are called by the transport workers; Evaluate() is called by
+// the core's health timer. Each channel has its own lock, so workers on
+// different channels never contend.
+class LinkHealthMonitor {
+ public:
+  using FrameSink = std::function<void(const LinkHealthFrame&)>;
+  using LossSink = std::function<void(const LinkLossEvent&)>;
+
+  explicit LinkHealthMonitor(LinkHealthPolicy policy = DefaultLinkHealthPolicy());
+
+  void SetFrameSink(FrameSink sink);
+  void SetLossSink(LossSink sink);
+
+  // Applies new thresholds, e.g. after SwitchActiveProfile.
+  void SetPolicy(const LinkHealthPolicy& policy);
+
+  void OnPacket(LinkChannel channel, std::int64_t receive_time_us, std::size_t size_bytes);
+
+  // MAVLink header sequence (wraps at 256). Each sender (system id,
+  // component id) numbers its own messages, so sequences are tracked per
+  // sender. Gaps count as lost packets; backwards jumps are treated as
+  // reordering/reboot and resynchronize.
+  void OnMavlinkSequence(std::uint8_t system_id, std::uint8_t component_id, std::uint8_t sequence);
+
+  // Command round trip (request sent -> ACK/REJECT received).
+  void OnRoundTrip(LinkChannel channel, std::int64_t rtt_us);
+
+  // Closes the current window, publishes one frame per channel and raises
+  // loss events on OK -> LOST edges.
+  std::array<LinkHealthFrame, kLinkChannelCount> Evaluate(std::int64_t now_us);
+
+ private:
+  struct ChannelState {
+    std::mutex mutex;
+    bool seen{false};
+    std::int64_t last_packet_us{0};
+    std::int64_t window_start_us{0};
+    std::uint64_t total_packets{0};
+    std::uint64_t window_packets{0};
+    std::uint64_t window_bytes{0};
+    utils::HdrHistogram interarrival;
+    utils::HdrHistogram rtt;
+    // (system id << 8 | component id) -> last sequence seen from that sender.
+    std::unordered_map<std::uint16_t, std::uint8_t> last_sequences;
+    std::uint64_t window_sequenced{0};
+    std::uint64_t window_lost{0};
+    std::uint64_t total_lost{0};
+    LinkHealthState state{LinkHealthState::kWaiting};
+  };
+
+  ChannelState& StateFor(LinkChannel channel) {
+    return channels_[static_cast<std::size_t>(channel)];
+  }
+
+  std::array<ChannelState, kLinkChannelCount> channels_;
+
+  std::mutex config_mutex_;
+  LinkHealthPolicy policy_;
+  FrameSink frame_sink_;
+  LossSink loss_sink_;
+};
+
+const char* ToString(LinkChannel channel);
+const char* ToString(LinkHealthState state);
+
+// Event code raised when `channel` goes silent (TELEMETRY_LOSS, CC_LINK_LOSS, STREAM_LOSS).
+const char* LossEventCode(LinkChannel channel);
+
+// Deterministic `telemetry/health` payload (keys sorted, like SerializeCommandRequest).
+std::string SerializeLinkHealthPayload(const LinkHealthFrame& frame);
+
+}  // namespace ulak::comms
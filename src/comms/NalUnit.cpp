@@ -0,0 +1,91 @@
+#include "NalUnit.h"
+
+#include <cstring>
+
+namespace ulak::comms {
+namespace {
+
+// Offset of the next 00 00 01 at or after `from`, or `size`.
+std::size_t FindStartCode(const std::uint8_t* bytes, std::size_t size, std::size_t from) {
+  while (from + 3 <= size) {
+    const void* hit = std::memchr(bytes + from, 0x01, size - from);
+    if (hit == nullptr) {
+      return size;
+    }
+    const std::size_t one = static_cast<std::size_t>(static_cast<const std::uint8_t*>(hit) - bytes);
+    if (one >= from + 2 && bytes[one - 1] == 0 && bytes[one - 2] == 0) {
+      return one - 2;
+    }
+    from = one + 1;
+  }
+  return size;
+}
+
+}  // namespace
+
+NalUnit ParseNalHeader(VideoCodec codec, const std::uint8_t* data, std::size_t size) {
+  NalUnit unit;
+  unit.data = data;
+  unit.size = size;
+  if (size == 0) {
+    return unit;
+  }
+
+  if (codec == VideoCodec::kH264) {
+    const int ref_idc = (data[0] >> 5) & 0x03;
+    unit.type = data[0] & 0x1F;
+    unit.vcl = unit.type >= 1 && unit.type <= 5;
+    unit.keyframe = unit.type == 5;
+    unit.reference = ref_idc != 0;
+    unit.parameter_set = unit.type == 7 || unit.type == 8;
+    return unit;
+  }
+
+  if (size < 2) {
+    return unit;
+  }
+  unit.type = (data[0] >> 1) & 0x3F;
+  unit.vcl = unit.type <= 31;
+  unit.keyframe = unit.type >= 16 && unit.type <= 23;
+  // TRAIL_N, TSA_N, STSA_N, RADL_N, RASL_N and reserved RSV_VCL_N10/12/14.
+  unit.reference = unit.vcl && !(unit.type <= 14 && unit.type % 2 == 0);
+  unit.parameter_set = unit.type >= 32 && unit.type <= 34;
+  return unit;
+}
+
+std::vector<NalUnit> SplitAnnexB(VideoCodec codec, const std::uint8_t* bytes, std::size_t size) {
+  std::vector<NalUnit> units;
+  std::size_t start = FindStartCode(bytes, size, 0);
+  while (start < size) {
+    const std::size_t begin = start + 3;
+    const std::size_t next = FindStartCode(bytes, size, begin);
+    std::size_t end = next;
+    // Zero bytes before the next start code (including the leading zero of a
+    // 4-byte start code) are not part of this unit.
+    while (end > begin && bytes[end - 1] == 0) {
+      --end;
+    }
+    if (end > begin) {
+      units.push_back(ParseNalHeader(codec, bytes + begin, end - begin));
+    }
+    start = next;
+  }
+  return units;
+}
+
+AccessUnitInfo ClassifyAccessUnit(VideoCodec codec, const std::uint8_t* bytes, std::size_t size) {
+  AccessUnitInfo info;
+  for (const auto& unit : SplitAnnexB(codec, bytes, size)) {
+    ++info.nal_count;
+    info.has_parameter_sets = info.has_parameter_sets || unit.parameter_set;
+    if (!unit.vcl) {
+      continue;
+    }
+    info.has_vcl = true;
+    info.keyframe = info.keyframe || unit.keyframe;
+    info.reference = info.reference || unit.reference;
+  }
+  return info;
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ulak::comms {
+
+enum class VideoCodec {
+  kH264,
+  kH265,
+};
+
+struct NalUnit {
+  const std::uint8_t* data{nullptr};  // First header byte, start code excluded.
+  std::size_t size{0};
+  int type{0};
+  bool vcl{false};
+  // IDR (H.264) or IRAP (H.265): decoding can start here.
+  bool keyframe{false};
+  // False for nal_ref_idc == 0 (H.264) or sub-layer non-reference pictures
+  // (H.265); such pictures can be skipped without corrupting later frames.
+  bool reference{false};
+  bool parameter_set{false};
+};
+
+// Classification of one Annex B access unit (one coded picture).
+struct AccessUnitInfo {
+  bool has_vcl{false};
+  bool keyframe{false};
+  bool reference{false};
+  bool has_parameter_sets{false};
+  std::size_t nal_count{0};
+};
+
+// Splits an Annex B byte stream (00 00 01 / 00 00 00 01 start codes).
+// Returned units point into `bytes`.
+std::vector<NalUnit> SplitAnnexB(VideoCodec codec, const std::uint8_t* bytes, std::size_t size);
+
+// Parses the NAL header at `data` (start code already stripped).
+NalUnit ParseNalHeader(VideoCodec codec, const std::uint8_t* data, std::size_t size);
+
+AccessUnitInfo ClassifyAccessUnit(VideoCodec codec, const std::uint8_t* bytes, std::size_t size);
+
+}  // namespace ulak::comms
@@ -0,0 +1,261 @@
+#include "PerceptionOverlayRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace ulak::comms {
+namespace {
+
+constexpr std::uint32_t kCrosshairColor = 0x99FFFFFFu;
+constexpr std::uint32_t kStaleColor = 0x80808080u;
+constexpr std::uint32_t kBarBackgroundColor = 0x60303030u;
+
+enum Shape {
+  kShapeDiamond = 0,
+  kShapeTriangle,
+  kShapeSquare,
+  kShapeCircle,
+};
+
+constexpr int kCircleSegments = 24;
+
+struct NamedColor {
+  std::string_view name;
+  std::uint32_t rgba;  // 0xAABBGGRR
+};
+
+constexpr NamedColor kColors[] = {
+    {"red", 0xFF3030E0u},    {"green", 0xFF40C040u},  {"blue", 0xFFE08030u},
+    {"yellow", 0xFF30D8F0u}, {"orange", 0xFF2090F0u}, {"purple", 0xFFC040A0u},
+    {"black", 0xFF202020u},
+};
+
+std::uint32_t ColorFor(std::string_view color) {
+  for (const auto& entry : kColors) {
+    if (entry.name == color) {
+      return entry.rgba;
+    }
+  }
+  return 0xFFFFFFFFu;
+}
+
+int ShapeFor(std::string_view shape) {
+  if (shape == "triangle") {
+    return kShapeTriangle;
+  }
+  if (shape == "square" || shape == "rectangle") {
+    return kShapeSquare;
+  }
+  if (shape == "circle") {
+    return kShapeCircle;
+  }
+  return kShapeDiamond;
+}
+
+std::uint32_t WithAlpha(std::uint32_t rgba, float alpha) {
+  const auto a = static_cast<std::uint32_t>(std::clamp(alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+  return (rgba & 0x00FFFFFFu) | (a << 24);
+}
+
+float Lerp(float a, float b, float t) {
+  return a + (b - a) * t;
+}
+
+class Emitter {
+ public:
+  Emitter(std::vector<OverlayVertex>* out, float aspect) : out_(out), x_scale_(1.0f / aspect) {}
+
+  void Triangle(float x0, float y0, float x1, float y1, float x2, float y2, std::uint32_t rgba) {
+    out_->push_back({x0, y0, rgba});
+    out_->push_back({x1, y1, rgba});
+    out_->push_back({x2, y2, rgba});
+  }
+
+  // Axis-aligned rectangle in clip space.
+  void Rect(float left, float bottom, float right, float top, std::uint32_t rgba) {
+    Triangle(left, bottom, right, bottom, right, top, rgba);
+    Triangle(left, bottom, right, top, left, top, rgba);
+  }
+
+  // Segment of the given clip-space width, corrected for aspect.
+  void Line(float x0, float y0, float x1, float y1, float width, std::uint32_t rgba) {
+    const float dx = (x1 - x0) / x_scale_;
+    const float dy = y1 - y0;
+    const float length = std::sqrt(dx * dx + dy * dy);
+    if (length <= 0.0f) {
+      return;
+    }
+    const float nx = -dy / length * width * 0.5f * x_scale_;
+    const float ny = dx / length * width * 0.5f;
+    Triangle(x0 + nx, y0 + ny, x1 + nx, y1 + ny, x1 - nx, y1 - ny, rgba);
+    Triangle(x0 + nx, y0 + ny, x1 - nx, y1 - ny, x0 - nx, y0 - ny, rgba);
+  }
+
+  // Regular polygon around (cx, cy), `radius` in clip-space height units.
+  void Polygon(float cx, float cy, float radius, int sides, float phase, std::uint32_t rgba) {
+    constexpr float kTwoPi = 6.28318530718f;
+    float px = cx + std::cos(phase) * radius * x_scale_;
+    float py = cy + std::sin(phase) * radius;
+    for (int side = 1; side <= sides; ++side) {
+      const float angle = phase + kTwoPi * static_cast<float>(side) / static_cast<float>(sides);
+      const float qx = cx + std::cos(angle) * radius * x_scale_;
+      const float qy = cy + std::sin(angle) * radius;
+      Triangle(cx, cy, px, py, qx, qy, rgba);
+      px = qx;
+      py = qy;
+    }
+  }
+
+  float x_scale() const { return x_scale_; }
+
+ private:
+  std::vector<OverlayVertex>* out_;
+  float x_scale_;
+};
+
+}  // namespace
+
+bool PerceptionOverlayRenderer::DisplayState::operator==(const DisplayState& other) const {
+  return x == other.x && y == other.y && confidence == other.confidence &&
+         color == other.color && shape == other.shape && has_target == other.has_target &&
+         stale == other.stale;
+}
+
+PerceptionOverlayRenderer::PerceptionOverlayRenderer(OverlayStyle style) : style_(style) {
+  for (auto& buffer : buffers_) {
+    buffer.reserve(256);
+  }
+}
+
+void PerceptionOverlayRenderer::OnTarget(const models::PerceptionTarget& target) {
+  Sample sample;
+  sample.x = static_cast<float>(std::clamp(target.alignment_dx, -1.0, 1.0));
+  // Image space has +dy down, clip space has +y up.
+  sample.y = static_cast<float>(-std::clamp(target.alignment_dy, -1.0, 1.0));
+  sample.confidence = static_cast<float>(std::clamp(target.confidence, 0.0, 1.0));
+  sample.color = ColorFor(target.color);
+  sample.shape = ShapeFor(target.shape);
+  sample.time_us = target.receive_time_us;
+  sample.valid = true;
+
+  std::lock_guard<std::mutex> lock(samples_mutex_);
+  if (current_.valid && sample.time_us < current_.time_us) {
+    return;
+  }
+  previous_ = current_;
+  current_ = sample;
+}
+
+PerceptionOverlayRenderer::DisplayState PerceptionOverlayRenderer::Interpolate(
+    std::int64_t now_us) const {
+  Sample previous;
+  Sample current;
+  {
+    std::lock_guard<std::mutex> lock(samples_mutex_);
+    previous = previous_;
+    current = current_;
+  }
+
+  DisplayState state;
+  if (!current.valid) {
+    return state;
+  }
+  state.has_target = true;
+  state.color = current.color;
+  state.shape = current.shape;
+  state.stale = now_us - current.time_us > style_.stale_after_us;
+
+  float t = 1.0f;
+  const std::int64_t span = current.time_us - previous.time_us;
+  if (previous.valid && span > 0 && !state.stale) {
+    const std::int64_t render_time = now_us - style_.interpolation_delay_us;
+    t = std::clamp(static_cast<float>(render_time - previous.time_us) / static_cast<float>(span),
+                   0.0f, 1.0f);
+  }
+  if (t >= 1.0f) {
+    state.x = current.x;
+    state.y = current.y;
+    state.confidence = current.confidence;
+  } else {
+    state.x = Lerp(previous.x, current.x, t);
+    state.y = Lerp(previous.y, current.y, t);
+    state.confidence = Lerp(previous.confidence, current.confidence, t);
+  }
+  return state;
+}
+
+void PerceptionOverlayRenderer::Build(const DisplayState& state,
+                                      std::vector<OverlayVertex>* out) const {
+  out->clear();
+  Emitter emit(out, style_.aspect);
+  const float arm = style_.marker_size * 0.5f;
+  const float width = style_.line_width;
+
+  // Frame-center crosshair.
+  emit.Line(-arm * emit.x_scale(), 0.0f, arm * emit.x_scale(), 0.0f, width, kCrosshairColor);
+  emit.Line(0.0f, -arm, 0.0f, arm, width, kCrosshairColor);
+  if (!state.has_target) {
+    return;
+  }
+
+  const std::uint32_t color =
+      state.stale ? kStaleColor : WithAlpha(state.color, 0.3f + 0.7f * state.confidence);
+  if (!state.stale) {
+    emit.Line(0.0f, 0.0f, state.x, state.y, width, WithAlpha(state.color, 0.6f));
+  }
+
+  const float radius = style_.marker_size;
+  switch (state.shape) {
+    case kShapeTriangle:
+      emit.Polygon(state.x, state.y, radius, 3, 1.5707963f, color);
+      break;
+    case kShapeSquare:
+      emit.Polygon(state.x, state.y, radius, 4, 0.7853982f, color);
+      break;
+    case kShapeCircle:
+      emit.Polygon(state.x, state.y, radius, kCircleSegments, 0.0f, color);
+      break;
+    default:
+      emit.Polygon(state.x, state.y, radius, 4, 0.0f, color);
+      break;
+  }
+
+  // Confidence bar, bottom-left corner.
+  const float left = -0.95f;
+  const float bottom = -0.95f;
+  const float bar_width = 0.3f * emit.x_scale();
+  const float bar_height = 0.03f;
+  emit.Rect(left, bottom, left + bar_width, bottom + bar_height, kBarBackgroundColor);
+  const std::uint32_t bar_color = state.stale              ? kStaleColor
+                                  : state.confidence >= 0.7f ? 0xE040C040u
+                                  : state.confidence >= 0.4f ? 0xE030D8F0u
+                                                             : 0xE03030E0u;
+  if (state.confidence > 0.0f) {
+    emit.Rect(left, bottom, left + bar_width * state.confidence, bottom + bar_height, bar_color);
+  }
+}
+
+bool PerceptionOverlayRenderer::Render(std::int64_t now_us) {
+  const DisplayState state = Interpolate(now_us);
+  if (last_state_ && *last_state_ == state) {
+    return false;
+  }
+  last_state_ = state;
+
+  // front_index_ is only written by this thread.
+  auto& back = buffers_[1 - front_index_];
+  Build(state, &back);
+
+  std::lock_guard<std::mutex> lock(front_mutex_);
+  front_index_ = 1 - front_index_;
+  ++generation_;
+  return true;
+}
+
+std::uint64_t PerceptionOverlayRenderer::generation() const {
+  std::lock_guard<std::mutex> lock(front_mutex_);
+  return generation_;
+}
+
+}  // namespace ulak::comms
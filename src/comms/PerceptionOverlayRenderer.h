@@ -0,0 +1,101 @@
+#pragma once
+
+#include "PerceptionTarget.h"
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace ulak::comms {
+
+// 12-byte vertex, clip-space position and packed 0xAABBGGRR color. The whole
+// overlay is one triangle list.
+struct OverlayVertex {
+  float x{0.0f};
+  float y{0.0f};
+  std::uint32_t rgba{0};
+};
+
+struct OverlayStyle {
+  // Viewport width / height, keeps markers square.
+  float aspect{16.0f / 9.0f};
+  float marker_size{0.06f};
+  float line_width{0.006f};
+  // Samples are displayed this far in the past so there is always a pair to
+  // interpolate between; should cover one perception interval.
+  std::int64_t interpolation_delay_us{100'000};
+  // Without a new sample for this long the marker is drawn as stale (gray).
+  std::int64_t stale_after_us{1'000'000};
+};
+
+// OUTPUTS_ONLY overlay path: turns the perception/output stream into a small
+// vertex buffer (well under 2 KB per frame) instead of decoding video.
+//
+// Threads: OnTarget() from the mission component, Render() from the display
+// tick, ReadFront() from the UI upload. Render() builds into the back buffer
+// and only swaps under the front lock, so readers never see a partial frame.
+class PerceptionOverlayRenderer {
+ public:
+  explicit PerceptionOverlayRenderer(OverlayStyle style = {});
+
+  void OnTarget(const models::PerceptionTarget& target);
+
+  // Builds the overlay for display time `now_us`. Returns false (and keeps the
+  // front buffer) when the frame would be identical to the last one.
+  bool Render(std::int64_t now_us);
+
+  // Calls fn(const OverlayVertex*, std::size_t count) on the front buffer.
+  template <typename Fn>
+  void ReadFront(Fn&& fn) const {
+    std::lock_guard<std::mutex> lock(front_mutex_);
+    const auto& front = buffers_[front_index_];
+    fn(front.data(), front.size());
+  }
+
+  // Incremented on every published frame; the UI can skip unchanged uploads.
+  std::uint64_t generation() const;
+
+ private:
+  struct Sample {
+    float x{0.0f};
+    float y{0.0f};
+    float confidence{0.0f};
+    std::uint32_t color{0};
+    int shape{0};
+    std::int64_t time_us{0};
+    bool valid{false};
+  };
+
+  struct DisplayState {
+    float x{0.0f};
+    float y{0.0f};
+    float confidence{0.0f};
+    std::uint32_t color{0};
+    int shape{0};
+    bool has_target{false};
+    bool stale{false};
+
+    bool operator==(const DisplayState& other) const;
+  };
+
+  DisplayState Interpolate(std::int64_t now_us) const;
+  void Build(const DisplayState& state, std::vector<OverlayVertex>* out) const;
+
+  const OverlayStyle style_;
+
+  mutable std::mutex samples_mutex_;
+  Sample previous_;
+  Sample current_;
+
+  // Render-thread state.
+  std::optional<DisplayState> last_state_;
+
+  mutable std::mutex front_mutex_;
+  std::array<std::vector<OverlayVertex>, 2> buffers_;
+  int front_index_{0};
+  std::uint64_t generation_{0};
+};
+
+}  // namespace ulak::comms
@@ -0,0 +1,328 @@
+#include "SegmentRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace ulak::comms {
+namespace {
+
+constexpr char kIndexMagic[8] = {'U', 'L', 'A', 'K', 'I', 'D', 'X', '1'};
+constexpr std::size_t kIndexHeaderSize = 16;
+constexpr std::size_t kIndexRecordSize = 32;
+
+void PutLe(std::vector<std::uint8_t>* out, std::uint64_t value, int bytes) {
+  for (int index = 0; index < bytes; ++index) {
+    out->push_back(static_cast<std::uint8_t>(value >> (8 * index)));
+  }
+}
+
+std::uint64_t GetLe(const std::uint8_t* data, int bytes) {
+  std::uint64_t value = 0;
+  for (int index = bytes - 1; index >= 0; --index) {
+    value = (value << 8) | data[index];
+  }
+  return value;
+}
+
+std::string SegmentName(const std::string& prefix, std::uint32_t segment) {
+  char number[16];
+  std::snprintf(number, sizeof(number), "%06u", segment);
+  return prefix + "-" + number;
+}
+
+bool WriteAll(std::FILE* file, const void* data, std::size_t size) {
+  return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+
+void SetReason(std::string* reason, const std::string& message) {
+  if (reason != nullptr) {
+    *reason = message;
+  }
+}
+
+}  // namespace
+
+std::filesystem::path RecordingSegmentPath(const std::filesystem::path& directory,
+                                           const std::string& prefix, VideoCodec codec,
+                                           std::uint32_t segment) {
+  return directory /
+         (SegmentName(prefix, segment) + (codec == VideoCodec::kH264 ? ".h264" : ".h265"));
+}
+
+std::filesystem::path RecordingIndexPath(const std::filesystem::path& directory,
+                                         const std::string& prefix, std::uint32_t segment) {
+  return directory / (SegmentName(prefix, segment) + ".idx");
+}
+
+SegmentRecorder::SegmentRecorder(RecordingConfig config) : config_(std::move(config)) {}
+
+SegmentRecorder::~SegmentRecorder() {
+  Close();
+}
+
+bool SegmentRecorder::Open(std::string* reason) {
+  std::error_code ec;
+  std::filesystem::create_directories(config_.directory, ec);
+  if (ec) {
+    SetReason(reason, "Failed to create recording directory: " + ec.message());
+    return false;
+  }
+  // Continue numbering after existing segments of the same prefix.
+  segment_index_ = 0;
+  while (std::filesystem::exists(RecordingIndexPath(config_.directory, config_.prefix, segment_index_),
+                                 ec)) {
+    ++segment_index_;
+  }
+  open_ = true;
+  return true;
+}
+
+bool SegmentRecorder::Write(const EncodedAccessUnit& unit, std::string* reason) {
+  if (!open_) {
+    SetReason(reason, "Recorder is not open");
+    return false;
+  }
+  RememberParameterSets(unit);
+
+  const bool keyframe = unit.info.keyframe;
+  if (segment_file_ == nullptr && !keyframe) {
+    ++units_skipped_;
+    return true;
+  }
+  const bool rotate = segment_file_ != nullptr && keyframe &&
+                      (unit.receive_time_us - segment_start_us_ >= config_.segment_duration_us ||
+                       segment_bytes_ + unit.data.size() > config_.max_segment_bytes);
+  if (rotate) {
+    CloseSegment();
+  }
+
+  if (segment_file_ == nullptr && !StartSegment(unit.receive_time_us, reason)) {
+    return false;
+  }
+
+  const std::uint64_t offset = segment_bytes_;
+  std::uint64_t size = unit.data.size();
+  bool prefixed = false;
+  if (offset == 0 && !unit.info.has_parameter_sets && !parameter_sets_.empty()) {
+    // A segment must decode on its own.
+    if (!WriteAll(segment_file_, parameter_sets_.data(), parameter_sets_.size())) {
+      SetReason(reason, "Failed to write recording segment");
+      return false;
+    }
+    segment_bytes_ += parameter_sets_.size();
+    size += parameter_sets_.size();
+    prefixed = true;
+  }
+  std::uint32_t flags = keyframe ? kRecordingFlagKeyframe : 0;
+  if (unit.info.has_parameter_sets || prefixed) {
+    flags |= kRecordingFlagParameterSets;
+  }
+
+  if (!WriteAll(segment_file_, unit.data.data(), unit.data.size())) {
+    SetReason(reason, "Failed to write recording segment");
+    return false;
+  }
+  segment_bytes_ += unit.data.size();
+  ++units_written_;
+
+  PutLe(&pending_index_, static_cast<std::uint64_t>(unit.receive_time_us), 8);
+  PutLe(&pending_index_, static_cast<std::uint64_t>(unit.pts_us), 8);
+  PutLe(&pending_index_, offset, 8);
+  PutLe(&pending_index_, size, 4);
+  PutLe(&pending_index_, flags, 4);
+  if (keyframe || unit.receive_time_us - last_flush_us_ >= config_.index_flush_interval_us) {
+    last_flush_us_ = unit.receive_time_us;
+    return FlushIndex(reason);
+  }
+  return true;
+}
+
+void SegmentRecorder::Close() {
+  CloseSegment();
+  open_ = false;
+}
+
+bool SegmentRecorder::StartSegment(std::int64_t start_time_us, std::string* reason) {
+  const auto segment_path =
+      RecordingSegmentPath(config_.directory, config_.prefix, config_.codec, segment_index_);
+  const auto index_path = RecordingIndexPath(config_.directory, config_.prefix, segment_index_);
+  segment_file_ = std::fopen(segment_path.string().c_str(), "wb");
+  index_file_ = std::fopen(index_path.string().c_str(), "wb");
+  if (segment_file_ == nullptr || index_file_ == nullptr) {
+    CloseSegment();
+    SetReason(reason, "Failed to open recording segment " + segment_path.string());
+    return false;
+  }
+  std::setvbuf(segment_file_, nullptr, _IONBF, 0);
+  std::setvbuf(index_file_, nullptr, _IONBF, 0);
+
+  std::vector<std::uint8_t> header(kIndexMagic, kIndexMagic + sizeof(kIndexMagic));
+  PutLe(&header, config_.codec == VideoCodec::kH264 ? 264 : 265, 4);
+  PutLe(&header, kIndexRecordSize, 4);
+  if (!WriteAll(index_file_, header.data(), header.size())) {
+    CloseSegment();
+    SetReason(reason, "Failed to write recording index header");
+    return false;
+  }
+
+  segment_start_us_ = start_time_us;
+  last_flush_us_ = start_time_us;
+  segment_bytes_ = 0;
+  ++segment_index_;
+  ++segments_started_;
+  return true;
+}
+
+bool SegmentRecorder::FlushIndex(std::string* reason) {
+  if (index_file_ == nullptr || pending_index_.empty()) {
+    return true;
+  }
+  // Index records trail the segment bytes they describe, so a crash leaves at
+  // worst unindexed (never dangling) data.
+  const bool ok = WriteAll(index_file_, pending_index_.data(), pending_index_.size());
+  pending_index_.clear();
+  if (!ok) {
+    SetReason(reason, "Failed to write recording index");
+  }
+  return ok;
+}
+
+void SegmentRecorder::CloseSegment() {
+  FlushIndex(nullptr);
+  if (segment_file_ != nullptr) {
+    std::fclose(segment_file_);
+    segment_file_ = nullptr;
+  }
+  if (index_file_ != nullptr) {
+    std::fclose(index_file_);
+    index_file_ = nullptr;
+  }
+}
+
+void SegmentRecorder::RememberParameterSets(const EncodedAccessUnit& unit) {
+  if (!unit.info.has_parameter_sets) {
+    return;
+  }
+  parameter_sets_.clear();
+  static constexpr std::uint8_t kStartCode[4] = {0, 0, 0, 1};
+  for (const auto& nal : SplitAnnexB(config_.codec, unit.data.data(), unit.data.size())) {
+    if (nal.parameter_set) {
+      parameter_sets_.insert(parameter_sets_.end(), kStartCode, kStartCode + 4);
+      parameter_sets_.insert(parameter_sets_.end(), nal.data, nal.data + nal.size);
+    }
+  }
+}
+
+bool RecordingIndex::Load(const std::filesystem::path& directory, const std::string& prefix,
+                          std::string* reason) {
+  segment_paths_.clear();
+  segment_heads_.clear();
+  entries_.clear();
+  keyframes_.clear();
+
+  std::error_code ec;
+  for (std::uint32_t segment = 0;; ++segment) {
+    const auto index_path = RecordingIndexPath(directory, prefix, segment);
+    if (!std::filesystem::exists(index_path, ec)) {
+      break;
+    }
+    std::ifstream input(index_path, std::ios::binary);
+    const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(input)),
+                                          std::istreambuf_iterator<char>());
+    if (bytes.size() < kIndexHeaderSize ||
+        std::memcmp(bytes.data(), kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+        GetLe(bytes.data() + 12, 4) != kIndexRecordSize) {
+      SetReason(reason, "Invalid recording index: " + index_path.string());
+      return false;
+    }
+    const VideoCodec codec = GetLe(bytes.data() + 8, 4) == 265 ? VideoCodec::kH265 : VideoCodec::kH264;
+    const auto segment_path = RecordingSegmentPath(directory, prefix, codec, segment);
+    const std::uint64_t segment_size = std::filesystem::file_size(segment_path, ec);
+    if (ec) {
+      SetReason(reason, "Missing recording segment: " + segment_path.string());
+      return false;
+    }
+
+    const auto slot = static_cast<std::uint32_t>(segment_paths_.size());
+    segment_paths_.push_back(segment_path);
+    segment_heads_.push_back(entries_.size());
+    // A torn trailing record or units past the end of a truncated segment are
+    // dropped.
+    for (std::size_t at = kIndexHeaderSize; at + kIndexRecordSize <= bytes.size();
+         at += kIndexRecordSize) {
+      RecordingIndexEntry entry;
+      entry.receive_time_us = static_cast<std::int64_t>(GetLe(bytes.data() + at, 8));
+      entry.pts_us = static_cast<std::int64_t>(GetLe(bytes.data() + at + 8, 8));
+      entry.offset = GetLe(bytes.data() + at + 16, 8);
+      entry.size = static_cast<std::uint32_t>(GetLe(bytes.data() + at + 24, 4));
+      entry.flags = static_cast<std::uint32_t>(GetLe(bytes.data() + at + 28, 4));
+      entry.segment = slot;
+      if (entry.offset + entry.size > segment_size) {
+        break;
+      }
+      if (!entries_.empty() && entry.receive_time_us < entries_.back().receive_time_us) {
+        // Clock stepped backwards; keep the index monotonic for binary search.
+        entry.receive_time_us = entries_.back().receive_time_us;
+      }
+      if ((entry.flags & kRecordingFlagKeyframe) != 0) {
+        keyframes_.push_back(entries_.size());
+      }
+      entries_.push_back(entry);
+    }
+  }
+  if (segment_paths_.empty()) {
+    SetReason(reason, "No recording found for prefix '" + prefix + "'");
+    return false;
+  }
+  return true;
+}
+
+std::optional<RecordingSeek> RecordingIndex::Seek(std::int64_t time_us) const {
+  const auto after = std::upper_bound(
+      entries_.begin(), entries_.end(), time_us,
+      [](std::int64_t time, const RecordingIndexEntry& entry) { return time < entry.receive_time_us; });
+  if (after == entries_.begin()) {
+    return std::nullopt;
+  }
+  const auto frame = static_cast<std::size_t>(std::distance(entries_.begin(), after) - 1);
+  const auto keyframe_it = std::upper_bound(keyframes_.begin(), keyframes_.end(), frame);
+  if (keyframe_it == keyframes_.begin()) {
+    return std::nullopt;
+  }
+  const std::size_t keyframe = *(keyframe_it - 1);
+  // Segments start at a keyframe, so the keyframe is always in the frame's segment.
+  const auto& frame_entry = entries_[frame];
+  const auto& keyframe_entry = entries_[keyframe];
+
+  RecordingSeek seek;
+  seek.segment_path = segment_paths_[frame_entry.segment];
+  seek.keyframe_offset = keyframe_entry.offset;
+  seek.frame_offset = frame_entry.offset;
+  seek.keyframe_time_us = keyframe_entry.receive_time_us;
+  seek.frame_time_us = frame_entry.receive_time_us;
+  seek.frames_to_decode = frame - keyframe + 1;
+
+  if ((keyframe_entry.flags & kRecordingFlagParameterSets) == 0) {
+    // Mid-segment keyframe without SPS/PPS: take them from the segment head.
+    const auto& head_entry = entries_[segment_heads_[frame_entry.segment]];
+    std::ifstream input(seek.segment_path, std::ios::binary);
+    std::vector<std::uint8_t> bytes(head_entry.size);
+    input.seekg(static_cast<std::streamoff>(head_entry.offset));
+    input.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    const VideoCodec codec =
+        seek.segment_path.extension() == ".h265" ? VideoCodec::kH265 : VideoCodec::kH264;
+    static constexpr std::uint8_t kStartCode[4] = {0, 0, 0, 1};
+    for (const auto& nal : SplitAnnexB(codec, bytes.data(), bytes.size())) {
+      if (nal.parameter_set) {
+        seek.parameter_sets.insert(seek.parameter_sets.end(), kStartCode, kStartCode + 4);
+        seek.parameter_sets.insert(seek.parameter_sets.end(), nal.data, nal.data + nal.size);
+      }
+    }
+  }
+  return seek;
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "NalUnit.h"
+#include "VideoDecodePipeline.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ulak::comms {
+
+struct RecordingConfig {
+  std::filesystem::path directory;
+  std::string prefix{"stream"};
+  VideoCodec codec{VideoCodec::kH264};
+  // A new segment starts at the first keyframe after either limit.
+  std::int64_t segment_duration_us{60'000'000};
+  std::uint64_t max_segment_bytes{512ull * 1024 * 1024};
+  std::int64_t index_flush_interval_us{1'000'000};
+};
+
+// One access unit in a segment. Written as a 32-byte little-endian record to
+// `<prefix>-NNNNNN.idx` next to the raw Annex B `<prefix>-NNNNNN.h264|.h265`.
+struct RecordingIndexEntry {
+  std::int64_t receive_time_us{0};
+  std::int64_t pts_us{0};
+  std::uint64_t offset{0};
+  std::uint32_t size{0};
+  std::uint32_t flags{0};
+  // Not stored; filled in by RecordingIndex::Load.
+  std::uint32_t segment{0};
+};
+
+inline constexpr std::uint32_t kRecordingFlagKeyframe = 1u << 0;
+inline constexpr std::uint32_t kRecordingFlagParameterSets = 1u << 1;
+
+// Writes received access units untouched into keyframe-aligned segment files.
+// Each segment is a plain elementary stream (playable as-is) and starts with a
+// keyframe, preceded by the last seen parameter sets when the keyframe lacks
+// them. Single-threaded: call from the stream ingest thread.
+class SegmentRecorder {
+ public:
+  explicit SegmentRecorder(RecordingConfig config);
+  SegmentRecorder(const SegmentRecorder&) = delete;
+  SegmentRecorder& operator=(const SegmentRecorder&) = delete;
+  ~SegmentRecorder();
+
+  bool Open(std::string* reason);
+  // Units before the first keyframe are skipped (returns true, not recorded).
+  bool Write(const EncodedAccessUnit& unit, std::string* reason);
+  void Close();
+
+  std::uint32_t segments_started() const { return segments_started_; }
+  std::uint64_t units_written() const { return units_written_; }
+  std::uint64_t units_skipped() const { return units_skipped_; }
+
+ private:
+  bool StartSegment(std::int64_t start_time_us, std::string* reason);
+  bool FlushIndex(std::string* reason);
+  void CloseSegment();
+  void RememberParameterSets(const EncodedAccessUnit& unit);
+
+  const RecordingConfig config_;
+  bool open_{false};
+  // Unbuffered: units go from the receive buffer to write(2) without a copy.
+  std::FILE* segment_file_{nullptr};
+  std::FILE* index_file_{nullptr};
+  std::uint32_t segment_index_{0};
+  std::uint32_t segments_started_{0};
+  std::int64_t segment_start_us_{0};
+  std::uint64_t segment_bytes_{0};
+  std::int64_t last_flush_us_{0};
+  std::vector<std::uint8_t> pending_index_;
+  std::vector<std::uint8_t> parameter_sets_;
+  std::uint64_t units_written_{0};
+  std::uint64_t units_skipped_{0};
+};
+
+struct RecordingSeek {
+  std::filesystem::path segment_path;
+  // Decode from the keyframe, display the frame at `frame_offset`.
+  std::uint64_t keyframe_offset{0};
+  std::uint64_t frame_offset{0};
+  std::int64_t keyframe_time_us{0};
+  std::int64_t frame_time_us{0};
+  std::size_t frames_to_decode{0};
+  // Parameter sets to feed the decoder first when the keyframe has none.
+  std::vector<std::uint8_t> parameter_sets;
+};
+
+// Read side: loads every index of a recording and answers "which frame was on
+// screen at time T" with two binary searches.
+class RecordingIndex {
+ public:
+  bool Load(const std::filesystem::path& directory, const std::string& prefix,
+            std::string* reason);
+
+  // Frame displayed at `time_us` (the last unit received at or before it).
+  std::optional<RecordingSeek> Seek(std::int64_t time_us) const;
+
+  const std::vector<RecordingIndexEntry>& entries() const { return entries_; }
+  std::size_t keyframe_count() const { return keyframes_.size(); }
+
+ private:
+  std::vector<std::filesystem::path> segment_paths_;
+  // Position in entries_ of each segment's first unit.
+  std::vector<std::size_t> segment_heads_;
+  std::vector<RecordingIndexEntry> entries_;
+  // Positions in entries_ of keyframes, ascending.
+  std::vector<std::size_t> keyframes_;
+};
+
+std::filesystem::path RecordingSegmentPath(const std::filesystem::path& directory,
+                                           const std::string& prefix, VideoCodec codec,
+                                           std::uint32_t segment);
+std::filesystem::path RecordingIndexPath(const std::filesystem::path& directory,
+                                         const std::string& prefix, std::uint32_t segment);
+
+}  // namespace ulak::comms
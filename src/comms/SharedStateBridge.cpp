@@ -0,0 +1,676 @@
+#include "SharedStateBridge.h"
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ulak::comms {
+namespace {
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+                  std::atomic<std::uint32_t>::is_always_lock_free &&
+                  std::atomic<std::int64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free to work across processes");
+
+constexpr std::size_t kAlignment = 64;
+constexpr std::uint32_t kFreshFrame = 4;
+constexpr std::uint32_t kBufferMask = 3;
+constexpr std::size_t kFrameBuffers = 3;
+// A reader gives up instead of spinning on a writer that died mid-write.
+constexpr int kMaxReadAttempts = 64;
+
+constexpr std::size_t AlignUp(std::size_t value) {
+  return (value + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+struct SegmentHeader {
+  std::atomic<std::uint32_t> magic;
+  std::uint32_t layout_version;
+  std::uint64_t total_size;
+  std::uint64_t telemetry_offset;
+  std::uint64_t mission_offset;
+  std::uint64_t perception_offset;
+  std::uint64_t link_health_offset;
+  std::uint64_t events_offset;
+  std::uint64_t frames_offset;
+  std::uint32_t event_capacity;
+  std::uint32_t frame_width;
+  std::uint32_t frame_height;
+  std::uint32_t frame_stride;
+  std::uint64_t frame_buffer_size;
+  std::atomic<std::int64_t> heartbeat_us;
+  std::atomic<std::uint32_t> closed;
+  std::int32_t writer_pid;
+};
+
+template <typename T>
+struct alignas(kAlignment) SeqlockSlot {
+  static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % 8 == 0,
+                "slot payloads are copied as whole words");
+  static constexpr std::size_t kWords = sizeof(T) / 8;
+
+  std::atomic<std::uint64_t> sequence;
+  std::atomic<std::uint64_t> words[kWords];
+
+  // Single writer. `stable` is the even sequence the slot holds afterwards.
+  void Store(const T& value, std::uint64_t stable) {
+    std::uint64_t buffer[kWords];
+    std::memcpy(buffer, &value, sizeof(T));
+    sequence.store(stable - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < kWords; ++i) {
+      words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+    sequence.store(stable, std::memory_order_release);
+  }
+
+  // Returns the stable sequence the copy belongs to, or 0 when the slot is
+  // empty or was being rewritten on every attempt.
+  std::uint64_t Load(T* out) const {
+    for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+      const std::uint64_t before = sequence.load(std::memory_order_acquire);
+      if (before == 0) {
+        return 0;
+      }
+      if ((before & 1) != 0) {
+        continue;
+      }
+      std::uint64_t buffer[kWords];
+      for (std::size_t i = 0; i < kWords; ++i) {
+        buffer[i] = words[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        std::memcpy(out, buffer, sizeof(T));
+        return before;
+      }
+    }
+    return 0;
+  }
+};
+
+struct alignas(kAlignment) EventRingHeader {
+  std::atomic<std::uint64_t> head;
+};
+
+struct alignas(kAlignment) FrameControl {
+  // Index of the middle buffer, | kFreshFrame when the reader has not taken it.
+  std::atomic<std::uint32_t> middle;
+  // Buffer the reader owns; kept here so a restarted UI resumes the swap.
+  std::atomic<std::uint32_t> reader_index;
+};
+
+struct alignas(kAlignment) FrameInfo {
+  std::uint32_t width;
+  std::uint32_t height;
+  std::int64_t pts_us;
+  std::uint64_t sequence;
+};
+
+struct Layout {
+  std::size_t telemetry{0};
+  std::size_t mission{0};
+  std::size_t perception{0};
+  std::size_t link_health{0};
+  std::size_t events{0};
+  std::size_t frames{0};
+  std::size_t frame_stride{0};
+  std::size_t frame_buffer_size{0};
+  std::size_t total{0};
+};
+
+Layout ComputeLayout(const SharedStateConfig& config) {
+  Layout layout;
+  std::size_t offset = AlignUp(sizeof(SegmentHeader));
+  const auto place = [&offset](std::size_t size) {
+    const std::size_t at = offset;
+    offset += AlignUp(size);
+    return at;
+  };
+  layout.telemetry = place(sizeof(SeqlockSlot<SharedTelemetry>));
+  layout.mission = place(sizeof(SeqlockSlot<SharedMissionState>));
+  layout.perception = place(sizeof(SeqlockSlot<SharedPerception>));
+  layout.link_health = place(sizeof(SeqlockSlot<SharedLinkHealth>));
+  layout.events = place(sizeof(EventRingHeader) +
+                        config.event_capacity * sizeof(SeqlockSlot<SharedSafetyEvent>));
+  if (config.frame_width > 0 && config.frame_height > 0) {
+    layout.frame_stride = AlignUp(static_cast<std::size_t>(config.frame_width) * 4);
+    layout.frame_buffer_size = AlignUp(layout.frame_stride * static_cast<std::size_t>(config.frame_height));
+    layout.frames = place(sizeof(FrameControl) + kFrameBuffers * sizeof(FrameInfo) +
+                          kFrameBuffers * layout.frame_buffer_size);
+  }
+  layout.total = offset;
+  return layout;
+}
+
+SegmentHeader* HeaderOf(std::uint8_t* base) { return reinterpret_cast<SegmentHeader*>(base); }
+
+template <typename T>
+SeqlockSlot<T>* SlotAt(std::uint8_t* base, std::uint64_t offset) {
+  return reinterpret_cast<SeqlockSlot<T>*>(base + offset);
+}
+
+template <typename T>
+const SeqlockSlot<T>* SlotAt(const std::uint8_t* base, std::uint64_t offset) {
+  return reinterpret_cast<const SeqlockSlot<T>*>(base + offset);
+}
+
+EventRingHeader* EventRingAt(std::uint8_t* base, std::uint64_t events_offset) {
+  return reinterpret_cast<EventRingHeader*>(base + events_offset);
+}
+
+SeqlockSlot<SharedSafetyEvent>* EventSlotsAt(std::uint8_t* base, std::uint64_t events_offset) {
+  return reinterpret_cast<SeqlockSlot<SharedSafetyEvent>*>(base + events_offset +
+                                                          sizeof(EventRingHeader));
+}
+
+FrameControl* FrameControlAt(std::uint8_t* base, std::uint64_t frames_offset) {
+  return reinterpret_cast<FrameControl*>(base + frames_offset);
+}
+
+FrameInfo* FrameInfoAt(std::uint8_t* base, std::uint64_t frames_offset, std::uint32_t index) {
+  return reinterpret_cast<FrameInfo*>(base + frames_offset + sizeof(FrameControl)) + index;
+}
+
+std::uint8_t* FramePixelsAt(std::uint8_t* base, std::uint64_t frames_offset,
+                            std::uint64_t frame_buffer_size, std::uint32_t index) {
+  return base + frames_offset + sizeof(FrameControl) + kFrameBuffers * sizeof(FrameInfo) +
+         index * frame_buffer_size;
+}
+
+// Writer-side shorthands; the writer trusts the header it wrote itself.
+EventRingHeader* EventRingOf(std::uint8_t* base) {
+  return EventRingAt(base, HeaderOf(base)->events_offset);
+}
+
+SeqlockSlot<SharedSafetyEvent>* EventSlots(std::uint8_t* base) {
+  return EventSlotsAt(base, HeaderOf(base)->events_offset);
+}
+
+FrameControl* FrameControlOf(std::uint8_t* base) {
+  return FrameControlAt(base, HeaderOf(base)->frames_offset);
+}
+
+FrameInfo* FrameInfoOf(std::uint8_t* base, std::uint32_t index) {
+  return FrameInfoAt(base, HeaderOf(base)->frames_offset, index);
+}
+
+std::uint8_t* FramePixels(std::uint8_t* base, std::uint32_t index) {
+  const SegmentHeader* header = HeaderOf(base);
+  return FramePixelsAt(base, header->frames_offset, header->frame_buffer_size, index);
+}
+
+// True when [offset, offset + length) lies inside a mapping of `size` bytes
+// and `offset` keeps the slot's atomics aligned.
+bool FitsInMapping(std::uint64_t offset, std::uint64_t length, std::size_t size) {
+  return offset % kAlignment == 0 && offset >= AlignUp(sizeof(SegmentHeader)) && offset <= size &&
+         length <= size - offset;
+}
+
+// Pid of the live process that owns segment `name`, or 0 when there is no
+// segment or it is stale: closed, never fully initialized, or left by a
+// process that is gone. A recycled pid keeps a stale segment alive until that
+// process exits; the owner can remove /dev/shm/<name> by hand.
+pid_t LiveWriterOf(const std::string& name) {
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  pid_t pid = 0;
+  struct stat info {};
+  if (::fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(SegmentHeader))) {
+    void* mapping = ::mmap(nullptr, sizeof(SegmentHeader), PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping != MAP_FAILED) {
+      const auto* header = static_cast<const SegmentHeader*>(mapping);
+      if (header->magic.load(std::memory_order_acquire) == kSharedStateMagic &&
+          header->closed.load(std::memory_order_acquire) == 0) {
+        pid = static_cast<pid_t>(header->writer_pid);
+      }
+      ::munmap(mapping, sizeof(SegmentHeader));
+    }
+  }
+  ::close(fd);
+  // EPERM: the process exists but belongs to another user.
+  if (pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM)) {
+    return pid;
+  }
+  return 0;
+}
+
+template <std::size_t N>
+void CopyText(char (&field)[N], const std::string& text) {
+  const std::size_t length = text.size() < N - 1 ? text.size() : N - 1;
+  std::memcpy(field, text.data(), length);
+  std::memset(field + length, 0, N - length);
+}
+
+template <typename T>
+std::uint64_t ReadSlot(const std::uint8_t* base, std::uint64_t offset, T* out,
+                       std::uint64_t* version) {
+  const std::uint64_t sequence = SlotAt<T>(base, offset)->Load(out);
+  if (sequence != 0 && version != nullptr) {
+    *version = sequence / 2;
+  }
+  return sequence;
+}
+
+}  // namespace
+
+SharedStateWriter::SharedStateWriter(SharedStateConfig config) : config_(std::move(config)) {}
+
+SharedStateWriter::~SharedStateWriter() { Close(); }
+
+bool SharedStateWriter::Open(std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+  if (base_ != nullptr) {
+    return true;
+  }
+  if (config_.name.size() < 2 || config_.name[0] != '/' ||
+      config_.name.find('/', 1) != std::string::npos) {
+    return fail("shared memory name must be \"/name\": " + config_.name);
+  }
+  if (config_.event_capacity == 0 || (config_.event_capacity & (config_.event_capacity - 1)) != 0) {
+    return fail("event_capacity must be a power of two");
+  }
+  if (config_.frame_width < 0 || config_.frame_height < 0) {
+    return fail("frame size must not be negative");
+  }
+
+  const Layout layout = ComputeLayout(config_);
+  if (const pid_t owner = LiveWriterOf(config_.name); owner != 0) {
+    return fail("shared memory segment " + config_.name + " is in use by pid " +
+                std::to_string(owner));
+  }
+  ::shm_unlink(config_.name.c_str());
+  const int fd = ::shm_open(config_.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return fail("shm_open " + config_.name + ": " + std::strerror(errno));
+  }
+  if (::ftruncate(fd, static_cast<off_t>(layout.total)) != 0) {
+    const std::string error = std::strerror(errno);
+    ::close(fd);
+    ::shm_unlink(config_.name.c_str());
+    return fail("ftruncate " + config_.name + ": " + error);
+  }
+  void* mapping = ::mmap(nullptr, layout.total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const std::string map_error = mapping == MAP_FAILED ? std::strerror(errno) : "";
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    ::shm_unlink(config_.name.c_str());
+    return fail("mmap " + config_.name + ": " + map_error);
+  }
+
+  // ftruncate zero-fills, which is the initial state of every slot; only the
+  // header and the frame swap indices need values.
+  base_ = static_cast<std::uint8_t*>(mapping);
+  size_ = layout.total;
+  SegmentHeader* header = HeaderOf(base_);
+  header->layout_version = kSharedStateLayoutVersion;
+  header->total_size = layout.total;
+  header->telemetry_offset = layout.telemetry;
+  header->mission_offset = layout.mission;
+  header->perception_offset = layout.perception;
+  header->link_health_offset = layout.link_health;
+  header->events_offset = layout.events;
+  header->frames_offset = layout.frames;
+  header->event_capacity = config_.event_capacity;
+  header->frame_width = static_cast<std::uint32_t>(layout.frames != 0 ? config_.frame_width : 0);
+  header->frame_height = static_cast<std::uint32_t>(layout.frames != 0 ? config_.frame_height : 0);
+  header->frame_stride = static_cast<std::uint32_t>(layout.frame_stride);
+  header->frame_buffer_size = layout.frame_buffer_size;
+  header->writer_pid = static_cast<std::int32_t>(::getpid());
+  if (layout.frames != 0) {
+    FrameControlOf(base_)->middle.store(1, std::memory_order_relaxed);
+    FrameControlOf(base_)->reader_index.store(2, std::memory_order_relaxed);
+  }
+  back_buffer_ = 0;
+  events_published_ = 0;
+  frames_committed_ = 0;
+  // Published last: readers treat the segment as absent until the magic is set.
+  header->magic.store(kSharedStateMagic, std::memory_order_release);
+  return true;
+}
+
+void SharedStateWriter::Close() {
+  if (base_ == nullptr) {
+    return;
+  }
+  HeaderOf(base_)->closed.store(1, std::memory_order_release);
+  ::munmap(base_, size_);
+  ::shm_unlink(config_.name.c_str());
+  base_ = nullptr;
+  size_ = 0;
+}
+
+void SharedStateWriter::PublishTelemetry(const models::TelemetryFrame& frame) {
+  if (base_ == nullptr) {
+    return;
+  }
+  SharedTelemetry shared;
+  shared.position_m[0] = frame.position_m.x;
+  shared.position_m[1] = frame.position_m.y;
+  shared.position_m[2] = frame.position_m.z;
+  shared.velocity_mps[0] = frame.velocity_mps.x;
+  shared.velocity_mps[1] = frame.velocity_mps.y;
+  shared.velocity_mps[2] = frame.velocity_mps.z;
+  shared.attitude_deg[0] = frame.attitude_deg.roll;
+  shared.attitude_deg[1] = frame.attitude_deg.pitch;
+  shared.attitude_deg[2] = frame.attitude_deg.yaw;
+  shared.receive_time_us = frame.receive_time_us;
+  shared.battery_percent = frame.battery_percent;
+  shared.vehicle_mode_id = frame.vehicle_mode_id;
+  CopyText(shared.telemetry_type, frame.telemetry_type);
+  CopyText(shared.frame_id, frame.frame_id);
+  CopyText(shared.vehicle_mode, frame.vehicle_mode);
+  auto* slot = SlotAt<SharedTelemetry>(base_, HeaderOf(base_)->telemetry_offset);
+  slot->Store(shared, slot->sequence.load(std::memory_order_relaxed) + 2);
+}
+
+void SharedStateWriter::PublishMissionState(const models::MissionStateUpdate& update) {
+  if (base_ == nullptr) {
+    return;
+  }
+  SharedMissionState shared;
+  shared.receive_time_us = update.receive_time_us;
+  shared.progress = static_cast<float>(update.progress);
+  CopyText(shared.state, update.state);
+  CopyText(shared.note, update.note);
+  auto* slot = SlotAt<SharedMissionState>(base_, HeaderOf(base_)->mission_offset);
+  slot->Store(shared, slot->sequence.load(std::memory_order_relaxed) + 2);
+}
+
+void SharedStateWriter::PublishPerception(const models::PerceptionTarget& target) {
+  if (base_ == nullptr) {
+    return;
+  }
+  SharedPerception shared;
+  shared.receive_time_us = target.receive_time_us;
+  shared.alignment_dx = static_cast<float>(target.alignment_dx);
+  shared.alignment_dy = static_cast<float>(target.alignment_dy);
+  shared.confidence = static_cast<float>(target.confidence);
+  CopyText(shared.color, target.color);
+  CopyText(shared.shape, target.shape);
+  auto* slot = SlotAt<SharedPerception>(base_, HeaderOf(base_)->perception_offset);
+  slot->Store(shared, slot->sequence.load(std::memory_order_relaxed) + 2);
+}
+
+void SharedStateWriter::PublishLinkHealth(const std::array<LinkHealthFrame, kLinkChannelCount>& frames) {
+  if (base_ == nullptr) {
+    return;
+  }
+  SharedLinkHealth shared;
+  for (std::size_t i = 0; i < kLinkChannelCount; ++i) {
+    const LinkHealthFrame& frame = frames[i];
+    SharedLinkChannel& channel = shared.channels[i];
+    channel.sample_time_us = frame.sample_time_us;
+    channel.last_packet_age_us = frame.last_packet_age_us;
+    channel.total_packets = frame.total_packets;
+    channel.total_lost = frame.total_lost;
+    channel.rate_hz = frame.rate_hz;
+    channel.throughput_bps = frame.throughput_bps;
+    channel.loss_ratio = frame.loss_ratio;
+    channel.jitter_us = frame.jitter_us;
+    channel.rtt_p50_us = frame.rtt_p50_us;
+    channel.rtt_p99_us = frame.rtt_p99_us;
+    channel.channel = static_cast<std::uint8_t>(frame.channel);
+    channel.state = static_cast<std::uint8_t>(frame.state);
+  }
+  auto* slot = SlotAt<SharedLinkHealth>(base_, HeaderOf(base_)->link_health_offset);
+  slot->Store(shared, slot->sequence.load(std::memory_order_relaxed) + 2);
+}
+
+void SharedStateWriter::PublishSafetyEvent(const models::SafetyEvent& event) {
+  if (base_ == nullptr) {
+    return;
+  }
+  SharedSafetyEvent shared;
+  shared.receive_time_us = event.receive_time_us;
+  shared.severity = static_cast<std::uint8_t>(event.severity);
+  CopyText(shared.code, event.code);
+  CopyText(shared.recommended_action, event.recommended_action);
+  CopyText(shared.message, event.message);
+  const std::uint64_t index = events_published_++;
+  EventSlots(base_)[index & (config_.event_capacity - 1)].Store(shared, 2 * (index + 1));
+  EventRingOf(base_)->head.store(events_published_, std::memory_order_release);
+}
+
+RgbaImage SharedStateWriter::BeginFrame(int width, int height) {
+  RgbaImage image;
+  if (base_ == nullptr || HeaderOf(base_)->frames_offset == 0 || width <= 0 || height <= 0 ||
+      width > config_.frame_width || height > config_.frame_height) {
+    return image;
+  }
+  frame_width_ = width;
+  frame_height_ = height;
+  image.data = FramePixels(base_, back_buffer_);
+  image.width = width;
+  image.height = height;
+  image.stride = static_cast<int>(HeaderOf(base_)->frame_stride);
+  return image;
+}
+
+void SharedStateWriter::CommitFrame(std::int64_t pts_us) {
+  if (base_ == nullptr || frame_width_ == 0) {
+    return;
+  }
+  FrameInfo* info = FrameInfoOf(base_, back_buffer_);
+  info->width = static_cast<std::uint32_t>(frame_width_);
+  info->height = static_cast<std::uint32_t>(frame_height_);
+  info->pts_us = pts_us;
+  info->sequence = ++frames_committed_;
+  const std::uint32_t previous =
+      FrameControlOf(base_)->middle.exchange(back_buffer_ | kFreshFrame, std::memory_order_acq_rel);
+  back_buffer_ = previous & kBufferMask;
+  frame_width_ = 0;
+  frame_height_ = 0;
+}
+
+void SharedStateWriter::Heartbeat(std::int64_t now_us) {
+  if (base_ != nullptr) {
+    HeaderOf(base_)->heartbeat_us.store(now_us, std::memory_order_release);
+  }
+}
+
+SharedStateReader::~SharedStateReader() { Close(); }
+
+bool SharedStateReader::Open(const std::string& name, std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+  Close();
+  const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return fail("shm_open " + name + ": " + std::strerror(errno));
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(SegmentHeader))) {
+    ::close(fd);
+    return fail("shared memory segment " + name + " is not initialized");
+  }
+  const auto size = static_cast<std::size_t>(info.st_size);
+  void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const std::string map_error = mapping == MAP_FAILED ? std::strerror(errno) : "";
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return fail("mmap " + name + ": " + map_error);
+  }
+
+  auto* base = static_cast<std::uint8_t*>(mapping);
+  const SegmentHeader* header = HeaderOf(base);
+  if (header->magic.load(std::memory_order_acquire) != kSharedStateMagic) {
+    ::munmap(mapping, size);
+    return fail("shared memory segment " + name + " is not initialized");
+  }
+  if (header->layout_version != kSharedStateLayoutVersion || header->total_size > size) {
+    ::munmap(mapping, size);
+    return fail("shared memory segment " + name + " has an incompatible layout");
+  }
+
+  // Every access below goes through these copies, so a corrupt or hostile
+  // header can at worst make reads fail, never reach outside the mapping.
+  Geometry geometry;
+  geometry.telemetry = header->telemetry_offset;
+  geometry.mission = header->mission_offset;
+  geometry.perception = header->perception_offset;
+  geometry.link_health = header->link_health_offset;
+  geometry.events = header->events_offset;
+  geometry.frames = header->frames_offset;
+  geometry.frame_buffer_size = header->frame_buffer_size;
+  geometry.event_capacity = header->event_capacity;
+  geometry.frame_width = header->frame_width;
+  geometry.frame_height = header->frame_height;
+  geometry.frame_stride = header->frame_stride;
+  const std::uint64_t capacity = geometry.event_capacity;
+  bool fits = FitsInMapping(geometry.telemetry, sizeof(SeqlockSlot<SharedTelemetry>), size) &&
+              FitsInMapping(geometry.mission, sizeof(SeqlockSlot<SharedMissionState>), size) &&
+              FitsInMapping(geometry.perception, sizeof(SeqlockSlot<SharedPerception>), size) &&
+              FitsInMapping(geometry.link_health, sizeof(SeqlockSlot<SharedLinkHealth>), size) &&
+              capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+              FitsInMapping(geometry.events,
+                            sizeof(EventRingHeader) +
+                                capacity * sizeof(SeqlockSlot<SharedSafetyEvent>),
+                            size);
+  if (fits && geometry.frames != 0) {
+    const std::uint64_t control = sizeof(FrameControl) + kFrameBuffers * sizeof(FrameInfo);
+    fits = FitsInMapping(geometry.frames, control, size) &&
+           static_cast<std::uint64_t>(geometry.frame_width) * 4 <= geometry.frame_stride &&
+           static_cast<std::uint64_t>(geometry.frame_stride) * geometry.frame_height <=
+               geometry.frame_buffer_size &&
+           geometry.frame_buffer_size <= (size - geometry.frames - control) / kFrameBuffers;
+  }
+  if (!fits) {
+    ::munmap(mapping, size);
+    return fail("shared memory segment " + name + " has offsets outside its " +
+                std::to_string(size) + " bytes");
+  }
+
+  base_ = base;
+  size_ = size;
+  geometry_ = geometry;
+  const std::uint64_t head =
+      EventRingAt(base_, geometry_.events)->head.load(std::memory_order_acquire);
+  event_cursor_ = head > capacity ? head - capacity : 0;
+  return true;
+}
+
+void SharedStateReader::Close() {
+  if (base_ == nullptr) {
+    return;
+  }
+  ::munmap(base_, size_);
+  base_ = nullptr;
+  size_ = 0;
+  geometry_ = Geometry{};
+  event_cursor_ = 0;
+}
+
+bool SharedStateReader::ReadTelemetry(SharedTelemetry* out, std::uint64_t* version) const {
+  return base_ != nullptr &&
+         ReadSlot(base_, geometry_.telemetry, out, version) != 0;
+}
+
+bool SharedStateReader::ReadMissionState(SharedMissionState* out, std::uint64_t* version) const {
+  return base_ != nullptr && ReadSlot(base_, geometry_.mission, out, version) != 0;
+}
+
+bool SharedStateReader::ReadPerception(SharedPerception* out, std::uint64_t* version) const {
+  return base_ != nullptr &&
+         ReadSlot(base_, geometry_.perception, out, version) != 0;
+}
+
+bool SharedStateReader::ReadLinkHealth(SharedLinkHealth* out, std::uint64_t* version) const {
+  return base_ != nullptr &&
+         ReadSlot(base_, geometry_.link_health, out, version) != 0;
+}
+
+std::size_t SharedStateReader::ReadSafetyEvents(std::vector<SharedSafetyEvent>* out,
+                                                std::uint64_t* lost) {
+  if (base_ == nullptr) {
+    return 0;
+  }
+  const std::uint64_t capacity = geometry_.event_capacity;
+  const std::uint64_t head =
+      EventRingAt(base_, geometry_.events)->head.load(std::memory_order_acquire);
+  std::uint64_t missed = 0;
+  if (head - event_cursor_ > capacity) {
+    missed += head - capacity - event_cursor_;
+    event_cursor_ = head - capacity;
+  }
+  const SeqlockSlot<SharedSafetyEvent>* slots = EventSlotsAt(base_, geometry_.events);
+  std::size_t read = 0;
+  for (; event_cursor_ < head; ++event_cursor_) {
+    SharedSafetyEvent event;
+    // A slot holding a newer sequence was overwritten after `head` was read.
+    if (slots[event_cursor_ & (capacity - 1)].Load(&event) == 2 * (event_cursor_ + 1)) {
+      out->push_back(event);
+      ++read;
+    } else {
+      ++missed;
+    }
+  }
+  if (lost != nullptr) {
+    *lost += missed;
+  }
+  return read;
+}
+
+bool SharedStateReader::AcquireFrame(SharedFrameView* view) {
+  if (base_ == nullptr || geometry_.frames == 0) {
+    return false;
+  }
+  FrameControl* control = FrameControlAt(base_, geometry_.frames);
+  if ((control->middle.load(std::memory_order_relaxed) & kFreshFrame) == 0) {
+    return false;
+  }
+  const std::uint32_t owned = control->reader_index.load(std::memory_order_relaxed);
+  if (owned >= kFrameBuffers) {
+    return false;
+  }
+  const std::uint32_t taken =
+      control->middle.exchange(owned, std::memory_order_acq_rel) & kBufferMask;
+  control->reader_index.store(taken, std::memory_order_relaxed);
+  if (taken >= kFrameBuffers) {
+    return false;
+  }
+
+  const FrameInfo* info = FrameInfoAt(base_, geometry_.frames, taken);
+  const std::uint32_t width = info->width;
+  const std::uint32_t height = info->height;
+  if (width > geometry_.frame_width || height > geometry_.frame_height) {
+    return false;
+  }
+  view->data = FramePixelsAt(base_, geometry_.frames, geometry_.frame_buffer_size, taken);
+  view->width = static_cast<int>(width);
+  view->height = static_cast<int>(height);
+  view->stride = static_cast<int>(geometry_.frame_stride);
+  view->pts_us = info->pts_us;
+  view->sequence = info->sequence;
+  return true;
+}
+
+std::int64_t SharedStateReader::heartbeat_us() const {
+  return base_ == nullptr ? 0 : HeaderOf(base_)->heartbeat_us.load(std::memory_order_acquire);
+}
+
+bool SharedStateReader::writer_closed() const {
+  return base_ == nullptr || HeaderOf(base_)->closed.load(std::memory_order_acquire) != 0;
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "FrameScaler.h"
+#include "LinkHealthMonitor.h"
+#include "MissionState.h"
+#include "PerceptionTarget.h"
+#include "SafetyEvent.h"
+#include "TelemetryFrame.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ulak::comms {
+
+// Shared-memory snapshots read by the out-of-process UI. These structs are the
+// segment ABI: fixed-width fields, NUL-padded text (truncated to size - 1),
+// sizes multiple of 8. Appending fields requires bumping kSharedStateLayoutVersion.
+struct SharedTelemetry {
+  double position_m[3]{};
+  double velocity_mps[3]{};
+  double attitude_deg[3]{};
+  std::int64_t receive_time_us{0};
+  std::int32_t battery_percent{-1};
+  std::uint16_t vehicle_mode_id{0};
+  std::uint16_t reserved{0};
+  char telemetry_type[24]{};
+  char frame_id[24]{};
+  char vehicle_mode[24]{};
+};
+
+struct SharedMissionState {
+  std::int64_t receive_time_us{0};
+  float progress{-1.0f};
+  std::uint32_t reserved{0};
+  char state[48]{};
+  char note[128]{};
+};
+
+struct SharedPerception {
+  std::int64_t receive_time_us{0};
+  float alignment_dx{0.0f};
+  float alignment_dy{0.0f};
+  float confidence{0.0f};
+  std::uint32_t reserved{0};
+  char color[24]{};
+  char shape[24]{};
+};
+
+struct SharedLinkChannel {
+  std::int64_t sample_time_us{0};
+  std::int64_t last_packet_age_us{0};
+  std::uint64_t total_packets{0};
+  std::uint64_t total_lost{0};
+  double rate_hz{0.0};
+  double throughput_bps{0.0};
+  double loss_ratio{0.0};
+  std::uint64_t jitter_us{0};
+  std::uint64_t rtt_p50_us{0};
+  std::uint64_t rtt_p99_us{0};
+  std::uint8_t channel{0};  // LinkChannel
+  std::uint8_t state{0};    // LinkHealthState
+  std::uint8_t reserved[6]{};
+};
+
+struct SharedLinkHealth {
+  SharedLinkChannel channels[kLinkChannelCount];
+};
+
+struct SharedSafetyEvent {
+  std::int64_t receive_time_us{0};
+  std::uint8_t severity{0};  // models::SafetySeverity
+  std::uint8_t reserved[7]{};
+  char code[32]{};
+  char recommended_action[32]{};
+  char message[176]{};
+};
+
+// Text of a NUL-padded snapshot field.
+template <std::size_t N>
+std::string_view SharedText(const char (&field)[N]) {
+  std::size_t length = 0;
+  while (length < N && field[length] != '\0') {
+    ++length;
+  }
+  return std::string_view(field, length);
+}
+
+inline constexpr std::uint32_t kSharedStateMagic = 0x4D53'4C55;  // "ULSM"
+inline constexpr std::uint32_t kSharedStateLayoutVersion = 1;
+
+struct SharedStateConfig {
+  // POSIX shm name ("/name"); appears as /dev/shm/name.
+  std::string name{"/ulak_gcs_state"};
+  // Safety events retained for a reader that falls behind; power of two.
+  std::uint32_t event_capacity{256};
+  // Largest RGBA frame the video slot holds; 0 disables the slot.
+  int frame_width{1280};
+  int frame_height{720};
+};
+
+// Newest video frame owned by the reader. Valid until the next successful
+// AcquireFrame() or Close().
+struct SharedFrameView {
+  const std::uint8_t* data{nullptr};
+  int width{0};
+  int height{0};
+  int stride{0};
+  std::int64_t pts_us{0};
+  std::uint64_t sequence{0};
+};
+
+// Core side of the UI state bridge: one POSIX shared-memory segment the UI
+// process maps read-mostly, so per-update reads need no syscall, copy through
+// a socket, or serialization, and a stalled UI never blocks the core.
+//
+// Segment layout (offsets in the header, all 64-byte aligned):
+//   - header: magic, layout version, offsets, heartbeat, closed flag;
+//   - one seqlock slot each for telemetry, mission state, perception and link
+//     health: a u64 sequence (odd while being written, 2 * publish count when
+//     stable) followed by the snapshot struct. Readers copy the struct and
+//     retry when the sequence changed underneath them;
+//   - safety events: a u64 head (events published) and `event_capacity`
+//     seqlock slots; event n sits in slot n % capacity with sequence
+//     2 * (n + 1). The writer overwrites the oldest event instead of waiting,
+//     and readers count what they missed;
+//   - video: a triple buffer of RGBA frames. The writer fills its back buffer
+//     and swaps it with the shared middle index; the reader swaps its own
+//     buffer for the middle when a fresh frame is flagged, then reads pixels
+//     in place.
+//
+// Each Publish* slot has one writing thread at a time; different slots may be
+// published from different threads. Opening unlinks a stale segment of the
+// same name left by a crashed process, and fails while the writer that
+// created it is still running.
+class SharedStateWriter {
+ public:
+  explicit SharedStateWriter(SharedStateConfig config = {});
+  SharedStateWriter(const SharedStateWriter&) = delete;
+  SharedStateWriter& operator=(const SharedStateWriter&) = delete;
+  ~SharedStateWriter();
+
+  // Fails when a segment of the same name is still open in a live process
+  // (its writer pid answers kill(pid, 0)); one left behind by a crash is
+  // replaced.
+  bool Open(std::string* reason);
+  // Flags the segment closed for readers, unmaps and unlinks it.
+  void Close();
+  bool is_open() const { return base_ != nullptr; }
+  const SharedStateConfig& config() const { return config_; }
+
+  void PublishTelemetry(const models::TelemetryFrame& frame);
+  void PublishMissionState(const models::MissionStateUpdate& update);
+  void PublishPerception(const models::PerceptionTarget& target);
+  void PublishLinkHealth(const std::array<LinkHealthFrame, kLinkChannelCount>& frames);
+  void PublishSafetyEvent(const models::SafetyEvent& event);
+
+  // Back buffer to render the next frame into (e.g. FrameScaler::Convert
+  // destination). Empty when the slot is disabled or the size exceeds it.
+  RgbaImage BeginFrame(int width, int height);
+  // Publishes the frame rendered since BeginFrame(), replacing one the reader
+  // has not taken yet.
+  void CommitFrame(std::int64_t pts_us);
+
+  // Liveness stamp for the UI; called from the core's health timer.
+  void Heartbeat(std::int64_t now_us);
+
+  std::uint64_t events_published() const { return events_published_; }
+
+ private:
+  SharedStateConfig config_;
+  std::uint8_t* base_{nullptr};
+  std::size_t size_{0};
+  std::uint64_t events_published_{0};
+  std::uint32_t back_buffer_{0};
+  int frame_width_{0};
+  int frame_height_{0};
+  std::uint64_t frames_committed_{0};
+};
+
+// UI side. Reads never block and never write into the snapshot slots; the
+// only stores are the video buffer swap, so at most one process may call
+// AcquireFrame() on a segment.
+class SharedStateReader {
+ public:
+  SharedStateReader() = default;
+  SharedStateReader(const SharedStateReader&) = delete;
+  SharedStateReader& operator=(const SharedStateReader&) = delete;
+  ~SharedStateReader();
+
+  // Fails until the writer has opened and initialized the segment, and when
+  // the header describes slots outside the mapped size.
+  bool Open(const std::string& name, std::string* reason);
+  void Close();
+  bool is_open() const { return base_ != nullptr; }
+
+  // False before the first publish or when the slot kept changing during the
+  // read. `version` is the publish count, for skipping unchanged panels.
+  bool ReadTelemetry(SharedTelemetry* out, std::uint64_t* version = nullptr) const;
+  bool ReadMissionState(SharedMissionState* out, std::uint64_t* version = nullptr) const;
+  bool ReadPerception(SharedPerception* out, std::uint64_t* version = nullptr) const;
+  bool ReadLinkHealth(SharedLinkHealth* out, std::uint64_t* version = nullptr) const;
+
+  // Appends safety events published since the previous call (starting with
+  // those still retained at Open()). `lost` accumulates events overwritten
+  // before they were read.
+  std::size_t ReadSafetyEvents(std::vector<SharedSafetyEvent>* out, std::uint64_t* lost = nullptr);
+
+  // Takes the newest frame if one was committed since the last take.
+  bool AcquireFrame(SharedFrameView* view);
+
+  std::int64_t heartbeat_us() const;
+  bool writer_closed() const;
+
+ private:
+  // Header fields checked against the mapping at Open(). The header stays
+  // writable by the other process, so offsets are never re-read from it.
+  struct Geometry {
+    std::uint64_t telemetry{0};
+    std::uint64_t mission{0};
+    std::uint64_t perception{0};
+    std::uint64_t link_health{0};
+    std::uint64_t events{0};
+    std::uint64_t frames{0};
+    std::uint64_t frame_buffer_size{0};
+    std::uint32_t event_capacity{0};
+    std::uint32_t frame_width{0};
+    std::uint32_t frame_height{0};
+    std::uint32_t frame_stride{0};
+  };
+
+  std::uint8_t* base_{nullptr};
+  std::size_t size_{0};
+  Geometry geometry_;
+  std::uint64_t event_cursor_{0};
+};
+
+}  // namespace ulak::comms
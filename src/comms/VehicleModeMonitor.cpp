@@ -0,0 +1,55 @@
+#include "VehicleModeMonitor.h"
+
+#include "BinaryLog.h"
+#include "Tracing.h"
+
+#include <algorithm>
+
+namespace ulak::comms {
+
+int VehicleModeMonitor::Subscribe(Listener listener) {
+  std::lock_guard<std::mutex> lock(listeners_mutex_);
+  const int token = next_token_++;
+  listeners_.emplace_back(token, std::move(listener));
+  return token;
+}
+
+void VehicleModeMonitor::Unsubscribe(int token) {
+  std::lock_guard<std::mutex> lock(listeners_mutex_);
+  listeners_.erase(std::remove_if(listeners_.begin(),
+                                  listeners_.end(),
+                                  [token](const auto& entry) { return entry.first == token; }),
+                   listeners_.end());
+}
+
+bool VehicleModeMonitor::Observe(const models::TelemetryFrame& frame) {
+  // Steady state: one integer compare per frame.
+  if (has_mode_ && frame.vehicle_mode_id == current_mode_) {
+    return false;
+  }
+
+  models::VehicleModeTransition transition;
+  transition.previous = current_mode_;
+  transition.current = frame.vehicle_mode_id;
+  transition.receive_time_us = frame.receive_time_us;
+  current_mode_ = frame.vehicle_mode_id;
+  has_mode_ = true;
+  ULAK_LOG_INFO("vehicle mode %u -> %u (%s)", transition.previous, transition.current,
+                frame.vehicle_mode);
+
+  std::vector<Listener> listeners;
+  {
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    listeners.reserve(listeners_.size());
+    for (const auto& entry : listeners_) {
+      listeners.push_back(entry.second);
+    }
+  }
+  ULAK_TRACE_SCOPE(utils::TraceStage::kBusPublish);
+  for (const auto& listener : listeners) {
+    listener(transition);
+  }
+  return true;
+}
+
+}  // namespace ulak::comms
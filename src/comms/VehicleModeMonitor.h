@@ -0,0 +1,36 @@
+#pragma once
+
+#include "TelemetryFrame.h"
+
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ulak::comms {
+
+// Edge detector on the decoded telemetry stream. The decoder feeds every frame;
+// listeners only run when the interned vehicle_mode id actually changes.
+class VehicleModeMonitor {
+ public:
+  using Listener = std::function<void(const models::VehicleModeTransition&)>;
+
+  // Registers a listener and returns a token for Unsubscribe.
+  int Subscribe(Listener listener);
+  void Unsubscribe(int token);
+
+  // Returns true when the frame produced a mode transition.
+  bool Observe(const models::TelemetryFrame& frame);
+
+  models::VehicleModeId current_mode() const { return current_mode_; }
+
+ private:
+  models::VehicleModeId current_mode_{models::kVehicleModeUnknown};
+  bool has_mode_{false};
+
+  std::mutex listeners_mutex_;
+  std::vector<std::pair<int, Listener>> listeners_;
+  int next_token_{1};
+};
+
+}  // namespace ulak::comms
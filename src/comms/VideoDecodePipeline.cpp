@@ -0,0 +1,241 @@
+#include "VideoDecodePipeline.h"
+
+#include "BinaryLog.h"
+#include "Tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace ulak::comms {
+namespace {
+
+VideoDecodeConfig Resolve(VideoDecodeConfig config) {
+  if (config.decoder_threads <= 0) {
+    config.decoder_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  }
+  config.frame_rate = config.frame_rate > 0.0 ? config.frame_rate : 30.0;
+  config.pool_frames = std::max<std::size_t>(config.pool_frames, 2);
+  config.max_queue = std::max<std::size_t>(config.max_queue, 2);
+  return config;
+}
+
+bool SkippableNonReference(const AccessUnitInfo& info) {
+  return info.has_vcl && !info.reference;
+}
+
+}  // namespace
+
+EncodedAccessUnit MakeAccessUnit(VideoCodec codec, std::vector<std::uint8_t> data,
+                                 std::int64_t pts_us) {
+  EncodedAccessUnit unit;
+  unit.info = ClassifyAccessUnit(codec, data.data(), data.size());
+  unit.data = std::move(data);
+  unit.pts_us = pts_us;
+  return unit;
+}
+
+VideoDecodePipeline::VideoDecodePipeline(VideoDecodeConfig config, VideoDecoderFactory factory)
+    : config_(Resolve(config)),
+      frame_interval_us_(static_cast<std::int64_t>(1'000'000.0 / config_.frame_rate)),
+      factory_(std::move(factory)),
+      pool_(config_.width, config_.height, config_.pool_frames) {}
+
+VideoDecodePipeline::~VideoDecodePipeline() {
+  Stop();
+}
+
+bool VideoDecodePipeline::Start(std::string* reason) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    return true;
+  }
+  if (!factory_) {
+    if (reason != nullptr) {
+      *reason = "No video decoder backend configured";
+    }
+    return false;
+  }
+  std::string factory_reason;
+  decoder_ = factory_(config_, &factory_reason);
+  if (!decoder_) {
+    if (reason != nullptr) {
+      *reason = factory_reason.empty() ? "Video decoder backend failed to open" : factory_reason;
+    }
+    return false;
+  }
+  if (!scratch_pool_) {
+    scratch_pool_ = std::make_unique<YuvFramePool>(config_.width, config_.height, 1);
+  }
+  running_ = true;
+  waiting_for_keyframe_ = true;
+  worker_ = std::thread(&VideoDecodePipeline::Run, this);
+  return true;
+}
+
+void VideoDecodePipeline::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+    queue_.clear();
+  }
+  queue_cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  decoder_.reset();
+  idle_cv_.notify_all();
+}
+
+bool VideoDecodePipeline::Submit(EncodedAccessUnit unit) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return false;
+    }
+    ++stats_.submitted;
+    bool kept_backlog = true;
+    if (queue_.size() >= config_.max_queue) {
+      // Shed skippable pictures first; if the backlog is all reference
+      // pictures, drop it and restart from the next keyframe.
+      const auto before = queue_.size();
+      queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                                  [](const EncodedAccessUnit& queued) {
+                                    return SkippableNonReference(queued.info);
+                                  }),
+                   queue_.end());
+      stats_.dropped_non_reference += before - queue_.size();
+      if (queue_.size() >= config_.max_queue) {
+        stats_.dropped_overflow += queue_.size();
+        queue_.clear();
+        waiting_for_keyframe_ = true;
+        ++stats_.keyframe_resyncs;
+        kept_backlog = false;
+      }
+    }
+    queue_.push_back(std::move(unit));
+    if (!kept_backlog) {
+      queue_cv_.notify_one();
+      return false;
+    }
+  }
+  queue_cv_.notify_one();
+  return true;
+}
+
+void VideoDecodePipeline::WaitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this] { return !running_ || (queue_.empty() && !busy_); });
+}
+
+VideoDecodePipeline::Stats VideoDecodePipeline::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void VideoDecodePipeline::Run() {
+  if (config_.thread_topology != nullptr) {
+    const auto report = config_.thread_topology->EnterSubsystem("stream_decode");
+    for (const std::string& degraded : report.degraded) {
+      ULAK_LOG_WARN("stream_decode: %s", degraded);
+    }
+  }
+  while (true) {
+    EncodedAccessUnit unit;
+    std::size_t backlog = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      busy_ = false;
+      if (queue_.empty()) {
+        idle_cv_.notify_all();
+      }
+      queue_cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+      if (!running_) {
+        return;
+      }
+      unit = std::move(queue_.front());
+      queue_.pop_front();
+      backlog = queue_.size();
+      busy_ = true;
+
+      if (waiting_for_keyframe_ && unit.info.has_vcl) {
+        if (!unit.info.keyframe) {
+          ++stats_.dropped_before_keyframe;
+          continue;
+        }
+        waiting_for_keyframe_ = false;
+      }
+      if (dropping_.load(std::memory_order_relaxed) && SkippableNonReference(unit.info)) {
+        ++stats_.dropped_non_reference;
+        continue;
+      }
+    }
+
+    bool scratch = false;
+    YuvFrameRef frame = pool_.Acquire();
+    if (!frame) {
+      frame = scratch_pool_->Acquire();
+      scratch = true;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    DecodeResult result;
+    {
+      ULAK_TRACE_SCOPE(utils::TraceStage::kDecode);
+      result = decoder_->Decode(unit, frame.get());
+    }
+    const auto decode_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+    if (unit.info.has_vcl) {
+      UpdateDropPolicy(decode_us, backlog);
+    }
+
+    bool publish = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.smoothed_decode_us = smoothed_decode_us_;
+      if (result == DecodeResult::kError) {
+        ++stats_.decode_errors;
+        waiting_for_keyframe_ = true;
+        ++stats_.keyframe_resyncs;
+      } else if (result == DecodeResult::kFrame) {
+        ++stats_.decoded;
+        if (scratch) {
+          ++stats_.pool_exhausted;
+        } else {
+          ++stats_.published;
+          publish = true;
+        }
+      }
+    }
+    if (publish) {
+      frame->sequence = next_sequence_++;
+      output_.Publish(std::move(frame));
+    }
+  }
+}
+
+void VideoDecodePipeline::UpdateDropPolicy(std::int64_t decode_us, std::size_t backlog) {
+  // EWMA with gain 1/8, as for RTT smoothing.
+  smoothed_decode_us_ = has_decode_sample_
+                            ? smoothed_decode_us_ + (decode_us - smoothed_decode_us_) / 8
+                            : decode_us;
+  has_decode_sample_ = true;
+  const double smoothed = static_cast<double>(smoothed_decode_us_);
+  const double interval = static_cast<double>(frame_interval_us_);
+  const bool behind =
+      smoothed > interval * config_.drop_enter_ratio || backlog >= config_.max_queue / 2;
+  const bool caught_up = smoothed < interval * config_.drop_exit_ratio && backlog <= 1;
+  const bool dropping = dropping_.load(std::memory_order_relaxed);
+  if (!dropping && behind) {
+    dropping_.store(true, std::memory_order_relaxed);
+  } else if (dropping && caught_up) {
+    dropping_.store(false, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "NalUnit.h"
+#include "ThreadTopology.h"
+#include "YuvFramePool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ulak::comms {
+
+// One coded picture in Annex B format, as read from the stream socket.
+struct EncodedAccessUnit {
+  std::vector<std::uint8_t> data;
+  std::int64_t pts_us{0};
+  // UTC epoch microseconds when the unit was read off the link; same clock as
+  // TelemetryFrame::receive_time_us.
+  std::int64_t receive_time_us{0};
+  AccessUnitInfo info;
+};
+
+// Builds an access unit and classifies its NAL units.
+EncodedAccessUnit MakeAccessUnit(VideoCodec codec, std::vector<std::uint8_t> data,
+                                 std::int64_t pts_us);
+
+struct VideoDecodeConfig {
+  VideoCodec codec{VideoCodec::kH264};
+  int width{1920};
+  int height{1080};
+  double frame_rate{30.0};
+  // Threads the backend may use for frame/slice threading; 0 = hardware concurrency.
+  int decoder_threads{0};
+  std::size_t pool_frames{6};
+  std::size_t max_queue{8};
+  // Non-reference pictures are skipped while the smoothed decode time is above
+  // enter_ratio * frame interval, until it falls below exit_ratio * interval.
+  double drop_enter_ratio{1.0};
+  double drop_exit_ratio{0.8};
+  // Not owned. The worker thread enters `stream_decode` before decoding.
+  // Backend threads are created by the factory in Start() and inherit the
+  // calling thread's placement instead.
+  const utils::ThreadTopology* thread_topology{nullptr};
+};
+
+enum class DecodeResult {
+  kFrame,    // `out` holds a displayable picture.
+  kNoFrame,  // Accepted, but nothing to output yet (reordering, parameter sets).
+  kError,
+};
+
+// Codec backend. Decode() is always called from the pipeline's worker thread,
+// in stream order; backends parallelize internally (frame/slice threads) and
+// set pts_us/keyframe on the picture they output.
+class VideoDecoder {
+ public:
+  virtual ~VideoDecoder() = default;
+  virtual DecodeResult Decode(const EncodedAccessUnit& unit, YuvFrame* out) = 0;
+};
+
+using VideoDecoderFactory =
+    std::function<std::unique_ptr<VideoDecoder>(const VideoDecodeConfig& config, std::string* reason)>;
+
+// COMPRESSED_LIVE decode path: bounded input queue -> decoder backend ->
+// pooled YUV frames -> LatestFrameSlot for the display.
+class VideoDecodePipeline {
+ public:
+  struct Stats {
+    std::uint64_t submitted{0};
+    std::uint64_t decoded{0};
+    std::uint64_t published{0};
+    std::uint64_t dropped_non_reference{0};
+    std::uint64_t dropped_overflow{0};
+    std::uint64_t decode_errors{0};
+    // Decoded into scratch because the display held every pooled frame.
+    std::uint64_t pool_exhausted{0};
+    std::uint64_t keyframe_resyncs{0};
+    // Pictures skipped while waiting for a keyframe after start or a resync.
+    std::uint64_t dropped_before_keyframe{0};
+    std::int64_t smoothed_decode_us{0};
+  };
+
+  VideoDecodePipeline(VideoDecodeConfig config, VideoDecoderFactory factory);
+  VideoDecodePipeline(const VideoDecodePipeline&) = delete;
+  VideoDecodePipeline& operator=(const VideoDecodePipeline&) = delete;
+  ~VideoDecodePipeline();
+
+  bool Start(std::string* reason);
+  void Stop();
+
+  // Returns false if the unit (or the backlog) was discarded.
+  bool Submit(EncodedAccessUnit unit);
+
+  // Blocks until the queue is empty and the worker is idle.
+  void WaitIdle();
+
+  LatestFrameSlot& output() { return output_; }
+  const YuvFramePool& pool() const { return pool_; }
+  bool dropping_non_reference() const { return dropping_.load(std::memory_order_relaxed); }
+  Stats stats() const;
+
+ private:
+  void Run();
+  // Worker thread only.
+  void UpdateDropPolicy(std::int64_t decode_us, std::size_t backlog);
+
+  const VideoDecodeConfig config_;
+  const std::int64_t frame_interval_us_;
+  VideoDecoderFactory factory_;
+  std::unique_ptr<VideoDecoder> decoder_;
+
+  YuvFramePool pool_;
+  // Reference pictures must be decoded even when no pooled frame is free.
+  std::unique_ptr<YuvFramePool> scratch_pool_;
+  LatestFrameSlot output_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable queue_cv_;
+  std::condition_variable idle_cv_;
+  std::deque<EncodedAccessUnit> queue_;
+  bool running_{false};
+  bool busy_{false};
+  bool waiting_for_keyframe_{true};
+  Stats stats_;
+  std::atomic<bool> dropping_{false};
+  std::int64_t smoothed_decode_us_{0};
+  bool has_decode_sample_{false};
+  std::uint64_t next_sequence_{1};
+  std::thread worker_;
+};
+
+}  // namespace ulak::comms
@@ -0,0 +1,169 @@
+#include "WireFormatNegotiator.h"
+
+#include "Timestamp.h"
+
+namespace ulak::comms {
+namespace {
+
+constexpr const char* kHelloSchemaVersion = "1.1.0";
+
+void AppendQuoted(std::string* out, std::string_view text) {
+  // Handshake strings are fixed identifiers and UUIDs; nothing to escape.
+  out->push_back('"');
+  out->append(text);
+  out->push_back('"');
+}
+
+std::string HelloEnvelope(std::string_view category, const std::string& correlation_id,
+                          std::string_view payload, models::MessageSource source,
+                          std::int64_t now_us) {
+  std::string out = "{\"category\":";
+  AppendQuoted(&out, category);
+  out.append(",\"correlation_id\":");
+  AppendQuoted(&out, correlation_id);
+  out.append(",\"payload\":");
+  out.append(payload);
+  out.append(",\"schema_version\":");
+  AppendQuoted(&out, kHelloSchemaVersion);
+  out.append(",\"source\":");
+  AppendQuoted(&out, models::SourceName(source));
+  out.append(",\"timestamp\":");
+  AppendQuoted(&out, utils::FormatRfc3339Micros(now_us));
+  out.push_back('}');
+  return out;
+}
+
+}  // namespace
+
+const char* ToString(WireFormat format) {
+  switch (format) {
+    case WireFormat::kJson:
+      return "json";
+    case WireFormat::kBinaryV1:
+      return "ulak-bin/1";
+  }
+  return "json";
+}
+
+std::optional<WireFormat> ParseWireFormat(std::string_view name) {
+  if (name == "json") {
+    return WireFormat::kJson;
+  }
+  if (name == "ulak-bin/1") {
+    return WireFormat::kBinaryV1;
+  }
+  return std::nullopt;
+}
+
+std::optional<WireFormat> DetectWireFormat(const std::uint8_t* data, std::size_t size) {
+  for (std::size_t index = 0; index < size; ++index) {
+    switch (data[index]) {
+      case models::kBinaryEnvelopeMagic:
+        if (index == 0) {
+          return WireFormat::kBinaryV1;
+        }
+        return std::nullopt;
+      case '{':
+        return WireFormat::kJson;
+      case ' ':
+      case '\t':
+      case '\r':
+      case '\n':
+        continue;
+      default:
+        return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
+WireFormatNegotiator::WireFormatNegotiator(bool offer_binary, std::int64_t reply_timeout_us)
+    : offer_binary_(offer_binary), reply_timeout_us_(reply_timeout_us) {}
+
+std::string WireFormatNegotiator::Offer(const std::string& correlation_id, std::int64_t now_us) {
+  state_ = State::kOffered;
+  send_format_ = WireFormat::kJson;
+  offer_time_us_ = now_us;
+  const std::string payload = offer_binary_ ? "{\"wire_formats\":[\"ulak-bin/1\",\"json\"]}"
+                                            : "{\"wire_formats\":[\"json\"]}";
+  return HelloEnvelope("station/hello", correlation_id, payload, models::MessageSource::kStation,
+                       now_us);
+}
+
+void WireFormatNegotiator::OnHelloAck(std::string_view wire_format) {
+  if (state_ != State::kOffered) {
+    return;
+  }
+  const auto format = ParseWireFormat(wire_format);
+  // A peer may only pick something we offered.
+  if (format == WireFormat::kBinaryV1 && offer_binary_) {
+    send_format_ = WireFormat::kBinaryV1;
+    state_ = State::kAgreed;
+  } else if (format == WireFormat::kJson) {
+    send_format_ = WireFormat::kJson;
+    state_ = State::kAgreed;
+  } else {
+    send_format_ = WireFormat::kJson;
+    state_ = State::kFallback;
+  }
+}
+
+void WireFormatNegotiator::OnHelloRejected() {
+  if (state_ == State::kOffered) {
+    send_format_ = WireFormat::kJson;
+    state_ = State::kFallback;
+  }
+}
+
+void WireFormatNegotiator::Poll(std::int64_t now_us) {
+  if (state_ == State::kOffered && now_us - offer_time_us_ >= reply_timeout_us_) {
+    send_format_ = WireFormat::kJson;
+    state_ = State::kFallback;
+  }
+}
+
+void WireFormatNegotiator::Reset() {
+  state_ = State::kIdle;
+  send_format_ = WireFormat::kJson;
+  offer_time_us_ = 0;
+}
+
+std::optional<WireFormat> WireFormatNegotiator::Encode(const models::WireEnvelope& envelope,
+                                                       std::vector<std::uint8_t>* out) const {
+  if (send_format_ == WireFormat::kBinaryV1 &&
+      models::EncodeBinaryEnvelope(envelope, out, nullptr)) {
+    return WireFormat::kBinaryV1;
+  }
+  std::string json;
+  if (!models::SerializeJsonEnvelope(envelope, &json, nullptr)) {
+    return std::nullopt;
+  }
+  out->insert(out->end(), json.begin(), json.end());
+  return WireFormat::kJson;
+}
+
+WireFormat SelectWireFormat(const std::vector<std::string>& offered,
+                            const std::vector<WireFormat>& supported) {
+  for (const auto& name : offered) {
+    const auto format = ParseWireFormat(name);
+    if (!format) {
+      continue;
+    }
+    for (const auto candidate : supported) {
+      if (candidate == *format) {
+        return candidate;
+      }
+    }
+  }
+  return WireFormat::kJson;
+}
+
+std::string BuildHelloAck(WireFormat format, const std::string& correlation_id,
+                          models::MessageSource source, std::int64_t now_us) {
+  std::string payload = "{\"wire_format\":";
+  AppendQuoted(&payload, ToString(format));
+  payload.push_back('}');
+  return HelloEnvelope("station/hello_ack", correlation_id, payload, source, now_us);
+}
+
+}  // namespace ulak::comms
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "WireEnvelope.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ulak::comms {
+
+enum class WireFormat {
+  kJson,
+  kBinaryV1,
+};
+
+// Wire names used in the handshake: "json", "ulak-bin/1".
+const char* ToString(WireFormat format);
+std::optional<WireFormat> ParseWireFormat(std::string_view name);
+
+// Per-message format of received bytes: binary frames start with
+// kBinaryEnvelopeMagic, JSON with '{' (leading whitespace allowed). Receivers
+// accept both at all times, so a sender may switch right after the handshake
+// (or fall back to JSON for one message) without coordination.
+std::optional<WireFormat> DetectWireFormat(const std::uint8_t* data, std::size_t size);
+
+// Connection-side half of the wire-format handshake (PROTOCOL.md §3.1).
+// On connect the station sends a `station/hello` JSON envelope listing the
+// formats it accepts; a 1.1 peer answers `station/hello_ack` with its choice.
+// A 1.0 peer rejects the unknown category or stays silent, and the connection
+// keeps JSON. Until a reply arrives everything goes out as JSON.
+// Not thread-safe; one per connection, reset on reconnect.
+class WireFormatNegotiator {
+ public:
+  enum class State {
+    kIdle,
+    kOffered,
+    kAgreed,
+    kFallback,
+  };
+
+  explicit WireFormatNegotiator(bool offer_binary = true, std::int64_t reply_timeout_us = 2'000'000);
+
+  // Returns the hello envelope to send first on a fresh connection.
+  std::string Offer(const std::string& correlation_id, std::int64_t now_us);
+  // `wire_format` of the peer's `station/hello_ack`.
+  void OnHelloAck(std::string_view wire_format);
+  // REJECT of the hello (UNKNOWN_CATEGORY from a 1.0 peer).
+  void OnHelloRejected();
+  // Falls back to JSON when no reply arrived in time.
+  void Poll(std::int64_t now_us);
+  void Reset();
+
+  State state() const { return state_; }
+  WireFormat send_format() const { return send_format_; }
+
+  // Encodes an outgoing envelope in the negotiated format. Envelopes binary
+  // cannot carry (no layout for the category, oversized field) go as JSON.
+  // Returns the format actually used, or nullopt (`out` untouched) when a
+  // payload number is NaN or infinite and neither format can carry it.
+  std::optional<WireFormat> Encode(const models::WireEnvelope& envelope,
+                                   std::vector<std::uint8_t>* out) const;
+
+ private:
+  const bool offer_binary_;
+  const std::int64_t reply_timeout_us_;
+  State state_{State::kIdle};
+  WireFormat send_format_{WireFormat::kJson};
+  std::int64_t offer_time_us_{0};
+};
+
+// Peer side: the first offered format this peer supports, else JSON.
+WireFormat SelectWireFormat(const std::vector<std::string>& offered,
+                            const std::vector<WireFormat>& supported);
+
+// `station/hello_ack` reply carrying the selected format.
+std::string BuildHelloAck(WireFormat format, const std::string& correlation_id,
+                          models::MessageSource source, std::int64_t now_us);
+
+}  // namespace ulak::comms
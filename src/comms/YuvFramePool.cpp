@@ -0,0 +1,134 @@
+#include "YuvFramePool.h"
+
+#include <cstring>
+#include <utility>
+
+namespace ulak::comms {
+namespace {
+
+constexpr std::size_t kAlignment = 64;
+
+int AlignStride(int width) {
+  return static_cast<int>((static_cast<std::size_t>(width) + kAlignment - 1) & ~(kAlignment - 1));
+}
+
+}  // namespace
+
+YuvFrameRef::YuvFrameRef(const YuvFrameRef& other) : frame_(other.frame_) {
+  if (frame_ != nullptr) {
+    frame_->refs_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+YuvFrameRef::YuvFrameRef(YuvFrameRef&& other) noexcept : frame_(other.frame_) {
+  other.frame_ = nullptr;
+}
+
+YuvFrameRef& YuvFrameRef::operator=(YuvFrameRef other) noexcept {
+  std::swap(frame_, other.frame_);
+  return *this;
+}
+
+YuvFrameRef::~YuvFrameRef() {
+  reset();
+}
+
+void YuvFrameRef::reset() {
+  if (frame_ == nullptr) {
+    return;
+  }
+  if (frame_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    frame_->pool_->Recycle(frame_);
+  }
+  frame_ = nullptr;
+}
+
+YuvFrame* YuvFrameRef::Release() {
+  YuvFrame* frame = frame_;
+  frame_ = nullptr;
+  return frame;
+}
+
+YuvFrameRef YuvFrameRef::Adopt(YuvFrame* frame) {
+  return YuvFrameRef(frame);
+}
+
+YuvFramePool::YuvFramePool(int width, int height, std::size_t frame_count)
+    : width_(width), height_(height) {
+  const int chroma_width = (width + 1) / 2;
+  const int chroma_height = (height + 1) / 2;
+  const int luma_stride = AlignStride(width);
+  const int chroma_stride = AlignStride(chroma_width);
+  const std::size_t luma_bytes = static_cast<std::size_t>(luma_stride) * height;
+  const std::size_t chroma_bytes = static_cast<std::size_t>(chroma_stride) * chroma_height;
+  const std::size_t total = luma_bytes + 2 * chroma_bytes + kAlignment;
+
+  frames_.reserve(frame_count);
+  free_list_.reserve(frame_count);
+  for (std::size_t index = 0; index < frame_count; ++index) {
+    auto frame = std::make_unique<YuvFrame>();
+    frame->width = width;
+    frame->height = height;
+    frame->pool_ = this;
+    frame->storage_ = std::make_unique<std::uint8_t[]>(total);
+    const auto raw = reinterpret_cast<std::uintptr_t>(frame->storage_.get());
+    std::uint8_t* base = frame->storage_.get() + ((kAlignment - raw % kAlignment) % kAlignment);
+    // Black frame: Y=16, Cb=Cr=128.
+    std::memset(base, 16, luma_bytes);
+    std::memset(base + luma_bytes, 128, 2 * chroma_bytes);
+    frame->planes[0] = base;
+    frame->planes[1] = base + luma_bytes;
+    frame->planes[2] = base + luma_bytes + chroma_bytes;
+    frame->strides[0] = luma_stride;
+    frame->strides[1] = chroma_stride;
+    frame->strides[2] = chroma_stride;
+    free_list_.push_back(frame.get());
+    frames_.push_back(std::move(frame));
+  }
+}
+
+YuvFrameRef YuvFramePool::Acquire() {
+  YuvFrame* frame = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_list_.empty()) {
+      return YuvFrameRef();
+    }
+    frame = free_list_.back();
+    free_list_.pop_back();
+  }
+  frame->refs_.store(1, std::memory_order_relaxed);
+  frame->pts_us = 0;
+  frame->sequence = 0;
+  frame->keyframe = false;
+  return YuvFrameRef(frame);
+}
+
+std::size_t YuvFramePool::available() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return free_list_.size();
+}
+
+void YuvFramePool::Recycle(YuvFrame* frame) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_list_.push_back(frame);
+}
+
+LatestFrameSlot::~LatestFrameSlot() {
+  YuvFrameRef::Adopt(slot_.exchange(nullptr, std::memory_order_acquire)).reset();
+}
+
+bool LatestFrameSlot::Publish(YuvFrameRef frame) {
+  YuvFrame* previous = slot_.exchange(frame.Release(), std::memory_order_acq_rel);
+  if (previous == nullptr) {
+    return false;
+  }
+  YuvFrameRef::Adopt(previous).reset();
+  return true;
+}
+
+YuvFrameRef LatestFrameSlot::Take() {
+  return YuvFrameRef::Adopt(slot_.exchange(nullptr, std::memory_order_acq_rel));
+}
+
+}  // namespace ulak::comms
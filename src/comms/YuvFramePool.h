@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ulak::comms {
+
+class YuvFramePool;
+
+// I420 picture in pool-owned storage. Planes are 64-byte aligned and strides
+// are multiples of 64 so SIMD kernels can run whole rows.
+struct YuvFrame {
+  int width{0};
+  int height{0};
+  std::uint8_t* planes[3]{nullptr, nullptr, nullptr};
+  int strides[3]{0, 0, 0};
+  std::int64_t pts_us{0};
+  std::uint64_t sequence{0};
+  bool keyframe{false};
+
+ private:
+  friend class YuvFramePool;
+  friend class YuvFrameRef;
+  YuvFramePool* pool_{nullptr};
+  std::atomic<int> refs_{0};
+  std::unique_ptr<std::uint8_t[]> storage_;
+};
+
+// Counted reference to a pooled frame; the last reference returns the frame to
+// the pool's free list. No allocation after the pool is built.
+class YuvFrameRef {
+ public:
+  YuvFrameRef() = default;
+  YuvFrameRef(const YuvFrameRef& other);
+  YuvFrameRef(YuvFrameRef&& other) noexcept;
+  YuvFrameRef& operator=(YuvFrameRef other) noexcept;
+  ~YuvFrameRef();
+
+  YuvFrame* get() const { return frame_; }
+  YuvFrame* operator->() const { return frame_; }
+  YuvFrame& operator*() const { return *frame_; }
+  explicit operator bool() const { return frame_ != nullptr; }
+
+  void reset();
+
+  // Hands the reference over as a raw pointer (used by LatestFrameSlot).
+  YuvFrame* Release();
+  static YuvFrameRef Adopt(YuvFrame* frame);
+
+ private:
+  explicit YuvFrameRef(YuvFrame* frame) : frame_(frame) {}
+  friend class YuvFramePool;
+
+  YuvFrame* frame_{nullptr};
+};
+
+// Fixed set of pre-sized frames recycled through a free list. The pool must
+// outlive every YuvFrameRef it hands out.
+class YuvFramePool {
+ public:
+  YuvFramePool(int width, int height, std::size_t frame_count);
+  YuvFramePool(const YuvFramePool&) = delete;
+  YuvFramePool& operator=(const YuvFramePool&) = delete;
+
+  // Returns an empty ref when every frame is in use.
+  YuvFrameRef Acquire();
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  std::size_t capacity() const { return frames_.size(); }
+  std::size_t available() const;
+
+ private:
+  friend class YuvFrameRef;
+  void Recycle(YuvFrame* frame);
+
+  const int width_;
+  const int height_;
+  std::vector<std::unique_ptr<YuvFrame>> frames_;
+
+  mutable std::mutex mutex_;
+  std::vector<YuvFrame*> free_list_;
+};
+
+// Single-slot, lock-free handoff of the newest decoded frame to the display.
+// Publishing replaces (and releases) a frame the display never took.
+class LatestFrameSlot {
+ public:
+  LatestFrameSlot() = default;
+  LatestFrameSlot(const LatestFrameSlot&) = delete;
+  LatestFrameSlot& operator=(const LatestFrameSlot&) = delete;
+  ~LatestFrameSlot();
+
+  // Returns true if an untaken frame was replaced.
+  bool Publish(YuvFrameRef frame);
+  // Empty when nothing new was published since the last Take().
+  YuvFrameRef Take();
+
+ private:
+  std::atomic<YuvFrame*> slot_{nullptr};
+};
+
+}  // namespace ulak::comms
@@ -0,0 +1,91 @@
+#include "AckTimeoutEstimator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ulak::core {
+namespace {
+
+// Clock granularity term G from RFC 6298; keeps RTO above SRTT on a perfectly
+// stable link.
+constexpr std::int64_t kGranularityUs = 1000;
+
+std::int64_t ShiftForAttempt(std::int64_t value_us, int attempt) {
+  const int shift = std::clamp(attempt - 1, 0, 20);
+  return value_us << shift;
+}
+
+}  // namespace
+
+AckTimeoutEstimator::AckTimeoutEstimator(AckTimeoutPolicy policy) : policy_(policy) {}
+
+void AckTimeoutEstimator::SetPolicy(const AckTimeoutPolicy& policy) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  policy_ = policy;
+}
+
+void AckTimeoutEstimator::AddSample(const std::string& target, std::int64_t rtt_us) {
+  if (rtt_us < 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  backoff_us_.erase(target);
+  auto found = estimates_.find(target);
+  if (found == estimates_.end()) {
+    estimates_.emplace(target, Estimate{rtt_us, rtt_us / 2});
+    return;
+  }
+  auto& estimate = found->second;
+  // RTTVAR <- 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT <- 7/8 SRTT + 1/8 R
+  estimate.rttvar_us = (3 * estimate.rttvar_us + std::llabs(estimate.srtt_us - rtt_us)) / 4;
+  estimate.srtt_us = (7 * estimate.srtt_us + rtt_us) / 8;
+}
+
+void AckTimeoutEstimator::OnAckTimeout(const std::string& target) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto found = backoff_us_.find(target);
+  const std::int64_t current_us =
+      found != backoff_us_.end() ? Clamp(found->second) : BaseTimeoutLocked(target);
+  backoff_us_[target] = Clamp(2 * current_us);
+}
+
+AckTimeoutPlan AckTimeoutEstimator::Plan(const std::string& target, int attempt) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AckTimeoutPlan plan;
+  plan.attempt = std::max(attempt, 1);
+
+  const auto found = estimates_.find(target);
+  if (found != estimates_.end()) {
+    plan.srtt_us = found->second.srtt_us;
+    plan.rttvar_us = found->second.rttvar_us;
+    plan.from_samples = true;
+  }
+  const std::int64_t base_us = BaseTimeoutLocked(target);
+
+  plan.effective_timeout_us = base_us;
+  const auto backoff = backoff_us_.find(target);
+  if (backoff != backoff_us_.end()) {
+    plan.effective_timeout_us = Clamp(backoff->second);
+    plan.backed_off = true;
+  }
+  if (plan.attempt > 1) {
+    plan.retry_delay_us = std::min(ShiftForAttempt(base_us / 4, plan.attempt - 1),
+                                   policy_.ceiling_us);
+  }
+  return plan;
+}
+
+std::int64_t AckTimeoutEstimator::BaseTimeoutLocked(const std::string& target) const {
+  const auto found = estimates_.find(target);
+  if (found == estimates_.end()) {
+    return Clamp(policy_.initial_timeout_us);
+  }
+  const Estimate& estimate = found->second;
+  return Clamp(estimate.srtt_us + std::max(kGranularityUs, 4 * estimate.rttvar_us));
+}
+
+std::int64_t AckTimeoutEstimator::Clamp(std::int64_t value_us) const {
+  return std::clamp(value_us, policy_.floor_us, std::max(policy_.floor_us, policy_.ceiling_us));
+}
+
+}  // namespace ulak::core
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ulak::core {
+
+// Profile-tunable bounds for the adaptive ACK timeout. Defaults reproduce the
+// fixed PROTOCOL.md §7.4/§9 values until RTT samples arrive (T_ack = 2s, up to
+// 3 retries after 500ms / 1s / 2s).
+struct AckTimeoutPolicy {
+  std::int64_t initial_timeout_us{2'000'000};
+  std::int64_t floor_us{250'000};
+  std::int64_t ceiling_us{5'000'000};
+  int max_retries{3};
+};
+
+// Timing decision for one send attempt, recorded in the lifecycle audit.
+struct AckTimeoutPlan {
+  int attempt{1};
+  std::int64_t effective_timeout_us{0};
+  // Delay before this attempt is sent (0 for the first attempt).
+  std::int64_t retry_delay_us{0};
+  std::int64_t srtt_us{0};
+  std::int64_t rttvar_us{0};
+  bool from_samples{false};
+  // effective_timeout_us is a backed-off T_ack (see OnAckTimeout).
+  bool backed_off{false};
+};
+
+// Jacobson/Karels (RFC 6298) round-trip estimator, one per command target.
+class AckTimeoutEstimator {
+ public:
+  explicit AckTimeoutEstimator(AckTimeoutPolicy policy = {});
+
+  void SetPolicy(const AckTimeoutPolicy& policy);
+  const AckTimeoutPolicy& policy() const { return policy_; }
+
+  // Feeds a request->ACK/REJECT round trip. Callers must skip retransmitted
+  // requests (Karn's rule): a retry reuses the correlation id, so its ACK
+  // cannot be matched to a single send.
+  // A sample also ends any backoff for the target.
+  void AddSample(const std::string& target, std::int64_t rtt_us);
+
+  // An attempt to `target` went unacknowledged: doubles its T_ack, up to the
+  // ceiling (RFC 6298 §5.5). Later attempts and later commands use the
+  // backed-off value until a first-attempt sample arrives, so a link whose RTT
+  // jumps above T_ack still yields unambiguous samples.
+  void OnAckTimeout(const std::string& target);
+
+  // Timeout and backoff for `attempt` (1-based). T_ack = SRTT + 4*RTTVAR
+  // clamped to the policy bounds, or the backed-off value; the retry delay
+  // starts at the unbacked T_ack / 4 and doubles per retry (500ms / 1s / 2s
+  // for the 2s default).
+  AckTimeoutPlan Plan(const std::string& target, int attempt) const;
+
+ private:
+  struct Estimate {
+    std::int64_t srtt_us{0};
+    std::int64_t rttvar_us{0};
+  };
+
+  std::int64_t Clamp(std::int64_t value_us) const;
+  // T_ack from the samples alone, before any backoff.
+  std::int64_t BaseTimeoutLocked(const std::string& target) const;
+
+  AckTimeoutPolicy policy_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Estimate> estimates_;
+  std::unordered_map<std::string, std::int64_t> backoff_us_;
+};
+
+}  // namespace ulak::core
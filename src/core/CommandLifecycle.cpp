@@ -0,0 +1,235 @@
+#include "CommandLifecycle.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ulak::core {
+
+CommandLifecycle::CommandLifecycle(CommandLifecyclePolicy policy)
+    : policy_(std::move(policy)), estimator_(policy_.ack) {
+  audit_log_.reserve(std::max<std::size_t>(policy_.audit_capacity, 1));
+}
+
+void CommandLifecycle::SetPolicy(const CommandLifecyclePolicy& policy) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const bool resized = policy.audit_capacity != policy_.audit_capacity;
+  policy_ = policy;
+  estimator_.SetPolicy(policy.ack);
+  if (resized) {
+    ReshapeAuditLocked();
+  }
+}
+
+CommandLifecycleRecord CommandLifecycle::Track(const std::string& correlation_id,
+                                               const std::string& command,
+                                               const std::string& target,
+                                               std::int64_t sent_time_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry entry;
+  entry.command = command;
+  entry.target = target;
+  entry.sent_time_us = sent_time_us;
+  entry.plan = estimator_.Plan(target, 1);
+  entry.deadline_us = sent_time_us + entry.plan.effective_timeout_us;
+
+  auto record = MakeRecordLocked(correlation_id, entry, CommandLifecycleStatus::kSent, sent_time_us);
+  entries_[correlation_id] = std::move(entry);
+  AppendAuditLocked(record);
+  return record;
+}
+
+bool CommandLifecycle::OnAck(const std::string& correlation_id, std::int64_t receive_time_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = entries_.find(correlation_id);
+  if (found == entries_.end() || found->second.phase == Phase::kAwaitingCompletion) {
+    return false;
+  }
+  auto& entry = found->second;
+  const std::int64_t rtt_us = receive_time_us - entry.sent_time_us;
+  // Karn's rule: only first-attempt round trips are unambiguous.
+  if (entry.attempt == 1) {
+    estimator_.AddSample(entry.target, rtt_us);
+  }
+
+  auto record = MakeRecordLocked(correlation_id, entry, CommandLifecycleStatus::kAck, receive_time_us);
+  record.rtt_us = rtt_us;
+  AppendAuditLocked(std::move(record));
+
+  entry.phase = Phase::kAwaitingCompletion;
+  entry.deadline_us = receive_time_us + ExecTimeoutLocked(entry.command);
+  return true;
+}
+
+bool CommandLifecycle::OnReject(const std::string& correlation_id, std::int64_t receive_time_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = entries_.find(correlation_id);
+  if (found == entries_.end() || found->second.phase == Phase::kAwaitingCompletion) {
+    return false;
+  }
+  const auto& entry = found->second;
+  const std::int64_t rtt_us = receive_time_us - entry.sent_time_us;
+  if (entry.attempt == 1) {
+    estimator_.AddSample(entry.target, rtt_us);
+  }
+
+  auto record =
+      MakeRecordLocked(correlation_id, entry, CommandLifecycleStatus::kReject, receive_time_us);
+  record.rtt_us = rtt_us;
+  AppendAuditLocked(std::move(record));
+  entries_.erase(found);
+  return true;
+}
+
+bool CommandLifecycle::OnCompletionEvidence(const std::string& correlation_id,
+                                            std::int64_t time_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = entries_.find(correlation_id);
+  if (found == entries_.end() || found->second.phase != Phase::kAwaitingCompletion) {
+    return false;
+  }
+  AppendAuditLocked(
+      MakeRecordLocked(correlation_id, found->second, CommandLifecycleStatus::kCompleted, time_us));
+  entries_.erase(found);
+  return true;
+}
+
+std::vector<CommandLifecycleAction> CommandLifecycle::Poll(std::int64_t now_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<CommandLifecycleAction> actions;
+
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    const auto& correlation_id = it->first;
+    auto& entry = it->second;
+    if (now_us < entry.deadline_us) {
+      ++it;
+      continue;
+    }
+
+    if (entry.phase == Phase::kAwaitingAck) {
+      estimator_.OnAckTimeout(entry.target);
+      if (entry.attempt <= policy_.ack.max_retries) {
+        ++entry.attempt;
+        entry.plan = estimator_.Plan(entry.target, entry.attempt);
+        entry.phase = Phase::kRetryPending;
+        entry.deadline_us = now_us + entry.plan.retry_delay_us;
+        ++it;
+        continue;
+      }
+      CommandLifecycleAction action;
+      action.kind = CommandLifecycleAction::Kind::kAckTimeout;
+      action.record =
+          MakeRecordLocked(correlation_id, entry, CommandLifecycleStatus::kAckTimeout, now_us);
+      AppendAuditLocked(action.record);
+      actions.push_back(std::move(action));
+      it = entries_.erase(it);
+      continue;
+    }
+
+    if (entry.phase == Phase::kRetryPending) {
+      entry.phase = Phase::kAwaitingAck;
+      entry.sent_time_us = now_us;
+      entry.deadline_us = now_us + entry.plan.effective_timeout_us;
+      CommandLifecycleAction action;
+      action.kind = CommandLifecycleAction::Kind::kResend;
+      action.record =
+          MakeRecordLocked(correlation_id, entry, CommandLifecycleStatus::kRetrySent, now_us);
+      AppendAuditLocked(action.record);
+      actions.push_back(std::move(action));
+      ++it;
+      continue;
+    }
+
+    CommandLifecycleAction action;
+    action.kind = CommandLifecycleAction::Kind::kExecTimeout;
+    action.record =
+        MakeRecordLocked(correlation_id, entry, CommandLifecycleStatus::kExecTimeout, now_us);
+    AppendAuditLocked(action.record);
+    actions.push_back(std::move(action));
+    it = entries_.erase(it);
+  }
+  return actions;
+}
+
+std::size_t CommandLifecycle::in_flight() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+std::size_t CommandLifecycle::audit_size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return audit_log_.size();
+}
+
+std::uint64_t CommandLifecycle::audit_overwritten() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return audit_overwritten_;
+}
+
+CommandLifecycleRecord CommandLifecycle::MakeRecordLocked(const std::string& correlation_id,
+                                                          const Entry& entry,
+                                                          CommandLifecycleStatus status,
+                                                          std::int64_t timestamp_us) const {
+  CommandLifecycleRecord record;
+  record.correlation_id = correlation_id;
+  record.command = entry.command;
+  record.target = entry.target;
+  record.status = status;
+  record.timestamp_us = timestamp_us;
+  record.attempt = entry.attempt;
+  record.effective_timeout_us = entry.plan.effective_timeout_us;
+  record.retry_delay_us = entry.plan.retry_delay_us;
+  return record;
+}
+
+std::int64_t CommandLifecycle::ExecTimeoutLocked(const std::string& command) const {
+  const auto found = policy_.exec_timeout_overrides_us.find(command);
+  return found != policy_.exec_timeout_overrides_us.end() ? found->second
+                                                          : policy_.exec_timeout_us;
+}
+
+void CommandLifecycle::AppendAuditLocked(CommandLifecycleRecord record) {
+  if (audit_log_.size() < std::max<std::size_t>(policy_.audit_capacity, 1)) {
+    audit_log_.push_back(std::move(record));
+    return;
+  }
+  // Move-assigning into the oldest record reuses its string buffers.
+  audit_log_[audit_head_] = std::move(record);
+  audit_head_ = (audit_head_ + 1) % audit_log_.size();
+  ++audit_overwritten_;
+}
+
+void CommandLifecycle::ReshapeAuditLocked() {
+  std::rotate(audit_log_.begin(), audit_log_.begin() + static_cast<std::ptrdiff_t>(audit_head_),
+              audit_log_.end());
+  audit_head_ = 0;
+  const std::size_t capacity = std::max<std::size_t>(policy_.audit_capacity, 1);
+  if (audit_log_.size() > capacity) {
+    const std::size_t excess = audit_log_.size() - capacity;
+    audit_log_.erase(audit_log_.begin(),
+                     audit_log_.begin() + static_cast<std::ptrdiff_t>(excess));
+    audit_overwritten_ += excess;
+  }
+  audit_log_.reserve(capacity);
+}
+
+const char* ToString(CommandLifecycleStatus status) {
+  switch (status) {
+    case CommandLifecycleStatus::kSent:
+      return "SENT";
+    case CommandLifecycleStatus::kRetrySent:
+      return "RETRY_SENT";
+    case CommandLifecycleStatus::kAck:
+      return "ACK";
+    case CommandLifecycleStatus::kReject:
+      return "REJECT";
+    case CommandLifecycleStatus::kAckTimeout:
+      return "ACK_TIMEOUT";
+    case CommandLifecycleStatus::kExecTimeout:
+      return "EXEC_TIMEOUT";
+    case CommandLifecycleStatus::kCompleted:
+      return "COMPLETED";
+  }
+  return "SENT";
+}
+
+}  // namespace ulak::core
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "AckTimeoutEstimator.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ulak::core {
+
+// Lifecycle of JSON commands sent to the companion (PROTOCOL.md §7). PANIC_RTL
+// does not pass through here.
+enum class CommandLifecycleStatus {
+  kSent,
+  kRetrySent,
+  kAck,
+  kReject,
+  kAckTimeout,
+  kExecTimeout,
+  kCompleted,
+};
+
+struct CommandLifecycleRecord {
+  std::string correlation_id;
+  std::string command;
+  std::string target;
+  CommandLifecycleStatus status{CommandLifecycleStatus::kSent};
+  std::int64_t timestamp_us{0};
+  int attempt{1};
+  // T_ack in force for this attempt (adaptive, see AckTimeoutEstimator).
+  std::int64_t effective_timeout_us{0};
+  std::int64_t retry_delay_us{0};
+  // Request->ACK round trip, for kAck/kReject records; -1 otherwise.
+  std::int64_t rtt_us{-1};
+};
+
+// Work the caller must do after Poll(): resend a request (same correlation id)
+// or surface a timeout to the exception pipeline.
+struct CommandLifecycleAction {
+  enum class Kind {
+    kResend,
+    kAckTimeout,
+    kExecTimeout,
+  };
+  Kind kind{Kind::kResend};
+  CommandLifecycleRecord record;
+};
+
+struct CommandLifecyclePolicy {
+  AckTimeoutPolicy ack;
+  std::int64_t exec_timeout_us{10'000'000};
+  // Command-specific T_exec overrides (PROTOCOL.md §7.4).
+  std::unordered_map<std::string, std::int64_t> exec_timeout_overrides_us;
+  // Audit records kept in memory; once full, the oldest are overwritten.
+  std::size_t audit_capacity{1024};
+};
+
+// Tracks in-flight commands from send to ACK/REJECT/TIMEOUT/completion, with
+// an adaptive per-target ACK timeout.
+class CommandLifecycle {
+ public:
+  explicit CommandLifecycle(CommandLifecyclePolicy policy = {});
+
+  void SetPolicy(const CommandLifecyclePolicy& policy);
+
+  // Registers the first send of a command.
+  CommandLifecycleRecord Track(const std::string& correlation_id,
+                               const std::string& command,
+                               const std::string& target,
+                               std::int64_t sent_time_us);
+
+  // Returns false for unknown or already-resolved correlation ids (duplicates).
+  bool OnAck(const std::string& correlation_id, std::int64_t receive_time_us);
+  bool OnReject(const std::string& correlation_id, std::int64_t receive_time_us);
+
+  // Deterministic completion evidence (e.g. mission FSM reached the expected
+  // state). Returns false if the command was not awaiting completion.
+  bool OnCompletionEvidence(const std::string& correlation_id, std::int64_t time_us);
+
+  // Advances timers; returns resend and timeout actions due at `now_us`.
+  std::vector<CommandLifecycleAction> Poll(std::int64_t now_us);
+
+  std::size_t in_flight() const;
+
+  // Visits the retained audit records oldest to newest without copying them.
+  // Runs under the lifecycle's lock: the visitor must not call back into it.
+  template <typename Visitor>
+  void ForEachAuditRecord(Visitor&& visitor) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::size_t size = audit_log_.size();
+    for (std::size_t index = 0; index < size; ++index) {
+      visitor(static_cast<const CommandLifecycleRecord&>(
+          audit_log_[(audit_head_ + index) % size]));
+    }
+  }
+
+  std::size_t audit_size() const;
+  // Audit records overwritten because the ring was full.
+  std::uint64_t audit_overwritten() const;
+  const AckTimeoutEstimator& estimator() const { return estimator_; }
+
+ private:
+  enum class Phase {
+    kAwaitingAck,
+    kRetryPending,
+    kAwaitingCompletion,
+  };
+
+  struct Entry {
+    std::string command;
+    std::string target;
+    Phase phase{Phase::kAwaitingAck};
+    int attempt{1};
+    std::int64_t sent_time_us{0};
+    std::int64_t deadline_us{0};
+    AckTimeoutPlan plan;
+  };
+
+  // Caller holds mutex_.
+  CommandLifecycleRecord MakeRecordLocked(const std::string& correlation_id,
+                                          const Entry& entry,
+                                          CommandLifecycleStatus status,
+                                          std::int64_t timestamp_us) const;
+  std::int64_t ExecTimeoutLocked(const std::string& command) const;
+  void AppendAuditLocked(CommandLifecycleRecord record);
+  // Puts the oldest record first and trims to policy_.audit_capacity.
+  void ReshapeAuditLocked();
+
+  mutable std::mutex mutex_;
+  CommandLifecyclePolicy policy_;
+  AckTimeoutEstimator estimator_;
+  std::unordered_map<std::string, Entry> entries_;
+  // Ring of at most policy_.audit_capacity records; audit_head_ is the oldest
+  // once it has filled up.
+  std::vector<CommandLifecycleRecord> audit_log_;
+  std::size_t audit_head_{0};
+  std::uint64_t audit_overwritten_{0};
+};
+
+const char* ToString(CommandLifecycleStatus status);
+
+}  // namespace ulak::core
@@ -0,0 +1,213 @@
+#include "MissionStateTracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ulak::core {
+namespace {
+
+// Registration order defines the kMissionState* constants.
+constexpr const char* kBuiltinStates[] = {
+    "MISSION_IDLE", "MISSION_RUNNING", "MISSION_PAUSED", "MISSION_ABORTED", "MISSION_COMPLETED",
+};
+
+}  // namespace
+
+std::string_view NoteView(const MissionTransition& transition) {
+  return std::string_view(transition.note, transition.note_length);
+}
+
+MissionStateTracker::MissionStateTracker(std::size_t history_capacity)
+    : capacity_(std::max<std::size_t>(1, history_capacity)) {
+  for (const char* name : kBuiltinStates) {
+    states_.Intern(name);
+  }
+  ring_.resize(capacity_);
+}
+
+void MissionStateTracker::SetCompletionListener(CompletionListener listener) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  listener_ = std::move(listener);
+}
+
+std::uint32_t MissionStateTracker::MaskOf(models::MissionStateId state) {
+  return state < 32 ? 1u << state : 0u;
+}
+
+bool MissionStateTracker::OnMissionState(const models::MissionStateUpdate& update) {
+  auto id = states_.Intern(update.state);
+  if (id == utils::StringInterner::kOverflowId) {
+    id = models::kMissionStateUnknown;
+  }
+
+  std::vector<Evidence> evidence;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    progress_ = update.progress;
+    note_ = update.note;
+    if (has_state_ && id == current_) {
+      return false;
+    }
+
+    const std::int64_t duration =
+        has_state_ ? std::max<std::int64_t>(0, update.receive_time_us - entered_time_us_) : 0;
+    if (has_state_) {
+      time_in_state_us_[current_] += duration;
+    }
+    if (time_in_state_us_.size() <= id) {
+      time_in_state_us_.resize(id + 1u, 0);
+      entry_counts_.resize(id + 1u, 0);
+    }
+    ++entry_counts_[id];
+
+    auto& transition = ring_[next_sequence_ % capacity_];
+    transition = MissionTransition{};
+    transition.sequence = next_sequence_++;
+    transition.receive_time_us = update.receive_time_us;
+    transition.previous_duration_us = duration;
+    transition.previous = current_;
+    transition.current = id;
+    transition.note_length = static_cast<std::uint8_t>(
+        std::min(update.note.size(), MissionTransition::kNoteCapacity));
+    std::memcpy(transition.note, update.note.data(), transition.note_length);
+
+    current_ = id;
+    has_state_ = true;
+    entered_time_us_ = update.receive_time_us;
+
+    const std::uint32_t mask = MaskOf(id);
+    if ((pending_mask_ & mask) == 0) {
+      return true;
+    }
+    pending_mask_ = 0;
+    auto kept = expectations_.begin();
+    for (auto& expectation : expectations_) {
+      if ((expectation.target_mask & mask) != 0) {
+        evidence.push_back({std::move(expectation.correlation_id), update.receive_time_us});
+      } else {
+        pending_mask_ |= expectation.target_mask;
+        *kept++ = std::move(expectation);
+      }
+    }
+    expectations_.erase(kept, expectations_.end());
+  }
+  Notify(evidence);
+  return true;
+}
+
+bool MissionStateTracker::ExpectCompletion(const std::string& correlation_id,
+                                           const std::string& command,
+                                           std::int64_t sent_time_us) {
+  std::uint32_t target_mask = 0;
+  if (command == "START_MISSION") {
+    target_mask = MaskOf(models::kMissionStateRunning);
+  } else if (command == "STOP_MISSION") {
+    target_mask = MaskOf(models::kMissionStateIdle) | MaskOf(models::kMissionStateAborted) |
+                  MaskOf(models::kMissionStateCompleted);
+  } else {
+    return false;
+  }
+
+  std::vector<Evidence> evidence;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expectations_.erase(std::remove_if(expectations_.begin(), expectations_.end(),
+                                       [&](const Expectation& expectation) {
+                                         return expectation.correlation_id == correlation_id;
+                                       }),
+                        expectations_.end());
+    if (has_state_ && (MaskOf(current_) & target_mask) != 0 &&
+        entered_time_us_ >= sent_time_us) {
+      evidence.push_back({correlation_id, entered_time_us_});
+    } else {
+      expectations_.push_back({correlation_id, target_mask});
+      pending_mask_ |= target_mask;
+    }
+  }
+  Notify(evidence);
+  return true;
+}
+
+void MissionStateTracker::CancelCompletion(const std::string& correlation_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_mask_ = 0;
+  auto kept = expectations_.begin();
+  for (auto& expectation : expectations_) {
+    if (expectation.correlation_id != correlation_id) {
+      pending_mask_ |= expectation.target_mask;
+      *kept++ = std::move(expectation);
+    }
+  }
+  expectations_.erase(kept, expectations_.end());
+}
+
+void MissionStateTracker::Notify(const std::vector<Evidence>& evidence) const {
+  if (evidence.empty()) {
+    return;
+  }
+  CompletionListener listener;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listener = listener_;
+  }
+  if (!listener) {
+    return;
+  }
+  for (const auto& item : evidence) {
+    listener(item.correlation_id, item.time_us);
+  }
+}
+
+MissionStateSnapshot MissionStateTracker::current() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  MissionStateSnapshot snapshot;
+  snapshot.state = current_;
+  snapshot.name = std::string(states_.Name(current_));
+  snapshot.entered_time_us = entered_time_us_;
+  snapshot.progress = progress_;
+  snapshot.note = note_;
+  snapshot.transitions = next_sequence_;
+  return snapshot;
+}
+
+std::vector<MissionTransition> MissionStateTracker::history() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::uint64_t begin = next_sequence_ > capacity_ ? next_sequence_ - capacity_ : 0;
+  std::vector<MissionTransition> result;
+  result.reserve(static_cast<std::size_t>(next_sequence_ - begin));
+  for (std::uint64_t sequence = begin; sequence < next_sequence_; ++sequence) {
+    result.push_back(ring_[sequence % capacity_]);
+  }
+  return result;
+}
+
+std::int64_t MissionStateTracker::time_in_state_us(models::MissionStateId state,
+                                                   std::int64_t now_us) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::int64_t total = state < time_in_state_us_.size() ? time_in_state_us_[state] : 0;
+  if (has_state_ && state == current_) {
+    total += std::max<std::int64_t>(0, now_us - entered_time_us_);
+  }
+  return total;
+}
+
+std::uint64_t MissionStateTracker::entry_count(models::MissionStateId state) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state < entry_counts_.size() ? entry_counts_[state] : 0;
+}
+
+std::size_t MissionStateTracker::pending_completions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return expectations_.size();
+}
+
+models::MissionStateId MissionStateTracker::StateId(std::string_view name) const {
+  const auto id = states_.Find(name);
+  return id == utils::StringInterner::kOverflowId ? models::kMissionStateUnknown : id;
+}
+
+std::string_view MissionStateTracker::StateName(models::MissionStateId state) const {
+  return states_.Name(state);
+}
+
+}  // namespace ulak::core
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "MissionState.h"
+#include "StringInterner.h"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace ulak::core {
+
+// Fixed-size history record; the note (transition reason) is stored inline and
+// truncated to kNoteCapacity bytes.
+struct MissionTransition {
+  static constexpr std::size_t kNoteCapacity = 48;
+
+  std::uint64_t sequence{0};
+  std::int64_t receive_time_us{0};
+  // Time spent in `previous` before this transition; 0 for the first one.
+  std::int64_t previous_duration_us{0};
+  models::MissionStateId previous{models::kMissionStateUnknown};
+  models::MissionStateId current{models::kMissionStateUnknown};
+  std::uint8_t note_length{0};
+  char note[kNoteCapacity]{};
+};
+
+static_assert(std::is_trivially_copyable_v<MissionTransition>,
+              "MissionTransition lives in a preallocated ring");
+
+std::string_view NoteView(const MissionTransition& transition);
+
+struct MissionStateSnapshot {
+  models::MissionStateId state{models::kMissionStateUnknown};
+  std::string name;
+  std::int64_t entered_time_us{0};
+  double progress{-1.0};
+  // Note of the latest message (the last transition reason, or a newer one).
+  std::string note;
+  std::uint64_t transitions{0};
+};
+
+// Station-side view of the companion's mission FSM (Architecture.md §5): the
+// current state, a bounded transition history, and per-state time and entry
+// counters. It also supplies completion evidence for mission commands
+// (PROTOCOL.md §7.4): START_MISSION completes when MISSION_RUNNING is entered,
+// STOP_MISSION when MISSION_IDLE, MISSION_ABORTED or MISSION_COMPLETED is.
+// Thread-safe; the completion listener runs on the caller of OnMissionState
+// (or ExpectCompletion) without the tracker's lock held.
+class MissionStateTracker {
+ public:
+  using CompletionListener =
+      std::function<void(const std::string& correlation_id, std::int64_t time_us)>;
+
+  static constexpr std::size_t kDefaultHistoryCapacity = 256;
+
+  explicit MissionStateTracker(std::size_t history_capacity = kDefaultHistoryCapacity);
+
+  // Typically bound to CommandLifecycle::OnCompletionEvidence.
+  void SetCompletionListener(CompletionListener listener);
+
+  // Feeds one `mission/state` message. Returns true when the state changed.
+  bool OnMissionState(const models::MissionStateUpdate& update);
+
+  // Arms completion evidence once a command is ACKed. If the expected state
+  // was already entered after `sent_time_us` (the transition raced the ACK),
+  // the listener fires immediately. Returns false for commands without a rule.
+  bool ExpectCompletion(const std::string& correlation_id, const std::string& command,
+                        std::int64_t sent_time_us);
+  void CancelCompletion(const std::string& correlation_id);
+
+  MissionStateSnapshot current() const;
+  // Retained transitions, oldest first.
+  std::vector<MissionTransition> history() const;
+  // Total time in `state`, including the ongoing interval up to `now_us`.
+  std::int64_t time_in_state_us(models::MissionStateId state, std::int64_t now_us) const;
+  // Number of times `state` was entered.
+  std::uint64_t entry_count(models::MissionStateId state) const;
+  std::size_t pending_completions() const;
+
+  models::MissionStateId StateId(std::string_view name) const;
+  std::string_view StateName(models::MissionStateId state) const;
+
+ private:
+  struct Expectation {
+    std::string correlation_id;
+    std::uint32_t target_mask{0};
+  };
+
+  struct Evidence {
+    std::string correlation_id;
+    std::int64_t time_us{0};
+  };
+
+  static std::uint32_t MaskOf(models::MissionStateId state);
+  void Notify(const std::vector<Evidence>& evidence) const;
+
+  utils::StringInterner states_;
+  const std::size_t capacity_;
+
+  mutable std::mutex mutex_;
+  CompletionListener listener_;
+  std::vector<MissionTransition> ring_;
+  std::uint64_t next_sequence_{0};
+  models::MissionStateId current_{models::kMissionStateUnknown};
+  bool has_state_{false};
+  std::int64_t entered_time_us_{0};
+  double progress_{-1.0};
+  std::string note_;
+  // Indexed by state id; grown on first entry.
+  std::vector<std::int64_t> time_in_state_us_;
+  std::vector<std::uint64_t> entry_counts_;
+  std::vector<Expectation> expectations_;
+  // Union of expectation target masks: transitions nobody waits for cost one AND.
+  std::uint32_t pending_mask_{0};
+};
+
+}  // namespace ulak::core
@@ -0,0 +1,365 @@
+#include "PanicAuditLog.h"
+
+#include "StringInterner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace ulak::core {
+namespace {
+
+constexpr char kSpillMagic[8] = {'U', 'L', 'A', 'K', 'P', 'A', 'U', '1'};
+
+struct SpillHeader {
+  char magic[8];
+  std::uint32_t record_size;
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(SpillHeader) == 16, "Spill header is 16 bytes on disk");
+
+utils::StringInterner& CommandNames() {
+  static utils::StringInterner interner;
+  return interner;
+}
+
+utils::StringInterner& ProfileNames() {
+  static utils::StringInterner interner;
+  return interner;
+}
+
+std::size_t RoundUpToPowerOfTwo(std::size_t value) {
+  std::size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+bool ValidateHeader(const SpillHeader& header, std::string* reason) {
+  if (std::memcmp(header.magic, kSpillMagic, sizeof(kSpillMagic)) != 0) {
+    if (reason != nullptr) {
+      *reason = "not a panic audit spill file";
+    }
+    return false;
+  }
+  if (header.record_size != sizeof(PanicAuditEntry)) {
+    if (reason != nullptr) {
+      *reason = "unsupported panic audit record size";
+    }
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+PanicAuditEntry MakePanicAuditEntry(std::string_view command,
+                                    std::string_view correlation_id,
+                                    std::string_view profile_id,
+                                    PanicAuditOutcome outcome,
+                                    std::int64_t timestamp_us,
+                                    std::int64_t time_to_confirmation_us) {
+  PanicAuditEntry entry;
+  entry.timestamp_us = timestamp_us;
+  entry.time_to_confirmation_us = time_to_confirmation_us;
+  entry.command_id = CommandNames().Intern(command);
+  entry.profile_id = ProfileNames().Intern(profile_id);
+  entry.outcome = outcome;
+  const std::size_t length =
+      std::min(correlation_id.size(), PanicAuditEntry::kCorrelationIdCapacity);
+  std::memcpy(entry.correlation_id, correlation_id.data(), length);
+  entry.correlation_id_length = static_cast<std::uint8_t>(length);
+  return entry;
+}
+
+std::string_view CorrelationIdView(const PanicAuditEntry& entry) {
+  return std::string_view(entry.correlation_id, entry.correlation_id_length);
+}
+
+std::string_view AuditCommandName(std::uint16_t command_id) {
+  return CommandNames().Name(command_id);
+}
+
+std::string_view AuditProfileName(std::uint16_t profile_id) {
+  return ProfileNames().Name(profile_id);
+}
+
+PanicAuditOutcome ParsePanicAuditOutcome(std::string_view state) {
+  if (state == "SENT") {
+    return PanicAuditOutcome::kSent;
+  }
+  if (state == "ACK") {
+    return PanicAuditOutcome::kAck;
+  }
+  if (state == "REJECT") {
+    return PanicAuditOutcome::kReject;
+  }
+  if (state == "ACK_TIMEOUT") {
+    return PanicAuditOutcome::kAckTimeout;
+  }
+  if (state == "EXEC_TIMEOUT") {
+    return PanicAuditOutcome::kExecTimeout;
+  }
+  if (state == "CONFIRMED") {
+    return PanicAuditOutcome::kConfirmed;
+  }
+  if (state == "FAILED") {
+    return PanicAuditOutcome::kFailed;
+  }
+  return PanicAuditOutcome::kUnknown;
+}
+
+const char* ToString(PanicAuditOutcome outcome) {
+  switch (outcome) {
+    case PanicAuditOutcome::kSent:
+      return "SENT";
+    case PanicAuditOutcome::kAck:
+      return "ACK";
+    case PanicAuditOutcome::kReject:
+      return "REJECT";
+    case PanicAuditOutcome::kAckTimeout:
+      return "ACK_TIMEOUT";
+    case PanicAuditOutcome::kExecTimeout:
+      return "EXEC_TIMEOUT";
+    case PanicAuditOutcome::kConfirmed:
+      return "CONFIRMED";
+    case PanicAuditOutcome::kFailed:
+      return "FAILED";
+    case PanicAuditOutcome::kUnknown:
+      return "UNKNOWN";
+  }
+  return "UNKNOWN";
+}
+
+PanicAuditRing::PanicAuditRing(std::size_t capacity)
+    : capacity_(RoundUpToPowerOfTwo(std::max<std::size_t>(capacity, 2))),
+      mask_(capacity_ - 1),
+      slots_(new Slot[capacity_]) {}
+
+std::uint64_t PanicAuditRing::Record(PanicAuditEntry entry) {
+  const std::uint64_t sequence = head_.fetch_add(1, std::memory_order_acq_rel);
+  entry.sequence = sequence;
+
+  Slot& slot = slots_[sequence & mask_];
+  const std::uint64_t previous_lap = sequence >= capacity_ ? 2 * (sequence - capacity_) + 2 : 0;
+  const std::uint64_t writing = 2 * sequence + 1;
+  std::uint64_t expected = previous_lap;
+  while (!slot.version.compare_exchange_weak(expected, writing, std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+    if (expected > previous_lap) {
+      // A producer a full lap ahead owns the slot; our record is already stale.
+      lapped_.fetch_add(1, std::memory_order_relaxed);
+      return sequence;
+    }
+    // The previous lap's producer has not published yet.
+    std::this_thread::yield();
+    expected = previous_lap;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(&slot.entry, &entry, sizeof(entry));
+  slot.version.store(2 * sequence + 2, std::memory_order_release);
+  return sequence;
+}
+
+PanicAuditRing::ReadStatus PanicAuditRing::ReadAt(std::uint64_t sequence,
+                                                  PanicAuditEntry* out) const {
+  const Slot& slot = slots_[sequence & mask_];
+  const std::uint64_t expected = 2 * sequence + 2;
+
+  const std::uint64_t before = slot.version.load(std::memory_order_acquire);
+  if (before < expected) {
+    return ReadStatus::kPending;
+  }
+  if (before > expected) {
+    return ReadStatus::kOverwritten;
+  }
+  std::memcpy(out, &slot.entry, sizeof(*out));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const std::uint64_t after = slot.version.load(std::memory_order_relaxed);
+  return after == expected ? ReadStatus::kOk : ReadStatus::kOverwritten;
+}
+
+PanicAuditSpillWriter::PanicAuditSpillWriter(const PanicAuditRing* ring,
+                                             std::filesystem::path path,
+                                             std::chrono::milliseconds flush_interval)
+    : ring_(ring), path_(std::move(path)), flush_interval_(flush_interval) {
+  batch_.reserve(ring_ != nullptr ? ring_->capacity() : 0);
+}
+
+PanicAuditSpillWriter::~PanicAuditSpillWriter() {
+  Stop();
+}
+
+bool PanicAuditSpillWriter::Start(std::string* reason) {
+  if (ring_ == nullptr) {
+    if (reason != nullptr) {
+      *reason = "panic audit ring is null";
+    }
+    return false;
+  }
+  if (thread_.joinable()) {
+    if (reason != nullptr) {
+      *reason = "panic audit spill writer already running";
+    }
+    return false;
+  }
+
+  std::error_code error_code;
+  const bool has_content = std::filesystem::exists(path_, error_code) &&
+                           std::filesystem::file_size(path_, error_code) > 0 && !error_code;
+  if (has_content) {
+    SpillHeader header{};
+    std::FILE* existing = std::fopen(path_.string().c_str(), "rb");
+    const bool read_ok =
+        existing != nullptr && std::fread(&header, sizeof(header), 1, existing) == 1;
+    if (existing != nullptr) {
+      std::fclose(existing);
+    }
+    if (!read_ok) {
+      if (reason != nullptr) {
+        *reason = "failed to read panic audit spill header: " + path_.string();
+      }
+      return false;
+    }
+    if (!ValidateHeader(header, reason)) {
+      return false;
+    }
+  }
+
+  file_ = std::fopen(path_.string().c_str(), "ab");
+  if (file_ == nullptr) {
+    if (reason != nullptr) {
+      *reason = "failed to open panic audit spill file: " + path_.string();
+    }
+    return false;
+  }
+  if (!has_content) {
+    SpillHeader header{};
+    std::memcpy(header.magic, kSpillMagic, sizeof(kSpillMagic));
+    header.record_size = sizeof(PanicAuditEntry);
+    const bool written = std::fwrite(&header, sizeof(header), 1, file_) == 1;
+    if (std::fflush(file_) != 0 || !written) {
+      std::fclose(file_);
+      file_ = nullptr;
+      if (reason != nullptr) {
+        *reason = "failed to write panic audit spill header: " + path_.string();
+      }
+      return false;
+    }
+  }
+
+  // Only entries recorded from now on are spilled; earlier ones already had
+  // their chance with a previous writer (or predate the session).
+  next_sequence_ = ring_->next_sequence();
+  stop_requested_ = false;
+  thread_ = std::thread(&PanicAuditSpillWriter::Run, this);
+  return true;
+}
+
+void PanicAuditSpillWriter::Stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+
+  std::fclose(file_);
+  file_ = nullptr;
+}
+
+void PanicAuditSpillWriter::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_requested_) {
+    wake_.wait_for(lock, flush_interval_, [this] { return stop_requested_; });
+    lock.unlock();
+    Drain();
+    lock.lock();
+  }
+  lock.unlock();
+
+  // A producer may be between claiming a sequence and publishing it.
+  for (int attempt = 0; attempt < 100 && !Drain(); ++attempt) {
+    std::this_thread::yield();
+  }
+}
+
+bool PanicAuditSpillWriter::Drain() {
+  const std::uint64_t end = ring_->next_sequence();
+  bool complete = true;
+  batch_.clear();
+
+  PanicAuditEntry entry;
+  while (next_sequence_ < end) {
+    const auto status = ring_->ReadAt(next_sequence_, &entry);
+    if (status == PanicAuditRing::ReadStatus::kPending) {
+      complete = false;
+      break;
+    }
+    if (status == PanicAuditRing::ReadStatus::kOverwritten) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      batch_.push_back(entry);
+    }
+    ++next_sequence_;
+  }
+
+  if (!batch_.empty()) {
+    std::size_t written =
+        std::fwrite(batch_.data(), sizeof(PanicAuditEntry), batch_.size(), file_);
+    if (std::fflush(file_) != 0) {
+      // How much of the batch reached the file is unknown; count it all as lost.
+      written = 0;
+      std::clearerr(file_);
+    }
+    spilled_.fetch_add(written, std::memory_order_relaxed);
+    write_failures_.fetch_add(batch_.size() - written, std::memory_order_relaxed);
+  }
+  return complete;
+}
+
+bool LoadPanicAuditSpill(const std::filesystem::path& path,
+                         std::vector<PanicAuditEntry>* entries,
+                         std::string* reason) {
+  if (entries == nullptr) {
+    if (reason != nullptr) {
+      *reason = "entries output is null";
+    }
+    return false;
+  }
+  std::FILE* file = std::fopen(path.string().c_str(), "rb");
+  if (file == nullptr) {
+    if (reason != nullptr) {
+      *reason = "failed to open panic audit spill file: " + path.string();
+    }
+    return false;
+  }
+
+  SpillHeader header{};
+  if (std::fread(&header, sizeof(header), 1, file) != 1) {
+    std::fclose(file);
+    if (reason != nullptr) {
+      *reason = "truncated panic audit spill header";
+    }
+    return false;
+  }
+  if (!ValidateHeader(header, reason)) {
+    std::fclose(file);
+    return false;
+  }
+
+  entries->clear();
+  PanicAuditEntry entry;
+  while (std::fread(&entry, sizeof(entry), 1, file) == 1) {
+    entries->push_back(entry);
+  }
+  std::fclose(file);
+  return true;
+}
+
+}  // namespace ulak::core
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ulak::core {
+
+enum class PanicAuditOutcome : std::uint8_t {
+  kSent,
+  kAck,
+  kReject,
+  kAckTimeout,
+  kExecTimeout,
+  kConfirmed,
+  kFailed,
+  kUnknown,
+};
+
+// Fixed-size audit record. Strings are interned (command, profile) or stored
+// inline (correlation id), so the record can live in a ring and be written to
+// disk as-is.
+struct PanicAuditEntry {
+  static constexpr std::size_t kCorrelationIdCapacity = 36;
+
+  std::uint64_t sequence{0};
+  std::int64_t timestamp_us{0};
+  // -1 unless the outcome is kConfirmed.
+  std::int64_t time_to_confirmation_us{-1};
+  std::uint16_t command_id{0};
+  std::uint16_t profile_id{0};
+  PanicAuditOutcome outcome{PanicAuditOutcome::kUnknown};
+  std::uint8_t correlation_id_length{0};
+  char correlation_id[kCorrelationIdCapacity]{};
+  std::uint8_t reserved[6]{};
+};
+
+static_assert(std::is_trivially_copyable_v<PanicAuditEntry>,
+              "PanicAuditEntry is copied with memcpy and written to disk raw");
+static_assert(sizeof(PanicAuditEntry) == 72, "Spill file layout depends on the record size");
+
+// Builds a record; correlation ids longer than 36 bytes (a UUID string) are truncated.
+PanicAuditEntry MakePanicAuditEntry(std::string_view command,
+                                    std::string_view correlation_id,
+                                    std::string_view profile_id,
+                                    PanicAuditOutcome outcome,
+                                    std::int64_t timestamp_us,
+                                    std::int64_t time_to_confirmation_us = -1);
+
+std::string_view CorrelationIdView(const PanicAuditEntry& entry);
+std::string_view AuditCommandName(std::uint16_t command_id);
+std::string_view AuditProfileName(std::uint16_t profile_id);
+
+// Maps RecordLifecycle state strings ("ACK", "EXEC_TIMEOUT", ...) to outcomes.
+PanicAuditOutcome ParsePanicAuditOutcome(std::string_view state);
+const char* ToString(PanicAuditOutcome outcome);
+
+// Bounded audit ring for any number of producer threads; once full, the
+// oldest entries are overwritten. A producer claims its slot with a CAS from
+// the previous lap's published version, so two producers a lap apart never
+// write the same slot at once and a slot's version only moves forward. The
+// claim waits while the previous lap's producer has not yet published into
+// the slot; a producer that was itself lapped before claiming gives up and
+// counts the record in lapped(). Readers use per-slot sequence locks, so the
+// UI and the spill writer never block producers and never observe a torn
+// record.
+class PanicAuditRing {
+ public:
+  static constexpr std::size_t kDefaultCapacity = 1024;
+
+  enum class ReadStatus {
+    kOk,
+    kPending,
+    kOverwritten,
+  };
+
+  // Capacity is rounded up to a power of two.
+  explicit PanicAuditRing(std::size_t capacity = kDefaultCapacity);
+
+  PanicAuditRing(const PanicAuditRing&) = delete;
+  PanicAuditRing& operator=(const PanicAuditRing&) = delete;
+
+  // Assigns the entry's sequence number and publishes it. Returns the sequence.
+  std::uint64_t Record(PanicAuditEntry entry);
+
+  // Reads the entry published under `sequence`.
+  ReadStatus ReadAt(std::uint64_t sequence, PanicAuditEntry* out) const;
+
+  // Visits retained entries oldest to newest without allocating. Entries
+  // overwritten during the walk are skipped.
+  template <typename Visitor>
+  void ForEach(Visitor&& visitor) const {
+    const std::uint64_t end = next_sequence();
+    const std::uint64_t begin = end > capacity_ ? end - capacity_ : 0;
+    PanicAuditEntry entry;
+    for (std::uint64_t sequence = begin; sequence < end; ++sequence) {
+      if (ReadAt(sequence, &entry) == ReadStatus::kOk) {
+        visitor(static_cast<const PanicAuditEntry&>(entry));
+      }
+    }
+  }
+
+  std::uint64_t next_sequence() const { return head_.load(std::memory_order_acquire); }
+  std::size_t capacity() const { return capacity_; }
+  // Records whose slot a later lap had already claimed; they read as kOverwritten.
+  std::uint64_t lapped() const { return lapped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct alignas(64) Slot {
+    // 2*seq+1 while writing, 2*seq+2 once published, 0 when never written.
+    std::atomic<std::uint64_t> version{0};
+    PanicAuditEntry entry;
+  };
+
+  std::size_t capacity_;
+  std::size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(64) std::atomic<std::uint64_t> head_{0};
+  std::atomic<std::uint64_t> lapped_{0};
+};
+
+// Background thread that appends every published ring entry to a binary
+// spill file (16-byte header, then raw PanicAuditEntry records).
+class PanicAuditSpillWriter {
+ public:
+  PanicAuditSpillWriter(const PanicAuditRing* ring,
+                        std::filesystem::path path,
+                        std::chrono::milliseconds flush_interval = std::chrono::milliseconds(200));
+  ~PanicAuditSpillWriter();
+
+  PanicAuditSpillWriter(const PanicAuditSpillWriter&) = delete;
+  PanicAuditSpillWriter& operator=(const PanicAuditSpillWriter&) = delete;
+
+  // Opens the file for append and starts the writer thread. Entries recorded
+  // before the call are not spilled, so a restart never duplicates records.
+  bool Start(std::string* reason);
+
+  // Drains everything recorded so far, then stops the thread and closes the file.
+  void Stop();
+
+  std::uint64_t spilled() const { return spilled_.load(std::memory_order_relaxed); }
+  // Entries overwritten in the ring before the writer reached them.
+  std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  // Entries lost to a failed fwrite/fflush (disk full, I/O error).
+  std::uint64_t write_failures() const { return write_failures_.load(std::memory_order_relaxed); }
+
+ private:
+  void Run();
+  // Returns false if entries were still pending when it returned.
+  bool Drain();
+
+  const PanicAuditRing* ring_;
+  std::filesystem::path path_;
+  std::chrono::milliseconds flush_interval_;
+
+  std::FILE* file_{nullptr};
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stop_requested_{false};
+
+  std::uint64_t next_sequence_{0};
+  std::vector<PanicAuditEntry> batch_;
+  std::atomic<std::uint64_t> spilled_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::atomic<std::uint64_t> write_failures_{0};
+};
+
+// Reads a spill file written by PanicAuditSpillWriter (offline tools, tests).
+bool LoadPanicAuditSpill(const std::filesystem::path& path,
+                         std::vector<PanicAuditEntry>* entries,
+                         std::string* reason);
+
+}  // namespace ulak::core
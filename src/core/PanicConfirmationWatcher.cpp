@@ -0,0 +1,144 @@
+#include "PanicConfirmationWatcher.h"
+
+#include "Timestamp.h"
+
+#include <utility>
+
+namespace ulak::core {
+
+PanicConfirmationWatcher::PanicConfirmationWatcher(OutcomeSink sink) : sink_(std::move(sink)) {}
+
+void PanicConfirmationWatcher::Arm(const std::string& profile_id,
+                                   const std::string& correlation_id,
+                                   std::int64_t sent_time_us,
+                                   models::VehicleModeId current_mode,
+                                   std::int64_t confirm_window_us) {
+  std::optional<PanicConfirmationRecord> superseded;
+  std::optional<PanicConfirmationRecord> immediate;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == PanicConfirmationState::kSent) {
+      ResolveLocked(PanicConfirmationState::kFailed, sent_time_us, "superseded by new panic trigger");
+      superseded = last_outcome_;
+    }
+
+    profile_id_ = profile_id;
+    correlation_id_ = correlation_id;
+    sent_time_us_ = sent_time_us;
+    deadline_us_ = sent_time_us + confirm_window_us;
+    state_ = PanicConfirmationState::kSent;
+    armed_.store(true, std::memory_order_release);
+
+    if (current_mode == models::kVehicleModeRtl) {
+      ResolveLocked(PanicConfirmationState::kConfirmed, sent_time_us, "vehicle_mode already RTL");
+      immediate = last_outcome_;
+    }
+  }
+
+  if (sink_ && superseded.has_value()) {
+    sink_(superseded.value());
+  }
+  if (sink_ && immediate.has_value()) {
+    sink_(immediate.value());
+  }
+}
+
+void PanicConfirmationWatcher::OnVehicleModeTransition(
+    const models::VehicleModeTransition& transition) {
+  if (transition.current != models::kVehicleModeRtl ||
+      !armed_.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  std::optional<PanicConfirmationRecord> outcome;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != PanicConfirmationState::kSent) {
+      return;
+    }
+    // A late edge must not rescue a trigger whose window already elapsed.
+    if (transition.receive_time_us > deadline_us_) {
+      ResolveLocked(PanicConfirmationState::kFailed,
+                    deadline_us_,
+                    "confirmation window elapsed without vehicle_mode RTL");
+    } else {
+      ResolveLocked(PanicConfirmationState::kConfirmed,
+                    transition.receive_time_us,
+                    "vehicle_mode transitioned to RTL");
+    }
+    outcome = last_outcome_;
+  }
+
+  if (sink_) {
+    sink_(outcome.value());
+  }
+}
+
+bool PanicConfirmationWatcher::Poll(std::int64_t now_us) {
+  if (!armed_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  std::optional<PanicConfirmationRecord> outcome;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != PanicConfirmationState::kSent || now_us <= deadline_us_) {
+      return false;
+    }
+    ResolveLocked(PanicConfirmationState::kFailed,
+                  deadline_us_,
+                  "confirmation window elapsed without vehicle_mode RTL");
+    outcome = last_outcome_;
+  }
+
+  if (sink_) {
+    sink_(outcome.value());
+  }
+  return true;
+}
+
+PanicConfirmationState PanicConfirmationWatcher::state() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_;
+}
+
+std::optional<PanicConfirmationRecord> PanicConfirmationWatcher::last_outcome() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return last_outcome_;
+}
+
+void PanicConfirmationWatcher::ResolveLocked(PanicConfirmationState state,
+                                             std::int64_t resolved_time_us,
+                                             const std::string& reason) {
+  PanicConfirmationRecord record;
+  record.profile_id = profile_id_;
+  record.correlation_id = correlation_id_;
+  record.state = state;
+  record.sent_time_us = sent_time_us_;
+  record.resolved_time_us = resolved_time_us;
+  if (state == PanicConfirmationState::kConfirmed) {
+    record.time_to_confirmation_us = resolved_time_us - sent_time_us_;
+  }
+  record.timestamp = utils::FormatRfc3339Micros(resolved_time_us);
+  record.reason = reason;
+
+  state_ = state;
+  armed_.store(false, std::memory_order_release);
+  last_outcome_ = std::move(record);
+}
+
+const char* ToString(PanicConfirmationState state) {
+  switch (state) {
+    case PanicConfirmationState::kIdle:
+      return "IDLE";
+    case PanicConfirmationState::kSent:
+      return "SENT";
+    case PanicConfirmationState::kConfirmed:
+      return "CONFIRMED";
+    case PanicConfirmationState::kFailed:
+      return "FAILED";
+  }
+  return "IDLE";
+}
+
+}  // namespace ulak::core
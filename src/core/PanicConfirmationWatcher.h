@@ -0,0 +1,87 @@
+#pragma once
+
+#include "TelemetryFrame.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace ulak::core {
+
+// Panic UI states from docs/spec/panic-button.md §3.
+enum class PanicConfirmationState {
+  kIdle,
+  kSent,
+  kConfirmed,
+  kFailed,
+};
+
+// Terminal outcome of one panic trigger, ready for the panic audit log.
+struct PanicConfirmationRecord {
+  std::string profile_id;
+  std::string correlation_id;
+  PanicConfirmationState state{PanicConfirmationState::kIdle};
+  std::int64_t sent_time_us{0};
+  // Receive time of the RTL frame for kConfirmed, window deadline for kFailed.
+  std::int64_t resolved_time_us{0};
+  // Only set for kConfirmed.
+  std::optional<std::int64_t> time_to_confirmation_us;
+  // RFC3339 with microseconds, derived from resolved_time_us.
+  std::string timestamp;
+  std::string reason;
+};
+
+// Edge-triggered SENT -> CONFIRMED/FAILED tracker for PANIC_RTL.
+// Subscribed to the telemetry decoder's vehicle_mode transitions, so it does no
+// per-frame work and compares interned mode ids only.
+class PanicConfirmationWatcher {
+ public:
+  using OutcomeSink = std::function<void(const PanicConfirmationRecord&)>;
+
+  static constexpr std::int64_t kDefaultConfirmWindowUs = 5'000'000;
+
+  explicit PanicConfirmationWatcher(OutcomeSink sink = {});
+
+  // Enters SENT after dispatch. `current_mode` is the last decoded mode, which
+  // confirms immediately if the vehicle is already in RTL. A pending trigger is
+  // resolved as FAILED (superseded) because every trigger needs an outcome.
+  void Arm(const std::string& profile_id,
+           const std::string& correlation_id,
+           std::int64_t sent_time_us,
+           models::VehicleModeId current_mode,
+           std::int64_t confirm_window_us = kDefaultConfirmWindowUs);
+
+  // Mode-change hook for comms::VehicleModeMonitor.
+  void OnVehicleModeTransition(const models::VehicleModeTransition& transition);
+
+  // Resolves FAILED once `now_us` passes the confirmation window.
+  // Returns true when this call produced an outcome.
+  bool Poll(std::int64_t now_us);
+
+  PanicConfirmationState state() const;
+  std::optional<PanicConfirmationRecord> last_outcome() const;
+
+ private:
+  // Caller holds mutex_.
+  void ResolveLocked(PanicConfirmationState state,
+                     std::int64_t resolved_time_us,
+                     const std::string& reason);
+
+  OutcomeSink sink_;
+  std::atomic<bool> armed_{false};
+
+  mutable std::mutex mutex_;
+  PanicConfirmationState state_{PanicConfirmationState::kIdle};
+  std::string profile_id_;
+  std::string correlation_id_;
+  std::int64_t sent_time_us_{0};
+  std::int64_t deadline_us_{0};
+  std::optional<PanicConfirmationRecord> last_outcome_;
+};
+
+const char* ToString(PanicConfirmationState state);
+
+}  // namespace ulak::core
@@ -0,0 +1,442 @@
+#include "PluginHost.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ulak::core {
+namespace {
+
+struct FieldName {
+  std::string_view name;
+  TelemetryField field;
+};
+
+constexpr FieldName kTelemetryFields[] = {
+    {"telemetry_type", TelemetryField::kTelemetryType},
+    {"frame_id", TelemetryField::kFrameId},
+    {"position_m.x", TelemetryField::kPositionX},
+    {"position_m.y", TelemetryField::kPositionY},
+    {"position_m.z", TelemetryField::kPositionZ},
+    {"velocity_mps.x", TelemetryField::kVelocityX},
+    {"velocity_mps.y", TelemetryField::kVelocityY},
+    {"velocity_mps.z", TelemetryField::kVelocityZ},
+    {"attitude_deg.roll", TelemetryField::kRoll},
+    {"attitude_deg.pitch", TelemetryField::kPitch},
+    {"attitude_deg.yaw", TelemetryField::kYaw},
+    {"vehicle_mode", TelemetryField::kVehicleMode},
+    {"vehicle_mode_id", TelemetryField::kVehicleModeId},
+    {"battery_percent", TelemetryField::kBatteryPercent},
+    {"receive_time_us", TelemetryField::kReceiveTimeUs},
+};
+
+std::uint64_t ElapsedUs(std::chrono::steady_clock::time_point from,
+                        std::chrono::steady_clock::time_point to) {
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+  return us > 0 ? static_cast<std::uint64_t>(us) : 0;
+}
+
+}  // namespace
+
+std::size_t PluginEventBatch::size() const {
+  return telemetry.size() + mode_transitions.size() + mission_states.size() + perception.size() +
+         safety_events.size();
+}
+
+std::uint32_t PluginEventBatch::kinds() const {
+  std::uint32_t bits = 0;
+  if (!telemetry.empty()) {
+    bits |= PluginEventBit(PluginEventKind::kTelemetry);
+  }
+  if (!mode_transitions.empty()) {
+    bits |= PluginEventBit(PluginEventKind::kVehicleMode);
+  }
+  if (!mission_states.empty()) {
+    bits |= PluginEventBit(PluginEventKind::kMissionState);
+  }
+  if (!perception.empty()) {
+    bits |= PluginEventBit(PluginEventKind::kPerception);
+  }
+  if (!safety_events.empty()) {
+    bits |= PluginEventBit(PluginEventKind::kSafetyEvent);
+  }
+  return bits;
+}
+
+TelemetryField ParseTelemetryField(std::string_view name) {
+  for (const auto& entry : kTelemetryFields) {
+    if (entry.name == name) {
+      return entry.field;
+    }
+  }
+  return TelemetryField::kUnknown;
+}
+
+PluginValue ReadTelemetryField(const models::TelemetryFrame& frame, TelemetryField field) {
+  switch (field) {
+    case TelemetryField::kTelemetryType:
+      return std::string_view(frame.telemetry_type);
+    case TelemetryField::kFrameId:
+      return std::string_view(frame.frame_id);
+    case TelemetryField::kPositionX:
+      return frame.position_m.x;
+    case TelemetryField::kPositionY:
+      return frame.position_m.y;
+    case TelemetryField::kPositionZ:
+      return frame.position_m.z;
+    case TelemetryField::kVelocityX:
+      return frame.velocity_mps.x;
+    case TelemetryField::kVelocityY:
+      return frame.velocity_mps.y;
+    case TelemetryField::kVelocityZ:
+      return frame.velocity_mps.z;
+    case TelemetryField::kRoll:
+      return frame.attitude_deg.roll;
+    case TelemetryField::kPitch:
+      return frame.attitude_deg.pitch;
+    case TelemetryField::kYaw:
+      return frame.attitude_deg.yaw;
+    case TelemetryField::kVehicleMode:
+      return std::string_view(frame.vehicle_mode);
+    case TelemetryField::kVehicleModeId:
+      return static_cast<double>(frame.vehicle_mode_id);
+    case TelemetryField::kBatteryPercent:
+      return static_cast<double>(frame.battery_percent);
+    case TelemetryField::kReceiveTimeUs:
+      return static_cast<double>(frame.receive_time_us);
+    case TelemetryField::kUnknown:
+      break;
+  }
+  return std::monostate{};
+}
+
+PluginBudgetMeter::PluginBudgetMeter(const PluginBudget& budget)
+    : budget_(budget),
+      deadline_(budget.max_batch_us > 0
+                    ? std::chrono::steady_clock::now() + std::chrono::microseconds(budget.max_batch_us)
+                    : std::chrono::steady_clock::time_point::max()) {}
+
+bool PluginBudgetMeter::Charge(std::uint64_t instructions) {
+  instructions_ += instructions;
+  if (!exhausted_) {
+    exhausted_ = (budget_.max_instructions != 0 && instructions_ > budget_.max_instructions) ||
+                 std::chrono::steady_clock::now() > deadline_;
+  }
+  return !exhausted_;
+}
+
+const char* ToString(PluginState state) {
+  switch (state) {
+    case PluginState::kActive:
+      return "ACTIVE";
+    case PluginState::kThrottled:
+      return "THROTTLED";
+    case PluginState::kDisabled:
+      return "DISABLED";
+  }
+  return "UNKNOWN";
+}
+
+PluginHost::PluginHost(PluginHostConfig config, PluginRuntimeFactory factory)
+    : config_(std::move(config)),
+      factory_(std::move(factory)),
+      open_(std::make_unique<PluginEventBatch>()) {}
+
+PluginHost::~PluginHost() { Stop(); }
+
+bool PluginHost::AddPlugin(const PluginManifest& manifest, std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    return fail("plugins are added before Start()");
+  }
+  if (manifest.name.empty()) {
+    return fail("plugin name is empty");
+  }
+  for (const auto& plugin : plugins_) {
+    if (plugin->manifest.name == manifest.name) {
+      return fail("duplicate plugin name: " + manifest.name);
+    }
+  }
+  if (!factory_) {
+    return fail("no plugin runtime available");
+  }
+  std::string load_error;
+  auto runtime = factory_(manifest, &load_error);
+  if (!runtime) {
+    return fail("failed to load plugin " + manifest.name + ": " + load_error);
+  }
+
+  auto plugin = std::make_unique<Plugin>();
+  plugin->manifest = manifest;
+  plugin->budget = manifest.budget.value_or(config_.default_budget);
+  plugin->runtime = std::move(runtime);
+  plugin->stats.name = manifest.name;
+  plugins_.push_back(std::move(plugin));
+  return true;
+}
+
+bool PluginHost::Start(std::string* reason) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    if (reason != nullptr) {
+      *reason = "plugin host already running";
+    }
+    return false;
+  }
+  running_ = true;
+  stopping_ = false;
+  const int threads = std::max(1, config_.worker_threads);
+  for (int i = 0; i < threads; ++i) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+  return true;
+}
+
+void PluginHost::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ready_.clear();
+  for (auto& plugin : plugins_) {
+    plugin->pending.clear();
+    plugin->queued = false;
+  }
+  open_ = std::make_unique<PluginEventBatch>();
+  running_ = false;
+  stopping_ = false;
+  idle_cv_.notify_all();
+}
+
+void PluginHost::OnTelemetry(const models::TelemetryFrame& frame) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    open_->telemetry.push_back(frame);
+    SealIfFullLocked();
+  }
+}
+
+void PluginHost::OnVehicleModeTransition(const models::VehicleModeTransition& transition) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    open_->mode_transitions.push_back(transition);
+    SealIfFullLocked();
+  }
+}
+
+void PluginHost::OnMissionState(const models::MissionStateUpdate& update) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    open_->mission_states.push_back(update);
+    SealIfFullLocked();
+  }
+}
+
+void PluginHost::OnPerception(const models::PerceptionTarget& target) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    open_->perception.push_back(target);
+    SealIfFullLocked();
+  }
+}
+
+void PluginHost::OnSafetyEvent(const models::SafetyEvent& event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    open_->safety_events.push_back(event);
+    SealIfFullLocked();
+  }
+}
+
+void PluginHost::Poll(std::int64_t now_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!running_) {
+    return;
+  }
+  if (last_seal_us_ == 0) {
+    last_seal_us_ = now_us;
+  }
+  if (now_us - last_seal_us_ >= config_.batch_interval_us) {
+    last_seal_us_ = now_us;
+    SealLocked();
+  }
+  const auto now = Clock::now();
+  for (std::size_t i = 0; i < plugins_.size(); ++i) {
+    ScheduleLocked(i, now);
+  }
+}
+
+void PluginHost::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    SealLocked();
+  }
+}
+
+void PluginHost::WaitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this] { return !running_ || (ready_.empty() && running_calls_ == 0); });
+}
+
+std::vector<PluginStats> PluginHost::Stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<PluginStats> stats;
+  stats.reserve(plugins_.size());
+  for (const auto& plugin : plugins_) {
+    PluginStats entry = plugin->stats;
+    entry.state = plugin->state;
+    entry.run_p50_us = plugin->run_us.ValueAtPercentile(50.0);
+    entry.run_p99_us = plugin->run_us.ValueAtPercentile(99.0);
+    entry.run_max_us = plugin->run_us.max();
+    entry.delivery_p99_us = plugin->delivery_us.ValueAtPercentile(99.0);
+    stats.push_back(std::move(entry));
+  }
+  return stats;
+}
+
+void PluginHost::SealIfFullLocked() {
+  if (open_->size() >= config_.max_batch_events) {
+    SealLocked();
+  }
+}
+
+void PluginHost::SealLocked() {
+  if (open_->size() == 0) {
+    return;
+  }
+  open_->sequence = next_sequence_++;
+  std::shared_ptr<const PluginEventBatch> batch(std::move(open_));
+  open_ = std::make_unique<PluginEventBatch>();
+
+  const auto now = Clock::now();
+  const std::uint32_t kinds = batch->kinds();
+  for (std::size_t i = 0; i < plugins_.size(); ++i) {
+    Plugin& plugin = *plugins_[i];
+    if (plugin.state == PluginState::kDisabled || (plugin.manifest.subscriptions & kinds) == 0) {
+      continue;
+    }
+    const std::size_t limit =
+        plugin.state == PluginState::kThrottled ? 1 : std::max<std::size_t>(1, config_.max_pending_batches);
+    while (plugin.pending.size() >= limit) {
+      plugin.pending.pop_front();
+      ++plugin.stats.dropped_batches;
+    }
+    plugin.pending.push_back(SealedBatch{batch, now});
+    ScheduleLocked(i, now);
+  }
+}
+
+void PluginHost::ScheduleLocked(std::size_t index, Clock::time_point now) {
+  Plugin& plugin = *plugins_[index];
+  if (plugin.queued || plugin.running || plugin.pending.empty() ||
+      plugin.state == PluginState::kDisabled || now < plugin.cooldown_until) {
+    return;
+  }
+  plugin.queued = true;
+  ready_.push_back(index);
+  work_cv_.notify_one();
+}
+
+void PluginHost::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+    if (stopping_) {
+      return;
+    }
+    const std::size_t index = ready_.front();
+    ready_.pop_front();
+    Plugin& plugin = *plugins_[index];
+    plugin.queued = false;
+    if (plugin.state == PluginState::kDisabled || plugin.pending.empty()) {
+      idle_cv_.notify_all();
+      continue;
+    }
+    SealedBatch item = std::move(plugin.pending.front());
+    plugin.pending.pop_front();
+    plugin.running = true;
+    ++running_calls_;
+    PluginRuntime* runtime = plugin.runtime.get();
+    const PluginBudget budget = plugin.budget;
+    lock.unlock();
+
+    const auto start = Clock::now();
+    PluginBudgetMeter meter(budget);
+    std::string error;
+    const PluginCallResult result = runtime->OnEvents(*item.batch, &meter, &error);
+    const auto end = Clock::now();
+
+    std::unique_ptr<PluginRuntime> released;
+    lock.lock();
+    const std::uint64_t run_us = ElapsedUs(start, end);
+    plugin.run_us.Record(run_us);
+    plugin.delivery_us.Record(ElapsedUs(item.sealed_at, end));
+    ++plugin.stats.batches;
+    plugin.stats.events += item.batch->size();
+
+    // The runtime may not notice the deadline between hook calls (or have no
+    // hook at all), so the measured time is checked as well.
+    const bool overrun = result == PluginCallResult::kBudgetExceeded ||
+                         (budget.max_batch_us > 0 && run_us > static_cast<std::uint64_t>(budget.max_batch_us));
+    const bool failed = result == PluginCallResult::kError;
+    if (overrun) {
+      ++plugin.stats.overruns;
+    }
+    if (failed) {
+      ++plugin.stats.errors;
+      plugin.stats.last_error = error;
+    }
+    if (overrun || failed) {
+      plugin.consecutive_clean = 0;
+      if (++plugin.consecutive_failures >= config_.failures_to_disable) {
+        plugin.state = PluginState::kDisabled;
+        plugin.stats.dropped_batches += plugin.pending.size();
+        plugin.pending.clear();
+        released = std::move(plugin.runtime);
+      } else if (overrun) {
+        plugin.state = PluginState::kThrottled;
+        while (plugin.pending.size() > 1) {
+          plugin.pending.pop_front();
+          ++plugin.stats.dropped_batches;
+        }
+      }
+    } else {
+      plugin.consecutive_failures = 0;
+      if (plugin.state == PluginState::kThrottled && ++plugin.consecutive_clean >= config_.batches_to_recover) {
+        plugin.state = PluginState::kActive;
+        plugin.consecutive_clean = 0;
+      }
+    }
+    if (plugin.state == PluginState::kThrottled) {
+      plugin.cooldown_until = end + std::chrono::microseconds(config_.throttle_cooldown_us);
+    }
+    plugin.running = false;
+    --running_calls_;
+    ScheduleLocked(index, end);
+    idle_cv_.notify_all();
+
+    if (released) {
+      // Script teardown (lua_close) can be slow; not under the host lock.
+      lock.unlock();
+      released.reset();
+      lock.lock();
+    }
+  }
+}
+
+}  // namespace ulak::core
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "HdrHistogram.h"
+#include "MissionState.h"
+#include "PerceptionTarget.h"
+#include "SafetyEvent.h"
+#include "TelemetryFrame.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace ulak::core {
+
+enum class PluginEventKind : std::uint8_t {
+  kTelemetry,
+  kVehicleMode,
+  kMissionState,
+  kPerception,
+  kSafetyEvent,
+};
+
+constexpr std::uint32_t PluginEventBit(PluginEventKind kind) {
+  return 1U << static_cast<unsigned>(kind);
+}
+
+inline constexpr std::uint32_t kAllPluginEvents = 0x1F;
+
+// Events gathered over one batch interval. Sealed batches are immutable and
+// shared by every plugin they are delivered to.
+struct PluginEventBatch {
+  std::uint64_t sequence{0};
+  std::vector<models::TelemetryFrame> telemetry;
+  std::vector<models::VehicleModeTransition> mode_transitions;
+  std::vector<models::MissionStateUpdate> mission_states;
+  std::vector<models::PerceptionTarget> perception;
+  std::vector<models::SafetyEvent> safety_events;
+
+  std::size_t size() const;
+  // PluginEventBit()s of the kinds present.
+  std::uint32_t kinds() const;
+};
+
+// Fields a script can read from a TelemetryFrame view. Runtimes resolve names
+// once (e.g. when a script indexes a field for the first time) and read by id.
+enum class TelemetryField : std::uint8_t {
+  kUnknown,
+  kTelemetryType,
+  kFrameId,
+  kPositionX,
+  kPositionY,
+  kPositionZ,
+  kVelocityX,
+  kVelocityY,
+  kVelocityZ,
+  kRoll,
+  kPitch,
+  kYaw,
+  kVehicleMode,
+  kVehicleModeId,
+  kBatteryPercent,
+  kReceiveTimeUs,
+};
+
+// Dotted names as in PROTOCOL.md §6.1: "position_m.x", "attitude_deg.yaw", ...
+TelemetryField ParseTelemetryField(std::string_view name);
+
+// Strings are views into the frame: valid while the batch is being handled.
+using PluginValue = std::variant<std::monostate, double, std::string_view>;
+PluginValue ReadTelemetryField(const models::TelemetryFrame& frame, TelemetryField field);
+
+struct PluginBudget {
+  // Script instructions per batch; 0 = unlimited.
+  std::uint64_t max_instructions{1'000'000};
+  // Wall time per batch.
+  std::int64_t max_batch_us{2'000};
+};
+
+// Budget of one OnEvents() call. The runtime's instruction hook charges it
+// (for Lua: a LUA_MASKCOUNT hook calling Charge(count) and raising an error
+// when it returns false), which bounds a runaway script; the host also
+// checks the measured wall time after the call.
+class PluginBudgetMeter {
+ public:
+  explicit PluginBudgetMeter(const PluginBudget& budget);
+
+  // Returns false once instructions or time are spent; the runtime must then
+  // abort the call and return kBudgetExceeded.
+  bool Charge(std::uint64_t instructions);
+
+  bool exhausted() const { return exhausted_; }
+  std::uint64_t instructions() const { return instructions_; }
+
+ private:
+  const PluginBudget budget_;
+  const std::chrono::steady_clock::time_point deadline_;
+  std::uint64_t instructions_{0};
+  bool exhausted_{false};
+};
+
+enum class PluginCallResult {
+  kOk,
+  kBudgetExceeded,
+  kError,
+};
+
+// Script engine holding one plugin's interpreter state. OnEvents() of one
+// runtime is never called concurrently, so a runtime owns its state (one
+// lua_State per plugin) without locking; calls may come from different
+// workers.
+class PluginRuntime {
+ public:
+  virtual ~PluginRuntime() = default;
+  virtual PluginCallResult OnEvents(const PluginEventBatch& batch, PluginBudgetMeter* meter,
+                                    std::string* error) = 0;
+};
+
+struct PluginManifest {
+  std::string name;
+  std::filesystem::path script_path;
+  std::uint32_t subscriptions{kAllPluginEvents};
+  // Host default when empty.
+  std::optional<PluginBudget> budget;
+};
+
+// Loads the plugin's script into a fresh runtime.
+using PluginRuntimeFactory =
+    std::function<std::unique_ptr<PluginRuntime>(const PluginManifest& manifest, std::string* reason)>;
+
+enum class PluginState {
+  kActive,
+  // Over budget recently: keeps only the newest pending batch and waits
+  // throttle_cooldown_us between runs.
+  kThrottled,
+  // Too many consecutive failures; the runtime has been released.
+  kDisabled,
+};
+
+const char* ToString(PluginState state);
+
+struct PluginHostConfig {
+  int worker_threads{2};
+  std::int64_t batch_interval_us{50'000};
+  // A batch is sealed early once it holds this many events.
+  std::size_t max_batch_events{512};
+  // Per plugin; the oldest batch is dropped when a slow plugin falls behind.
+  std::size_t max_pending_batches{4};
+  PluginBudget default_budget;
+  std::int64_t throttle_cooldown_us{200'000};
+  // Consecutive in-budget batches that lift throttling.
+  int batches_to_recover{20};
+  // Consecutive failed batches (over budget or script error) that disable.
+  int failures_to_disable{3};
+};
+
+struct PluginStats {
+  std::string name;
+  PluginState state{PluginState::kActive};
+  std::uint64_t batches{0};
+  std::uint64_t events{0};
+  std::uint64_t dropped_batches{0};
+  std::uint64_t overruns{0};
+  std::uint64_t errors{0};
+  // Time inside OnEvents().
+  std::uint64_t run_p50_us{0};
+  std::uint64_t run_p99_us{0};
+  std::uint64_t run_max_us{0};
+  // Batch sealed -> plugin done with it.
+  std::uint64_t delivery_p99_us{0};
+  std::string last_error;
+};
+
+// Runs scripted plugins next to the core without being on its hot paths.
+// Producers (telemetry decoder, classifier, panic path) only append to the
+// open batch under a short lock; batches are sealed every batch_interval_us
+// and handed to a worker pool, where each plugin handles them one batch per
+// call. A plugin that overruns its budget is throttled, and disabled if it
+// keeps failing, so a slow script costs its own events, never the core's.
+class PluginHost {
+ public:
+  PluginHost(PluginHostConfig config, PluginRuntimeFactory factory);
+  PluginHost(const PluginHost&) = delete;
+  PluginHost& operator=(const PluginHost&) = delete;
+  ~PluginHost();
+
+  // Before Start().
+  bool AddPlugin(const PluginManifest& manifest, std::string* reason);
+
+  bool Start(std::string* reason);
+  // Waits for running calls; pending batches are discarded.
+  void Stop();
+
+  void OnTelemetry(const models::TelemetryFrame& frame);
+  void OnVehicleModeTransition(const models::VehicleModeTransition& transition);
+  void OnMissionState(const models::MissionStateUpdate& update);
+  void OnPerception(const models::PerceptionTarget& target);
+  void OnSafetyEvent(const models::SafetyEvent& event);
+
+  // Core timer: seals the open batch once batch_interval_us has passed and
+  // reschedules throttled plugins whose cooldown ended.
+  void Poll(std::int64_t now_us);
+  // Seals the open batch now.
+  void Flush();
+  // Blocks until no plugin has a runnable batch or a call in progress.
+  // Plugins still in cooldown do not count as runnable.
+  void WaitIdle();
+
+  std::vector<PluginStats> Stats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct SealedBatch {
+    std::shared_ptr<const PluginEventBatch> batch;
+    Clock::time_point sealed_at;
+  };
+
+  struct Plugin {
+    PluginManifest manifest;
+    PluginBudget budget;
+    std::unique_ptr<PluginRuntime> runtime;
+    std::deque<SealedBatch> pending;
+    PluginState state{PluginState::kActive};
+    bool queued{false};
+    bool running{false};
+    Clock::time_point cooldown_until{};
+    int consecutive_failures{0};
+    int consecutive_clean{0};
+    PluginStats stats;
+    utils::HdrHistogram run_us;
+    utils::HdrHistogram delivery_us;
+  };
+
+  // Callers hold mutex_.
+  void SealLocked();
+  void SealIfFullLocked();
+  void ScheduleLocked(std::size_t index, Clock::time_point now);
+  void WorkerLoop();
+
+  const PluginHostConfig config_;
+  PluginRuntimeFactory factory_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable idle_cv_;
+  std::vector<std::unique_ptr<Plugin>> plugins_;
+  std::deque<std::size_t> ready_;
+  std::unique_ptr<PluginEventBatch> open_;
+  std::uint64_t next_sequence_{1};
+  std::int64_t last_seal_us_{0};
+  int running_calls_{0};
+  bool running_{false};
+  bool stopping_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace ulak::core
@@ -0,0 +1,218 @@
+#include "PolisherTuningSession.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+
+namespace ulak::core {
+namespace {
+
+void AppendEscaped(std::string* out, const std::string& text) {
+  out->push_back('"');
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+    }
+    out->push_back(c);
+  }
+  out->push_back('"');
+}
+
+// Shortest of %.15g / %.17g that round-trips, so 0.35 stays "0.35".
+// SetValue() refuses non-finite values; a hand-built frame carrying one
+// serializes as null, which the receiver rejects, rather than as a number.
+void AppendNumber(std::string* out, double value) {
+  if (!std::isfinite(value)) {
+    out->append("null");
+    return;
+  }
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (std::strtod(buffer, nullptr) != value) {
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  }
+  out->append(buffer);
+}
+
+}  // namespace
+
+PolisherTuningSession::PolisherTuningSession(std::string session_id,
+                                             std::vector<std::string> param_names,
+                                             PolisherTuningPolicy policy)
+    : session_id_(std::move(session_id)),
+      param_names_(std::move(param_names)),
+      policy_(policy),
+      min_interval_us_(1'000'000 / std::max(1, policy.max_rate_hz)),
+      slots_(param_names_.size()) {}
+
+bool PolisherTuningSession::SetValue(std::uint16_t param_id, double value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (param_id >= slots_.size() || !std::isfinite(value)) {
+    return false;
+  }
+  auto& slot = slots_[param_id];
+  slot.pending = value;
+  slot.dirty = true;
+  return true;
+}
+
+std::optional<PolisherDeltaFrame> PolisherTuningSession::Poll(std::int64_t now_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!unacked_frames_.empty() &&
+      now_us - unacked_frames_.front().second >= policy_.ack_timeout_us) {
+    // The stream is not ACK-gated, but values must not be silently lost: push
+    // the newest value of everything the receiver has not confirmed again.
+    for (auto& slot : slots_) {
+      if (slot.has_sent && slot.sent_sequence > acked_sequence_) {
+        slot.dirty = true;
+        slot.resend = true;
+      }
+    }
+    unacked_frames_.clear();
+  }
+  if (has_sent_ && now_us - last_send_us_ < min_interval_us_) {
+    return std::nullopt;
+  }
+
+  PolisherDeltaFrame frame;
+  for (std::size_t index = 0; index < slots_.size(); ++index) {
+    auto& slot = slots_[index];
+    if (!slot.dirty) {
+      continue;
+    }
+    slot.dirty = false;
+    // Dragged away and back within one frame interval: nothing to send.
+    if (slot.has_sent && !slot.resend && slot.pending == slot.sent) {
+      continue;
+    }
+    frame.deltas.emplace_back(static_cast<std::uint16_t>(index), slot.pending);
+  }
+  if (frame.deltas.empty()) {
+    return std::nullopt;
+  }
+
+  frame.session_id = session_id_;
+  frame.sequence = next_sequence_++;
+  for (const auto& delta : frame.deltas) {
+    auto& slot = slots_[delta.first];
+    slot.sent = delta.second;
+    slot.sent_sequence = frame.sequence;
+    slot.has_sent = true;
+    slot.resend = false;
+  }
+  unacked_frames_.emplace_back(frame.sequence, now_us);
+  last_send_us_ = now_us;
+  has_sent_ = true;
+  return frame;
+}
+
+void PolisherTuningSession::OnAck(std::uint32_t applied_sequence, std::uint32_t applied_mask) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (applied_sequence <= acked_sequence_ || applied_sequence >= next_sequence_) {
+    return;
+  }
+  // Frames further back than the mask reaches count as lost: resending a
+  // value the receiver already has is harmless, missing one is not.
+  const auto applied = [applied_sequence, applied_mask](std::uint32_t sequence) {
+    const std::uint32_t back = applied_sequence - sequence;
+    return back == 0 || (back <= 32 && ((applied_mask >> (back - 1)) & 1U) != 0);
+  };
+  for (auto& slot : slots_) {
+    if (!slot.has_sent || slot.sent_sequence <= acked_sequence_ ||
+        slot.sent_sequence > applied_sequence) {
+      continue;
+    }
+    if (applied(slot.sent_sequence)) {
+      slot.confirmed = slot.sent;
+      slot.has_confirmed = true;
+    } else {
+      slot.dirty = true;
+      slot.resend = true;
+    }
+  }
+  acked_sequence_ = applied_sequence;
+  while (!unacked_frames_.empty() && unacked_frames_.front().first <= applied_sequence) {
+    unacked_frames_.pop_front();
+  }
+}
+
+bool PolisherTuningSession::stalled(std::int64_t now_us) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !unacked_frames_.empty() &&
+         now_us - unacked_frames_.front().second >= policy_.ack_timeout_us;
+}
+
+std::uint32_t PolisherTuningSession::last_sent_sequence() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return next_sequence_ - 1;
+}
+
+std::uint32_t PolisherTuningSession::acked_sequence() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return acked_sequence_;
+}
+
+double PolisherTuningSession::confirmed_value(std::uint16_t param_id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (param_id >= slots_.size() || !slots_[param_id].has_confirmed) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return slots_[param_id].confirmed;
+}
+
+std::string PolisherTuningSession::SerializeOpenParams() const {
+  std::map<std::string, std::size_t> ids;
+  for (std::size_t index = 0; index < param_names_.size(); ++index) {
+    ids.emplace(param_names_[index], index);
+  }
+
+  std::string out = "{\"ack_interval_ms\":";
+  out += std::to_string(policy_.ack_interval_us / 1000);
+  out += ",\"max_rate_hz\":";
+  out += std::to_string(policy_.max_rate_hz);
+  out += ",\"param_ids\":{";
+  bool first = true;
+  for (const auto& [name, id] : ids) {
+    if (!first) {
+      out.push_back(',');
+    }
+    first = false;
+    AppendEscaped(&out, name);
+    out.push_back(':');
+    out += std::to_string(id);
+  }
+  out += "},\"tuning_session\":\"open\"}";
+  return out;
+}
+
+std::string PolisherTuningSession::SerializeCloseParams() const {
+  std::string out = "{\"session_id\":";
+  AppendEscaped(&out, session_id_);
+  out += ",\"tuning_session\":\"close\"}";
+  return out;
+}
+
+std::string SerializePolisherDeltaFrame(const PolisherDeltaFrame& frame) {
+  std::string out = "{\"d\":[";
+  for (std::size_t index = 0; index < frame.deltas.size(); ++index) {
+    if (index > 0) {
+      out.push_back(',');
+    }
+    out.push_back('[');
+    out += std::to_string(frame.deltas[index].first);
+    out.push_back(',');
+    AppendNumber(&out, frame.deltas[index].second);
+    out.push_back(']');
+  }
+  out += "],\"q\":";
+  out += std::to_string(frame.sequence);
+  out += ",\"s\":";
+  AppendEscaped(&out, frame.session_id);
+  out.push_back('}');
+  return out;
+}
+
+}  // namespace ulak::core
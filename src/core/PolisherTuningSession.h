@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ulak::core {
+
+struct PolisherTuningPolicy {
+  // Upper bound on delta frame rate; slider moves in between are coalesced.
+  int max_rate_hz{60};
+  // Interval the receiver is asked to ACK at.
+  std::int64_t ack_interval_us{250'000};
+  // No ACK for this long after a frame: resend unconfirmed values.
+  std::int64_t ack_timeout_us{1'000'000};
+};
+
+// One `station/commands/tuning` frame (PROTOCOL.md §7.6). Values are latest-wins:
+// a param appears at most once, with its newest value.
+struct PolisherDeltaFrame {
+  std::string session_id;
+  std::uint32_t sequence{0};
+  std::vector<std::pair<std::uint16_t, double>> deltas;
+};
+
+// Sender side of a Polisher tuning session. The session is opened and closed
+// with ordinary SET_PARAM requests (which go through CommandLifecycle); the
+// value stream in between is not ACK-gated. The receiver applies frames with
+// a higher sequence than the last applied one and periodically ACKs the
+// highest applied sequence, plus a mask of which of the 32 frames before it
+// were applied, so frames lost in between (e.g. across a reconnect) are
+// detected and their values resent.
+class PolisherTuningSession {
+ public:
+  // `session_id` is the correlation id of the opening SET_PARAM request.
+  // Param ids are indices into `param_names`.
+  PolisherTuningSession(std::string session_id,
+                        std::vector<std::string> param_names,
+                        PolisherTuningPolicy policy = {});
+
+  // UI thread: records the newest value of a slider/toggle. Returns false for
+  // an unknown param id or a non-finite value.
+  bool SetValue(std::uint16_t param_id, double value);
+
+  // Comms thread: returns the next frame if one is due at `now_us`.
+  std::optional<PolisherDeltaFrame> Poll(std::int64_t now_us);
+
+  // Periodic ACK carrying the highest applied sequence. Bit i of
+  // `applied_mask` is set if frame applied_sequence - 1 - i was applied too.
+  // Params whose latest frame is not covered are resent on the next Poll().
+  // Stale or out-of-range ACKs are ignored.
+  void OnAck(std::uint32_t applied_sequence, std::uint32_t applied_mask);
+
+  // True while frames are unacknowledged for longer than ack_timeout_us.
+  bool stalled(std::int64_t now_us) const;
+  std::uint32_t last_sent_sequence() const;
+  std::uint32_t acked_sequence() const;
+  // Values the receiver is known to have applied (NaN until confirmed).
+  double confirmed_value(std::uint16_t param_id) const;
+
+  const std::string& session_id() const { return session_id_; }
+  const std::vector<std::string>& param_names() const { return param_names_; }
+
+  // SET_PARAM `params` objects that open/close the session (sorted keys).
+  std::string SerializeOpenParams() const;
+  std::string SerializeCloseParams() const;
+
+ private:
+  struct Slot {
+    double pending{0.0};
+    double sent{0.0};
+    double confirmed{0.0};
+    std::uint32_t sent_sequence{0};
+    bool dirty{false};
+    bool has_sent{false};
+    bool has_confirmed{false};
+    bool resend{false};
+  };
+
+  const std::string session_id_;
+  const std::vector<std::string> param_names_;
+  const PolisherTuningPolicy policy_;
+  const std::int64_t min_interval_us_;
+
+  mutable std::mutex mutex_;
+  std::vector<Slot> slots_;
+  std::uint32_t next_sequence_{1};
+  std::uint32_t acked_sequence_{0};
+  std::int64_t last_send_us_{0};
+  bool has_sent_{false};
+  // (sequence, send time) of frames newer than acked_sequence_.
+  std::deque<std::pair<std::uint32_t, std::int64_t>> unacked_frames_;
+};
+
+// Compact `station/commands/tuning` payload:
+// {"d":[[id,value],...],"q":<sequence>,"s":"<session>"}
+std::string SerializePolisherDeltaFrame(const PolisherDeltaFrame& frame);
+
+}  // namespace ulak::core
@@ -0,0 +1,222 @@
+#include "SafetyEventAggregator.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ulak::core {
+namespace {
+
+using models::SafetySeverity;
+
+std::size_t Index(SafetySeverity severity) {
+  return static_cast<std::size_t>(severity);
+}
+
+}  // namespace
+
+SafetyEventAggregator::SafetyEventAggregator() = default;
+
+void SafetyEventAggregator::SetEventSink(EventSink sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = std::move(sink);
+}
+
+bool SafetyEventAggregator::SetPolicy(SafetyAggregationPolicy policy, std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+
+  if (policy.coalesce_window_us < 0) {
+    return fail("coalesce window must not be negative");
+  }
+  if (policy.max_codes == 0) {
+    return fail("max_codes must be positive");
+  }
+  std::int64_t history_us = 0;
+  std::size_t history_depth = 0;
+  for (std::size_t i = 0; i < policy.escalation.size(); ++i) {
+    const EscalationRule& rule = policy.escalation[i];
+    const std::string name = "escalation rule " + std::to_string(i);
+    if (rule.count == 0 || rule.window_us <= 0) {
+      return fail(name + " needs a positive count and window");
+    }
+    if (rule.to <= rule.from) {
+      return fail(name + " does not raise the severity");
+    }
+    history_us = std::max(history_us, rule.window_us);
+    history_depth = std::max<std::size_t>(history_depth, rule.count);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  policy_ = std::move(policy);
+  history_us_ = history_us;
+  history_depth_ = history_depth;
+  for (auto& entry : codes_) {
+    for (auto& recent : entry.second.recent) {
+      recent.clear();
+    }
+  }
+  return true;
+}
+
+std::vector<AggregatedSafetyEvent> SafetyEventAggregator::Submit(const models::SafetyEvent& event,
+                                                                 std::int64_t now_us) {
+  std::vector<AggregatedSafetyEvent> out;
+  std::unique_lock<std::mutex> lock(mutex_);
+  ++stats_.received;
+
+  auto found = codes_.find(event.code);
+  if (found == codes_.end() && codes_.size() >= policy_.max_codes) {
+    // Never drop a safety event; it just loses the storm protection.
+    ++stats_.untracked;
+    ++stats_.forwarded;
+    AggregatedSafetyEvent passed;
+    passed.event = event;
+    passed.source_severity = event.severity;
+    passed.first_seen_us = now_us;
+    out.push_back(std::move(passed));
+    lock.unlock();
+    Deliver(out);
+    return out;
+  }
+  const bool fresh = found == codes_.end();
+  if (fresh) {
+    found = codes_.emplace(event.code, CodeState{}).first;
+  }
+  CodeState& state = found->second;
+  state.latest = event;
+  state.last_seen_us = now_us;
+
+  auto& recent = state.recent[Index(event.severity)];
+  if (history_depth_ > 0) {
+    recent.push_back(now_us);
+  }
+  while (!recent.empty() &&
+         (recent.size() > history_depth_ || recent.front() < now_us - history_us_)) {
+    recent.pop_front();
+  }
+  const SafetySeverity severity = Escalate(event.code, &state, event.severity, now_us);
+
+  const bool window_closed = now_us - state.forwarded_us >= policy_.coalesce_window_us;
+  if (fresh || window_closed || severity > state.forwarded_severity) {
+    const std::int64_t first_seen_us = state.pending > 0 ? state.first_pending_us : now_us;
+    out.push_back(Forward(&state, severity, first_seen_us, state.pending + 1, now_us));
+  } else {
+    if (state.pending == 0) {
+      state.first_pending_us = now_us;
+      state.pending_severity = severity;
+    }
+    ++state.pending;
+    state.pending_severity = std::max(state.pending_severity, severity);
+    ++stats_.suppressed;
+    return out;
+  }
+  lock.unlock();
+  Deliver(out);
+  return out;
+}
+
+std::vector<AggregatedSafetyEvent> SafetyEventAggregator::Flush(std::int64_t now_us) {
+  std::vector<AggregatedSafetyEvent> out;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::int64_t forget_after_us = std::max(policy_.coalesce_window_us, history_us_);
+    for (auto it = codes_.begin(); it != codes_.end();) {
+      CodeState& state = it->second;
+      if (state.pending > 0 && now_us - state.forwarded_us >= policy_.coalesce_window_us) {
+        out.push_back(Forward(&state, state.pending_severity, state.first_pending_us,
+                              state.pending, now_us));
+      }
+      if (state.pending == 0 && !state.countdown_open &&
+          now_us - state.last_seen_us > forget_after_us) {
+        it = codes_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  Deliver(out);
+  return out;
+}
+
+void SafetyEventAggregator::ReleaseCountdown(const std::string& code) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto found = codes_.find(code);
+  if (found != codes_.end()) {
+    found->second.countdown_open = false;
+  }
+}
+
+SafetyAggregatorStats SafetyEventAggregator::Stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+SafetySeverity SafetyEventAggregator::Escalate(const std::string& code, CodeState* state,
+                                               SafetySeverity severity, std::int64_t now_us) {
+  SafetySeverity result = severity;
+  for (const EscalationRule& rule : policy_.escalation) {
+    if ((!rule.code.empty() && rule.code != code) || severity < rule.from || rule.to <= result) {
+      continue;
+    }
+    std::size_t count = 0;
+    for (std::size_t level = Index(rule.from); level < kSeverityCount; ++level) {
+      const auto& recent = state->recent[level];
+      for (auto it = recent.rbegin(); it != recent.rend() && *it >= now_us - rule.window_us;
+           ++it) {
+        ++count;
+      }
+    }
+    if (count >= rule.count) {
+      result = rule.to;
+    }
+  }
+  return result;
+}
+
+AggregatedSafetyEvent SafetyEventAggregator::Forward(CodeState* state, SafetySeverity severity,
+                                                     std::int64_t first_seen_us,
+                                                     std::uint32_t occurrences,
+                                                     std::int64_t now_us) {
+  AggregatedSafetyEvent out;
+  out.event = state->latest;
+  out.event.severity = severity;
+  out.source_severity = state->latest.severity;
+  out.occurrences = occurrences;
+  out.first_seen_us = first_seen_us;
+  if (severity == SafetySeverity::kError && !state->countdown_open) {
+    out.begins_countdown = true;
+    state->countdown_open = true;
+    ++stats_.countdowns;
+  }
+  if (severity != out.source_severity) {
+    ++stats_.escalated;
+  }
+  ++stats_.forwarded;
+  state->forwarded_severity = severity;
+  state->forwarded_us = now_us;
+  state->pending = 0;
+  return out;
+}
+
+void SafetyEventAggregator::Deliver(const std::vector<AggregatedSafetyEvent>& events) {
+  if (events.empty()) {
+    return;
+  }
+  EventSink sink;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sink = sink_;
+  }
+  if (!sink) {
+    return;
+  }
+  for (const auto& event : events) {
+    sink(event);
+  }
+}
+
+}  // namespace ulak::core
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "SafetyEvent.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ulak::core {
+
+// "`count` events of `code` at `from` or above within `window_us` -> `to`".
+// An empty code matches every code.
+struct EscalationRule {
+  std::string code;
+  models::SafetySeverity from{models::SafetySeverity::kWarn};
+  std::uint32_t count{0};
+  std::int64_t window_us{0};
+  models::SafetySeverity to{models::SafetySeverity::kError};
+};
+
+// Loaded from the active profile's `safety_aggregation` section.
+struct SafetyAggregationPolicy {
+  // Repeats of a forwarded code within this window are folded into one
+  // summary instead of reaching the classifier one by one.
+  std::int64_t coalesce_window_us{1'000'000};
+  // Codes tracked at once; beyond it events pass through unaggregated.
+  std::size_t max_codes{256};
+  std::vector<EscalationRule> escalation;
+};
+
+// What the classifier sees: one event standing for `occurrences` raw ones.
+struct AggregatedSafetyEvent {
+  // Latest raw event; `severity` is the escalated one.
+  models::SafetyEvent event;
+  models::SafetySeverity source_severity{models::SafetySeverity::kWarn};
+  std::uint32_t occurrences{1};
+  std::int64_t first_seen_us{0};
+  // ERROR with no countdown open for the code: the classifier starts one.
+  // At most one countdown per code until ReleaseCountdown().
+  bool begins_countdown{false};
+};
+
+struct SafetyAggregatorStats {
+  std::uint64_t received{0};
+  std::uint64_t forwarded{0};
+  std::uint64_t suppressed{0};
+  std::uint64_t escalated{0};
+  std::uint64_t countdowns{0};
+  // Passed through because max_codes codes were already tracked.
+  std::uint64_t untracked{0};
+};
+
+// Pre-classifier stage for `safety/events` and station-raised events, keyed by
+// code. The first event of a code goes out at once; repeats within the
+// coalesce window are only counted and go out as one summary from Flush(). A
+// repeat that raises the code's severity (by itself or through an escalation
+// rule) is never held back. A storm of hundreds of events per second thus
+// costs the classifier, timeline and recorder about one event per code per
+// window, and starts at most one ERROR countdown per code.
+//
+// Escalation counts raw severities in per-code sliding windows, so an
+// escalated event does not feed further rules.
+class SafetyEventAggregator {
+ public:
+  using EventSink = std::function<void(const AggregatedSafetyEvent&)>;
+
+  SafetyEventAggregator();
+
+  void SetEventSink(EventSink sink);
+
+  // Applies new rules, e.g. after SwitchActiveProfile; escalation history is
+  // dropped, open countdowns are kept. Fails on a rule with a zero count or
+  // window, or one that does not raise the severity.
+  bool SetPolicy(SafetyAggregationPolicy policy, std::string* reason);
+
+  // Returns the event to classify now, if any (also delivered to the sink,
+  // outside the lock).
+  std::vector<AggregatedSafetyEvent> Submit(const models::SafetyEvent& event,
+                                            std::int64_t now_us);
+
+  // Emits summaries for codes whose coalesce window has closed with repeats
+  // pending, and forgets codes quiet for longer than every window. Called by
+  // the core's health timer.
+  std::vector<AggregatedSafetyEvent> Flush(std::int64_t now_us);
+
+  // The code's countdown was confirmed, cancelled or timed out.
+  void ReleaseCountdown(const std::string& code);
+
+  SafetyAggregatorStats Stats() const;
+
+ private:
+  static constexpr std::size_t kSeverityCount = 3;
+
+  struct CodeState {
+    models::SafetyEvent latest;
+    models::SafetySeverity forwarded_severity{models::SafetySeverity::kWarn};
+    std::int64_t forwarded_us{0};
+    // Repeats held back since the last forward.
+    std::uint32_t pending{0};
+    std::int64_t first_pending_us{0};
+    models::SafetySeverity pending_severity{models::SafetySeverity::kWarn};
+    std::int64_t last_seen_us{0};
+    bool countdown_open{false};
+    // Recent raw occurrence times per severity, newest last.
+    std::array<std::deque<std::int64_t>, kSeverityCount> recent;
+  };
+
+  // Takes mutex_ itself; callers must not hold it.
+  void Deliver(const std::vector<AggregatedSafetyEvent>& events);
+
+  // Callers hold mutex_.
+  models::SafetySeverity Escalate(const std::string& code, CodeState* state,
+                                  models::SafetySeverity severity, std::int64_t now_us);
+  AggregatedSafetyEvent Forward(CodeState* state, models::SafetySeverity severity,
+                                std::int64_t first_seen_us, std::uint32_t occurrences,
+                                std::int64_t now_us);
+
+  mutable std::mutex mutex_;
+  EventSink sink_;
+  SafetyAggregationPolicy policy_;
+  // Longest rule window, and the largest count any rule needs to see.
+  std::int64_t history_us_{0};
+  std::size_t history_depth_{0};
+  std::unordered_map<std::string, CodeState> codes_;
+  SafetyAggregatorStats stats_;
+};
+
+}  // namespace ulak::core
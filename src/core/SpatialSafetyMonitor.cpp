@@ -0,0 +1,400 @@
+#include "SpatialSafetyMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+namespace ulak::core {
+namespace {
+
+// Keep-out zones covering more cells than this are checked on every frame.
+constexpr std::int64_t kMaxCellsPerZone = 4096;
+
+bool IsNedFrame(const std::string& frame_id) {
+  constexpr const char* kSuffix = "_NED";
+  return frame_id.size() >= 4 && frame_id.compare(frame_id.size() - 4, 4, kSuffix) == 0;
+}
+
+// Clamped to the int32 range CellKey keeps; the cast of an out-of-range
+// double would be undefined. NaN must be filtered out by the caller.
+std::int64_t CellIndex(double value, double cell_size) {
+  constexpr double kMin = std::numeric_limits<std::int32_t>::min();
+  constexpr double kMax = std::numeric_limits<std::int32_t>::max();
+  return static_cast<std::int64_t>(std::clamp(std::floor(value / cell_size), kMin, kMax));
+}
+
+std::uint64_t CellKey(std::int64_t cx, std::int64_t cy) {
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+         static_cast<std::uint32_t>(cy);
+}
+
+// Even-odd rule; points on an edge may fall either way.
+bool PointInPolygon(const std::vector<FencePoint>& polygon, double x, double y) {
+  bool inside = false;
+  for (std::size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    const FencePoint& a = polygon[i];
+    const FencePoint& b = polygon[j];
+    if ((a.y > y) != (b.y > y) && x < (b.x - a.x) * (y - a.y) / (b.y - a.y) + a.x) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+std::string SeparationMessage(VehicleId vehicle, VehicleId other, double distance_m) {
+  char buffer[96];
+  std::snprintf(buffer, sizeof(buffer), "Vehicles %u and %u are %.1f m apart",
+                static_cast<unsigned>(vehicle), static_cast<unsigned>(other), distance_m);
+  return buffer;
+}
+
+std::string BreachMessage(VehicleId vehicle, const GeofenceZone& zone) {
+  const char* verb = zone.kind == GeofenceKind::kKeepIn ? "left" : "entered";
+  char buffer[64];
+  std::snprintf(buffer, sizeof(buffer), "Vehicle %u %s zone ", static_cast<unsigned>(vehicle), verb);
+  return buffer + (zone.name.empty() ? std::to_string(zone.id) : zone.name);
+}
+
+}  // namespace
+
+SpatialSafetyMonitor::SpatialSafetyMonitor() = default;
+
+bool SpatialSafetyMonitor::SetPolicy(SpatialSafetyPolicy policy, std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+
+  // The distances are also grid cell sizes: zero or NaN would divide into
+  // garbage cell indices.
+  const auto positive = [](double value) { return std::isfinite(value) && value > 0.0; };
+  if (!positive(policy.separation_warn_m)) {
+    return fail("separation_warn_m must be a positive distance");
+  }
+  if (!positive(policy.separation_clear_m) ||
+      policy.separation_clear_m < policy.separation_warn_m) {
+    return fail("separation_clear_m must be finite and at least separation_warn_m");
+  }
+  if (!positive(policy.fence_cell_m)) {
+    return fail("fence_cell_m must be a positive distance");
+  }
+  if (policy.stale_after_us < 0 || policy.geofence_rearm_us < 0) {
+    return fail("stale_after_us and geofence_rearm_us must not be negative");
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  policy_ = policy;
+  vehicle_grid_.clear();
+  const double cell = policy_.separation_clear_m;
+  for (auto& [id, vehicle] : vehicles_) {
+    vehicle.cell = CellKey(CellIndex(vehicle.x, cell), CellIndex(vehicle.y, cell));
+    vehicle_grid_[vehicle.cell].push_back(id);
+  }
+  IndexZones();
+  return true;
+}
+
+void SpatialSafetyMonitor::SetEventSink(EventSink sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = std::move(sink);
+}
+
+bool SpatialSafetyMonitor::SetZones(std::vector<GeofenceZone> zones, std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+
+  std::vector<Zone> indexed;
+  indexed.reserve(zones.size());
+  std::unordered_set<std::uint32_t> ids;
+  for (auto& spec : zones) {
+    const std::string label = "zone " + std::to_string(spec.id);
+    if (!ids.insert(spec.id).second) {
+      return fail("duplicate " + label);
+    }
+    if (spec.polygon.size() < 3) {
+      return fail(label + " needs at least 3 vertices");
+    }
+    if (std::isnan(spec.floor_m) || std::isnan(spec.ceiling_m) || !(spec.floor_m < spec.ceiling_m)) {
+      return fail(label + " has an empty altitude band");
+    }
+    Zone zone;
+    zone.min_x = zone.min_y = std::numeric_limits<double>::infinity();
+    zone.max_x = zone.max_y = -std::numeric_limits<double>::infinity();
+    for (const FencePoint& point : spec.polygon) {
+      if (!std::isfinite(point.x) || !std::isfinite(point.y)) {
+        return fail(label + " has a non-finite vertex");
+      }
+      zone.min_x = std::min(zone.min_x, point.x);
+      zone.min_y = std::min(zone.min_y, point.y);
+      zone.max_x = std::max(zone.max_x, point.x);
+      zone.max_y = std::max(zone.max_y, point.y);
+    }
+    zone.spec = std::move(spec);
+    indexed.push_back(std::move(zone));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  zones_ = std::move(indexed);
+  IndexZones();
+  for (auto& [id, vehicle] : vehicles_) {
+    vehicle.zones.clear();
+  }
+  return true;
+}
+
+void SpatialSafetyMonitor::IndexZones() {
+  const double cell = policy_.fence_cell_m;
+  keep_in_zones_.clear();
+  large_zones_.clear();
+  zone_grid_.clear();
+  for (std::size_t i = 0; i < zones_.size(); ++i) {
+    const Zone& zone = zones_[i];
+    if (zone.spec.kind == GeofenceKind::kKeepIn) {
+      keep_in_zones_.push_back(i);
+      continue;
+    }
+    const std::int64_t x0 = CellIndex(zone.min_x, cell);
+    const std::int64_t x1 = CellIndex(zone.max_x, cell);
+    const std::int64_t y0 = CellIndex(zone.min_y, cell);
+    const std::int64_t y1 = CellIndex(zone.max_y, cell);
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) > kMaxCellsPerZone) {
+      large_zones_.push_back(i);
+      continue;
+    }
+    for (std::int64_t cx = x0; cx <= x1; ++cx) {
+      for (std::int64_t cy = y0; cy <= y1; ++cy) {
+        zone_grid_[CellKey(cx, cy)].push_back(i);
+      }
+    }
+  }
+}
+
+std::vector<SpatialSafetyEvent> SpatialSafetyMonitor::Update(VehicleId id,
+                                                             const models::TelemetryFrame& frame) {
+  std::vector<SpatialSafetyEvent> events;
+  if (!std::isfinite(frame.position_m.x) || !std::isfinite(frame.position_m.y) ||
+      !std::isfinite(frame.position_m.z)) {
+    return events;
+  }
+  EventSink sink;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Vehicle& vehicle = vehicles_[id];
+    const bool is_new = vehicle.last_update_us == 0;
+    vehicle.x = frame.position_m.x;
+    vehicle.y = frame.position_m.y;
+    vehicle.up = IsNedFrame(frame.frame_id) ? -frame.position_m.z : frame.position_m.z;
+    vehicle.last_update_us = std::max<std::int64_t>(frame.receive_time_us, 1);
+
+    const double cell = policy_.separation_clear_m;
+    const std::uint64_t key = CellKey(CellIndex(vehicle.x, cell), CellIndex(vehicle.y, cell));
+    if (is_new || key != vehicle.cell) {
+      if (!is_new) {
+        auto& members = vehicle_grid_[vehicle.cell];
+        members.erase(std::remove(members.begin(), members.end(), id), members.end());
+        if (members.empty()) {
+          vehicle_grid_.erase(vehicle.cell);
+        }
+      }
+      vehicle.cell = key;
+      vehicle_grid_[key].push_back(id);
+    }
+
+    CheckSeparation(id, &vehicle, frame.receive_time_us, &events);
+    CheckZones(id, &vehicle, frame.receive_time_us, &events);
+    if (!events.empty()) {
+      sink = sink_;
+    }
+  }
+  if (sink) {
+    for (const auto& event : events) {
+      sink(event);
+    }
+  }
+  return events;
+}
+
+void SpatialSafetyMonitor::CheckSeparation(VehicleId id, Vehicle* vehicle, std::int64_t now_us,
+                                           std::vector<SpatialSafetyEvent>* events) {
+  const auto distance_to = [this, vehicle](const Vehicle& other) {
+    ++pair_checks_;
+    const double dx = other.x - vehicle->x;
+    const double dy = other.y - vehicle->y;
+    const double dz = other.up - vehicle->up;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+  };
+  const auto stale = [this, now_us](const Vehicle& other) {
+    return now_us - other.last_update_us > policy_.stale_after_us;
+  };
+
+  // Pairs already raised: re-arm once apart (they may have left the 3x3
+  // neighbourhood, so they are checked directly).
+  for (std::size_t i = 0; i < vehicle->close_to.size();) {
+    const VehicleId other_id = vehicle->close_to[i];
+    auto other = vehicles_.find(other_id);
+    if (other == vehicles_.end() || stale(other->second) ||
+        distance_to(other->second) > policy_.separation_clear_m) {
+      if (other != vehicles_.end()) {
+        auto& back = other->second.close_to;
+        back.erase(std::remove(back.begin(), back.end(), id), back.end());
+      }
+      vehicle->close_to[i] = vehicle->close_to.back();
+      vehicle->close_to.pop_back();
+    } else {
+      ++i;
+    }
+  }
+
+  const double cell = policy_.separation_clear_m;
+  const std::int64_t cx = CellIndex(vehicle->x, cell);
+  const std::int64_t cy = CellIndex(vehicle->y, cell);
+  for (std::int64_t nx = cx - 1; nx <= cx + 1; ++nx) {
+    for (std::int64_t ny = cy - 1; ny <= cy + 1; ++ny) {
+      const auto members = vehicle_grid_.find(CellKey(nx, ny));
+      if (members == vehicle_grid_.end()) {
+        continue;
+      }
+      for (const VehicleId other_id : members->second) {
+        if (other_id == id || std::find(vehicle->close_to.begin(), vehicle->close_to.end(), other_id) !=
+                                  vehicle->close_to.end()) {
+          continue;
+        }
+        Vehicle& other = vehicles_.at(other_id);
+        if (stale(other)) {
+          continue;
+        }
+        const double distance = distance_to(other);
+        if (distance >= policy_.separation_warn_m) {
+          continue;
+        }
+        vehicle->close_to.push_back(other_id);
+        other.close_to.push_back(id);
+        SpatialSafetyEvent event;
+        event.code = kSeparationWarnCode;
+        event.message = SeparationMessage(id, other_id, distance);
+        event.vehicle = id;
+        event.other_vehicle = other_id;
+        event.distance_m = distance;
+        event.raised_time_us = now_us;
+        events->push_back(std::move(event));
+      }
+    }
+  }
+}
+
+void SpatialSafetyMonitor::CheckZones(VehicleId id, Vehicle* vehicle, std::int64_t now_us,
+                                      std::vector<SpatialSafetyEvent>* events) {
+  if (zones_.empty()) {
+    return;
+  }
+  candidates_.clear();
+  for (const std::size_t zone : keep_in_zones_) {
+    if (InBreach(zones_[zone], *vehicle)) {
+      candidates_.push_back(zone);
+    }
+  }
+  for (const std::size_t zone : large_zones_) {
+    if (InBreach(zones_[zone], *vehicle)) {
+      candidates_.push_back(zone);
+    }
+  }
+  const double cell = policy_.fence_cell_m;
+  const auto cell_zones =
+      zone_grid_.find(CellKey(CellIndex(vehicle->x, cell), CellIndex(vehicle->y, cell)));
+  if (cell_zones != zone_grid_.end()) {
+    for (const std::size_t zone : cell_zones->second) {
+      if (InBreach(zones_[zone], *vehicle)) {
+        candidates_.push_back(zone);
+      }
+    }
+  }
+
+  // candidates_ now holds the zones breached by this frame.
+  for (const std::size_t zone : candidates_) {
+    auto state = std::find_if(vehicle->zones.begin(), vehicle->zones.end(),
+                              [zone](const ZoneState& entry) { return entry.zone == zone; });
+    if (state != vehicle->zones.end()) {
+      // Back in breach before re-arming: part of the same violation.
+      state->in_breach = true;
+      continue;
+    }
+    vehicle->zones.push_back(ZoneState{zone, true, 0});
+    const GeofenceZone& spec = zones_[zone].spec;
+    SpatialSafetyEvent event;
+    event.code = kGeofenceBreachCode;
+    event.message = BreachMessage(id, spec);
+    event.vehicle = id;
+    event.zone_id = spec.id;
+    event.raised_time_us = now_us;
+    events->push_back(std::move(event));
+  }
+  for (std::size_t i = 0; i < vehicle->zones.size();) {
+    ZoneState& state = vehicle->zones[i];
+    const bool breached =
+        std::find(candidates_.begin(), candidates_.end(), state.zone) != candidates_.end();
+    if (!breached && state.in_breach) {
+      state.in_breach = false;
+      state.compliant_since_us = now_us;
+    }
+    if (!breached && now_us - state.compliant_since_us >= policy_.geofence_rearm_us) {
+      vehicle->zones[i] = vehicle->zones.back();
+      vehicle->zones.pop_back();
+    } else {
+      ++i;
+    }
+  }
+}
+
+bool SpatialSafetyMonitor::InBreach(const Zone& zone, const Vehicle& vehicle) const {
+  const bool in_band = vehicle.up >= zone.spec.floor_m && vehicle.up <= zone.spec.ceiling_m;
+  const bool in_box = vehicle.x >= zone.min_x && vehicle.x <= zone.max_x && vehicle.y >= zone.min_y &&
+                      vehicle.y <= zone.max_y;
+  const bool inside = in_band && in_box && PointInPolygon(zone.spec.polygon, vehicle.x, vehicle.y);
+  return zone.spec.kind == GeofenceKind::kKeepIn ? !inside : inside;
+}
+
+void SpatialSafetyMonitor::RemoveVehicle(VehicleId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = vehicles_.find(id);
+  if (found == vehicles_.end()) {
+    return;
+  }
+  Unlink(id, &found->second);
+  vehicles_.erase(found);
+}
+
+void SpatialSafetyMonitor::Unlink(VehicleId id, Vehicle* vehicle) {
+  auto& members = vehicle_grid_[vehicle->cell];
+  members.erase(std::remove(members.begin(), members.end(), id), members.end());
+  if (members.empty()) {
+    vehicle_grid_.erase(vehicle->cell);
+  }
+  for (const VehicleId other_id : vehicle->close_to) {
+    auto other = vehicles_.find(other_id);
+    if (other != vehicles_.end()) {
+      auto& back = other->second.close_to;
+      back.erase(std::remove(back.begin(), back.end(), id), back.end());
+    }
+  }
+}
+
+std::size_t SpatialSafetyMonitor::vehicle_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return vehicles_.size();
+}
+
+std::uint64_t SpatialSafetyMonitor::pair_checks() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pair_checks_;
+}
+
+}  // namespace ulak::core
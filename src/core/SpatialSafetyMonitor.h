@@ -0,0 +1,158 @@
+#pragma once
+
+#include "TelemetryFrame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ulak::core {
+
+// Station-side vehicle key (e.g. MAVLink system id).
+using VehicleId = std::uint32_t;
+
+struct FencePoint {
+  double x{0.0};
+  double y{0.0};
+};
+
+enum class GeofenceKind {
+  kKeepIn,   // breach when outside the polygon or its altitude band
+  kKeepOut,  // breach when inside the polygon and its altitude band
+};
+
+// Polygon in the horizontal axes of the telemetry frame (position_m x/y),
+// with an up-positive altitude band.
+struct GeofenceZone {
+  std::uint32_t id{0};
+  std::string name;
+  GeofenceKind kind{GeofenceKind::kKeepOut};
+  std::vector<FencePoint> polygon;
+  double floor_m{-std::numeric_limits<double>::infinity()};
+  double ceiling_m{std::numeric_limits<double>::infinity()};
+};
+
+// Loaded from the active profile's `spatial_safety` section.
+struct SpatialSafetyPolicy {
+  double separation_warn_m{15.0};
+  // A pair re-arms once it is this far apart again. Also the cell size of the
+  // vehicle index, so it must not be below separation_warn_m.
+  double separation_clear_m{20.0};
+  // Vehicles silent for longer are not checked against others.
+  std::int64_t stale_after_us{2'000'000};
+  // A breached zone raises again only after the vehicle has been compliant
+  // this long, so GPS noise along a fence edge does not flood the timeline.
+  std::int64_t geofence_rearm_us{2'000'000};
+  // Cell size of the fence index.
+  double fence_cell_m{50.0};
+};
+
+inline constexpr const char* kSeparationWarnCode = "SEPARATION_WARN";
+inline constexpr const char* kGeofenceBreachCode = "GEOFENCE_BREACH";
+
+// Raised once per violation edge; `code` is the ExceptionClassifier event
+// code, which the active profile maps to severity and action.
+struct SpatialSafetyEvent {
+  std::string code;
+  std::string message;
+  VehicleId vehicle{0};
+  // SEPARATION_WARN: the other vehicle and the 3D distance between them.
+  VehicleId other_vehicle{0};
+  double distance_m{0.0};
+  // GEOFENCE_BREACH.
+  std::uint32_t zone_id{0};
+  std::int64_t raised_time_us{0};
+};
+
+// Multi-vehicle separation and geofence checks, updated incrementally per
+// telemetry frame. Vehicles sit in a uniform grid over x/y with cells of
+// separation_clear_m, so a frame is checked only against the 3x3 cells around
+// it instead of every other vehicle. Keep-out zones are indexed in a grid of
+// fence_cell_m cells; keep-in zones (usually one flight area) are checked on
+// every frame. All vehicles must report in the same local frame.
+class SpatialSafetyMonitor {
+ public:
+  using EventSink = std::function<void(const SpatialSafetyEvent&)>;
+
+  // Starts with the default policy.
+  SpatialSafetyMonitor();
+
+  void SetEventSink(EventSink sink);
+
+  // Applies new thresholds, e.g. after SwitchActiveProfile; tracked vehicles,
+  // raised pairs and breaches are kept and re-indexed. Fails on non-finite or
+  // non-positive distances, a clear distance below the warn distance, or
+  // negative durations.
+  bool SetPolicy(SpatialSafetyPolicy policy, std::string* reason);
+
+  // Replaces the fence set; breach state of vehicles is reset. Fails on a
+  // polygon with fewer than 3 vertices, non-finite coordinates, an empty
+  // altitude band or a duplicate id.
+  bool SetZones(std::vector<GeofenceZone> zones, std::string* reason);
+
+  // Checks the vehicle's new position and returns the events raised (also
+  // delivered to the sink, outside the lock). Frames with a non-finite
+  // position (e.g. no GPS fix) are ignored; the last good position stands.
+  std::vector<SpatialSafetyEvent> Update(VehicleId vehicle, const models::TelemetryFrame& frame);
+
+  void RemoveVehicle(VehicleId vehicle);
+
+  std::size_t vehicle_count() const;
+  // Distance computations so far; shows the index doing its job.
+  std::uint64_t pair_checks() const;
+
+ private:
+  struct ZoneState {
+    std::size_t zone{0};
+    bool in_breach{false};
+    std::int64_t compliant_since_us{0};
+  };
+
+  struct Vehicle {
+    double x{0.0};
+    double y{0.0};
+    double up{0.0};
+    std::int64_t last_update_us{0};
+    std::uint64_t cell{0};
+    std::vector<VehicleId> close_to;
+    std::vector<ZoneState> zones;
+  };
+
+  struct Zone {
+    GeofenceZone spec;
+    double min_x{0.0};
+    double min_y{0.0};
+    double max_x{0.0};
+    double max_y{0.0};
+  };
+
+  // Callers hold mutex_.
+  void CheckSeparation(VehicleId id, Vehicle* vehicle, std::int64_t now_us,
+                       std::vector<SpatialSafetyEvent>* events);
+  void CheckZones(VehicleId id, Vehicle* vehicle, std::int64_t now_us,
+                  std::vector<SpatialSafetyEvent>* events);
+  bool InBreach(const Zone& zone, const Vehicle& vehicle) const;
+  void Unlink(VehicleId id, Vehicle* vehicle);
+  // Rebuilds the keep-in, large-zone and fence grid lists from zones_.
+  void IndexZones();
+
+  mutable std::mutex mutex_;
+  EventSink sink_;
+  SpatialSafetyPolicy policy_;
+  std::unordered_map<VehicleId, Vehicle> vehicles_;
+  std::unordered_map<std::uint64_t, std::vector<VehicleId>> vehicle_grid_;
+  std::vector<Zone> zones_;
+  std::vector<std::size_t> keep_in_zones_;
+  // Keep-out zones too large to index cell by cell.
+  std::vector<std::size_t> large_zones_;
+  std::unordered_map<std::uint64_t, std::vector<std::size_t>> zone_grid_;
+  std::vector<std::size_t> candidates_;
+  std::uint64_t pair_checks_{0};
+};
+
+}  // namespace ulak::core
@@ -0,0 +1,408 @@
+#include "TelemetryArchive.h"
+
+#include "ColumnCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace ulak::core {
+namespace {
+
+constexpr char kMagic[8] = {'U', 'L', 'A', 'K', 'C', 'O', 'L', '1'};
+constexpr std::uint16_t kEncodingDeltaBitPacked = 1;
+// Keeps quantized values well inside int64 for garbage input.
+constexpr double kQuantizeLimit = 1e15;
+
+std::size_t IndexOf(TelemetryColumn column) {
+  return static_cast<std::size_t>(column);
+}
+
+bool IsEventColumn(std::size_t index) {
+  return index >= IndexOf(TelemetryColumn::kEventTime);
+}
+
+std::int64_t Quantize(double value, TelemetryColumn column) {
+  if (!std::isfinite(value)) {
+    return 0;
+  }
+  const double scaled = std::clamp(value / TelemetryColumnScale(column), -kQuantizeLimit,
+                                   kQuantizeLimit);
+  return std::llround(scaled);
+}
+
+bool IsNedFrame(const std::string& frame_id) {
+  constexpr const char* kSuffix = "_NED";
+  return frame_id.size() >= 4 && frame_id.compare(frame_id.size() - 4, 4, kSuffix) == 0;
+}
+
+void PutU16(std::uint16_t value, std::vector<std::uint8_t>* out) {
+  out->push_back(static_cast<std::uint8_t>(value));
+  out->push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+void PutU32(std::uint32_t value, std::vector<std::uint8_t>* out) {
+  for (int i = 0; i < 4; ++i) {
+    out->push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+  }
+}
+
+void PutU64(std::uint64_t value, std::vector<std::uint8_t>* out) {
+  for (int i = 0; i < 8; ++i) {
+    out->push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+  }
+}
+
+void PutDictionary(const std::vector<std::string>& names, std::vector<std::uint8_t>* out) {
+  PutU32(static_cast<std::uint32_t>(names.size()), out);
+  for (const auto& name : names) {
+    const auto length = static_cast<std::uint16_t>(std::min<std::size_t>(name.size(), 0xFFFF));
+    PutU16(length, out);
+    out->insert(out->end(), name.begin(), name.begin() + length);
+  }
+}
+
+class Cursor {
+ public:
+  explicit Cursor(const std::vector<std::uint8_t>& bytes) : bytes_(bytes) {}
+
+  bool Read(std::size_t count, const std::uint8_t** data) {
+    if (bytes_.size() - position_ < count) {
+      return false;
+    }
+    *data = bytes_.data() + position_;
+    position_ += count;
+    return true;
+  }
+
+  template <typename T>
+  bool ReadInt(T* value) {
+    const std::uint8_t* data = nullptr;
+    if (!Read(sizeof(T), &data)) {
+      return false;
+    }
+    std::uint64_t result = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      result |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+    }
+    *value = static_cast<T>(result);
+    return true;
+  }
+
+  bool ReadDictionary(std::vector<std::string>* names) {
+    std::uint32_t count = 0;
+    if (!ReadInt(&count)) {
+      return false;
+    }
+    names->clear();
+    for (std::uint32_t i = 0; i < count; ++i) {
+      std::uint16_t length = 0;
+      const std::uint8_t* data = nullptr;
+      if (!ReadInt(&length) || !Read(length, &data)) {
+        return false;
+      }
+      names->emplace_back(reinterpret_cast<const char*>(data), length);
+    }
+    return true;
+  }
+
+ private:
+  const std::vector<std::uint8_t>& bytes_;
+  std::size_t position_{0};
+};
+
+}  // namespace
+
+double TelemetryColumnScale(TelemetryColumn column) {
+  switch (column) {
+    case TelemetryColumn::kPositionX:
+    case TelemetryColumn::kPositionY:
+    case TelemetryColumn::kPositionZ:
+    case TelemetryColumn::kAltitude:
+    case TelemetryColumn::kVelocityX:
+    case TelemetryColumn::kVelocityY:
+    case TelemetryColumn::kVelocityZ:
+      return 0.001;
+    case TelemetryColumn::kRoll:
+    case TelemetryColumn::kPitch:
+    case TelemetryColumn::kYaw:
+      return 0.01;
+    default:
+      return 1.0;
+  }
+}
+
+std::int64_t TelemetryArchiveWriter::Dictionary::Intern(const std::string& name) {
+  const auto [it, inserted] = ids.emplace(name, static_cast<std::int64_t>(names.size()));
+  if (inserted) {
+    names.push_back(name);
+  }
+  return it->second;
+}
+
+void TelemetryArchiveWriter::Push(TelemetryColumn column, std::int64_t value) {
+  columns_[IndexOf(column)].push_back(value);
+}
+
+void TelemetryArchiveWriter::Append(const models::TelemetryFrame& frame) {
+  std::int64_t mode = 0;
+  if (frame.vehicle_mode_id != models::kVehicleModeUnknown) {
+    if (mode_index_.size() <= frame.vehicle_mode_id) {
+      mode_index_.resize(frame.vehicle_mode_id + 1u, -1);
+    }
+    auto& cached = mode_index_[frame.vehicle_mode_id];
+    if (cached < 0) {
+      cached = vehicle_modes_.Intern(
+          std::string(models::VehicleModeName(frame.vehicle_mode_id)));
+    }
+    mode = cached;
+  } else {
+    mode = vehicle_modes_.Intern(frame.vehicle_mode);
+  }
+  const double up = IsNedFrame(frame.frame_id) ? -frame.position_m.z : frame.position_m.z;
+
+  Push(TelemetryColumn::kTime, frame.receive_time_us);
+  Push(TelemetryColumn::kPositionX, Quantize(frame.position_m.x, TelemetryColumn::kPositionX));
+  Push(TelemetryColumn::kPositionY, Quantize(frame.position_m.y, TelemetryColumn::kPositionY));
+  Push(TelemetryColumn::kPositionZ, Quantize(frame.position_m.z, TelemetryColumn::kPositionZ));
+  Push(TelemetryColumn::kAltitude, Quantize(up, TelemetryColumn::kAltitude));
+  Push(TelemetryColumn::kVelocityX, Quantize(frame.velocity_mps.x, TelemetryColumn::kVelocityX));
+  Push(TelemetryColumn::kVelocityY, Quantize(frame.velocity_mps.y, TelemetryColumn::kVelocityY));
+  Push(TelemetryColumn::kVelocityZ, Quantize(frame.velocity_mps.z, TelemetryColumn::kVelocityZ));
+  Push(TelemetryColumn::kRoll, Quantize(frame.attitude_deg.roll, TelemetryColumn::kRoll));
+  Push(TelemetryColumn::kPitch, Quantize(frame.attitude_deg.pitch, TelemetryColumn::kPitch));
+  Push(TelemetryColumn::kYaw, Quantize(frame.attitude_deg.yaw, TelemetryColumn::kYaw));
+  Push(TelemetryColumn::kVehicleMode, mode);
+  Push(TelemetryColumn::kFrameId, frame_ids_.Intern(frame.frame_id));
+  Push(TelemetryColumn::kBattery, frame.battery_percent);
+}
+
+void TelemetryArchiveWriter::Append(const models::SafetyEvent& event) {
+  Push(TelemetryColumn::kEventTime, event.receive_time_us);
+  Push(TelemetryColumn::kEventSeverity, static_cast<std::int64_t>(event.severity));
+  Push(TelemetryColumn::kEventCode, event_codes_.Intern(event.code));
+}
+
+bool TelemetryArchiveWriter::Finish(const std::filesystem::path& path,
+                                    std::string* reason) const {
+  std::vector<std::uint8_t> header(std::begin(kMagic), std::end(kMagic));
+  PutU64(frame_count(), &header);
+  PutU64(event_count(), &header);
+  PutDictionary(vehicle_modes_.names, &header);
+  PutDictionary(frame_ids_.names, &header);
+  PutDictionary(event_codes_.names, &header);
+  PutU32(static_cast<std::uint32_t>(kTelemetryColumnCount), &header);
+
+  std::vector<std::uint8_t> body;
+  std::vector<std::uint8_t> directory;
+  const std::size_t directory_size = kTelemetryColumnCount * 20;
+  const std::uint64_t body_offset = header.size() + directory_size;
+  for (std::size_t index = 0; index < kTelemetryColumnCount; ++index) {
+    const std::size_t begin = body.size();
+    utils::EncodeDeltaColumn(columns_[index].data(), columns_[index].size(), &body);
+    PutU16(static_cast<std::uint16_t>(index), &directory);
+    PutU16(kEncodingDeltaBitPacked, &directory);
+    PutU64(body_offset + begin, &directory);
+    PutU64(body.size() - begin, &directory);
+  }
+
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(header.data()),
+                 static_cast<std::streamsize>(header.size()));
+    output.write(reinterpret_cast<const char*>(directory.data()),
+                 static_cast<std::streamsize>(directory.size()));
+    output.write(reinterpret_cast<const char*>(body.data()),
+                 static_cast<std::streamsize>(body.size()));
+    if (!output) {
+      if (reason != nullptr) {
+        *reason = "Failed to write " + temporary.string();
+      }
+      return false;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    if (reason != nullptr) {
+      *reason = "Failed to rename " + temporary.string() + ": " + error.message();
+    }
+    return false;
+  }
+  return true;
+}
+
+bool TelemetryArchive::Open(const std::filesystem::path& path, std::string* reason) {
+  const auto fail = [&](const std::string& why) {
+    if (reason != nullptr) {
+      *reason = why + ": " + path.string();
+    }
+    return false;
+  };
+
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    return fail("Cannot open telemetry archive");
+  }
+  bytes_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+  for (std::size_t index = 0; index < kTelemetryColumnCount; ++index) {
+    chunks_[index] = Chunk{};
+    columns_[index].clear();
+  }
+
+  Cursor cursor(bytes_);
+  const std::uint8_t* magic = nullptr;
+  std::uint64_t frames = 0;
+  std::uint64_t events = 0;
+  std::uint32_t column_count = 0;
+  if (!cursor.Read(sizeof(kMagic), &magic) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    return fail("Not a telemetry archive");
+  }
+  if (!cursor.ReadInt(&frames) || !cursor.ReadInt(&events) ||
+      !cursor.ReadDictionary(&vehicle_modes_) || !cursor.ReadDictionary(&frame_ids_) ||
+      !cursor.ReadDictionary(&event_codes_) || !cursor.ReadInt(&column_count)) {
+    return fail("Truncated telemetry archive header");
+  }
+  // A block of identical deltas takes two bytes; anything denser is corrupt.
+  const std::uint64_t max_rows = bytes_.size() * utils::kDeltaBlockSize + 1;
+  if (frames > max_rows || events > max_rows) {
+    return fail("Implausible row count in telemetry archive");
+  }
+  for (std::uint32_t i = 0; i < column_count; ++i) {
+    std::uint16_t id = 0;
+    std::uint16_t encoding = 0;
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+    if (!cursor.ReadInt(&id) || !cursor.ReadInt(&encoding) || !cursor.ReadInt(&offset) ||
+        !cursor.ReadInt(&size)) {
+      return fail("Truncated telemetry archive directory");
+    }
+    // Unknown columns and encodings are skipped, so newer files stay readable.
+    if (id >= kTelemetryColumnCount || encoding != kEncodingDeltaBitPacked) {
+      continue;
+    }
+    if (offset > bytes_.size() || size > bytes_.size() - offset) {
+      return fail("Column outside telemetry archive");
+    }
+    chunks_[id].offset = offset;
+    chunks_[id].size = size;
+    chunks_[id].present = true;
+  }
+  frame_count_ = static_cast<std::size_t>(frames);
+  event_count_ = static_cast<std::size_t>(events);
+  return true;
+}
+
+const std::vector<std::int64_t>* TelemetryArchive::Column(TelemetryColumn column) {
+  const std::size_t index = IndexOf(column);
+  auto& chunk = chunks_[index];
+  if (!chunk.decoded) {
+    chunk.decoded = true;
+    const std::size_t rows = IsEventColumn(index) ? event_count_ : frame_count_;
+    if (!chunk.present) {
+      chunk.corrupt = rows != 0;
+    } else {
+      columns_[index].resize(rows);
+      chunk.corrupt = !utils::DecodeDeltaColumn(bytes_.data() + chunk.offset, chunk.size, rows,
+                                                columns_[index].data());
+    }
+    if (chunk.corrupt) {
+      columns_[index].clear();
+    }
+  }
+  return chunk.corrupt ? nullptr : &columns_[index];
+}
+
+std::optional<double> TelemetryArchive::MaxAltitudeM() {
+  const auto* altitude = Column(TelemetryColumn::kAltitude);
+  if (altitude == nullptr || altitude->empty()) {
+    return std::nullopt;
+  }
+  return static_cast<double>(*std::max_element(altitude->begin(), altitude->end())) *
+         TelemetryColumnScale(TelemetryColumn::kAltitude);
+}
+
+std::vector<VehicleModeTime> TelemetryArchive::TimeInModes(std::int64_t max_gap_us) {
+  const auto* time = Column(TelemetryColumn::kTime);
+  const auto* mode = Column(TelemetryColumn::kVehicleMode);
+  std::vector<VehicleModeTime> result;
+  if (time == nullptr || mode == nullptr) {
+    return result;
+  }
+  std::vector<std::int64_t> totals(vehicle_modes_.size(), 0);
+  const std::int64_t* t = time->data();
+  const std::int64_t* m = mode->data();
+  for (std::size_t i = 0; i + 1 < time->size(); ++i) {
+    const std::int64_t step = t[i + 1] - t[i];
+    if (step > 0 && step <= max_gap_us && static_cast<std::uint64_t>(m[i]) < totals.size()) {
+      totals[static_cast<std::size_t>(m[i])] += step;
+    }
+  }
+  for (std::size_t i = 0; i < totals.size(); ++i) {
+    result.push_back({vehicle_modes_[i], totals[i]});
+  }
+  return result;
+}
+
+std::optional<double> TelemetryArchive::BatteryDrainPercentPerMinute() {
+  const auto* time = Column(TelemetryColumn::kTime);
+  const auto* battery = Column(TelemetryColumn::kBattery);
+  if (time == nullptr || battery == nullptr || time->empty()) {
+    return std::nullopt;
+  }
+  // Minutes relative to the first frame keep the sums well conditioned.
+  const std::int64_t* t = time->data();
+  const std::int64_t* b = battery->data();
+  const std::int64_t origin = t[0];
+  double n = 0.0;
+  double sum_t = 0.0;
+  double sum_b = 0.0;
+  double sum_tt = 0.0;
+  double sum_tb = 0.0;
+  for (std::size_t i = 0; i < time->size(); ++i) {
+    const double known = b[i] >= 0 ? 1.0 : 0.0;
+    const double minutes = static_cast<double>(t[i] - origin) / 60e6;
+    const double level = static_cast<double>(b[i]);
+    n += known;
+    sum_t += known * minutes;
+    sum_b += known * level;
+    sum_tt += known * minutes * minutes;
+    sum_tb += known * minutes * level;
+  }
+  const double denominator = n * sum_tt - sum_t * sum_t;
+  if (n < 2.0 || denominator <= 1e-12) {
+    return std::nullopt;
+  }
+  return -(n * sum_tb - sum_t * sum_b) / denominator;
+}
+
+std::vector<ArchivedSafetyEvent> TelemetryArchive::EventsBetween(std::int64_t from_us,
+                                                                 std::int64_t to_us) {
+  const auto* time = Column(TelemetryColumn::kEventTime);
+  const auto* severity = Column(TelemetryColumn::kEventSeverity);
+  const auto* code = Column(TelemetryColumn::kEventCode);
+  std::vector<ArchivedSafetyEvent> result;
+  if (time == nullptr || severity == nullptr || code == nullptr) {
+    return result;
+  }
+  for (std::size_t i = 0; i < time->size(); ++i) {
+    const std::int64_t t = (*time)[i];
+    if (t < from_us || t > to_us) {
+      continue;
+    }
+    const auto code_index = static_cast<std::uint64_t>((*code)[i]);
+    const auto level = std::clamp<std::int64_t>(
+        (*severity)[i], 0, static_cast<std::int64_t>(models::SafetySeverity::kCritical));
+    result.push_back({t, static_cast<models::SafetySeverity>(level),
+                      code_index < event_codes_.size() ? event_codes_[code_index] : ""});
+  }
+  return result;
+}
+
+}  // namespace ulak::core
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "SafetyEvent.h"
+#include "TelemetryFrame.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ulak::core {
+
+// Columns of a telemetry archive. Frame columns have one row per
+// TelemetryFrame, event columns one row per SafetyEvent.
+enum class TelemetryColumn : std::uint16_t {
+  kTime,          // receive_time_us
+  kPositionX,     // mm
+  kPositionY,     // mm
+  kPositionZ,     // mm, as received
+  kAltitude,      // mm, up-positive (-z for *_NED frames)
+  kVelocityX,     // mm/s
+  kVelocityY,     // mm/s
+  kVelocityZ,     // mm/s
+  kRoll,          // 0.01 deg
+  kPitch,         // 0.01 deg
+  kYaw,           // 0.01 deg
+  kVehicleMode,   // index into vehicle_modes()
+  kFrameId,       // index into frame_ids()
+  kBattery,       // percent, -1 when unknown
+  kEventTime,     // receive_time_us
+  kEventSeverity, // models::SafetySeverity
+  kEventCode,     // index into event_codes()
+};
+
+inline constexpr std::size_t kTelemetryColumnCount = 17;
+
+// Multiplier from a column's stored integer to its unit (0.001 for mm columns).
+double TelemetryColumnScale(TelemetryColumn column);
+
+// Post-flight export of a telemetry stream into a compressed columnar file.
+// Values are quantized (see TelemetryColumn) and each column is encoded with
+// utils::EncodeDeltaColumn; strings are dictionary-encoded. Buffers the whole
+// flight in memory (about 110 bytes per frame); not thread-safe.
+class TelemetryArchiveWriter {
+ public:
+  void Append(const models::TelemetryFrame& frame);
+  void Append(const models::SafetyEvent& event);
+
+  // Writes `<path>.tmp` and renames it over `path`.
+  bool Finish(const std::filesystem::path& path, std::string* reason) const;
+
+  std::size_t frame_count() const { return columns_[0].size(); }
+  std::size_t event_count() const {
+    return columns_[static_cast<std::size_t>(TelemetryColumn::kEventTime)].size();
+  }
+
+ private:
+  struct Dictionary {
+    std::vector<std::string> names;
+    std::unordered_map<std::string, std::int64_t> ids;
+    std::int64_t Intern(const std::string& name);
+  };
+
+  void Push(TelemetryColumn column, std::int64_t value);
+
+  std::vector<std::int64_t> columns_[kTelemetryColumnCount];
+  Dictionary vehicle_modes_;
+  Dictionary frame_ids_;
+  Dictionary event_codes_;
+  // VehicleModeId -> vehicle_modes_ index, so ids skip the string hash.
+  std::vector<std::int64_t> mode_index_;
+};
+
+struct VehicleModeTime {
+  std::string mode;
+  std::int64_t duration_us{0};
+};
+
+struct ArchivedSafetyEvent {
+  std::int64_t receive_time_us{0};
+  models::SafetySeverity severity{models::SafetySeverity::kWarn};
+  std::string code;
+};
+
+// Read side. Columns are decoded on first use and cached, so a query only pays
+// for the columns it scans. Not thread-safe.
+class TelemetryArchive {
+ public:
+  bool Open(const std::filesystem::path& path, std::string* reason);
+
+  std::size_t frame_count() const { return frame_count_; }
+  std::size_t event_count() const { return event_count_; }
+  const std::vector<std::string>& vehicle_modes() const { return vehicle_modes_; }
+  const std::vector<std::string>& frame_ids() const { return frame_ids_; }
+  const std::vector<std::string>& event_codes() const { return event_codes_; }
+
+  // Stored integers of a column; nullptr if the column is corrupt.
+  const std::vector<std::int64_t>* Column(TelemetryColumn column);
+
+  // Highest up-positive altitude in meters.
+  std::optional<double> MaxAltitudeM();
+  // Time attributed to each vehicle_mode, from each frame to the next. Gaps
+  // longer than `max_gap_us` (link loss) are not attributed to any mode.
+  std::vector<VehicleModeTime> TimeInModes(std::int64_t max_gap_us = 2'000'000);
+  // Least-squares battery slope over frames with a known level, as percent
+  // drained per minute (positive while discharging).
+  std::optional<double> BatteryDrainPercentPerMinute();
+  // Safety events received in [from_us, to_us].
+  std::vector<ArchivedSafetyEvent> EventsBetween(std::int64_t from_us, std::int64_t to_us);
+
+ private:
+  struct Chunk {
+    std::uint64_t offset{0};
+    std::uint64_t size{0};
+    bool present{false};
+    bool decoded{false};
+    bool corrupt{false};
+  };
+
+  std::vector<std::uint8_t> bytes_;
+  std::size_t frame_count_{0};
+  std::size_t event_count_{0};
+  std::vector<std::string> vehicle_modes_;
+  std::vector<std::string> frame_ids_;
+  std::vector<std::string> event_codes_;
+  Chunk chunks_[kTelemetryColumnCount];
+  std::vector<std::int64_t> columns_[kTelemetryColumnCount];
+};
+
+}  // namespace ulak::core
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ulak::models {
+
+// Interned mission FSM state name. The companion's documented states are
+// pre-registered so their ids are compile-time constants.
+using MissionStateId = std::uint16_t;
+
+inline constexpr MissionStateId kMissionStateUnknown = 0;
+inline constexpr MissionStateId kMissionStateIdle = 1;
+inline constexpr MissionStateId kMissionStateRunning = 2;
+inline constexpr MissionStateId kMissionStatePaused = 3;
+inline constexpr MissionStateId kMissionStateAborted = 4;
+inline constexpr MissionStateId kMissionStateCompleted = 5;
+
+// `mission/state` payload (PROTOCOL.md §6.2).
+struct MissionStateUpdate {
+  std::string state;
+  // [0, 1], or -1 when the message carries no progress.
+  double progress{-1.0};
+  std::string note;
+  // UTC epoch microseconds taken when the payload was read off the link.
+  std::int64_t receive_time_us{0};
+};
+
+}  // namespace ulak::models
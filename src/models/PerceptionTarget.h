@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ulak::models {
+
+// `perception/output` payload (PROTOCOL.md §6.3).
+struct PerceptionTarget {
+  std::string color;
+  std::string shape;
+  // Normalized image-space offset of the target from the frame center,
+  // [-1, 1] on each axis, +dy pointing down.
+  double alignment_dx{0.0};
+  double alignment_dy{0.0};
+  double confidence{0.0};
+  // UTC epoch microseconds taken when the payload was read off the link.
+  std::int64_t receive_time_us{0};
+};
+
+}  // namespace ulak::models
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ulak::models {
+
+enum class SafetySeverity : std::uint8_t {
+  kWarn,
+  kError,
+  kCritical,
+};
+
+// `safety/events` payload (PROTOCOL.md §6.4, exception-handling spec §3).
+struct SafetyEvent {
+  SafetySeverity severity{SafetySeverity::kWarn};
+  std::string code;
+  std::string message;
+  std::string recommended_action;
+  // UTC epoch microseconds taken when the payload was read off the link.
+  std::int64_t receive_time_us{0};
+};
+
+}  // namespace ulak::models
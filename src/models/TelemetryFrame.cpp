@@ -0,0 +1,48 @@
+#include "TelemetryFrame.h"
+
+#include "StringInterner.h"
+
+#include <array>
+
+namespace ulak::models {
+namespace {
+
+constexpr std::array<std::string_view, 13> kBuiltinModes = {
+    "",        "STABILIZE", "ACRO", "ALT_HOLD", "AUTO",  "GUIDED",   "LOITER",
+    "RTL",     "CIRCLE",    "LAND", "POSHOLD",  "BRAKE", "SMART_RTL",
+};
+
+// Seeded with the built-in table in order, so their ids match the constants;
+// modes outside it (custom firmware, other autopilots) follow.
+utils::StringInterner& VehicleModes() {
+  static utils::StringInterner interner;
+  static const bool seeded = [] {
+    for (const std::string_view mode : kBuiltinModes) {
+      interner.Intern(mode);
+    }
+    return true;
+  }();
+  static_cast<void>(seeded);
+  return interner;
+}
+
+}  // namespace
+
+VehicleModeId InternVehicleMode(std::string_view mode) {
+  for (std::size_t index = 0; index < kBuiltinModes.size(); ++index) {
+    if (kBuiltinModes[index] == mode) {
+      return static_cast<VehicleModeId>(index);
+    }
+  }
+  const utils::StringInterner::Id id = VehicleModes().Intern(mode);
+  return id == utils::StringInterner::kOverflowId ? kVehicleModeUnknown : id;
+}
+
+std::string_view VehicleModeName(VehicleModeId id) {
+  if (id < kBuiltinModes.size()) {
+    return kBuiltinModes[id];
+  }
+  return VehicleModes().Name(id);
+}
+
+}  // namespace ulak::models
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ulak::models {
+
+struct Vector3 {
+  double x{0.0};
+  double y{0.0};
+  double z{0.0};
+};
+
+struct Attitude {
+  double roll{0.0};
+  double pitch{0.0};
+  double yaw{0.0};
+};
+
+// Interned `vehicle_mode` identifier. Consumers compare ids instead of strings.
+using VehicleModeId = std::uint16_t;
+
+// ArduPilot modes are pre-registered so their ids are compile-time constants.
+inline constexpr VehicleModeId kVehicleModeUnknown = 0;
+inline constexpr VehicleModeId kVehicleModeStabilize = 1;
+inline constexpr VehicleModeId kVehicleModeAcro = 2;
+inline constexpr VehicleModeId kVehicleModeAltHold = 3;
+inline constexpr VehicleModeId kVehicleModeAuto = 4;
+inline constexpr VehicleModeId kVehicleModeGuided = 5;
+inline constexpr VehicleModeId kVehicleModeLoiter = 6;
+inline constexpr VehicleModeId kVehicleModeRtl = 7;
+inline constexpr VehicleModeId kVehicleModeCircle = 8;
+inline constexpr VehicleModeId kVehicleModeLand = 9;
+inline constexpr VehicleModeId kVehicleModePosHold = 10;
+inline constexpr VehicleModeId kVehicleModeBrake = 11;
+inline constexpr VehicleModeId kVehicleModeSmartRtl = 12;
+
+// Returns the id for a mode string, registering unseen modes. Thread-safe.
+// Empty strings map to kVehicleModeUnknown.
+VehicleModeId InternVehicleMode(std::string_view mode);
+
+// Returns the mode string for an id, or an empty view for unregistered ids.
+std::string_view VehicleModeName(VehicleModeId id);
+
+// Normalized telemetry (PROTOCOL.md §6.1), shared by vehicle and simulator feeds.
+struct TelemetryFrame {
+  std::string telemetry_type;
+  std::string frame_id;
+  Vector3 position_m;
+  Vector3 velocity_mps;
+  Attitude attitude_deg;
+  std::string vehicle_mode;
+  VehicleModeId vehicle_mode_id{kVehicleModeUnknown};
+  int battery_percent{-1};
+  // UTC epoch microseconds taken when the source packet was read off the link.
+  std::int64_t receive_time_us{0};
+};
+
+// Edge emitted by the telemetry decoder when `vehicle_mode_id` changes.
+struct VehicleModeTransition {
+  VehicleModeId previous{kVehicleModeUnknown};
+  VehicleModeId current{kVehicleModeUnknown};
+  std::int64_t receive_time_us{0};
+};
+
+}  // namespace ulak::models
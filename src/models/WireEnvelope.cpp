@@ -0,0 +1,1249 @@
+#include "WireEnvelope.h"
+
+#include "Timestamp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+namespace ulak::models {
+namespace {
+
+constexpr std::string_view kCategoryNames[] = {
+    "",
+    "telemetry/vehicle",
+    "telemetry/simulator",
+    "telemetry/health",
+    "mission/state",
+    "perception/output",
+    "safety/events",
+    "station/commands/request",
+    "station/commands/ack",
+    "station/commands/reject",
+    "station/commands/tuning",
+    "station/commands/tuning_ack",
+};
+
+constexpr std::string_view kSourceNames[] = {
+    "",
+    "station",
+    "flight_controller",
+    "companion_computer",
+};
+
+constexpr const char* kSeverityNames[] = {"WARN", "ERROR", "CRITICAL"};
+
+// Little-endian writer over a caller-owned buffer. Strings carry a u8 or u16
+// length prefix; anything longer fails the whole encode.
+class Writer {
+ public:
+  explicit Writer(std::vector<std::uint8_t>* out) : out_(out) {}
+
+  void U8(std::uint8_t value) { out_->push_back(value); }
+  void U16(std::uint16_t value) {
+    U8(static_cast<std::uint8_t>(value));
+    U8(static_cast<std::uint8_t>(value >> 8));
+  }
+  void I64(std::int64_t value) {
+    const auto bits = static_cast<std::uint64_t>(value);
+    for (int shift = 0; shift < 64; shift += 8) {
+      U8(static_cast<std::uint8_t>(bits >> shift));
+    }
+  }
+  void F32(double value) {
+    const float narrowed = static_cast<float>(value);
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &narrowed, sizeof(bits));
+    for (int shift = 0; shift < 32; shift += 8) {
+      U8(static_cast<std::uint8_t>(bits >> shift));
+    }
+  }
+  bool Str8(const std::string& text) {
+    if (text.size() > 0xFF) {
+      return false;
+    }
+    U8(static_cast<std::uint8_t>(text.size()));
+    out_->insert(out_->end(), text.begin(), text.end());
+    return true;
+  }
+  bool Str16(const std::string& text) {
+    if (text.size() > 0xFFFF) {
+      return false;
+    }
+    U16(static_cast<std::uint16_t>(text.size()));
+    out_->insert(out_->end(), text.begin(), text.end());
+    return true;
+  }
+
+ private:
+  std::vector<std::uint8_t>* out_;
+};
+
+// Bounds-checked reader; every accessor returns false once past the end.
+class Reader {
+ public:
+  Reader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+  bool U8(std::uint8_t* value) {
+    if (position_ + 1 > size_) {
+      return false;
+    }
+    *value = data_[position_++];
+    return true;
+  }
+  bool F32(double* value) {
+    if (position_ + 4 > size_) {
+      return false;
+    }
+    std::uint32_t bits = 0;
+    for (int byte = 0; byte < 4; ++byte) {
+      bits |= static_cast<std::uint32_t>(data_[position_ + byte]) << (8 * byte);
+    }
+    position_ += 4;
+    float narrowed = 0.0f;
+    std::memcpy(&narrowed, &bits, sizeof(narrowed));
+    *value = narrowed;
+    return true;
+  }
+  bool Str8(std::string* text) {
+    std::uint8_t length = 0;
+    return U8(&length) && Bytes(length, text);
+  }
+  bool Str16(std::string* text) {
+    if (position_ + 2 > size_) {
+      return false;
+    }
+    const std::size_t length = data_[position_] | (static_cast<std::size_t>(data_[position_ + 1]) << 8);
+    position_ += 2;
+    return Bytes(length, text);
+  }
+
+ private:
+  bool Bytes(std::size_t length, std::string* text) {
+    if (position_ + length > size_) {
+      return false;
+    }
+    text->assign(reinterpret_cast<const char*>(data_ + position_), length);
+    position_ += length;
+    return true;
+  }
+
+  const std::uint8_t* data_;
+  std::size_t size_;
+  std::size_t position_{0};
+};
+
+std::uint16_t ReadU16(const std::uint8_t* data) {
+  return static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+}
+
+EnvelopeParseResult Fail(EnvelopeParseError error, std::string message) {
+  EnvelopeParseResult result;
+  result.error = error;
+  result.message = std::move(message);
+  return result;
+}
+
+// NaN, infinity and values past FLT_MAX have no f32 (or JSON) encoding; the
+// decoder would reject them anyway.
+bool NumbersFitF32(const EnvelopePayload& payload) {
+  const auto fits = [](double value) {
+    return std::isfinite(value) && std::fabs(value) <= std::numeric_limits<float>::max();
+  };
+  if (const auto* state = std::get_if<MissionStateUpdate>(&payload)) {
+    return fits(state->progress);
+  }
+  if (const auto* target = std::get_if<PerceptionTarget>(&payload)) {
+    return fits(target->alignment_dx) && fits(target->alignment_dy) && fits(target->confidence);
+  }
+  return true;
+}
+
+bool EncodePayload(const WireEnvelope& envelope, Writer* writer) {
+  switch (envelope.category) {
+    case MessageCategory::kMissionState: {
+      const auto* state = std::get_if<MissionStateUpdate>(&envelope.payload);
+      if (state == nullptr || !writer->Str8(state->state)) {
+        return false;
+      }
+      writer->F32(state->progress);
+      return writer->Str16(state->note);
+    }
+    case MessageCategory::kPerceptionOutput: {
+      const auto* target = std::get_if<PerceptionTarget>(&envelope.payload);
+      if (target == nullptr || !writer->Str8(target->color) || !writer->Str8(target->shape)) {
+        return false;
+      }
+      writer->F32(target->alignment_dx);
+      writer->F32(target->alignment_dy);
+      writer->F32(target->confidence);
+      return true;
+    }
+    case MessageCategory::kSafetyEvents: {
+      const auto* event = std::get_if<SafetyEvent>(&envelope.payload);
+      if (event == nullptr) {
+        return false;
+      }
+      writer->U8(static_cast<std::uint8_t>(event->severity));
+      return writer->Str8(event->code) && writer->Str16(event->message) &&
+             writer->Str8(event->recommended_action);
+    }
+    case MessageCategory::kCommandRequest: {
+      const auto* command = std::get_if<CommandPayload>(&envelope.payload);
+      return command != nullptr && writer->Str8(command->command) &&
+             writer->Str8(command->target) && writer->Str16(command->params_json);
+    }
+    case MessageCategory::kCommandAck:
+    case MessageCategory::kCommandReject: {
+      const auto* reply = std::get_if<CommandReplyPayload>(&envelope.payload);
+      return reply != nullptr && writer->Str8(reply->status) && writer->Str8(reply->accepted_by) &&
+             writer->Str8(reply->error_code) && writer->Str16(reply->message);
+    }
+    default:
+      return false;
+  }
+}
+
+// Truncated payloads report kMissingField: binary fields are positional, so a
+// short payload is the binary form of an absent key.
+EnvelopeParseResult DecodePayload(MessageCategory category, Reader* reader, EnvelopePayload* payload) {
+  const auto missing = [](const char* field) {
+    return Fail(EnvelopeParseError::kMissingField, std::string("missing payload.") + field);
+  };
+  const auto invalid = [](const char* field) {
+    return Fail(EnvelopeParseError::kInvalidValue, std::string("invalid payload.") + field);
+  };
+
+  switch (category) {
+    case MessageCategory::kMissionState: {
+      MissionStateUpdate state;
+      if (!reader->Str8(&state.state) || state.state.empty()) {
+        return missing("state");
+      }
+      if (!reader->F32(&state.progress)) {
+        return missing("progress");
+      }
+      if (!std::isfinite(state.progress)) {
+        return invalid("progress");
+      }
+      if (!reader->Str16(&state.note)) {
+        return missing("note");
+      }
+      *payload = std::move(state);
+      break;
+    }
+    case MessageCategory::kPerceptionOutput: {
+      PerceptionTarget target;
+      if (!reader->Str8(&target.color) || !reader->Str8(&target.shape)) {
+        return missing("target");
+      }
+      if (!reader->F32(&target.alignment_dx) || !reader->F32(&target.alignment_dy)) {
+        return missing("alignment");
+      }
+      if (!reader->F32(&target.confidence)) {
+        return missing("confidence");
+      }
+      if (!std::isfinite(target.alignment_dx) || !std::isfinite(target.alignment_dy)) {
+        return invalid("alignment");
+      }
+      if (!(target.confidence >= 0.0 && target.confidence <= 1.0)) {
+        return invalid("confidence");
+      }
+      *payload = std::move(target);
+      break;
+    }
+    case MessageCategory::kSafetyEvents: {
+      SafetyEvent event;
+      std::uint8_t severity = 0;
+      if (!reader->U8(&severity)) {
+        return missing("severity");
+      }
+      if (severity > static_cast<std::uint8_t>(SafetySeverity::kCritical)) {
+        return invalid("severity");
+      }
+      event.severity = static_cast<SafetySeverity>(severity);
+      if (!reader->Str8(&event.code) || event.code.empty()) {
+        return missing("code");
+      }
+      if (!reader->Str16(&event.message)) {
+        return missing("message");
+      }
+      if (!reader->Str8(&event.recommended_action)) {
+        return missing("recommended_action");
+      }
+      *payload = std::move(event);
+      break;
+    }
+    case MessageCategory::kCommandRequest: {
+      CommandPayload command;
+      if (!reader->Str8(&command.command) || command.command.empty()) {
+        return missing("command");
+      }
+      if (!reader->Str8(&command.target) || command.target.empty()) {
+        return missing("target");
+      }
+      if (!reader->Str16(&command.params_json)) {
+        return missing("params");
+      }
+      if (command.params_json.empty() || command.params_json.front() != '{') {
+        return invalid("params");
+      }
+      *payload = std::move(command);
+      break;
+    }
+    case MessageCategory::kCommandAck:
+    case MessageCategory::kCommandReject: {
+      CommandReplyPayload reply;
+      if (!reader->Str8(&reply.status) || reply.status.empty()) {
+        return missing("status");
+      }
+      if (!reader->Str8(&reply.accepted_by) || !reader->Str8(&reply.error_code) ||
+          !reader->Str16(&reply.message)) {
+        return missing(category == MessageCategory::kCommandAck ? "accepted_by" : "error_code");
+      }
+      *payload = std::move(reply);
+      break;
+    }
+    default:
+      return Fail(EnvelopeParseError::kUnsupportedCategory, "category has no binary layout");
+  }
+  EnvelopeParseResult result;
+  result.ok = true;
+  return result;
+}
+
+void AppendJsonString(std::string* out, std::string_view text) {
+  out->push_back('"');
+  for (const char c : text) {
+    switch (c) {
+      case '"':
+        out->append("\\\"");
+        break;
+      case '\\':
+        out->append("\\\\");
+        break;
+      case '\n':
+        out->append("\\n");
+        break;
+      case '\r':
+        out->append("\\r");
+        break;
+      case '\t':
+        out->append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+          out->append(escaped);
+        } else {
+          out->push_back(c);
+        }
+    }
+  }
+  out->push_back('"');
+}
+
+// False for NaN and infinity: "%.6g" would print nan/inf, which is not JSON.
+bool AppendJsonNumber(std::string* out, double value) {
+  if (!std::isfinite(value)) {
+    return false;
+  }
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.6g", value);
+  out->append(text);
+  return true;
+}
+
+// False when a number cannot be written; `out` then holds a partial payload.
+bool AppendJsonPayload(const WireEnvelope& envelope, std::string* out) {
+  return std::visit(
+      [out](const auto& payload) {
+        using T = std::decay_t<decltype(payload)>;
+        if constexpr (std::is_same_v<T, MissionStateUpdate>) {
+          out->append("{\"note\":");
+          AppendJsonString(out, payload.note);
+          out->append(",\"progress\":");
+          if (!AppendJsonNumber(out, payload.progress)) {
+            return false;
+          }
+          out->append(",\"state\":");
+          AppendJsonString(out, payload.state);
+          out->push_back('}');
+        } else if constexpr (std::is_same_v<T, PerceptionTarget>) {
+          out->append("{\"alignment\":{\"dx\":");
+          if (!AppendJsonNumber(out, payload.alignment_dx)) {
+            return false;
+          }
+          out->append(",\"dy\":");
+          if (!AppendJsonNumber(out, payload.alignment_dy)) {
+            return false;
+          }
+          out->append("},\"confidence\":");
+          if (!AppendJsonNumber(out, payload.confidence)) {
+            return false;
+          }
+          out->append(",\"target\":{\"color\":");
+          AppendJsonString(out, payload.color);
+          out->append(",\"shape\":");
+          AppendJsonString(out, payload.shape);
+          out->append("}}");
+        } else if constexpr (std::is_same_v<T, SafetyEvent>) {
+          out->append("{\"code\":");
+          AppendJsonString(out, payload.code);
+          out->append(",\"message\":");
+          AppendJsonString(out, payload.message);
+          out->append(",\"recommended_action\":");
+          AppendJsonString(out, payload.recommended_action);
+          out->append(",\"severity\":");
+          const auto severity = static_cast<std::size_t>(payload.severity);
+          AppendJsonString(out, severity < 3 ? kSeverityNames[severity] : "");
+          out->push_back('}');
+        } else if constexpr (std::is_same_v<T, CommandPayload>) {
+          out->append("{\"command\":");
+          AppendJsonString(out, payload.command);
+          out->append(",\"params\":");
+          out->append(payload.params_json.empty() ? "{}" : payload.params_json);
+          out->append(",\"target\":");
+          AppendJsonString(out, payload.target);
+          out->push_back('}');
+        } else if constexpr (std::is_same_v<T, CommandReplyPayload>) {
+          // Keys of the other reply kind are omitted rather than sent empty.
+          out->push_back('{');
+          if (!payload.accepted_by.empty()) {
+            out->append("\"accepted_by\":");
+            AppendJsonString(out, payload.accepted_by);
+            out->push_back(',');
+          }
+          if (!payload.error_code.empty()) {
+            out->append("\"error_code\":");
+            AppendJsonString(out, payload.error_code);
+            out->push_back(',');
+          }
+          if (!payload.message.empty()) {
+            out->append("\"message\":");
+            AppendJsonString(out, payload.message);
+            out->push_back(',');
+          }
+          out->append("\"status\":");
+          AppendJsonString(out, payload.status);
+          out->push_back('}');
+        } else {
+          out->append("{}");
+        }
+        return true;
+      },
+      envelope.payload);
+}
+
+// Minimal JSON reader for ParseJsonEnvelope: strings, numbers and skipping of
+// any other value. Every accessor skips leading whitespace and returns false
+// on malformed input.
+class JsonReader {
+ public:
+  explicit JsonReader(std::string_view text) : text_(text) {}
+
+  bool Consume(char expected) {
+    SkipSpace();
+    return Accept(expected);
+  }
+
+  bool AtEnd() {
+    SkipSpace();
+    return position_ == text_.size();
+  }
+
+  // Calls `member(key)` for each member; `member` must read the value.
+  template <typename Fn>
+  bool Object(Fn&& member) {
+    if (!Consume('{')) {
+      return false;
+    }
+    if (Consume('}')) {
+      return true;
+    }
+    std::string key;
+    do {
+      if (!String(&key) || !Consume(':') || !member(key)) {
+        return false;
+      }
+    } while (Consume(','));
+    return Consume('}');
+  }
+
+  bool String(std::string* out) {
+    if (!Consume('"')) {
+      return false;
+    }
+    out->clear();
+    while (position_ < text_.size()) {
+      const char c = text_[position_++];
+      if (c == '"') {
+        return true;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+      if (c != '\\') {
+        out->push_back(c);
+        continue;
+      }
+      if (position_ >= text_.size()) {
+        return false;
+      }
+      switch (text_[position_++]) {
+        case '"':
+          out->push_back('"');
+          break;
+        case '\\':
+          out->push_back('\\');
+          break;
+        case '/':
+          out->push_back('/');
+          break;
+        case 'b':
+          out->push_back('\b');
+          break;
+        case 'f':
+          out->push_back('\f');
+          break;
+        case 'n':
+          out->push_back('\n');
+          break;
+        case 'r':
+          out->push_back('\r');
+          break;
+        case 't':
+          out->push_back('\t');
+          break;
+        case 'u':
+          if (!Unicode(out)) {
+            return false;
+          }
+          break;
+        default:
+          return false;
+      }
+    }
+    return false;
+  }
+
+  // JSON number grammar only: no NaN, infinity or hex. Overflow fails too.
+  bool Number(double* value) {
+    SkipSpace();
+    const std::size_t start = position_;
+    Accept('-');
+    if (!Accept('0') && !AcceptDigits()) {
+      return false;
+    }
+    if (Accept('.') && !AcceptDigits()) {
+      return false;
+    }
+    if (Accept('e') || Accept('E')) {
+      if (!Accept('+')) {
+        Accept('-');
+      }
+      if (!AcceptDigits()) {
+        return false;
+      }
+    }
+    char buffer[64];
+    const std::size_t length = position_ - start;
+    if (length >= sizeof(buffer)) {
+      return false;
+    }
+    std::memcpy(buffer, text_.data() + start, length);
+    buffer[length] = '\0';
+    *value = std::strtod(buffer, nullptr);
+    return std::isfinite(*value);
+  }
+
+  // Skips one value of any type; `raw` receives its text.
+  bool Skip(std::string_view* raw = nullptr, int depth = 0) {
+    SkipSpace();
+    const std::size_t start = position_;
+    if (position_ >= text_.size() || depth > kMaxDepth) {
+      return false;
+    }
+    bool ok = false;
+    std::string scratch;
+    double number = 0.0;
+    switch (text_[position_]) {
+      case '{':
+        ok = Object([this, depth](const std::string&) { return Skip(nullptr, depth + 1); });
+        break;
+      case '[':
+        ++position_;
+        ok = Consume(']');
+        if (!ok) {
+          do {
+            ok = Skip(nullptr, depth + 1);
+          } while (ok && Consume(','));
+          ok = ok && Consume(']');
+        }
+        break;
+      case '"':
+        ok = String(&scratch);
+        break;
+      case 't':
+        ok = Keyword("true");
+        break;
+      case 'f':
+        ok = Keyword("false");
+        break;
+      case 'n':
+        ok = Keyword("null");
+        break;
+      default:
+        ok = Number(&number);
+    }
+    if (ok && raw != nullptr) {
+      *raw = text_.substr(start, position_ - start);
+    }
+    return ok;
+  }
+
+ private:
+  static constexpr int kMaxDepth = 32;
+
+  void SkipSpace() {
+    while (position_ < text_.size() && (text_[position_] == ' ' || text_[position_] == '\n' ||
+                                        text_[position_] == '\r' || text_[position_] == '\t')) {
+      ++position_;
+    }
+  }
+
+  bool Accept(char expected) {
+    if (position_ < text_.size() && text_[position_] == expected) {
+      ++position_;
+      return true;
+    }
+    return false;
+  }
+
+  bool AcceptDigits() {
+    const std::size_t start = position_;
+    while (position_ < text_.size() && text_[position_] >= '0' && text_[position_] <= '9') {
+      ++position_;
+    }
+    return position_ > start;
+  }
+
+  bool Keyword(std::string_view word) {
+    if (text_.substr(position_, word.size()) != word) {
+      return false;
+    }
+    position_ += word.size();
+    return true;
+  }
+
+  bool Hex4(std::uint32_t* value) {
+    if (position_ + 4 > text_.size()) {
+      return false;
+    }
+    std::uint32_t result = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = text_[position_++];
+      result <<= 4;
+      if (c >= '0' && c <= '9') {
+        result |= static_cast<std::uint32_t>(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        result |= static_cast<std::uint32_t>(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        result |= static_cast<std::uint32_t>(c - 'A' + 10);
+      } else {
+        return false;
+      }
+    }
+    *value = result;
+    return true;
+  }
+
+  // \uXXXX after the 'u', surrogate pairs included, appended as UTF-8.
+  bool Unicode(std::string* out) {
+    std::uint32_t code = 0;
+    if (!Hex4(&code) || (code >= 0xDC00 && code <= 0xDFFF)) {
+      return false;
+    }
+    if (code >= 0xD800 && code <= 0xDBFF) {
+      std::uint32_t low = 0;
+      if (!Accept('\\') || !Accept('u') || !Hex4(&low) || low < 0xDC00 || low > 0xDFFF) {
+        return false;
+      }
+      code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    }
+    if (code < 0x80) {
+      out->push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out->push_back(static_cast<char>(0xC0 | (code >> 6)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+      out->push_back(static_cast<char>(0xE0 | (code >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+      out->push_back(static_cast<char>(0xF0 | (code >> 18)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+    return true;
+  }
+
+  std::string_view text_;
+  std::size_t position_{0};
+};
+
+// Typed payload of `category` from its JSON object text. Absent keys are
+// kMissingField and wrong types or out-of-range values kInvalidValue, as in
+// the binary decoder.
+EnvelopeParseResult ParseJsonPayload(MessageCategory category, std::string_view json,
+                                     EnvelopePayload* payload) {
+  const auto missing = [](const char* field) {
+    return Fail(EnvelopeParseError::kMissingField, std::string("missing payload.") + field);
+  };
+  const auto invalid = [](const char* field) {
+    return Fail(EnvelopeParseError::kInvalidValue, std::string("invalid payload.") + field);
+  };
+
+  JsonReader reader(json);
+  // Set when a known key holds a value of the wrong type.
+  const char* bad_field = nullptr;
+  const auto read_string = [&](const char* field, std::string* out, bool* seen) {
+    *seen = true;
+    if (!reader.String(out)) {
+      bad_field = field;
+      return false;
+    }
+    return true;
+  };
+  const auto read_number = [&](const char* field, double* out, bool* seen) {
+    *seen = true;
+    if (!reader.Number(out)) {
+      bad_field = field;
+      return false;
+    }
+    return true;
+  };
+  const auto parsed = [&](bool ok) {
+    if (ok) {
+      return EnvelopeParseResult{true, EnvelopeParseError::kNone, {}};
+    }
+    return bad_field != nullptr ? invalid(bad_field)
+                                : Fail(EnvelopeParseError::kInvalidValue, "payload is not an object");
+  };
+
+  switch (category) {
+    case MessageCategory::kMissionState: {
+      MissionStateUpdate state;
+      bool has_state = false;
+      bool has_progress = false;
+      bool has_note = false;
+      const auto result = parsed(reader.Object([&](const std::string& key) {
+        if (key == "state") {
+          return read_string("state", &state.state, &has_state);
+        }
+        if (key == "progress") {
+          return read_number("progress", &state.progress, &has_progress);
+        }
+        if (key == "note") {
+          return read_string("note", &state.note, &has_note);
+        }
+        return reader.Skip();
+      }));
+      if (!result.ok) {
+        return result;
+      }
+      if (!has_state || state.state.empty()) {
+        return missing("state");
+      }
+      if (!has_progress) {
+        return missing("progress");
+      }
+      *payload = std::move(state);
+      break;
+    }
+    case MessageCategory::kPerceptionOutput: {
+      PerceptionTarget target;
+      bool has_color = false;
+      bool has_shape = false;
+      bool has_dx = false;
+      bool has_dy = false;
+      bool has_confidence = false;
+      const auto result = parsed(reader.Object([&](const std::string& key) {
+        if (key == "target") {
+          return reader.Object([&](const std::string& inner) {
+            if (inner == "color") {
+              return read_string("target", &target.color, &has_color);
+            }
+            if (inner == "shape") {
+              return read_string("target", &target.shape, &has_shape);
+            }
+            return reader.Skip();
+          });
+        }
+        if (key == "alignment") {
+          return reader.Object([&](const std::string& inner) {
+            if (inner == "dx") {
+              return read_number("alignment", &target.alignment_dx, &has_dx);
+            }
+            if (inner == "dy") {
+              return read_number("alignment", &target.alignment_dy, &has_dy);
+            }
+            return reader.Skip();
+          });
+        }
+        if (key == "confidence") {
+          return read_number("confidence", &target.confidence, &has_confidence);
+        }
+        return reader.Skip();
+      }));
+      if (!result.ok) {
+        return result;
+      }
+      if (!has_color || !has_shape) {
+        return missing("target");
+      }
+      if (!has_dx || !has_dy) {
+        return missing("alignment");
+      }
+      if (!has_confidence) {
+        return missing("confidence");
+      }
+      if (!(target.confidence >= 0.0 && target.confidence <= 1.0)) {
+        return invalid("confidence");
+      }
+      *payload = std::move(target);
+      break;
+    }
+    case MessageCategory::kSafetyEvents: {
+      SafetyEvent event;
+      std::string severity;
+      bool has_severity = false;
+      bool has_code = false;
+      bool has_message = false;
+      bool has_action = false;
+      const auto result = parsed(reader.Object([&](const std::string& key) {
+        if (key == "severity") {
+          return read_string("severity", &severity, &has_severity);
+        }
+        if (key == "code") {
+          return read_string("code", &event.code, &has_code);
+        }
+        if (key == "message") {
+          return read_string("message", &event.message, &has_message);
+        }
+        if (key == "recommended_action") {
+          return read_string("recommended_action", &event.recommended_action, &has_action);
+        }
+        return reader.Skip();
+      }));
+      if (!result.ok) {
+        return result;
+      }
+      if (!has_severity) {
+        return missing("severity");
+      }
+      const auto* name = std::find(std::begin(kSeverityNames), std::end(kSeverityNames), severity);
+      if (name == std::end(kSeverityNames)) {
+        return invalid("severity");
+      }
+      event.severity = static_cast<SafetySeverity>(name - std::begin(kSeverityNames));
+      if (!has_code || event.code.empty()) {
+        return missing("code");
+      }
+      if (!has_message) {
+        return missing("message");
+      }
+      if (!has_action) {
+        return missing("recommended_action");
+      }
+      *payload = std::move(event);
+      break;
+    }
+    case MessageCategory::kCommandRequest: {
+      CommandPayload command;
+      bool has_command = false;
+      bool has_target = false;
+      bool has_params = false;
+      const auto result = parsed(reader.Object([&](const std::string& key) {
+        if (key == "command") {
+          return read_string("command", &command.command, &has_command);
+        }
+        if (key == "target") {
+          return read_string("target", &command.target, &has_target);
+        }
+        if (key == "params") {
+          std::string_view raw;
+          has_params = true;
+          if (!reader.Skip(&raw)) {
+            return false;
+          }
+          command.params_json.assign(raw.data(), raw.size());
+          return true;
+        }
+        return reader.Skip();
+      }));
+      if (!result.ok) {
+        return result;
+      }
+      if (!has_command || command.command.empty()) {
+        return missing("command");
+      }
+      if (!has_target || command.target.empty()) {
+        return missing("target");
+      }
+      if (!has_params) {
+        return missing("params");
+      }
+      if (command.params_json.front() != '{') {
+        return invalid("params");
+      }
+      *payload = std::move(command);
+      break;
+    }
+    case MessageCategory::kCommandAck:
+    case MessageCategory::kCommandReject: {
+      // The serializer omits the other reply kind's keys; only status is required.
+      CommandReplyPayload reply;
+      bool has_status = false;
+      bool seen = false;
+      const auto result = parsed(reader.Object([&](const std::string& key) {
+        if (key == "status") {
+          return read_string("status", &reply.status, &has_status);
+        }
+        if (key == "accepted_by") {
+          return read_string("accepted_by", &reply.accepted_by, &seen);
+        }
+        if (key == "error_code") {
+          return read_string("error_code", &reply.error_code, &seen);
+        }
+        if (key == "message") {
+          return read_string("message", &reply.message, &seen);
+        }
+        return reader.Skip();
+      }));
+      if (!result.ok) {
+        return result;
+      }
+      if (!has_status || reply.status.empty()) {
+        return missing("status");
+      }
+      *payload = std::move(reply);
+      break;
+    }
+    default:
+      return Fail(EnvelopeParseError::kUnsupportedCategory, "category has no typed payload");
+  }
+  EnvelopeParseResult result;
+  result.ok = true;
+  return result;
+}
+
+}  // namespace
+
+std::string_view CategoryName(MessageCategory category) {
+  const auto index = static_cast<std::size_t>(category);
+  return index < std::size(kCategoryNames) ? kCategoryNames[index] : std::string_view();
+}
+
+MessageCategory ParseCategory(std::string_view name) {
+  for (std::size_t index = 1; index < std::size(kCategoryNames); ++index) {
+    if (kCategoryNames[index] == name) {
+      return static_cast<MessageCategory>(index);
+    }
+  }
+  return MessageCategory::kUnknown;
+}
+
+std::string_view SourceName(MessageSource source) {
+  const auto index = static_cast<std::size_t>(source);
+  return index < std::size(kSourceNames) ? kSourceNames[index] : std::string_view();
+}
+
+MessageSource ParseSource(std::string_view name) {
+  for (std::size_t index = 1; index < std::size(kSourceNames); ++index) {
+    if (kSourceNames[index] == name) {
+      return static_cast<MessageSource>(index);
+    }
+  }
+  return MessageSource::kUnknown;
+}
+
+const char* ToString(EnvelopeParseError error) {
+  switch (error) {
+    case EnvelopeParseError::kNone:
+      return "NONE";
+    case EnvelopeParseError::kMalformed:
+      return "MALFORMED";
+    case EnvelopeParseError::kMissingField:
+      return "MISSING_FIELD";
+    case EnvelopeParseError::kInvalidValue:
+      return "INVALID_VALUE";
+    case EnvelopeParseError::kUnsupportedCategory:
+      return "UNSUPPORTED_CATEGORY";
+    case EnvelopeParseError::kUnsupportedSchema:
+      return "UNSUPPORTED_SCHEMA";
+  }
+  return "UNKNOWN";
+}
+
+bool HasBinaryLayout(MessageCategory category) {
+  switch (category) {
+    case MessageCategory::kMissionState:
+    case MessageCategory::kPerceptionOutput:
+    case MessageCategory::kSafetyEvents:
+    case MessageCategory::kCommandRequest:
+    case MessageCategory::kCommandAck:
+    case MessageCategory::kCommandReject:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool EncodeBinaryEnvelope(const WireEnvelope& envelope, std::vector<std::uint8_t>* out,
+                          std::string* reason) {
+  const auto fail = [reason](const char* what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+  if (!HasBinaryLayout(envelope.category)) {
+    return fail("category has no binary layout");
+  }
+  if (envelope.source == MessageSource::kUnknown) {
+    return fail("source is not set");
+  }
+  if (!NumbersFitF32(envelope.payload)) {
+    return fail("payload number is not finite or exceeds the f32 range");
+  }
+
+  const std::size_t start = out->size();
+  Writer writer(out);
+  writer.U8(kBinaryEnvelopeMagic);
+  writer.U8(envelope.schema_major);
+  writer.U8(envelope.schema_minor);
+  writer.U8(envelope.schema_patch);
+  writer.U16(0);  // body length, patched below
+  writer.U8(static_cast<std::uint8_t>(envelope.category));
+  writer.U8(static_cast<std::uint8_t>(envelope.source));
+  writer.I64(envelope.timestamp_us);
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    writer.U8(static_cast<std::uint8_t>(envelope.correlation_id.hi >> shift));
+  }
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    writer.U8(static_cast<std::uint8_t>(envelope.correlation_id.lo >> shift));
+  }
+  if (!EncodePayload(envelope, &writer)) {
+    out->resize(start);
+    return fail("payload does not match the category or a field is too long");
+  }
+  const std::size_t body = out->size() - start - 6;
+  if (body > 0xFFFF) {
+    out->resize(start);
+    return fail("frame exceeds 64 KiB");
+  }
+  (*out)[start + 4] = static_cast<std::uint8_t>(body);
+  (*out)[start + 5] = static_cast<std::uint8_t>(body >> 8);
+  return true;
+}
+
+std::size_t BinaryEnvelopeFrameSize(const std::uint8_t* data, std::size_t size) {
+  if (size < 6) {
+    return 0;
+  }
+  return 6 + static_cast<std::size_t>(ReadU16(data + 4));
+}
+
+EnvelopeParseResult DecodeBinaryEnvelope(const std::uint8_t* data, std::size_t size,
+                                         WireEnvelope* envelope) {
+  if (size < kBinaryEnvelopeHeaderSize || data[0] != kBinaryEnvelopeMagic) {
+    return Fail(EnvelopeParseError::kMalformed, "not a binary envelope");
+  }
+  const std::size_t frame_size = BinaryEnvelopeFrameSize(data, size);
+  if (frame_size < kBinaryEnvelopeHeaderSize || frame_size > size) {
+    return Fail(EnvelopeParseError::kMalformed, "frame length does not match the data");
+  }
+  if (data[1] != 1) {
+    return Fail(EnvelopeParseError::kUnsupportedSchema,
+                "unsupported schema major version " + std::to_string(data[1]));
+  }
+
+  WireEnvelope decoded;
+  decoded.schema_major = data[1];
+  decoded.schema_minor = data[2];
+  decoded.schema_patch = data[3];
+  decoded.category = static_cast<MessageCategory>(data[6]);
+  if (!HasBinaryLayout(decoded.category)) {
+    return Fail(EnvelopeParseError::kUnsupportedCategory,
+                "unsupported category id " + std::to_string(data[6]));
+  }
+  decoded.source = static_cast<MessageSource>(data[7]);
+  if (SourceName(decoded.source).empty() || decoded.source == MessageSource::kUnknown) {
+    return Fail(EnvelopeParseError::kInvalidValue, "invalid source id " + std::to_string(data[7]));
+  }
+  std::uint64_t timestamp = 0;
+  for (int byte = 0; byte < 8; ++byte) {
+    timestamp |= static_cast<std::uint64_t>(data[8 + byte]) << (8 * byte);
+  }
+  decoded.timestamp_us = static_cast<std::int64_t>(timestamp);
+  if (decoded.timestamp_us <= 0) {
+    return Fail(EnvelopeParseError::kInvalidValue, "invalid timestamp");
+  }
+  for (int byte = 0; byte < 8; ++byte) {
+    decoded.correlation_id.hi = (decoded.correlation_id.hi << 8) | data[16 + byte];
+    decoded.correlation_id.lo = (decoded.correlation_id.lo << 8) | data[24 + byte];
+  }
+  if (decoded.correlation_id == utils::Uuid128{}) {
+    return Fail(EnvelopeParseError::kMissingField, "missing correlation_id");
+  }
+
+  Reader reader(data + kBinaryEnvelopeHeaderSize, frame_size - kBinaryEnvelopeHeaderSize);
+  auto result = DecodePayload(decoded.category, &reader, &decoded.payload);
+  if (result.ok) {
+    *envelope = std::move(decoded);
+  }
+  return result;
+}
+
+bool SerializeJsonEnvelope(const WireEnvelope& envelope, std::string* out, std::string* reason) {
+  char correlation_id[utils::kUuidTextLength];
+  utils::FormatUuid(envelope.correlation_id, correlation_id);
+  char version[16];
+  std::snprintf(version, sizeof(version), "%u.%u.%u", envelope.schema_major, envelope.schema_minor,
+                envelope.schema_patch);
+
+  const std::size_t start = out->size();
+  out->reserve(start + 256);
+  out->append("{\"category\":");
+  AppendJsonString(out, CategoryName(envelope.category));
+  out->append(",\"correlation_id\":");
+  AppendJsonString(out, std::string_view(correlation_id, sizeof(correlation_id)));
+  out->append(",\"payload\":");
+  if (!AppendJsonPayload(envelope, out)) {
+    out->resize(start);
+    if (reason != nullptr) {
+      *reason = "payload number is not finite";
+    }
+    return false;
+  }
+  out->append(",\"schema_version\":");
+  AppendJsonString(out, version);
+  out->append(",\"source\":");
+  AppendJsonString(out, SourceName(envelope.source));
+  out->append(",\"timestamp\":");
+  AppendJsonString(out, utils::FormatRfc3339Micros(envelope.timestamp_us));
+  out->push_back('}');
+  return true;
+}
+
+EnvelopeParseResult ParseJsonEnvelope(std::string_view json, WireEnvelope* envelope) {
+  std::string category;
+  std::string correlation_id;
+  std::string version;
+  std::string source;
+  std::string timestamp;
+  std::string_view payload;
+  bool has_category = false;
+  bool has_correlation_id = false;
+  bool has_version = false;
+  bool has_source = false;
+  bool has_timestamp = false;
+  bool has_payload = false;
+
+  JsonReader reader(json);
+  const auto read = [&reader](std::string* out, bool* seen) {
+    *seen = true;
+    return reader.String(out);
+  };
+  const bool well_formed = reader.Object([&](const std::string& key) {
+    if (key == "category") {
+      return read(&category, &has_category);
+    }
+    if (key == "correlation_id") {
+      return read(&correlation_id, &has_correlation_id);
+    }
+    if (key == "schema_version") {
+      return read(&version, &has_version);
+    }
+    if (key == "source") {
+      return read(&source, &has_source);
+    }
+    if (key == "timestamp") {
+      return read(&timestamp, &has_timestamp);
+    }
+    if (key == "payload") {
+      has_payload = true;
+      return reader.Skip(&payload);
+    }
+    return reader.Skip();
+  });
+  if (!well_formed || !reader.AtEnd()) {
+    return Fail(EnvelopeParseError::kMalformed, "invalid JSON");
+  }
+
+  WireEnvelope parsed;
+  if (!has_version) {
+    return Fail(EnvelopeParseError::kMissingField, "missing schema_version");
+  }
+  unsigned major = 0;
+  unsigned minor = 0;
+  unsigned patch = 0;
+  char tail = 0;
+  if (std::sscanf(version.c_str(), "%u.%u.%u%c", &major, &minor, &patch, &tail) != 3 ||
+      minor > 0xFF || patch > 0xFF) {
+    return Fail(EnvelopeParseError::kInvalidValue, "invalid schema_version");
+  }
+  if (major != 1) {
+    return Fail(EnvelopeParseError::kUnsupportedSchema,
+                "unsupported schema major version " + std::to_string(major));
+  }
+  parsed.schema_major = 1;
+  parsed.schema_minor = static_cast<std::uint8_t>(minor);
+  parsed.schema_patch = static_cast<std::uint8_t>(patch);
+
+  if (!has_category) {
+    return Fail(EnvelopeParseError::kMissingField, "missing category");
+  }
+  parsed.category = ParseCategory(category);
+  if (!HasBinaryLayout(parsed.category)) {
+    return Fail(EnvelopeParseError::kUnsupportedCategory, "unsupported category " + category);
+  }
+  if (!has_source) {
+    return Fail(EnvelopeParseError::kMissingField, "missing source");
+  }
+  parsed.source = ParseSource(source);
+  if (parsed.source == MessageSource::kUnknown) {
+    return Fail(EnvelopeParseError::kInvalidValue, "invalid source " + source);
+  }
+  if (!has_timestamp) {
+    return Fail(EnvelopeParseError::kMissingField, "missing timestamp");
+  }
+  if (!utils::ParseRfc3339Micros(timestamp, &parsed.timestamp_us) || parsed.timestamp_us <= 0) {
+    return Fail(EnvelopeParseError::kInvalidValue, "invalid timestamp");
+  }
+  if (!has_correlation_id) {
+    return Fail(EnvelopeParseError::kMissingField, "missing correlation_id");
+  }
+  if (!utils::ParseUuid(correlation_id, &parsed.correlation_id)) {
+    return Fail(EnvelopeParseError::kInvalidValue, "invalid correlation_id");
+  }
+  if (!has_payload) {
+    return Fail(EnvelopeParseError::kMissingField, "missing payload");
+  }
+
+  auto result = ParseJsonPayload(parsed.category, payload, &parsed.payload);
+  if (result.ok) {
+    *envelope = std::move(parsed);
+  }
+  return result;
+}
+
+}  // namespace ulak::models
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "CorrelationId.h"
+#include "MissionState.h"
+#include "PerceptionTarget.h"
+#include "SafetyEvent.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace ulak::models {
+
+// Category ids of the binary envelope (PROTOCOL.md §3.1). Ids are stable wire
+// values; new categories append.
+enum class MessageCategory : std::uint8_t {
+  kUnknown = 0,
+  kTelemetryVehicle = 1,
+  kTelemetrySimulator = 2,
+  kTelemetryHealth = 3,
+  kMissionState = 4,
+  kPerceptionOutput = 5,
+  kSafetyEvents = 6,
+  kCommandRequest = 7,
+  kCommandAck = 8,
+  kCommandReject = 9,
+  kCommandTuning = 10,
+  kCommandTuningAck = 11,
+};
+
+enum class MessageSource : std::uint8_t {
+  kUnknown = 0,
+  kStation = 1,
+  kFlightController = 2,
+  kCompanionComputer = 3,
+};
+
+std::string_view CategoryName(MessageCategory category);
+MessageCategory ParseCategory(std::string_view name);
+std::string_view SourceName(MessageSource source);
+MessageSource ParseSource(std::string_view name);
+
+// `station/commands/request` payload. `params` stays JSON text: it is free-form
+// per command and only the receiver interprets it.
+struct CommandPayload {
+  std::string command;
+  std::string target;
+  std::string params_json{"{}"};
+};
+
+// `station/commands/ack` and `station/commands/reject` payloads (§7.2, §7.3).
+struct CommandReplyPayload {
+  std::string status;
+  std::string accepted_by;
+  std::string error_code;
+  std::string message;
+};
+
+using EnvelopePayload = std::variant<std::monostate,
+                                     MissionStateUpdate,
+                                     PerceptionTarget,
+                                     SafetyEvent,
+                                     CommandPayload,
+                                     CommandReplyPayload>;
+
+// The §5 envelope with typed fields: what either wire format decodes into.
+struct WireEnvelope {
+  std::uint8_t schema_major{1};
+  std::uint8_t schema_minor{1};
+  std::uint8_t schema_patch{0};
+  MessageCategory category{MessageCategory::kUnknown};
+  MessageSource source{MessageSource::kUnknown};
+  // UTC epoch microseconds.
+  std::int64_t timestamp_us{0};
+  utils::Uuid128 correlation_id;
+  EnvelopePayload payload;
+};
+
+// Same classes as CommandParseError so both formats reject alike: a bad frame
+// is kMalformed where JSON reports kInvalidJson.
+enum class EnvelopeParseError {
+  kNone,
+  kMalformed,
+  kMissingField,
+  kInvalidValue,
+  kUnsupportedCategory,
+  kUnsupportedSchema,
+};
+
+struct EnvelopeParseResult {
+  bool ok{false};
+  EnvelopeParseError error{EnvelopeParseError::kNone};
+  std::string message;
+};
+
+const char* ToString(EnvelopeParseError error);
+
+// First byte of every binary frame. JSON envelopes start with '{' (or
+// whitespace), so a receiver can tell the formats apart per message.
+inline constexpr std::uint8_t kBinaryEnvelopeMagic = 0xB5;
+inline constexpr std::size_t kBinaryEnvelopeHeaderSize = 32;
+inline constexpr std::size_t kMaxBinaryEnvelopeSize = 6 + 0xFFFF;
+
+// True when `category` has a binary payload layout.
+bool HasBinaryLayout(MessageCategory category);
+
+// Appends one frame to `out`. Returns false, leaving `out` untouched, when the
+// envelope cannot be expressed in binary (no layout for the category, string
+// over its length prefix); the caller then sends JSON. Also refuses NaN,
+// infinite and out-of-float-range numbers, which JSON cannot carry either.
+//
+// `f32` fields are narrowed from double and keep about 7 significant digits
+// (0.1 arrives as 0.100000001490116). ulak-bin/1 only lays out bounded,
+// display-grade values (alignment offsets, confidence, progress) as f32; a
+// layout carrying positions or other wide-range values needs f64 fields.
+bool EncodeBinaryEnvelope(const WireEnvelope& envelope, std::vector<std::uint8_t>* out,
+                          std::string* reason);
+
+// Total size of the frame starting at `data`, or 0 when fewer than 6 bytes are
+// available. Stream transports read this many bytes before decoding.
+std::size_t BinaryEnvelopeFrameSize(const std::uint8_t* data, std::size_t size);
+
+// Decodes one frame. Unknown trailing payload bytes (minor-version additions)
+// are ignored; a major-version mismatch is rejected (§3).
+EnvelopeParseResult DecodeBinaryEnvelope(const std::uint8_t* data, std::size_t size,
+                                         WireEnvelope* envelope);
+
+// Deterministic JSON (keys sorted, as SerializeCommandRequest) of the same
+// envelope: the fallback format and the reference for the binary one. Appends
+// to `out`; returns false, leaving it untouched, when a payload number is NaN
+// or infinite (JSON has no literal for them).
+bool SerializeJsonEnvelope(const WireEnvelope& envelope, std::string* out, std::string* reason);
+
+// Parses a JSON envelope of a category with a typed payload (the binary
+// layouts). Errors use the binary decoder's classes: invalid JSON is
+// kMalformed, other categories kUnsupportedCategory. Unknown keys are ignored
+// (minor-version additions).
+EnvelopeParseResult ParseJsonEnvelope(std::string_view json, WireEnvelope* envelope);
+
+}  // namespace ulak::models
@@ -0,0 +1,614 @@
+#include "BinaryLog.h"
+
+#include "Timestamp.h"
+
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+namespace ulak::utils {
+namespace {
+
+// File layout: magic, varint epoch_us at Start(), then tagged items. Sites are
+// written before their first entry; integers are varints (signed ones
+// zigzagged), doubles raw little-endian, strings varint length + bytes.
+constexpr char kMagic[8] = {'U', 'L', 'A', 'K', 'L', 'O', 'G', '1'};
+constexpr std::uint8_t kSiteTag = 1;
+constexpr std::uint8_t kEntryTag = 2;
+constexpr std::uint8_t kDropTag = 3;
+
+void PutVarint(std::string* out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void PutString(std::string* out, std::string_view text) {
+  PutVarint(out, text.size());
+  out->append(text.data(), text.size());
+}
+
+std::uint64_t ZigZag(std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t UnZigZag(std::uint64_t value) {
+  return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+// Retires the thread's ring when the thread exits so the logger can free it.
+struct LocalBufferHolder {
+  std::shared_ptr<LogBuffer> buffer;
+
+  ~LocalBufferHolder() {
+    if (buffer) {
+      buffer->Retire();
+    }
+  }
+};
+
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool done() const { return offset_ == data_.size(); }
+
+  bool Byte(std::uint8_t* value) {
+    if (offset_ >= data_.size()) {
+      return false;
+    }
+    *value = static_cast<std::uint8_t>(data_[offset_++]);
+    return true;
+  }
+
+  bool Varint(std::uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      std::uint8_t byte = 0;
+      if (!Byte(&byte)) {
+        return false;
+      }
+      *value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool Raw(std::size_t size, std::string_view* out) {
+    if (data_.size() - offset_ < size) {
+      return false;
+    }
+    *out = data_.substr(offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool String(std::string* out) {
+    std::uint64_t size = 0;
+    std::string_view bytes;
+    if (!Varint(&size) || !Raw(static_cast<std::size_t>(size), &bytes)) {
+      return false;
+    }
+    out->assign(bytes.data(), bytes.size());
+    return true;
+  }
+
+ private:
+  std::string_view data_;
+  std::size_t offset_{0};
+};
+
+struct DecodedSite {
+  LogLevel level{LogLevel::kInfo};
+  int line{0};
+  std::string file;
+  std::string format;
+  std::vector<LogArgType> types;
+};
+
+struct DecodedArg {
+  LogArgType type{LogArgType::kInt};
+  std::int64_t i{0};
+  std::uint64_t u{0};
+  double d{0.0};
+  std::string s;
+};
+
+template <typename T>
+void AppendFormatted(std::string* out, const std::string& spec, T value) {
+  char buffer[128];
+  const int length = std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+  if (length < 0) {
+    return;
+  }
+  if (static_cast<std::size_t>(length) < sizeof(buffer)) {
+    out->append(buffer, static_cast<std::size_t>(length));
+    return;
+  }
+  std::string large(static_cast<std::size_t>(length) + 1, '\0');
+  std::snprintf(large.data(), large.size(), spec.c_str(), value);
+  out->append(large.data(), static_cast<std::size_t>(length));
+}
+
+// Re-runs the printf conversions one argument at a time, with length
+// modifiers rewritten to the stored 64-bit / double / string forms.
+std::string Render(const std::string& format, const std::vector<DecodedArg>& args) {
+  std::string out;
+  std::size_t next_arg = 0;
+  for (std::size_t i = 0; i < format.size(); ++i) {
+    if (format[i] != '%') {
+      out.push_back(format[i]);
+      continue;
+    }
+    if (i + 1 < format.size() && format[i + 1] == '%') {
+      out.push_back('%');
+      ++i;
+      continue;
+    }
+    std::string spec = "%";
+    std::size_t j = i + 1;
+    while (j < format.size() && std::strchr("-+ #0123456789.", format[j]) != nullptr) {
+      spec.push_back(format[j++]);
+    }
+    while (j < format.size() && std::strchr("hljztLq", format[j]) != nullptr) {
+      ++j;
+    }
+    if (j == format.size()) {
+      out.append(format, i, std::string::npos);
+      break;
+    }
+    const char conversion = format[j];
+    i = j;
+    if (next_arg == args.size()) {
+      out += "<missing>";
+      continue;
+    }
+    const DecodedArg& arg = args[next_arg++];
+    const std::int64_t as_int = arg.type == LogArgType::kInt      ? arg.i
+                                : arg.type == LogArgType::kUint   ? static_cast<std::int64_t>(arg.u)
+                                : arg.type == LogArgType::kDouble ? static_cast<std::int64_t>(arg.d)
+                                                                  : 0;
+    switch (conversion) {
+      case 'd':
+      case 'i':
+        AppendFormatted(&out, spec + "lld", static_cast<long long>(as_int));
+        break;
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+        AppendFormatted(&out, spec + "ll" + conversion,
+                        static_cast<unsigned long long>(arg.type == LogArgType::kUint ? arg.u
+                                                                                      : as_int));
+        break;
+      case 'c':
+        AppendFormatted(&out, spec + "c", static_cast<int>(as_int));
+        break;
+      case 'p':
+        AppendFormatted(&out, "0x%llx", static_cast<unsigned long long>(arg.u));
+        break;
+      case 's':
+        if (arg.type == LogArgType::kString) {
+          AppendFormatted(&out, spec + "s", arg.s.c_str());
+        } else {
+          out += std::to_string(as_int);
+        }
+        break;
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        AppendFormatted(&out, spec + conversion,
+                        arg.type == LogArgType::kDouble ? arg.d : static_cast<double>(as_int));
+        break;
+      default:
+        out += "<bad conversion>";
+        break;
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+const char* ToString(LogLevel level) {
+  switch (level) {
+    case LogLevel::kDebug:
+      return "DEBUG";
+    case LogLevel::kInfo:
+      return "INFO";
+    case LogLevel::kWarn:
+      return "WARN";
+    case LogLevel::kError:
+      return "ERROR";
+    case LogLevel::kOff:
+      return "OFF";
+  }
+  return "UNKNOWN";
+}
+
+Logger& Logger::Instance() {
+  static Logger logger;
+  return logger;
+}
+
+Logger::Logger() : clock_(Tracer::Instance()) {}
+
+Logger::~Logger() {
+  Stop();
+}
+
+bool Logger::Start(const LoggerConfig& config, std::string* reason) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    if (reason != nullptr) {
+      *reason = "logger already started";
+    }
+    return false;
+  }
+  file_ = std::fopen(config.path.c_str(), "wb");
+  if (file_ == nullptr) {
+    if (reason != nullptr) {
+      *reason = "cannot open " + config.path.string() + ": " + std::strerror(errno);
+    }
+    return false;
+  }
+  config_ = config;
+  origin_ticks_ = clock_.Now();
+  out_.assign(kMagic, sizeof(kMagic));
+  PutVarint(&out_, static_cast<std::uint64_t>(NowEpochMicros()));
+  site_cache_.clear();
+  running_ = true;
+  stopping_ = false;
+  thread_ = std::thread([this] { Run(); });
+  min_level_.store(config.min_level, std::memory_order_relaxed);
+  return true;
+}
+
+void Logger::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    min_level_.store(LogLevel::kOff, std::memory_order_relaxed);
+    stopping_ = true;
+  }
+  wake_cv_.notify_all();
+  thread_.join();
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::fclose(file_);
+  file_ = nullptr;
+  running_ = false;
+}
+
+void Logger::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!running_ || stopping_) {
+    return;
+  }
+  const std::uint64_t ticket = ++flush_requested_;
+  wake_cv_.notify_all();
+  flushed_cv_.wait(lock, [this, ticket] { return flush_done_ >= ticket || !running_; });
+}
+
+void Logger::SetMinLevel(LogLevel level) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_.min_level = level;
+  if (running_ && !stopping_) {
+    min_level_.store(level, std::memory_order_relaxed);
+  }
+}
+
+std::uint32_t Logger::Register(const LogSite* site) {
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  sites_.push_back(site);
+  return static_cast<std::uint32_t>(sites_.size() - 1);
+}
+
+LogBuffer& Logger::LocalBuffer() {
+  thread_local LocalBufferHolder holder;
+  if (!holder.buffer) {
+    holder.buffer = RegisterThread();
+  }
+  return *holder.buffer;
+}
+
+std::shared_ptr<LogBuffer> Logger::RegisterThread() {
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  // Indices are never reused, so a decoded thread id names one thread.
+  auto buffer = std::make_shared<LogBuffer>(next_thread_index_++);
+  buffers_.push_back(buffer);
+  return buffer;
+}
+
+void Logger::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_cv_.wait_for(lock, std::chrono::microseconds(config_.flush_interval_us),
+                      [this] { return stopping_ || flush_requested_ > flush_done_; });
+    const std::uint64_t requested = flush_requested_;
+    const bool stop = stopping_;
+    lock.unlock();
+    const LoggerStats drained = DrainAll();
+    lock.lock();
+    stats_.records += drained.records;
+    stats_.raw_bytes += drained.raw_bytes;
+    stats_.file_bytes += drained.file_bytes;
+    stats_.write_failures += drained.write_failures;
+    flush_done_ = requested;
+    flushed_cv_.notify_all();
+    if (stop) {
+      return;
+    }
+  }
+}
+
+LoggerStats Logger::DrainAll() {
+  std::vector<std::shared_ptr<LogBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    buffers = buffers_;
+  }
+  LoggerStats drained;
+  std::vector<const LogBuffer*> finished;
+  for (const auto& buffer : buffers) {
+    // Read before draining: a ring retired by then has committed its last
+    // record, so the drain below empties it for good.
+    const bool retired = buffer->retired();
+    buffer->Drain([this, &buffer, &drained](const char* data, std::size_t size) {
+      WriteRecord(*buffer, data, size);
+      ++drained.records;
+      drained.raw_bytes += size;
+    });
+    const std::uint64_t dropped = buffer->TakeNewDrops();
+    if (dropped > 0) {
+      out_.push_back(static_cast<char>(kDropTag));
+      PutVarint(&out_, buffer->thread_index());
+      PutVarint(&out_, dropped);
+    }
+    if (retired) {
+      finished.push_back(buffer.get());
+    }
+  }
+  if (!finished.empty()) {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    const auto done = [&finished](const std::shared_ptr<LogBuffer>& buffer) {
+      return std::find(finished.begin(), finished.end(), buffer.get()) != finished.end();
+    };
+    for (const auto& buffer : buffers_) {
+      if (done(buffer)) {
+        retired_dropped_ += buffer->dropped();
+      }
+    }
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(), done), buffers_.end());
+  }
+  if (!out_.empty()) {
+    // The file is torn from this batch on; the count lets callers notice.
+    const std::size_t written = std::fwrite(out_.data(), 1, out_.size(), file_);
+    if (written != out_.size() || std::fflush(file_) != 0) {
+      ++drained.write_failures;
+    }
+    drained.file_bytes = written;
+    out_.clear();
+  }
+  return drained;
+}
+
+void Logger::WriteRecord(const LogBuffer& buffer, const char* data, std::size_t size) {
+  log_internal::RecordHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.site >= site_cache_.size()) {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    while (site_cache_.size() < sites_.size()) {
+      const LogSite* site = sites_[site_cache_.size()];
+      out_.push_back(static_cast<char>(kSiteTag));
+      PutVarint(&out_, site_cache_.size());
+      out_.push_back(static_cast<char>(site->level));
+      PutVarint(&out_, static_cast<std::uint64_t>(site->line));
+      PutString(&out_, site->file);
+      PutString(&out_, site->format);
+      PutVarint(&out_, site->arg_count);
+      for (std::size_t i = 0; i < site->arg_count; ++i) {
+        out_.push_back(static_cast<char>(site->arg_types[i]));
+      }
+      site_cache_.push_back(site);
+    }
+  }
+  const LogSite* site = site_cache_[header.site];
+  const std::uint64_t ticks = header.ticks > origin_ticks_ ? header.ticks - origin_ticks_ : 0;
+  out_.push_back(static_cast<char>(kEntryTag));
+  PutVarint(&out_, header.site);
+  PutVarint(&out_, buffer.thread_index());
+  PutVarint(&out_, static_cast<std::uint64_t>(clock_.TicksToNs(ticks)));
+  const char* arg = data + sizeof(header);
+  const char* end = data + size;
+  for (std::size_t i = 0; i < site->arg_count && arg < end; ++i) {
+    switch (site->arg_types[i]) {
+      case LogArgType::kInt: {
+        std::int64_t value = 0;
+        std::memcpy(&value, arg, 8);
+        PutVarint(&out_, ZigZag(value));
+        arg += 8;
+        break;
+      }
+      case LogArgType::kUint: {
+        std::uint64_t value = 0;
+        std::memcpy(&value, arg, 8);
+        PutVarint(&out_, value);
+        arg += 8;
+        break;
+      }
+      case LogArgType::kDouble:
+        out_.append(arg, 8);
+        arg += 8;
+        break;
+      case LogArgType::kString: {
+        std::uint32_t length = 0;
+        std::memcpy(&length, arg, 4);
+        PutString(&out_, std::string_view(arg + 4, length));
+        arg += 4 + length;
+        break;
+      }
+    }
+  }
+}
+
+LoggerStats Logger::Stats() const {
+  LoggerStats stats;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats = stats_;
+  }
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  stats.dropped += retired_dropped_;
+  for (const auto& buffer : buffers_) {
+    stats.dropped += buffer->dropped();
+  }
+  stats.thread_buffers = buffers_.size();
+  return stats;
+}
+
+bool DecodeBinaryLog(const std::filesystem::path& path, std::vector<DecodedLogEntry>* entries,
+                     std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what;
+    }
+    return false;
+  };
+
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    return fail("cannot open " + path.string());
+  }
+  const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+  if (data.size() < sizeof(kMagic) || data.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) != 0) {
+    return fail("not a binary log: " + path.string());
+  }
+  Reader reader(std::string_view(data).substr(sizeof(kMagic)));
+  std::uint64_t origin_epoch_us = 0;
+  if (!reader.Varint(&origin_epoch_us)) {
+    return fail("truncated log header");
+  }
+
+  std::unordered_map<std::uint64_t, DecodedSite> sites;
+  std::vector<DecodedArg> args;
+  std::uint64_t last_ns = 0;
+  while (!reader.done()) {
+    std::uint8_t tag = 0;
+    reader.Byte(&tag);
+    if (tag == kSiteTag) {
+      std::uint64_t id = 0;
+      std::uint8_t level = 0;
+      std::uint64_t line = 0;
+      std::uint64_t count = 0;
+      DecodedSite site;
+      if (!reader.Varint(&id) || !reader.Byte(&level) || !reader.Varint(&line) ||
+          !reader.String(&site.file) || !reader.String(&site.format) || !reader.Varint(&count)) {
+        return fail("truncated call site");
+      }
+      site.level = static_cast<LogLevel>(level);
+      site.line = static_cast<int>(line);
+      for (std::uint64_t i = 0; i < count; ++i) {
+        std::uint8_t type = 0;
+        if (!reader.Byte(&type) || type > static_cast<std::uint8_t>(LogArgType::kString)) {
+          return fail("bad argument type in call site");
+        }
+        site.types.push_back(static_cast<LogArgType>(type));
+      }
+      sites[id] = std::move(site);
+    } else if (tag == kEntryTag) {
+      std::uint64_t id = 0;
+      std::uint64_t thread = 0;
+      std::uint64_t elapsed_ns = 0;
+      if (!reader.Varint(&id) || !reader.Varint(&thread) || !reader.Varint(&elapsed_ns)) {
+        return fail("truncated entry");
+      }
+      const auto site = sites.find(id);
+      if (site == sites.end()) {
+        return fail("entry for unknown call site " + std::to_string(id));
+      }
+      args.assign(site->second.types.size(), DecodedArg{});
+      for (std::size_t i = 0; i < args.size(); ++i) {
+        DecodedArg& arg = args[i];
+        arg.type = site->second.types[i];
+        std::uint64_t raw = 0;
+        std::string_view bytes;
+        bool ok = true;
+        switch (arg.type) {
+          case LogArgType::kInt:
+            ok = reader.Varint(&raw);
+            arg.i = UnZigZag(raw);
+            break;
+          case LogArgType::kUint:
+            ok = reader.Varint(&arg.u);
+            break;
+          case LogArgType::kDouble:
+            ok = reader.Raw(8, &bytes);
+            if (ok) {
+              std::memcpy(&arg.d, bytes.data(), 8);
+            }
+            break;
+          case LogArgType::kString:
+            ok = reader.String(&arg.s);
+            break;
+        }
+        if (!ok) {
+          return fail("truncated entry arguments");
+        }
+      }
+      DecodedLogEntry entry;
+      entry.elapsed_ns = elapsed_ns;
+      entry.epoch_us = static_cast<std::int64_t>(origin_epoch_us + elapsed_ns / 1000);
+      entry.level = site->second.level;
+      entry.thread_index = static_cast<std::uint32_t>(thread);
+      entry.file = site->second.file;
+      entry.line = site->second.line;
+      entry.text = Render(site->second.format, args);
+      entries->push_back(std::move(entry));
+      last_ns = elapsed_ns;
+    } else if (tag == kDropTag) {
+      std::uint64_t thread = 0;
+      std::uint64_t count = 0;
+      if (!reader.Varint(&thread) || !reader.Varint(&count)) {
+        return fail("truncated drop notice");
+      }
+      DecodedLogEntry entry;
+      entry.elapsed_ns = last_ns;
+      entry.epoch_us = static_cast<std::int64_t>(origin_epoch_us + last_ns / 1000);
+      entry.level = LogLevel::kWarn;
+      entry.thread_index = static_cast<std::uint32_t>(thread);
+      entry.file = "<logger>";
+      entry.text = std::to_string(count) + " records dropped (ring full)";
+      entries->push_back(std::move(entry));
+    } else {
+      return fail("unknown item tag " + std::to_string(tag));
+    }
+  }
+  return true;
+}
+
+std::string FormatLogEntry(const DecodedLogEntry& entry) {
+  const std::size_t slash = entry.file.find_last_of('/');
+  const std::string file = slash == std::string::npos ? entry.file : entry.file.substr(slash + 1);
+  std::string line = FormatRfc3339Micros(entry.epoch_us) + " " + ToString(entry.level) + " [t" +
+                     std::to_string(entry.thread_index) + "] " + file;
+  if (entry.line > 0) {
+    line += ":" + std::to_string(entry.line);
+  }
+  return line + " " + entry.text;
+}
+
+}  // namespace ulak::utils
@@ -0,0 +1,391 @@
+#pragma once
+
+#include "Tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Structured binary logging. A call site
+//
+//   ULAK_LOG_DEBUG("decoded %s frame in %u us", frame_id.c_str(), elapsed_us);
+//
+// registers its format string, file, line and argument types once; each call
+// then copies only the raw arguments and a timestamp into the calling thread's
+// ring. A background thread compresses records into the log file, and
+// DecodeBinaryLog() turns the file back into text offline. Formats are
+// checked like printf at compile time; arguments may be integers, enums,
+// floating point, `const char*`, std::string and std::string_view. `*` widths
+// and %n are not supported.
+namespace ulak::utils {
+
+enum class LogLevel : std::uint8_t {
+  kDebug,
+  kInfo,
+  kWarn,
+  kError,
+  kOff,
+};
+
+const char* ToString(LogLevel level);
+
+enum class LogArgType : std::uint8_t {
+  kInt,
+  kUint,
+  kDouble,
+  kString,
+};
+
+struct LogSite {
+  LogLevel level{LogLevel::kInfo};
+  const char* format{""};
+  const char* file{""};
+  int line{0};
+  const LogArgType* arg_types{nullptr};
+  std::size_t arg_count{0};
+};
+
+namespace log_internal {
+
+// Longer string arguments are truncated.
+inline constexpr std::size_t kMaxStringBytes = 1024;
+
+struct RecordHeader {
+  std::uint32_t site{0};
+  std::uint32_t size{0};
+  std::uint64_t ticks{0};
+};
+
+template <typename T>
+constexpr LogArgType ArgTypeOf() {
+  if constexpr (std::is_enum_v<T>) {
+    return ArgTypeOf<std::underlying_type_t<T>>();
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return LogArgType::kUint;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return LogArgType::kDouble;
+  } else if constexpr (std::is_integral_v<T>) {
+    return std::is_signed_v<T> ? LogArgType::kInt : LogArgType::kUint;
+  } else {
+    static_assert(std::is_convertible_v<const T&, std::string_view>, "unsupported log argument type");
+    return LogArgType::kString;
+  }
+}
+
+template <typename... Args>
+struct ArgTypes {
+  static constexpr std::size_t kCount = sizeof...(Args);
+  // One spare element so the array is never empty.
+  static constexpr LogArgType kTypes[kCount + 1] = {ArgTypeOf<Args>()..., LogArgType::kInt};
+};
+
+template <typename... Args>
+ArgTypes<std::decay_t<Args>...> TypesOf(const Args&...);
+
+// What the printf format check sees for each argument.
+template <typename T>
+auto FormatProxy(const T& value) {
+  if constexpr (std::is_enum_v<T>) {
+    return static_cast<std::underlying_type_t<T>>(value);
+  } else if constexpr (std::is_arithmetic_v<T> || std::is_pointer_v<T>) {
+    return value;
+  } else {
+    return static_cast<const char*>(nullptr);
+  }
+}
+
+// Never called; only lets the compiler check the format against the arguments.
+[[gnu::format(printf, 1, 2)]] inline void CheckFormat(const char*, ...) {}
+
+template <typename T>
+std::size_t EncodedSize(const T& value) {
+  if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+    return 8;
+  } else {
+    return 4 + std::min(std::string_view(value).size(), kMaxStringBytes);
+  }
+}
+
+// Call-site strings are short (ids, frame names); for those a libc memcpy()
+// call costs more than the copy.
+inline void CopyBytes(char* out, const char* in, std::size_t size) {
+  if (size > 64) {
+    std::memcpy(out, in, size);
+    return;
+  }
+  for (; size >= 8; size -= 8, out += 8, in += 8) {
+    std::memcpy(out, in, 8);
+  }
+  for (; size > 0; --size) {
+    *out++ = *in++;
+  }
+}
+
+template <typename T>
+void Encode(char** out, const T& value) {
+  if constexpr (std::is_enum_v<T>) {
+    Encode(out, static_cast<std::underlying_type_t<T>>(value));
+  } else if constexpr (std::is_floating_point_v<T>) {
+    const double raw = static_cast<double>(value);
+    std::memcpy(*out, &raw, 8);
+    *out += 8;
+  } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    const std::int64_t raw = static_cast<std::int64_t>(value);
+    std::memcpy(*out, &raw, 8);
+    *out += 8;
+  } else if constexpr (std::is_integral_v<T>) {
+    const std::uint64_t raw = static_cast<std::uint64_t>(value);
+    std::memcpy(*out, &raw, 8);
+    *out += 8;
+  } else {
+    const std::string_view text(value);
+    const std::uint32_t length = static_cast<std::uint32_t>(std::min(text.size(), kMaxStringBytes));
+    std::memcpy(*out, &length, 4);
+    CopyBytes(*out + 4, text.data(), length);
+    *out += 4 + length;
+  }
+}
+
+}  // namespace log_internal
+
+// Single-producer (the owning thread) / single-consumer (the logger thread)
+// byte ring of variable-size records. Records never wrap: the producer skips
+// the tail of the ring instead. A full ring drops the record rather than
+// blocking the caller. The owning thread retires the ring when it exits; the
+// consumer frees it once the last records are drained.
+class LogBuffer {
+ public:
+  static constexpr std::size_t kCapacity = 64 * 1024;
+
+  explicit LogBuffer(std::uint32_t thread_index)
+      : thread_index_(thread_index), bytes_(new char[kCapacity]) {}
+
+  // Producer: space for `size` contiguous bytes, or nullptr when full.
+  char* Reserve(std::size_t size) {
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    const std::size_t offset = static_cast<std::size_t>(head % kCapacity);
+    skip_ = kCapacity - offset < size ? kCapacity - offset : 0;
+    if (head + skip_ + size - tail_.load(std::memory_order_acquire) > kCapacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    if (skip_ >= sizeof(log_internal::RecordHeader)) {
+      // Size 0 tells the consumer to jump to the start of the ring.
+      std::memset(bytes_.get() + offset, 0, sizeof(log_internal::RecordHeader));
+    }
+    return bytes_.get() + (skip_ == 0 ? offset : 0);
+  }
+
+  void Commit(std::size_t size) {
+    head_.store(head_.load(std::memory_order_relaxed) + skip_ + size, std::memory_order_release);
+  }
+
+  // Consumer: hands each pending record to `on_record(data, size)`, then
+  // frees them.
+  template <typename F>
+  void Drain(F&& on_record) {
+    std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const std::uint64_t head = head_.load(std::memory_order_acquire);
+    while (tail < head) {
+      const std::size_t offset = static_cast<std::size_t>(tail % kCapacity);
+      const std::size_t room = kCapacity - offset;
+      log_internal::RecordHeader header;
+      if (room < sizeof(header)) {
+        tail += room;
+        continue;
+      }
+      std::memcpy(&header, bytes_.get() + offset, sizeof(header));
+      if (header.size == 0) {
+        tail += room;
+        continue;
+      }
+      on_record(bytes_.get() + offset, static_cast<std::size_t>(header.size));
+      tail += header.size;
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  // Consumer: drops since the previous call.
+  std::uint64_t TakeNewDrops() {
+    const std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    const std::uint64_t fresh = dropped - drops_reported_;
+    drops_reported_ = dropped;
+    return fresh;
+  }
+
+  // Producer, at thread exit: no records follow.
+  void Retire() { retired_.store(true, std::memory_order_release); }
+  bool retired() const { return retired_.load(std::memory_order_acquire); }
+
+  std::uint32_t thread_index() const { return thread_index_; }
+  std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  const std::uint32_t thread_index_;
+  std::unique_ptr<char[]> bytes_;
+  alignas(64) std::atomic<std::uint64_t> head_{0};
+  std::size_t skip_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::atomic<bool> retired_{false};
+  alignas(64) std::atomic<std::uint64_t> tail_{0};
+  std::uint64_t drops_reported_{0};
+};
+
+struct LoggerConfig {
+  std::filesystem::path path;
+  LogLevel min_level{LogLevel::kDebug};
+  // Background drain period; Flush() drains immediately.
+  std::int64_t flush_interval_us{20'000};
+};
+
+struct LoggerStats {
+  std::uint64_t records{0};
+  std::uint64_t dropped{0};
+  // Raw bytes drained from the rings vs compressed bytes written.
+  std::uint64_t raw_bytes{0};
+  std::uint64_t file_bytes{0};
+  // Drains whose fwrite or fflush failed; their records are lost.
+  std::uint64_t write_failures{0};
+  // Rings of threads that have logged and not yet been freed.
+  std::uint64_t thread_buffers{0};
+};
+
+// Process-wide logger. Until Start() every level is disabled, so call sites
+// in library code cost one relaxed load when nobody logs.
+class Logger {
+ public:
+  static Logger& Instance();
+
+  Logger(const Logger&) = delete;
+  Logger& operator=(const Logger&) = delete;
+  ~Logger();
+
+  bool Start(const LoggerConfig& config, std::string* reason);
+  // Drains every ring, closes the file.
+  void Stop();
+  // Blocks until records logged before the call are in the file.
+  void Flush();
+
+  bool Enabled(LogLevel level) const {
+    return level >= min_level_.load(std::memory_order_relaxed);
+  }
+  void SetMinLevel(LogLevel level);
+
+  // Called once per call site (from the macro's static initializer).
+  std::uint32_t Register(const LogSite* site);
+
+  template <typename... Args>
+  void Write(std::uint32_t site, const Args&... args) {
+    const std::size_t size =
+        sizeof(log_internal::RecordHeader) + (std::size_t{0} + ... + log_internal::EncodedSize(args));
+    LogBuffer& buffer = LocalBuffer();
+    char* out = buffer.Reserve(size);
+    if (out == nullptr) {
+      return;
+    }
+    const log_internal::RecordHeader header{site, static_cast<std::uint32_t>(size), clock_.Now()};
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    (log_internal::Encode(&out, args), ...);
+    buffer.Commit(size);
+  }
+
+  LoggerStats Stats() const;
+
+ private:
+  Logger();
+  LogBuffer& LocalBuffer();
+  std::shared_ptr<LogBuffer> RegisterThread();
+  void Run();
+  // Logger thread only.
+  LoggerStats DrainAll();
+  void WriteRecord(const LogBuffer& buffer, const char* data, std::size_t size);
+
+  // Timestamps share the tracer's clock (TSC when invariant).
+  Tracer& clock_;
+  std::atomic<LogLevel> min_level_{LogLevel::kOff};
+
+  mutable std::mutex registry_mutex_;
+  std::vector<const LogSite*> sites_;
+  std::vector<std::shared_ptr<LogBuffer>> buffers_;
+  std::uint32_t next_thread_index_{0};
+  // Drops counted by rings that have since been freed.
+  std::uint64_t retired_dropped_{0};
+
+  // Logger thread state.
+  std::FILE* file_{nullptr};
+  std::string out_;
+  // Sites already written to the current file, by id.
+  std::vector<const LogSite*> site_cache_;
+  std::uint64_t origin_ticks_{0};
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_cv_;
+  std::condition_variable flushed_cv_;
+  LoggerConfig config_;
+  bool running_{false};
+  bool stopping_{false};
+  std::uint64_t flush_requested_{0};
+  std::uint64_t flush_done_{0};
+  LoggerStats stats_;
+  std::thread thread_;
+};
+
+struct DecodedLogEntry {
+  std::int64_t epoch_us{0};
+  // Since Start(), at the tracer clock's resolution.
+  std::uint64_t elapsed_ns{0};
+  LogLevel level{LogLevel::kInfo};
+  std::uint32_t thread_index{0};
+  std::string file;
+  int line{0};
+  std::string text;
+};
+
+// Offline decoder. Dropped-record notices come back as kWarn entries from
+// "<logger>". Fails on a truncated or corrupt file, keeping what decoded.
+bool DecodeBinaryLog(const std::filesystem::path& path, std::vector<DecodedLogEntry>* entries,
+                     std::string* reason);
+
+// "2026-02-21T00:00:01.250000Z DEBUG [t3] TelemetryFrame.cpp:42 text"
+std::string FormatLogEntry(const DecodedLogEntry& entry);
+
+}  // namespace ulak::utils
+
+#define ULAK_LOG_CONCAT_INNER(a, b) a##b
+#define ULAK_LOG_CONCAT(a, b) ULAK_LOG_CONCAT_INNER(a, b)
+
+#define ULAK_LOG(level, format, ...)                                                              \
+  do {                                                                                            \
+    if (::ulak::utils::Logger::Instance().Enabled(level)) {                                       \
+      if (false) {                                                                                \
+        [](const auto&... args) {                                                                 \
+          ::ulak::utils::log_internal::CheckFormat(                                               \
+              format, ::ulak::utils::log_internal::FormatProxy(args)...);                         \
+        }(__VA_ARGS__);                                                                           \
+      }                                                                                           \
+      using UlakLogTypes = decltype(::ulak::utils::log_internal::TypesOf(__VA_ARGS__));           \
+      static constexpr ::ulak::utils::LogSite kUlakLogSite{                                       \
+          level, format, __FILE__, __LINE__, UlakLogTypes::kTypes, UlakLogTypes::kCount};         \
+      static const std::uint32_t kUlakLogSiteId =                                                 \
+          ::ulak::utils::Logger::Instance().Register(&kUlakLogSite);                              \
+      ::ulak::utils::Logger::Instance().Write(kUlakLogSiteId, ##__VA_ARGS__);                     \
+    }                                                                                             \
+  } while (false)
+
+#define ULAK_LOG_DEBUG(format, ...) ULAK_LOG(::ulak::utils::LogLevel::kDebug, format, ##__VA_ARGS__)
+#define ULAK_LOG_INFO(format, ...) ULAK_LOG(::ulak::utils::LogLevel::kInfo, format, ##__VA_ARGS__)
+#define ULAK_LOG_WARN(format, ...) ULAK_LOG(::ulak::utils::LogLevel::kWarn, format, ##__VA_ARGS__)
+#define ULAK_LOG_ERROR(format, ...) ULAK_LOG(::ulak::utils::LogLevel::kError, format, ##__VA_ARGS__)
@@ -0,0 +1,197 @@
+#include "ColumnCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ulak::utils {
+namespace {
+
+void PutVarint(std::uint64_t value, std::vector<std::uint8_t>* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<std::uint8_t>(value));
+}
+
+bool GetVarint(const std::uint8_t* data, std::size_t size, std::size_t* position,
+               std::uint64_t* value) {
+  std::uint64_t result = 0;
+  for (int shift = 0; shift < 64 && *position < size; shift += 7) {
+    const std::uint8_t byte = data[(*position)++];
+    result |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+int BitWidth(std::uint64_t value) {
+  int width = 0;
+  while (value != 0) {
+    ++width;
+    value >>= 1;
+  }
+  return width;
+}
+
+std::uint64_t LowBits(std::uint64_t value, int width) {
+  return width >= 64 ? value : value & ((std::uint64_t{1} << width) - 1);
+}
+
+// LSB-first bit stream over 64-bit little-endian words.
+class BitWriter {
+ public:
+  explicit BitWriter(std::vector<std::uint8_t>* out) : out_(out) {}
+
+  void Put(std::uint64_t value, int width) {
+    if (width == 0) {
+      return;
+    }
+    value = LowBits(value, width);
+    word_ |= value << used_;
+    const int total = used_ + width;
+    if (total < 64) {
+      used_ = total;
+      return;
+    }
+    Emit(8);
+    word_ = used_ == 0 ? 0 : value >> (64 - used_);
+    used_ = total - 64;
+  }
+
+  void Flush() {
+    Emit((used_ + 7) / 8);
+    word_ = 0;
+    used_ = 0;
+  }
+
+ private:
+  void Emit(int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+      out_->push_back(static_cast<std::uint8_t>(word_ >> (8 * i)));
+    }
+  }
+
+  std::vector<std::uint8_t>* out_;
+  std::uint64_t word_{0};
+  int used_{0};
+};
+
+// Reader for one block; the caller checks the block fits in the buffer.
+class BitReader {
+ public:
+  BitReader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+  std::uint64_t Get(int width) {
+    if (width == 0) {
+      return 0;
+    }
+    if (available_ >= width) {
+      const std::uint64_t value = LowBits(word_, width);
+      word_ = width >= 64 ? 0 : word_ >> width;
+      available_ -= width;
+      return value;
+    }
+    const std::uint64_t next = Load();
+    const int from_next = width - available_;
+    const std::uint64_t value = LowBits(word_ | (next << available_), width);
+    word_ = from_next >= 64 ? 0 : next >> from_next;
+    available_ = 64 - from_next;
+    return value;
+  }
+
+ private:
+  std::uint64_t Load() {
+    std::uint8_t bytes[8] = {};
+    const std::size_t take = std::min<std::size_t>(8, size_ - position_);
+    std::memcpy(bytes, data_ + position_, take);
+    position_ += take;
+    std::uint64_t word = 0;
+    for (int i = 7; i >= 0; --i) {
+      word = (word << 8) | bytes[i];
+    }
+    return word;
+  }
+
+  const std::uint8_t* data_;
+  std::size_t size_;
+  std::size_t position_{0};
+  std::uint64_t word_{0};
+  int available_{0};
+};
+
+}  // namespace
+
+void EncodeDeltaColumn(const std::int64_t* values, std::size_t count,
+                       std::vector<std::uint8_t>* out) {
+  if (count == 0) {
+    return;
+  }
+  PutVarint(ZigZagEncode(values[0]), out);
+
+  std::int64_t deltas[kDeltaBlockSize];
+  for (std::size_t begin = 1; begin < count; begin += kDeltaBlockSize) {
+    const std::size_t block = std::min(kDeltaBlockSize, count - begin);
+    std::int64_t minimum = 0;
+    for (std::size_t i = 0; i < block; ++i) {
+      // Wrapping subtraction: extreme values still round-trip.
+      deltas[i] = static_cast<std::int64_t>(static_cast<std::uint64_t>(values[begin + i]) -
+                                            static_cast<std::uint64_t>(values[begin + i - 1]));
+      minimum = i == 0 ? deltas[i] : std::min(minimum, deltas[i]);
+    }
+    std::uint64_t spread = 0;
+    for (std::size_t i = 0; i < block; ++i) {
+      spread |= static_cast<std::uint64_t>(deltas[i]) - static_cast<std::uint64_t>(minimum);
+    }
+    const int width = BitWidth(spread);
+
+    PutVarint(ZigZagEncode(minimum), out);
+    out->push_back(static_cast<std::uint8_t>(width));
+    BitWriter writer(out);
+    for (std::size_t i = 0; i < block; ++i) {
+      writer.Put(static_cast<std::uint64_t>(deltas[i]) - static_cast<std::uint64_t>(minimum),
+                 width);
+    }
+    writer.Flush();
+  }
+}
+
+bool DecodeDeltaColumn(const std::uint8_t* data, std::size_t size, std::size_t count,
+                       std::int64_t* values) {
+  if (count == 0) {
+    return true;
+  }
+  std::size_t position = 0;
+  std::uint64_t first = 0;
+  if (!GetVarint(data, size, &position, &first)) {
+    return false;
+  }
+  std::uint64_t current = static_cast<std::uint64_t>(ZigZagDecode(first));
+  values[0] = static_cast<std::int64_t>(current);
+
+  for (std::size_t begin = 1; begin < count; begin += kDeltaBlockSize) {
+    const std::size_t block = std::min(kDeltaBlockSize, count - begin);
+    std::uint64_t minimum = 0;
+    if (!GetVarint(data, size, &position, &minimum) || position >= size) {
+      return false;
+    }
+    const int width = data[position++];
+    const std::size_t bytes = (block * static_cast<std::size_t>(width) + 7) / 8;
+    if (width > 64 || size - position < bytes) {
+      return false;
+    }
+    const auto base = static_cast<std::uint64_t>(ZigZagDecode(minimum));
+    BitReader reader(data + position, bytes);
+    for (std::size_t i = 0; i < block; ++i) {
+      current += base + reader.Get(width);
+      values[begin + i] = static_cast<std::int64_t>(current);
+    }
+    position += bytes;
+  }
+  return position == size;
+}
+
+}  // namespace ulak::utils
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ulak::utils {
+
+inline std::uint64_t ZigZagEncode(std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t ZigZagDecode(std::uint64_t value) {
+  return static_cast<std::int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// Integer column codec for slowly changing series (timestamps, quantized
+// positions, enum ids). Values are delta-coded; deltas are grouped in blocks
+// of kDeltaBlockSize and stored as a zigzag varint block minimum followed by
+// (delta - minimum) bit-packed at the block's width. A constant-slope series
+// (fixed-rate timestamps) packs to 0 bits per value.
+inline constexpr std::size_t kDeltaBlockSize = 128;
+
+// Appends the encoding of `values[0, count)` to `out`.
+void EncodeDeltaColumn(const std::int64_t* values, std::size_t count,
+                       std::vector<std::uint8_t>* out);
+
+// Decodes exactly `count` values from `data`. Returns false on truncated or
+// malformed input.
+bool DecodeDeltaColumn(const std::uint8_t* data, std::size_t size, std::size_t count,
+                       std::int64_t* values);
+
+}  // namespace ulak::utils
@@ -0,0 +1,214 @@
+#include "CorrelationId.h"
+
+#include <cstring>
+#include <random>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ULAK_UUID_HEX_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ULAK_UUID_HEX_NEON 1
+#endif
+
+namespace ulak::utils {
+namespace {
+
+std::uint64_t RotateLeft(std::uint64_t value, int shift) {
+  return (value << shift) | (value >> (64 - shift));
+}
+
+std::uint64_t SplitMix64(std::uint64_t* state) {
+  std::uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// xoshiro256** (Blackman & Vigna). Not cryptographic; correlation ids only
+// need uniqueness, and the OS seed keeps streams independent across threads
+// and process restarts.
+class Xoshiro256StarStar {
+ public:
+  Xoshiro256StarStar() {
+    if (!SeedFromOs()) {
+      std::random_device device;
+      std::uint64_t mix = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+      for (auto& word : state_) {
+        word = SplitMix64(&mix);
+      }
+    }
+    if ((state_[0] | state_[1] | state_[2] | state_[3]) == 0) {
+      std::uint64_t mix = 0x2545F4914F6CDD1DULL;
+      for (auto& word : state_) {
+        word = SplitMix64(&mix);
+      }
+    }
+  }
+
+  std::uint64_t Next() {
+    const std::uint64_t result = RotateLeft(state_[1] * 5, 7) * 9;
+    const std::uint64_t shifted = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= shifted;
+    state_[3] = RotateLeft(state_[3], 45);
+    return result;
+  }
+
+ private:
+  bool SeedFromOs() {
+#if defined(__linux__)
+    std::size_t filled = 0;
+    auto* bytes = reinterpret_cast<unsigned char*>(state_);
+    while (filled < sizeof(state_)) {
+      const ssize_t got = getrandom(bytes + filled, sizeof(state_) - filled, 0);
+      if (got <= 0) {
+        return false;
+      }
+      filled += static_cast<std::size_t>(got);
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  std::uint64_t state_[4]{};
+};
+
+Xoshiro256StarStar& ThreadGenerator() {
+  thread_local Xoshiro256StarStar generator;
+  return generator;
+}
+
+void StoreBigEndian(std::uint64_t value, unsigned char* out) {
+  for (int index = 7; index >= 0; --index) {
+    out[index] = static_cast<unsigned char>(value & 0xFF);
+    value >>= 8;
+  }
+}
+
+// Encodes 16 bytes as 32 lowercase hex characters.
+void HexEncode16(const unsigned char* bytes, char* out) {
+#if defined(ULAK_UUID_HEX_SSE2)
+  const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+  const __m128i low_mask = _mm_set1_epi8(0x0F);
+  const __m128i high = _mm_and_si128(_mm_srli_epi16(input, 4), low_mask);
+  const __m128i low = _mm_and_si128(input, low_mask);
+  const __m128i first = _mm_unpacklo_epi8(high, low);
+  const __m128i second = _mm_unpackhi_epi8(high, low);
+  // nibble + '0', plus ('a' - '0' - 10) for nibbles above 9.
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i ascii_zero = _mm_set1_epi8('0');
+  const __m128i letter_offset = _mm_set1_epi8('a' - '0' - 10);
+  const __m128i first_hex = _mm_add_epi8(
+      _mm_add_epi8(first, ascii_zero),
+      _mm_and_si128(_mm_cmpgt_epi8(first, nine), letter_offset));
+  const __m128i second_hex = _mm_add_epi8(
+      _mm_add_epi8(second, ascii_zero),
+      _mm_and_si128(_mm_cmpgt_epi8(second, nine), letter_offset));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), first_hex);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), second_hex);
+#elif defined(ULAK_UUID_HEX_NEON)
+  static const std::uint8_t kDigits[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                           '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+  const uint8x16_t table = vld1q_u8(kDigits);
+  const uint8x16_t input = vld1q_u8(bytes);
+  const uint8x16_t high = vqtbl1q_u8(table, vshrq_n_u8(input, 4));
+  const uint8x16_t low = vqtbl1q_u8(table, vandq_u8(input, vdupq_n_u8(0x0F)));
+  const uint8x16x2_t zipped = vzipq_u8(high, low);
+  vst1q_u8(reinterpret_cast<std::uint8_t*>(out), zipped.val[0]);
+  vst1q_u8(reinterpret_cast<std::uint8_t*>(out + 16), zipped.val[1]);
+#else
+  static const char kDigits[] = "0123456789abcdef";
+  for (int index = 0; index < 16; ++index) {
+    out[2 * index] = kDigits[bytes[index] >> 4];
+    out[2 * index + 1] = kDigits[bytes[index] & 0x0F];
+  }
+#endif
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+}  // namespace
+
+Uuid128 GenerateUuidV4() {
+  auto& generator = ThreadGenerator();
+  Uuid128 value;
+  value.hi = generator.Next();
+  value.lo = generator.Next();
+  // Version 4 in bits 12-15 of time_hi, RFC 4122 variant (10xx) in clock_seq_hi.
+  value.hi = (value.hi & ~0xF000ULL) | 0x4000ULL;
+  value.lo = (value.lo & ~(0xC0ULL << 56)) | (0x80ULL << 56);
+  return value;
+}
+
+void FormatUuid(const Uuid128& value, char* out) {
+  unsigned char bytes[16];
+  StoreBigEndian(value.hi, bytes);
+  StoreBigEndian(value.lo, bytes + 8);
+
+  char hex[32];
+  HexEncode16(bytes, hex);
+  std::memcpy(out, hex, 8);
+  out[8] = '-';
+  std::memcpy(out + 9, hex + 8, 4);
+  out[13] = '-';
+  std::memcpy(out + 14, hex + 12, 4);
+  out[18] = '-';
+  std::memcpy(out + 19, hex + 16, 4);
+  out[23] = '-';
+  std::memcpy(out + 24, hex + 20, 12);
+}
+
+bool ParseUuid(std::string_view text, Uuid128* out) {
+  if (out == nullptr || text.size() != kUuidTextLength) {
+    return false;
+  }
+  std::uint64_t halves[2] = {0, 0};
+  int nibble_count = 0;
+  for (std::size_t index = 0; index < text.size(); ++index) {
+    if (index == 8 || index == 13 || index == 18 || index == 23) {
+      if (text[index] != '-') {
+        return false;
+      }
+      continue;
+    }
+    const int nibble = HexValue(text[index]);
+    if (nibble < 0) {
+      return false;
+    }
+    auto& half = halves[nibble_count / 16];
+    half = (half << 4) | static_cast<std::uint64_t>(nibble);
+    ++nibble_count;
+  }
+  out->hi = halves[0];
+  out->lo = halves[1];
+  return true;
+}
+
+std::string GenerateCorrelationId() {
+  char buffer[kUuidTextLength];
+  FormatUuid(GenerateUuidV4(), buffer);
+  return std::string(buffer, kUuidTextLength);
+}
+
+}  // namespace ulak::utils
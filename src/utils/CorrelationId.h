@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ulak::utils {
+
+// Binary UUID, big-endian halves (hi holds the first 8 bytes of the text form).
+struct Uuid128 {
+  std::uint64_t hi{0};
+  std::uint64_t lo{0};
+
+  bool operator==(const Uuid128& other) const { return hi == other.hi && lo == other.lo; }
+  bool operator!=(const Uuid128& other) const { return !(*this == other); }
+  bool operator<(const Uuid128& other) const {
+    return hi != other.hi ? hi < other.hi : lo < other.lo;
+  }
+};
+
+// For dedup tables keyed by correlation id (e.g. the 60s idempotency window).
+struct Uuid128Hash {
+  std::size_t operator()(const Uuid128& value) const {
+    // Random v4 bits are already uniform; fold the halves.
+    return static_cast<std::size_t>(value.hi ^ (value.lo * 0x9E3779B97F4A7C15ULL));
+  }
+};
+
+inline constexpr std::size_t kUuidTextLength = 36;
+
+// Random UUIDv4 from a per-thread xoshiro256** generator seeded from the OS
+// (getrandom on Linux). No locks, no allocation.
+Uuid128 GenerateUuidV4();
+
+// Writes the canonical 8-4-4-4-12 lowercase form into `out` (exactly 36 bytes,
+// not NUL-terminated). Hex encoding is vectorized on SSE2 / NEON targets.
+void FormatUuid(const Uuid128& value, char* out);
+
+// Parses the canonical text form (either hex case). Returns false on bad input.
+bool ParseUuid(std::string_view text, Uuid128* out);
+
+// Convenience for envelope fields: GenerateUuidV4 formatted as a string.
+std::string GenerateCorrelationId();
+
+}  // namespace ulak::utils
@@ -0,0 +1,108 @@
+#include "HdrHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ulak::utils {
+namespace {
+
+int MostSignificantBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - __builtin_clzll(value);
+#else
+  int bit = 0;
+  while (value >>= 1) {
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+}  // namespace
+
+std::size_t HdrHistogram::IndexFor(std::uint64_t value) {
+  if (value < kSubBucketCount) {
+    return static_cast<std::size_t>(value);
+  }
+  const int shift = MostSignificantBit(value) - (kSubBucketBits - 1);
+  const std::uint64_t sub_bucket = value >> shift;
+  return kSubBucketCount + static_cast<std::size_t>(shift - 1) * kHalfSubBucketCount +
+         static_cast<std::size_t>(sub_bucket - kHalfSubBucketCount);
+}
+
+std::uint64_t HdrHistogram::UpperEdgeFor(std::size_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  const std::size_t offset = index - kSubBucketCount;
+  const int shift = static_cast<int>(offset / kHalfSubBucketCount) + 1;
+  const std::uint64_t sub_bucket = offset % kHalfSubBucketCount + kHalfSubBucketCount;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+void HdrHistogram::Record(std::uint64_t value) {
+  RecordN(value, 1);
+}
+
+void HdrHistogram::RecordN(std::uint64_t value, std::uint64_t count) {
+  if (count == 0) {
+    return;
+  }
+  value = std::min(value, kMaxTrackableValue);
+  counts_[IndexFor(value)] += count;
+  if (total_count_ == 0 || value < min_) {
+    min_ = value;
+  }
+  max_ = std::max(max_, value);
+  total_count_ += count;
+  sum_ += static_cast<long double>(value) * count;
+}
+
+void HdrHistogram::Merge(const HdrHistogram& other) {
+  if (other.total_count_ == 0) {
+    return;
+  }
+  for (std::size_t index = 0; index < kBucketCount; ++index) {
+    counts_[index] += other.counts_[index];
+  }
+  if (total_count_ == 0 || other.min_ < min_) {
+    min_ = other.min_;
+  }
+  max_ = std::max(max_, other.max_);
+  total_count_ += other.total_count_;
+  sum_ += other.sum_;
+}
+
+void HdrHistogram::Reset() {
+  counts_.fill(0);
+  total_count_ = 0;
+  min_ = 0;
+  max_ = 0;
+  sum_ = 0.0L;
+}
+
+std::uint64_t HdrHistogram::ValueAtPercentile(double p) const {
+  if (total_count_ == 0) {
+    return 0;
+  }
+  p = std::clamp(p, 0.0, 100.0);
+  const auto target = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total_count_))));
+  std::uint64_t seen = 0;
+  for (std::size_t index = 0; index < kBucketCount; ++index) {
+    seen += counts_[index];
+    if (seen >= target) {
+      return std::min(UpperEdgeFor(index), max_);
+    }
+  }
+  return max_;
+}
+
+double HdrHistogram::mean() const {
+  if (total_count_ == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(sum_ / total_count_);
+}
+
+}  // namespace ulak::utils
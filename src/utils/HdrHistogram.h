@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ulak::utils {
+
+// Fixed-memory log-linear histogram in the style of HdrHistogram: values below
+// 128 are exact, larger values keep 7 significant bits (within 1/64 relative).
+// Covers 0 .. 2^40 (about 12.7 days in microseconds); larger values saturate.
+// Not thread-safe; give each writer its own instance and Merge() them.
+class HdrHistogram {
+ public:
+  static constexpr int kSubBucketBits = 7;
+  static constexpr std::uint64_t kMaxTrackableValue = (1ULL << 40) - 1;
+
+  void Record(std::uint64_t value);
+  void RecordN(std::uint64_t value, std::uint64_t count);
+  void Merge(const HdrHistogram& other);
+  void Reset();
+
+  // Value at percentile `p` in [0, 100]; 0 when empty. Reported values are
+  // the upper edge of their bucket.
+  std::uint64_t ValueAtPercentile(double p) const;
+
+  std::uint64_t count() const { return total_count_; }
+  std::uint64_t min() const { return total_count_ == 0 ? 0 : min_; }
+  std::uint64_t max() const { return max_; }
+  double mean() const;
+
+ private:
+  static constexpr std::size_t kSubBucketCount = 1U << kSubBucketBits;
+  static constexpr std::size_t kHalfSubBucketCount = kSubBucketCount / 2;
+  static constexpr std::size_t kBucketCount =
+      kSubBucketCount + (40 - kSubBucketBits) * kHalfSubBucketCount;
+
+  static std::size_t IndexFor(std::uint64_t value);
+  static std::uint64_t UpperEdgeFor(std::size_t index);
+
+  std::array<std::uint64_t, kBucketCount> counts_{};
+  std::uint64_t total_count_{0};
+  std::uint64_t min_{0};
+  std::uint64_t max_{0};
+  long double sum_{0.0L};
+};
+
+}  // namespace ulak::utils
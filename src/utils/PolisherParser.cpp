@@ -0,0 +1,644 @@
+#include "PolisherParser.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <unordered_set>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ULAK_POLISHER_HAS_MMAP 1
+#endif
+
+namespace ulak::utils {
+namespace {
+
+constexpr std::string_view kStartMarker = "@polisher_start";
+constexpr std::string_view kEndMarker = "@polisher_end";
+constexpr std::string_view kParamMarker = "@polisher_param";
+
+// Read-only view of a script file: mmap on POSIX, a heap copy elsewhere.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() {
+#ifdef ULAK_POLISHER_HAS_MMAP
+    if (mapped_ != nullptr) {
+      munmap(mapped_, size_);
+    }
+#endif
+  }
+
+  bool Open(const std::filesystem::path& path, PolisherParseError* error) {
+#ifdef ULAK_POLISHER_HAS_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      *error = errno == ENOENT ? PolisherParseError::kMissingFile : PolisherParseError::kReadFailed;
+      return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      *error = PolisherParseError::kReadFailed;
+      return false;
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ > 0) {
+      void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED) {
+        ::close(fd);
+        *error = PolisherParseError::kReadFailed;
+        return false;
+      }
+      mapped_ = mapped;
+    }
+    ::close(fd);
+    return true;
+#else
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+      *error = PolisherParseError::kMissingFile;
+      return false;
+    }
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+      *error = PolisherParseError::kReadFailed;
+      return false;
+    }
+    copy_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    return true;
+#endif
+  }
+
+  std::string_view view() const {
+#ifdef ULAK_POLISHER_HAS_MMAP
+    return mapped_ == nullptr ? std::string_view()
+                              : std::string_view(static_cast<const char*>(mapped_), size_);
+#else
+    return copy_;
+#endif
+  }
+
+ private:
+#ifdef ULAK_POLISHER_HAS_MMAP
+  void* mapped_{nullptr};
+  std::size_t size_{0};
+#else
+  std::string copy_;
+#endif
+};
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool IsIdentStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool IsIdentChar(char c) {
+  return IsIdentStart(c) || (c >= '0' && c <= '9');
+}
+
+std::string_view Trim(std::string_view text) {
+  while (!text.empty() && IsSpace(text.front())) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && IsSpace(text.back())) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+// Markers may be written bare or inside a comment ("# @polisher_start").
+std::string_view StripMarkerComment(std::string_view line) {
+  line = Trim(line);
+  if (!line.empty() && line.front() == '#') {
+    line = Trim(line.substr(1));
+  }
+  return line;
+}
+
+// Finds a line consisting only of `marker`, starting at `from`. Returns the
+// offset of the line start, or npos.
+std::size_t FindMarkerLine(std::string_view source, std::string_view marker, std::size_t from) {
+  while (from < source.size()) {
+    const std::size_t hit = source.find(marker, from);
+    if (hit == std::string_view::npos) {
+      return std::string_view::npos;
+    }
+    const std::size_t line_begin = source.rfind('\n', hit == 0 ? 0 : hit - 1);
+    const std::size_t begin = (line_begin == std::string_view::npos || hit == 0) ? 0 : line_begin + 1;
+    std::size_t end = source.find('\n', hit);
+    if (end == std::string_view::npos) {
+      end = source.size();
+    }
+    if (StripMarkerComment(source.substr(begin, end - begin)) == marker) {
+      return begin;
+    }
+    from = hit + marker.size();
+  }
+  return std::string_view::npos;
+}
+
+struct BlockLocation {
+  bool found{false};
+  bool terminated{false};
+  // Body between the marker lines and the 1-based line number of its first line.
+  std::string_view body;
+  int first_line{0};
+};
+
+BlockLocation LocateBlock(std::string_view source) {
+  BlockLocation location;
+  const std::size_t start = FindMarkerLine(source, kStartMarker, 0);
+  if (start == std::string_view::npos) {
+    return location;
+  }
+  location.found = true;
+  std::size_t body_begin = source.find('\n', start);
+  body_begin = body_begin == std::string_view::npos ? source.size() : body_begin + 1;
+  location.first_line =
+      static_cast<int>(std::count(source.begin(), source.begin() + body_begin, '\n')) + 1;
+
+  const std::size_t end = FindMarkerLine(source, kEndMarker, body_begin);
+  if (end == std::string_view::npos) {
+    location.body = source.substr(body_begin);
+    return location;
+  }
+  location.terminated = true;
+  location.body = source.substr(body_begin, end - body_begin);
+  return location;
+}
+
+std::uint64_t HashBlock(const BlockLocation& location) {
+  // FNV-1a over the block text; the start line is mixed in so that reported
+  // line numbers stay correct when lines are added above the block.
+  std::uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](unsigned char byte) {
+    hash ^= byte;
+    hash *= 1099511628211ull;
+  };
+  for (int shift = 0; shift < 32; shift += 8) {
+    mix(static_cast<unsigned char>(static_cast<std::uint32_t>(location.first_line) >> shift));
+  }
+  mix(location.found ? 1 : 0);
+  mix(location.terminated ? 1 : 0);
+  for (const char c : location.body) {
+    mix(static_cast<unsigned char>(c));
+  }
+  return hash;
+}
+
+enum class LiteralKind {
+  kString,
+  kInt,
+  kFloat,
+  kBool,
+};
+
+struct Literal {
+  LiteralKind kind{LiteralKind::kString};
+  std::string text;
+  double number{0.0};
+  bool boolean{false};
+};
+
+bool ParseNumber(std::string_view token, Literal* out) {
+  if (token.empty()) {
+    return false;
+  }
+  bool integral = true;
+  for (std::size_t index = 0; index < token.size(); ++index) {
+    const char c = token[index];
+    if (c >= '0' && c <= '9') {
+      continue;
+    }
+    if ((c == '-' || c == '+') && index == 0) {
+      continue;
+    }
+    integral = false;
+  }
+  const std::string copy(token);
+  char* end = nullptr;
+  errno = 0;
+  const double value = std::strtod(copy.c_str(), &end);
+  if (end != copy.c_str() + copy.size() || errno == ERANGE || copy == "-" || copy == "+") {
+    return false;
+  }
+  // strtod also accepts "inf", "nan" and hex floats; Python-style decimals only.
+  for (const char c : copy) {
+    if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+      return false;
+    }
+  }
+  out->kind = integral ? LiteralKind::kInt : LiteralKind::kFloat;
+  out->number = value;
+  return true;
+}
+
+// Parses one literal at the front of `text` and advances it.
+bool ParseLiteral(std::string_view* text, Literal* out) {
+  std::string_view rest = Trim(*text);
+  if (rest.empty()) {
+    return false;
+  }
+  const char quote = rest.front();
+  if (quote == '"' || quote == '\'') {
+    const std::size_t close = rest.find(quote, 1);
+    if (close == std::string_view::npos) {
+      return false;
+    }
+    out->kind = LiteralKind::kString;
+    out->text = std::string(rest.substr(1, close - 1));
+    *text = rest.substr(close + 1);
+    return true;
+  }
+
+  std::size_t length = 0;
+  while (length < rest.size() && rest[length] != ',' && rest[length] != ')' &&
+         rest[length] != '#' && !IsSpace(rest[length])) {
+    ++length;
+  }
+  const std::string_view token = rest.substr(0, length);
+  *text = rest.substr(length);
+  if (token == "True" || token == "False") {
+    out->kind = LiteralKind::kBool;
+    out->boolean = token == "True";
+    return true;
+  }
+  return ParseNumber(token, out);
+}
+
+struct Attributes {
+  std::optional<std::string> label;
+  std::optional<std::string> type;
+  std::optional<Literal> min;
+  std::optional<Literal> max;
+  std::optional<Literal> step;
+};
+
+bool ParseAttributes(std::string_view line, Attributes* attributes, std::string* reason) {
+  std::string_view rest = Trim(line.substr(kParamMarker.size()));
+  if (rest.empty() || rest.front() != '(') {
+    *reason = "expected '(' after @polisher_param";
+    return false;
+  }
+  rest.remove_prefix(1);
+
+  std::unordered_set<std::string> seen;
+  while (true) {
+    rest = Trim(rest);
+    if (!rest.empty() && rest.front() == ')') {
+      break;
+    }
+    std::size_t key_length = 0;
+    while (key_length < rest.size() && IsIdentChar(rest[key_length])) {
+      ++key_length;
+    }
+    if (key_length == 0 || !IsIdentStart(rest.front())) {
+      *reason = "expected attribute name";
+      return false;
+    }
+    const std::string key(rest.substr(0, key_length));
+    rest = Trim(rest.substr(key_length));
+    if (rest.empty() || rest.front() != '=') {
+      *reason = "expected '=' after attribute '" + key + "'";
+      return false;
+    }
+    rest.remove_prefix(1);
+
+    Literal value;
+    if (!ParseLiteral(&rest, &value)) {
+      *reason = "invalid value for attribute '" + key + "'";
+      return false;
+    }
+    if (!seen.insert(key).second) {
+      *reason = "duplicate attribute '" + key + "'";
+      return false;
+    }
+
+    const bool numeric = value.kind == LiteralKind::kInt || value.kind == LiteralKind::kFloat;
+    if (key == "label" || key == "type") {
+      if (value.kind != LiteralKind::kString) {
+        *reason = "attribute '" + key + "' must be a string";
+        return false;
+      }
+      (key == "label" ? attributes->label : attributes->type) = value.text;
+    } else if (key == "min" || key == "max" || key == "step") {
+      if (!numeric) {
+        *reason = "attribute '" + key + "' must be numeric";
+        return false;
+      }
+      (key == "min" ? attributes->min : key == "max" ? attributes->max : attributes->step) = value;
+    }
+    // Unknown attributes are ignored so scripts can target newer panels.
+
+    rest = Trim(rest);
+    if (!rest.empty() && rest.front() == ',') {
+      rest.remove_prefix(1);
+      continue;
+    }
+    if (rest.empty() || rest.front() != ')') {
+      *reason = "expected ',' or ')' in @polisher_param";
+      return false;
+    }
+  }
+  return true;
+}
+
+// `name = literal  # optional comment`
+bool ParseAssignment(std::string_view line, std::string* name, Literal* value) {
+  line = Trim(line);
+  std::size_t length = 0;
+  while (length < line.size() && IsIdentChar(line[length])) {
+    ++length;
+  }
+  if (length == 0 || !IsIdentStart(line.front())) {
+    return false;
+  }
+  *name = std::string(line.substr(0, length));
+  std::string_view rest = Trim(line.substr(length));
+  if (rest.empty() || rest.front() != '=' || (rest.size() > 1 && rest[1] == '=')) {
+    return false;
+  }
+  rest.remove_prefix(1);
+  if (!ParseLiteral(&rest, value) || value->kind == LiteralKind::kString) {
+    return false;
+  }
+  rest = Trim(rest);
+  return rest.empty() || rest.front() == '#';
+}
+
+bool BuildParam(const Attributes& attributes,
+                const std::string& name,
+                const Literal& value,
+                PolisherParam* param,
+                std::string* reason) {
+  if (!attributes.label || attributes.label->empty()) {
+    *reason = "missing required attribute 'label'";
+    return false;
+  }
+  if (!attributes.type) {
+    *reason = "missing required attribute 'type'";
+    return false;
+  }
+  param->name = name;
+  param->label = *attributes.label;
+
+  if (*attributes.type == "toggle") {
+    if (value.kind != LiteralKind::kBool) {
+      *reason = "toggle default must be True or False";
+      return false;
+    }
+    param->type = PolisherParamType::kToggle;
+    param->default_toggle = value.boolean;
+    param->default_value = value.boolean ? 1.0 : 0.0;
+    param->min = 0.0;
+    param->max = 1.0;
+    return true;
+  }
+
+  if (*attributes.type != "slider") {
+    *reason = "unsupported type '" + *attributes.type + "'";
+    return false;
+  }
+  if (!attributes.min || !attributes.max) {
+    *reason = "slider requires 'min' and 'max'";
+    return false;
+  }
+  if (value.kind != LiteralKind::kInt && value.kind != LiteralKind::kFloat) {
+    *reason = "slider default must be numeric";
+    return false;
+  }
+  param->type = value.kind == LiteralKind::kInt ? PolisherParamType::kIntSlider
+                                                : PolisherParamType::kFloatSlider;
+  param->min = attributes.min->number;
+  param->max = attributes.max->number;
+  param->step = attributes.step ? attributes.step->number : 1.0;
+  param->default_value = value.number;
+  if (!(param->min < param->max)) {
+    *reason = "slider 'min' must be less than 'max'";
+    return false;
+  }
+  if (!(param->step > 0.0)) {
+    *reason = "slider 'step' must be positive";
+    return false;
+  }
+  if (param->default_value < param->min || param->default_value > param->max) {
+    *reason = "default value outside [min, max]";
+    return false;
+  }
+  return true;
+}
+
+PolisherParseResult ParseBlock(const BlockLocation& location) {
+  PolisherParseResult result;
+  if (!location.found) {
+    result.ok = true;
+    return result;
+  }
+  if (!location.terminated) {
+    result.error = PolisherParseError::kUnterminatedBlock;
+    result.error_line = location.first_line - 1;
+    result.message = "@polisher_start without matching @polisher_end";
+    return result;
+  }
+
+  auto fail = [&result](int line, const std::string& reason) {
+    result.ok = false;
+    result.error = PolisherParseError::kInvalidParam;
+    result.error_line = line;
+    result.message = "line " + std::to_string(line) + ": " + reason;
+    result.params.clear();
+    return result;
+  };
+
+  std::unordered_set<std::string> names;
+  std::optional<Attributes> pending;
+  int pending_line = 0;
+  int line_number = location.first_line;
+  std::string_view body = location.body;
+  while (!body.empty()) {
+    const std::size_t newline = body.find('\n');
+    const std::string_view raw = body.substr(0, newline);
+    body = newline == std::string_view::npos ? std::string_view() : body.substr(newline + 1);
+    const int current_line = line_number++;
+
+    const std::string_view line = Trim(raw);
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+
+    if (line.substr(0, kParamMarker.size()) == kParamMarker) {
+      if (pending) {
+        return fail(pending_line, "@polisher_param must be followed by an assignment");
+      }
+      Attributes attributes;
+      std::string reason;
+      if (!ParseAttributes(line, &attributes, &reason)) {
+        return fail(current_line, reason);
+      }
+      pending = std::move(attributes);
+      pending_line = current_line;
+      continue;
+    }
+
+    if (!pending) {
+      // Plain code inside the block is allowed and not inspected.
+      continue;
+    }
+
+    std::string name;
+    Literal value;
+    if (!ParseAssignment(line, &name, &value)) {
+      return fail(current_line, "expected 'name = <default>' after @polisher_param");
+    }
+    PolisherParam param;
+    std::string reason;
+    if (!BuildParam(*pending, name, value, &param, &reason)) {
+      return fail(pending_line, reason);
+    }
+    if (!names.insert(name).second) {
+      return fail(current_line, "duplicate parameter '" + name + "'");
+    }
+    param.line = pending_line;
+    result.params.push_back(std::move(param));
+    pending.reset();
+  }
+  if (pending) {
+    return fail(pending_line, "@polisher_param must be followed by an assignment");
+  }
+
+  result.ok = true;
+  result.polisher_enabled = !result.params.empty();
+  return result;
+}
+
+PolisherParseResult OpenFailure(const std::filesystem::path& path, PolisherParseError error) {
+  PolisherParseResult result;
+  result.error = error;
+  result.message = (error == PolisherParseError::kMissingFile ? "Script not found: "
+                                                              : "Failed to read script: ") +
+                   path.string();
+  return result;
+}
+
+}  // namespace
+
+PolisherParseResult ParsePolisherSource(std::string_view source) {
+  return ParseBlock(LocateBlock(source));
+}
+
+PolisherParseResult ParsePolisherScript(const std::filesystem::path& path) {
+  MappedFile file;
+  PolisherParseError error = PolisherParseError::kNone;
+  if (!file.Open(path, &error)) {
+    return OpenFailure(path, error);
+  }
+  return ParsePolisherSource(file.view());
+}
+
+std::shared_ptr<const PolisherParseResult> PolisherScriptCache::Load(
+    const std::filesystem::path& path) {
+  const std::string key = path.lexically_normal().string();
+
+  FileIdentity identity;
+  bool have_identity = false;
+#ifdef ULAK_POLISHER_HAS_MMAP
+  struct stat info {};
+  if (::stat(path.c_str(), &info) == 0) {
+    identity.device = static_cast<std::uint64_t>(info.st_dev);
+    identity.inode = static_cast<std::uint64_t>(info.st_ino);
+    identity.size = static_cast<std::uint64_t>(info.st_size);
+#if defined(__APPLE__)
+    identity.mtime_ns = static_cast<std::int64_t>(info.st_mtimespec.tv_sec) * 1000000000 +
+                        info.st_mtimespec.tv_nsec;
+#else
+    identity.mtime_ns = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 +
+                        info.st_mtim.tv_nsec;
+#endif
+    have_identity = true;
+  }
+#else
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(path, ec);
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (!ec) {
+    identity.size = static_cast<std::uint64_t>(size);
+    identity.mtime_ns = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+    have_identity = true;
+  }
+#endif
+
+  if (have_identity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = entries_.find(key);
+    if (found != entries_.end() && found->second.identity == identity) {
+      ++stats_.stat_hits;
+      return found->second.result;
+    }
+  }
+
+  MappedFile file;
+  PolisherParseError error = PolisherParseError::kNone;
+  if (!have_identity || !file.Open(path, &error)) {
+    if (error == PolisherParseError::kNone) {
+      error = PolisherParseError::kMissingFile;
+    }
+    Invalidate(path);
+    return std::make_shared<const PolisherParseResult>(OpenFailure(path, error));
+  }
+
+  const BlockLocation location = LocateBlock(file.view());
+  const std::uint64_t hash = HashBlock(location);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = entries_.find(key);
+    if (found != entries_.end() && found->second.block_hash == hash) {
+      // Edited outside the block (or only touched): keep the parsed table.
+      found->second.identity = identity;
+      ++stats_.hash_hits;
+      return found->second.result;
+    }
+  }
+
+  auto result = std::make_shared<const PolisherParseResult>(ParseBlock(location));
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.parses;
+  entries_[key] = Entry{identity, hash, result};
+  return result;
+}
+
+void PolisherScriptCache::Invalidate(const std::filesystem::path& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.erase(path.lexically_normal().string());
+}
+
+PolisherScriptCache::Stats PolisherScriptCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+const char* ToString(PolisherParamType type) {
+  switch (type) {
+    case PolisherParamType::kIntSlider:
+      return "int_slider";
+    case PolisherParamType::kFloatSlider:
+      return "float_slider";
+    case PolisherParamType::kToggle:
+      return "toggle";
+  }
+  return "int_slider";
+}
+
+}  // namespace ulak::utils
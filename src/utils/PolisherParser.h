@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ulak::utils {
+
+enum class PolisherParamType {
+  kIntSlider,
+  kFloatSlider,
+  kToggle,
+};
+
+// One `@polisher_param` declaration (docs/spec/polisher.md §4).
+struct PolisherParam {
+  std::string name;
+  std::string label;
+  PolisherParamType type{PolisherParamType::kIntSlider};
+  double min{0.0};
+  double max{0.0};
+  double step{1.0};
+  double default_value{0.0};
+  bool default_toggle{false};
+  // 1-based line of the decorator in the script.
+  int line{0};
+};
+
+enum class PolisherParseError {
+  kNone,
+  kMissingFile,
+  kReadFailed,
+  kUnterminatedBlock,
+  kInvalidParam,
+};
+
+struct PolisherParseResult {
+  bool ok{false};
+  PolisherParseError error{PolisherParseError::kNone};
+  std::string message;
+  int error_line{0};
+  // False when the block or its params are absent ("Polisher not enabled on
+  // this script"); that is not an error.
+  bool polisher_enabled{false};
+  std::vector<PolisherParam> params;
+};
+
+// Parses the `@polisher_start` / `@polisher_end` block of a script held in memory.
+// Only the block is inspected; the rest of the script is skipped.
+PolisherParseResult ParsePolisherSource(std::string_view source);
+
+// Memory-maps `path` and parses its block.
+PolisherParseResult ParsePolisherScript(const std::filesystem::path& path);
+
+// Parsed-block cache for config/polisher/scripts/. A script is re-read only
+// when its (device, inode, size, mtime) changes, and re-parsed only when the
+// hash of its block text changes, so switching between scripts is a stat() call.
+class PolisherScriptCache {
+ public:
+  struct Stats {
+    std::uint64_t stat_hits{0};
+    std::uint64_t hash_hits{0};
+    std::uint64_t parses{0};
+  };
+
+  std::shared_ptr<const PolisherParseResult> Load(const std::filesystem::path& path);
+
+  void Invalidate(const std::filesystem::path& path);
+  Stats stats() const;
+
+ private:
+  struct FileIdentity {
+    std::uint64_t device{0};
+    std::uint64_t inode{0};
+    std::uint64_t size{0};
+    std::int64_t mtime_ns{0};
+
+    bool operator==(const FileIdentity& other) const {
+      return device == other.device && inode == other.inode && size == other.size &&
+             mtime_ns == other.mtime_ns;
+    }
+  };
+
+  struct Entry {
+    FileIdentity identity;
+    std::uint64_t block_hash{0};
+    std::shared_ptr<const PolisherParseResult> result;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  Stats stats_;
+};
+
+const char* ToString(PolisherParamType type);
+
+}  // namespace ulak::utils
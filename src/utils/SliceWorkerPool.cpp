@@ -0,0 +1,101 @@
+#include "SliceWorkerPool.h"
+
+#include <algorithm>
+
+namespace ulak::utils {
+
+SliceWorkerPool::SliceWorkerPool(int threads) {
+  if (threads <= 0) {
+    threads = static_cast<int>(std::min(8u, std::max(1u, std::thread::hardware_concurrency())));
+  }
+  for (int index = 1; index < threads; ++index) {
+    workers_.emplace_back(&SliceWorkerPool::WorkerLoop, this);
+  }
+}
+
+SliceWorkerPool::~SliceWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void SliceWorkerPool::RunImpl(int slice_count, Trampoline trampoline, void* context) {
+  if (slice_count <= 0) {
+    return;
+  }
+  if (workers_.empty() || slice_count == 1) {
+    for (int slice = 0; slice < slice_count; ++slice) {
+      trampoline(context, slice);
+    }
+    return;
+  }
+
+  std::uint64_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trampoline_ = trampoline;
+    context_ = context;
+    slice_count_ = slice_count;
+    next_slice_ = 0;
+    pending_ = slice_count;
+    generation = ++generation_;
+  }
+  work_cv_.notify_all();
+  Drain(generation, trampoline, context);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return pending_ == 0; });
+  trampoline_ = nullptr;
+  context_ = nullptr;
+}
+
+void SliceWorkerPool::Drain(std::uint64_t generation, Trampoline trampoline, void* context) {
+  int finished = 0;
+  while (true) {
+    int slice = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_ -= finished;
+      finished = 0;
+      if (pending_ == 0) {
+        done_cv_.notify_all();
+      }
+      // A worker that woke late must not run another generation's slices
+      // with this generation's (possibly dangling) context.
+      if (generation_ != generation || next_slice_ >= slice_count_) {
+        return;
+      }
+      slice = next_slice_++;
+    }
+    trampoline(context, slice);
+    finished = 1;
+  }
+}
+
+void SliceWorkerPool::WorkerLoop() {
+  std::uint64_t seen = 0;
+  while (true) {
+    Trampoline trampoline = nullptr;
+    void* context = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [this, seen] { return stopping_ || generation_ != seen; });
+      if (stopping_) {
+        return;
+      }
+      seen = generation_;
+      trampoline = trampoline_;
+      context = context_;
+    }
+    if (trampoline != nullptr) {
+      Drain(seen, trampoline, context);
+    }
+  }
+}
+
+}  // namespace ulak::utils
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ulak::utils {
+
+// Small fixed pool for data-parallel loops (image slices). Run() blocks until
+// every slice has executed; the calling thread works on slices too. One Run()
+// at a time.
+class SliceWorkerPool {
+ public:
+  // `threads` includes the caller; 0 = hardware concurrency, capped at 8.
+  explicit SliceWorkerPool(int threads = 0);
+  SliceWorkerPool(const SliceWorkerPool&) = delete;
+  SliceWorkerPool& operator=(const SliceWorkerPool&) = delete;
+  ~SliceWorkerPool();
+
+  int concurrency() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls fn(slice) for slice in [0, slice_count).
+  template <typename Fn>
+  void Run(int slice_count, Fn& fn) {
+    RunImpl(slice_count, [](void* context, int slice) { (*static_cast<Fn*>(context))(slice); },
+            &fn);
+  }
+
+ private:
+  using Trampoline = void (*)(void* context, int slice);
+
+  void RunImpl(int slice_count, Trampoline trampoline, void* context);
+  void WorkerLoop();
+  // Claims and runs slices of `generation` until none are left. Caller holds
+  // no lock.
+  void Drain(std::uint64_t generation, Trampoline trampoline, void* context);
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::vector<std::thread> workers_;
+
+  std::uint64_t generation_{0};
+  Trampoline trampoline_{nullptr};
+  void* context_{nullptr};
+  int slice_count_{0};
+  int next_slice_{0};
+  int pending_{0};
+  bool stopping_{false};
+};
+
+}  // namespace ulak::utils
@@ -0,0 +1,45 @@
+#include "StringInterner.h"
+
+namespace ulak::utils {
+
+StringInterner::StringInterner() {
+  names_.emplace_back();
+  ids_.emplace(names_.back(), kEmptyId);
+}
+
+StringInterner::Id StringInterner::Intern(std::string_view label) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto found = ids_.find(label);
+  if (found != ids_.end()) {
+    return found->second;
+  }
+  if (names_.size() >= kOverflowId) {
+    return kOverflowId;
+  }
+  const auto id = static_cast<Id>(names_.size());
+  // deque keeps element addresses stable, so the map key view stays valid.
+  names_.emplace_back(label);
+  ids_.emplace(names_.back(), id);
+  return id;
+}
+
+StringInterner::Id StringInterner::Find(std::string_view label) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto found = ids_.find(label);
+  return found == ids_.end() ? kOverflowId : found->second;
+}
+
+std::string_view StringInterner::Name(Id id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (id >= names_.size()) {
+    return {};
+  }
+  return names_[id];
+}
+
+std::size_t StringInterner::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return names_.size();
+}
+
+}  // namespace ulak::utils
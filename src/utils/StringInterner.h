@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ulak::utils {
+
+// Maps short, low-cardinality labels (command names, profile ids, event codes)
+// to dense integer ids so fixed-size records and hot paths never carry strings.
+// Id 0 is reserved for the empty label. Thread-safe; names stay valid for the
+// interner's lifetime.
+class StringInterner {
+ public:
+  using Id = std::uint16_t;
+
+  static constexpr Id kEmptyId = 0;
+  static constexpr Id kOverflowId = 0xFFFF;
+
+  StringInterner();
+
+  // Returns the id for `label`, registering it on first use. Returns
+  // kOverflowId once the id space is exhausted.
+  Id Intern(std::string_view label);
+
+  // Returns the id for `label` without registering it (kOverflowId if absent).
+  Id Find(std::string_view label) const;
+
+  // Returns the label for `id`, or an empty view for unknown ids.
+  std::string_view Name(Id id) const;
+
+  std::size_t size() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::deque<std::string> names_;
+  std::unordered_map<std::string_view, Id> ids_;
+};
+
+}  // namespace ulak::utils
@@ -0,0 +1,252 @@
+#include "ThreadTopology.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ulak::utils {
+namespace {
+
+constexpr int kCapIpcLock = 14;
+
+bool KnownSubsystem(std::string_view name) {
+  return std::find(kThreadSubsystems.begin(), kThreadSubsystems.end(), name) !=
+         kThreadSubsystems.end();
+}
+
+std::string ErrorText(int error) {
+  return std::strerror(error);
+}
+
+// CAP_IPC_LOCK lifts RLIMIT_MEMLOCK; read from the effective capability mask.
+bool HasIpcLockCapability() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("CapEff:", 0) == 0) {
+      const unsigned long long mask = std::stoull(line.substr(7), nullptr, 16);
+      return (mask >> kCapIpcLock) & 1ULL;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+const char* ToString(SchedulingPolicy policy) {
+  switch (policy) {
+    case SchedulingPolicy::kOther:
+      return "other";
+    case SchedulingPolicy::kFifo:
+      return "fifo";
+  }
+  return "other";
+}
+
+ThreadTopologyConfig DefaultThreadTopology() {
+  ThreadTopologyConfig config;
+  config.lock_memory = true;
+  config.executors = {
+      {"safety", {}, SchedulingPolicy::kFifo, 80, -10},
+      {"telemetry", {}, SchedulingPolicy::kFifo, 60, -5},
+      {"bulk", {}, SchedulingPolicy::kOther, 0, 10},
+      {"ui", {}, SchedulingPolicy::kOther, 0, 0},
+  };
+  config.assignments = {
+      {"panic_dispatch", "safety"},   {"safety_classifier", "safety"},
+      {"command_gateway", "safety"},  {"telemetry_decode", "telemetry"},
+      {"stream_decode", "bulk"},      {"recorder", "bulk"},
+      {"ui_bridge", "ui"},
+  };
+  return config;
+}
+
+bool ValidateThreadTopology(const ThreadTopologyConfig& config, std::string* reason) {
+  const auto fail = [reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = "thread_topology: " + what;
+    }
+    return false;
+  };
+
+  std::set<std::string> executors;
+  for (const ExecutorSpec& executor : config.executors) {
+    if (executor.name.empty()) {
+      return fail("executor without a name");
+    }
+    if (!executors.insert(executor.name).second) {
+      return fail("duplicate executor '" + executor.name + "'");
+    }
+    for (const int cpu : executor.cpus) {
+      if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return fail("executor '" + executor.name + "' has invalid CPU " + std::to_string(cpu));
+      }
+    }
+    if (executor.policy == SchedulingPolicy::kFifo &&
+        (executor.fifo_priority < 1 || executor.fifo_priority > 99)) {
+      return fail("executor '" + executor.name + "' needs a fifo priority in 1..99");
+    }
+    if (executor.nice < -20 || executor.nice > 19) {
+      return fail("executor '" + executor.name + "' needs a nice level in -20..19");
+    }
+  }
+
+  std::set<std::string> assigned;
+  for (const auto& [subsystem, executor] : config.assignments) {
+    if (!KnownSubsystem(subsystem)) {
+      return fail("unknown subsystem '" + subsystem + "'");
+    }
+    if (!assigned.insert(subsystem).second) {
+      return fail("subsystem '" + subsystem + "' assigned twice");
+    }
+    if (executors.count(executor) == 0) {
+      return fail("subsystem '" + subsystem + "' uses missing executor '" + executor + "'");
+    }
+  }
+  return true;
+}
+
+TopologyApplyReport ApplyExecutorToCurrentThread(const ExecutorSpec& executor) {
+  TopologyApplyReport report;
+  const std::string label = "executor '" + executor.name + "': ";
+
+  if (executor.cpus.empty()) {
+    // Drop a mask inherited from a pinned parent. The kernel intersects the
+    // request with the cgroup's cpuset, so this widens to every allowed CPU.
+    cpu_set_t every;
+    CPU_ZERO(&every);
+    const long configured = sysconf(_SC_NPROCESSORS_CONF);
+    for (long cpu = 0; cpu < std::min<long>(configured, CPU_SETSIZE); ++cpu) {
+      CPU_SET(static_cast<int>(cpu), &every);
+    }
+    const int error = pthread_setaffinity_np(pthread_self(), sizeof(every), &every);
+    if (error == 0) {
+      report.affinity_applied = true;
+    } else {
+      report.degraded.push_back(label + "affinity reset refused: " + ErrorText(error));
+    }
+  } else {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed);
+    cpu_set_t wanted;
+    CPU_ZERO(&wanted);
+    std::size_t missing = 0;
+    for (const int cpu : executor.cpus) {
+      if (CPU_ISSET(cpu, &allowed)) {
+        CPU_SET(cpu, &wanted);
+      } else {
+        ++missing;
+      }
+    }
+    if (CPU_COUNT(&wanted) == 0) {
+      report.degraded.push_back(label + "none of its CPUs is available, affinity unchanged");
+    } else {
+      const int error = pthread_setaffinity_np(pthread_self(), sizeof(wanted), &wanted);
+      if (error == 0) {
+        report.affinity_applied = true;
+        if (missing > 0) {
+          report.degraded.push_back(label + std::to_string(missing) +
+                                    " CPU(s) unavailable, pinned to the rest");
+        }
+      } else {
+        report.degraded.push_back(label + "affinity refused: " + ErrorText(error));
+      }
+    }
+  }
+
+  if (executor.policy == SchedulingPolicy::kFifo) {
+    sched_param param{};
+    param.sched_priority = executor.fifo_priority;
+    const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error == 0) {
+      report.realtime_applied = true;
+      return report;
+    }
+    report.degraded.push_back(label + "SCHED_FIFO refused (" + ErrorText(error) +
+                              "), using nice " + std::to_string(executor.nice));
+  } else {
+    // A thread spawned from a SCHED_FIFO thread inherits its policy, and nice
+    // has no effect under SCHED_FIFO.
+    sched_param param{};
+    const int error = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    if (error != 0) {
+      report.degraded.push_back(label + "SCHED_OTHER refused: " + ErrorText(error));
+    }
+  }
+
+  // Nice is per thread on Linux: address the thread id, not the process.
+  const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+  if (setpriority(PRIO_PROCESS, tid, executor.nice) == 0) {
+    report.nice_applied = true;
+  } else {
+    report.degraded.push_back(label + "nice " + std::to_string(executor.nice) +
+                              " refused: " + ErrorText(errno));
+  }
+  return report;
+}
+
+bool ThreadTopology::Configure(ThreadTopologyConfig config, std::string* reason) {
+  if (!ValidateThreadTopology(config, reason)) {
+    return false;
+  }
+  config_ = std::move(config);
+  return true;
+}
+
+TopologyApplyReport ThreadTopology::ApplyProcessSettings() const {
+  TopologyApplyReport report;
+  if (!config_.lock_memory) {
+    return report;
+  }
+  // With MCL_FUTURE every later allocation counts against RLIMIT_MEMLOCK;
+  // under a finite limit that turns into allocation failures, so only lock
+  // when the limit cannot bite.
+  rlimit limit{};
+  getrlimit(RLIMIT_MEMLOCK, &limit);
+  if (limit.rlim_cur != RLIM_INFINITY && !HasIpcLockCapability()) {
+    report.degraded.push_back("mlockall skipped: RLIMIT_MEMLOCK is " +
+                              std::to_string(limit.rlim_cur / 1024) +
+                              " KiB and CAP_IPC_LOCK is missing");
+    return report;
+  }
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+    report.memory_locked = true;
+  } else {
+    report.degraded.push_back("mlockall failed: " + ErrorText(errno));
+  }
+  return report;
+}
+
+TopologyApplyReport ThreadTopology::EnterSubsystem(std::string_view subsystem) const {
+  const ExecutorSpec* executor = ExecutorFor(subsystem);
+  if (executor == nullptr) {
+    return {};
+  }
+  return ApplyExecutorToCurrentThread(*executor);
+}
+
+const ExecutorSpec* ThreadTopology::ExecutorFor(std::string_view subsystem) const {
+  for (const auto& [name, executor] : config_.assignments) {
+    if (name != subsystem) {
+      continue;
+    }
+    for (const ExecutorSpec& spec : config_.executors) {
+      if (spec.name == executor) {
+        return &spec;
+      }
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace ulak::utils
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ulak::utils {
+
+enum class SchedulingPolicy : std::uint8_t {
+  kOther,  // SCHED_OTHER with a nice level
+  kFifo,   // SCHED_FIFO with a real-time priority
+};
+
+const char* ToString(SchedulingPolicy policy);
+
+// A named group of threads sharing CPU placement and priority.
+struct ExecutorSpec {
+  std::string name;
+  // CPUs the threads may run on; empty means any CPU the process may use.
+  std::vector<int> cpus;
+  SchedulingPolicy policy{SchedulingPolicy::kOther};
+  // 1..99, kFifo only.
+  int fifo_priority{0};
+  // -20..19. Used for kOther, and as the fallback when SCHED_FIFO is refused.
+  int nice{0};
+};
+
+// Subsystems that run their own threads and can be assigned to an executor.
+inline constexpr std::array<std::string_view, 7> kThreadSubsystems = {
+    "telemetry_decode", "command_gateway", "panic_dispatch", "safety_classifier",
+    "stream_decode",    "recorder",        "ui_bridge",
+};
+
+// `thread_topology` section of settings.json.
+struct ThreadTopologyConfig {
+  // mlockall(MCL_CURRENT | MCL_FUTURE): no page faults on the safety paths.
+  bool lock_memory{false};
+  std::vector<ExecutorSpec> executors;
+  // Subsystem -> executor name. Unassigned subsystems keep the defaults.
+  std::vector<std::pair<std::string, std::string>> assignments;
+};
+
+// Safety paths (panic, classifier, command gateway) on SCHED_FIFO, telemetry
+// just below, stream decode and recording niced down, no pinning. Used when
+// settings.json has no `thread_topology` section.
+ThreadTopologyConfig DefaultThreadTopology();
+
+// Rejects duplicate or empty executor names, out-of-range priorities, nice
+// levels and CPU ids, unknown subsystems, subsystems assigned twice and
+// assignments to missing executors.
+bool ValidateThreadTopology(const ThreadTopologyConfig& config, std::string* reason);
+
+// What a thread or the process actually got. Settings the process is not
+// allowed to use (no CAP_SYS_NICE, a low RLIMIT_MEMLOCK, CPUs that are offline
+// or outside the cgroup) are skipped and listed in `degraded`; the station
+// runs on regardless.
+struct TopologyApplyReport {
+  bool affinity_applied{false};
+  bool realtime_applied{false};
+  bool nice_applied{false};
+  bool memory_locked{false};
+  std::vector<std::string> degraded;
+};
+
+// Applies `executor` to the calling thread, replacing the affinity and
+// scheduling policy it inherited from its creator (a kOther executor on a
+// thread spawned by a SCHED_FIFO one ends up SCHED_OTHER). Threads it creates
+// afterwards inherit the result.
+TopologyApplyReport ApplyExecutorToCurrentThread(const ExecutorSpec& executor);
+
+// Validated topology, shared read-only by the subsystems' threads.
+class ThreadTopology {
+ public:
+  bool Configure(ThreadTopologyConfig config, std::string* reason);
+
+  // Process-wide settings (mlockall). Called once at startup, before the
+  // subsystem threads are started.
+  TopologyApplyReport ApplyProcessSettings() const;
+
+  // Called first on each subsystem thread. Unassigned subsystems run
+  // unchanged (empty report).
+  TopologyApplyReport EnterSubsystem(std::string_view subsystem) const;
+
+  // nullptr when the subsystem is unassigned.
+  const ExecutorSpec* ExecutorFor(std::string_view subsystem) const;
+
+  const ThreadTopologyConfig& config() const { return config_; }
+
+ private:
+  ThreadTopologyConfig config_;
+};
+
+}  // namespace ulak::utils
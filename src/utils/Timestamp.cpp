@@ -0,0 +1,133 @@
+#include "Timestamp.h"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace ulak::utils {
+namespace {
+
+// Reads exactly `count` digits starting at `*position`.
+bool Digits(std::string_view text, std::size_t* position, int count, int* value) {
+  if (*position + static_cast<std::size_t>(count) > text.size()) {
+    return false;
+  }
+  int result = 0;
+  for (int i = 0; i < count; ++i) {
+    const char c = text[*position + static_cast<std::size_t>(i)];
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    result = result * 10 + (c - '0');
+  }
+  *position += static_cast<std::size_t>(count);
+  *value = result;
+  return true;
+}
+
+bool Literal(std::string_view text, std::size_t* position, char expected) {
+  if (*position >= text.size() || text[*position] != expected) {
+    return false;
+  }
+  ++*position;
+  return true;
+}
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar (H. Hinnant's
+// days_from_civil), so parsing does not depend on timegm().
+std::int64_t DaysFromCivil(int year, int month, int day) {
+  year -= month <= 2 ? 1 : 0;
+  const int era = (year >= 0 ? year : year - 399) / 400;
+  const int year_of_era = year - era * 400;
+  const int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return static_cast<std::int64_t>(era) * 146097 + day_of_era - 719468;
+}
+
+}  // namespace
+
+std::int64_t NowEpochMicros() {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+std::string FormatRfc3339Micros(std::int64_t epoch_us) {
+  std::int64_t seconds = epoch_us / 1000000;
+  std::int64_t micros = epoch_us % 1000000;
+  if (micros < 0) {
+    micros += 1000000;
+    --seconds;
+  }
+
+  const std::time_t time_value = static_cast<std::time_t>(seconds);
+  std::tm utc{};
+#if defined(_WIN32)
+  gmtime_s(&utc, &time_value);
+#else
+  gmtime_r(&time_value, &utc);
+#endif
+
+  char buffer[96];
+  std::snprintf(buffer,
+                sizeof(buffer),
+                "%04d-%02d-%02dT%02d:%02d:%02d.%06lldZ",
+                utc.tm_year + 1900,
+                utc.tm_mon + 1,
+                utc.tm_mday,
+                utc.tm_hour,
+                utc.tm_min,
+                utc.tm_sec,
+                static_cast<long long>(micros));
+  return buffer;
+}
+
+bool ParseRfc3339Micros(std::string_view text, std::int64_t* epoch_us) {
+  std::size_t position = 0;
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  if (!Digits(text, &position, 4, &year) || !Literal(text, &position, '-') ||
+      !Digits(text, &position, 2, &month) || !Literal(text, &position, '-') ||
+      !Digits(text, &position, 2, &day) || !Literal(text, &position, 'T') ||
+      !Digits(text, &position, 2, &hour) || !Literal(text, &position, ':') ||
+      !Digits(text, &position, 2, &minute) || !Literal(text, &position, ':') ||
+      !Digits(text, &position, 2, &second)) {
+    return false;
+  }
+  static constexpr int kDaysInMonth[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if (month < 1 || month > 12 || day < 1 || day > kDaysInMonth[month - 1] || hour > 23 ||
+      minute > 59 || second > 60) {
+    return false;
+  }
+
+  std::int64_t micros = 0;
+  if (Literal(text, &position, '.')) {
+    int digits = 0;
+    while (position < text.size() && text[position] >= '0' && text[position] <= '9') {
+      if (digits < 6) {
+        micros = micros * 10 + (text[position] - '0');
+      }
+      ++digits;
+      ++position;
+    }
+    if (digits == 0) {
+      return false;
+    }
+    for (; digits < 6; ++digits) {
+      micros *= 10;
+    }
+  }
+  if (!Literal(text, &position, 'Z') || position != text.size()) {
+    return false;
+  }
+
+  const std::int64_t seconds =
+      DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+  *epoch_us = seconds * 1000000 + micros;
+  return true;
+}
+
+}  // namespace ulak::utils
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ulak::utils {
+
+// Current UTC time as microseconds since the Unix epoch.
+std::int64_t NowEpochMicros();
+
+// Formats epoch microseconds as RFC3339 UTC with a microsecond fraction
+// (e.g. 2026-02-21T00:00:01.250000Z).
+std::string FormatRfc3339Micros(std::int64_t epoch_us);
+
+// Inverse of FormatRfc3339Micros: `YYYY-MM-DDTHH:MM:SS[.fraction]Z`, UTC only.
+// Fraction digits past the sixth are truncated. Returns false on other input.
+bool ParseRfc3339Micros(std::string_view text, std::int64_t* epoch_us);
+
+}  // namespace ulak::utils
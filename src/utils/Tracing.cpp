@@ -0,0 +1,327 @@
+#include "Tracing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace ulak::utils {
+namespace {
+
+// Only an invariant TSC ticks at a constant rate across P-states and cores.
+bool HasInvariantTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int eax = 0;
+  unsigned int ebx = 0;
+  unsigned int ecx = 0;
+  unsigned int edx = 0;
+  if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u) {
+    return false;
+  }
+  __cpuid(0x80000007u, eax, ebx, ecx, edx);
+  return (edx & (1u << 8)) != 0;
+#else
+  return false;
+#endif
+}
+
+std::uint64_t SteadyNs() {
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::steady_clock::now().time_since_epoch())
+                                        .count());
+}
+
+}  // namespace
+
+const char* ToString(TraceStage stage) {
+  switch (stage) {
+    case TraceStage::kRecv:
+      return "recv";
+    case TraceStage::kDecode:
+      return "decode";
+    case TraceStage::kBusPublish:
+      return "bus_publish";
+    case TraceStage::kClassify:
+      return "classify";
+    case TraceStage::kCountdown:
+      return "countdown";
+    case TraceStage::kGatewaySend:
+      return "gateway_send";
+    case TraceStage::kPanicSend:
+      return "panic_send";
+  }
+  return "unknown";
+}
+
+void TraceRing::Drain(std::vector<TraceRecord>* out) {
+  const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+  const std::uint64_t head = head_.load(std::memory_order_acquire);
+  for (std::uint64_t index = tail; index < head; ++index) {
+    out->push_back(records_[index % kCapacity]);
+  }
+  tail_.store(head, std::memory_order_release);
+}
+
+Tracer& Tracer::Instance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer() : uses_tsc_(HasInvariantTsc()) {
+  anchor_ns_ = SteadyNs();
+  origin_ticks_ = Now();
+}
+
+double Tracer::NsPerTick() const {
+  if (!uses_tsc_) {
+    return 1.0;
+  }
+  // The TSC rate is measured against steady_clock over everything since
+  // construction. Re-measuring each time that interval doubles keeps the
+  // error (clock read skew / interval) shrinking at the cost of one compare
+  // on most calls, and nothing ever waits to calibrate.
+  const std::uint64_t ticks = Now();
+  const std::uint64_t calibrated = calibrated_ticks_.load(std::memory_order_relaxed);
+  if (calibrated != 0 && ticks - origin_ticks_ < 2 * (calibrated - origin_ticks_)) {
+    return ns_per_tick_.load(std::memory_order_relaxed);
+  }
+  const std::uint64_t ns = SteadyNs();
+  if (ticks <= origin_ticks_ || ns <= anchor_ns_) {
+    return ns_per_tick_.load(std::memory_order_relaxed);
+  }
+  const double ns_per_tick =
+      static_cast<double>(ns - anchor_ns_) / static_cast<double>(ticks - origin_ticks_);
+  ns_per_tick_.store(ns_per_tick, std::memory_order_relaxed);
+  calibrated_ticks_.store(ticks, std::memory_order_relaxed);
+  return ns_per_tick;
+}
+
+TraceRing& Tracer::LocalRing() {
+  thread_local std::shared_ptr<TraceRing> ring;
+  if (!ring) {
+    ring = RegisterThread();
+  }
+  return *ring;
+}
+
+std::shared_ptr<TraceRing> Tracer::RegisterThread() {
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  static std::uint32_t next_thread_index = 0;
+  auto ring = std::make_shared<TraceRing>(next_thread_index++);
+  rings_.push_back(ring);
+  return ring;
+}
+
+void Tracer::Collect() {
+  std::lock_guard<std::mutex> lock(collect_mutex_);
+  CollectLocked();
+}
+
+void Tracer::CollectLocked() {
+  std::vector<std::shared_ptr<TraceRing>> rings;
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    rings = rings_;
+  }
+  for (const auto& ring : rings) {
+    scratch_.clear();
+    ring->Drain(&scratch_);
+    for (const auto& record : scratch_) {
+      const std::uint64_t ticks =
+          record.end_ticks > record.start_ticks ? record.end_ticks - record.start_ticks : 0;
+      histograms_[static_cast<std::size_t>(record.stage)].Record(
+          static_cast<std::uint64_t>(TicksToNs(ticks)));
+      if (recent_.size() == kRecentCapacity) {
+        recent_.pop_front();
+      }
+      recent_.push_back({record.start_ticks, record.end_ticks, ring->thread_index(), record.stage});
+    }
+  }
+}
+
+TraceSnapshot Tracer::Snapshot() {
+  std::lock_guard<std::mutex> lock(collect_mutex_);
+  CollectLocked();
+  TraceSnapshot snapshot;
+  snapshot.uses_tsc = uses_tsc_;
+  for (std::size_t index = 0; index < kTraceStageCount; ++index) {
+    const auto& histogram = histograms_[index];
+    auto& stats = snapshot.stages[index];
+    stats.stage = static_cast<TraceStage>(index);
+    stats.count = histogram.count();
+    stats.min_ns = histogram.min();
+    stats.p50_ns = histogram.ValueAtPercentile(50.0);
+    stats.p99_ns = histogram.ValueAtPercentile(99.0);
+    stats.p999_ns = histogram.ValueAtPercentile(99.9);
+    stats.max_ns = histogram.max();
+    stats.mean_ns = histogram.mean();
+  }
+  std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+  for (const auto& ring : rings_) {
+    snapshot.dropped += ring->dropped();
+  }
+  return snapshot;
+}
+
+std::string Tracer::StatsJson() {
+  const TraceSnapshot snapshot = Snapshot();
+  std::ostringstream out;
+  out << "{\"clock\":\"" << (snapshot.uses_tsc ? "tsc" : "steady") << "\",\"dropped\":"
+      << snapshot.dropped << ",\"stages\":[";
+  for (std::size_t index = 0; index < kTraceStageCount; ++index) {
+    const auto& stats = snapshot.stages[index];
+    char mean[32];
+    std::snprintf(mean, sizeof(mean), "%.1f", stats.mean_ns);
+    out << (index == 0 ? "" : ",") << "{\"name\":\"" << ToString(stats.stage)
+        << "\",\"count\":" << stats.count << ",\"min_ns\":" << stats.min_ns
+        << ",\"p50_ns\":" << stats.p50_ns << ",\"p99_ns\":" << stats.p99_ns
+        << ",\"p999_ns\":" << stats.p999_ns << ",\"max_ns\":" << stats.max_ns
+        << ",\"mean_ns\":" << mean << '}';
+  }
+  out << "]}\n";
+  return out.str();
+}
+
+bool Tracer::WriteChromeTrace(const std::filesystem::path& path, std::string* reason) {
+  std::lock_guard<std::mutex> lock(collect_mutex_);
+  CollectLocked();
+
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  if (!output) {
+    if (reason != nullptr) {
+      *reason = "cannot open " + path.string();
+    }
+    return false;
+  }
+  // Complete ("X") events; ts and dur are microseconds since the tracer started.
+  output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  char line[192];
+  for (const auto& span : recent_) {
+    const std::uint64_t start = span.start_ticks > origin_ticks_ ? span.start_ticks - origin_ticks_ : 0;
+    const std::uint64_t duration = span.end_ticks > span.start_ticks ? span.end_ticks - span.start_ticks : 0;
+    std::snprintf(line, sizeof(line),
+                  "%s\n{\"name\":\"%s\",\"cat\":\"ulak\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                  "\"ts\":%.3f,\"dur\":%.3f}",
+                  first ? "" : ",", ToString(span.stage), span.thread_index,
+                  TicksToNs(start) / 1000.0, TicksToNs(duration) / 1000.0);
+    output << line;
+    first = false;
+  }
+  output << "\n]}\n";
+  if (!output) {
+    if (reason != nullptr) {
+      *reason = "write failed for " + path.string();
+    }
+    return false;
+  }
+  return true;
+}
+
+void Tracer::Reset() {
+  std::lock_guard<std::mutex> lock(collect_mutex_);
+  CollectLocked();
+  for (auto& histogram : histograms_) {
+    histogram.Reset();
+  }
+  recent_.clear();
+  // Rings only the registry still holds belong to threads that have exited.
+  std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+  rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                              [](const auto& ring) { return ring.use_count() == 1; }),
+               rings_.end());
+}
+
+TraceStatsServer::TraceStatsServer(std::filesystem::path socket_path)
+    : socket_path_(std::move(socket_path)) {}
+
+TraceStatsServer::~TraceStatsServer() { Stop(); }
+
+bool TraceStatsServer::Start(std::string* reason) {
+  const auto fail = [this, reason](const std::string& what) {
+    if (reason != nullptr) {
+      *reason = what + ": " + std::strerror(errno);
+    }
+    if (listen_fd_ >= 0) {
+      ::close(listen_fd_);
+      listen_fd_ = -1;
+    }
+    return false;
+  };
+
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  const std::string path = socket_path_.string();
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    if (reason != nullptr) {
+      *reason = "socket path is empty or too long: " + path;
+    }
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    return fail("socket");
+  }
+  ::unlink(path.c_str());
+  if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    return fail("bind " + path);
+  }
+  if (::listen(listen_fd_, 4) != 0) {
+    return fail("listen " + path);
+  }
+  stopping_.store(false);
+  thread_ = std::thread([this] { Run(); });
+  return true;
+}
+
+void TraceStatsServer::Stop() {
+  stopping_.store(true);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    ::unlink(socket_path_.string().c_str());
+  }
+}
+
+void TraceStatsServer::Run() {
+  while (!stopping_.load()) {
+    pollfd descriptor{listen_fd_, POLLIN, 0};
+    if (::poll(&descriptor, 1, 100) <= 0 || (descriptor.revents & POLLIN) == 0) {
+      continue;
+    }
+    const int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0) {
+      continue;
+    }
+    const std::string body = Tracer::Instance().StatsJson();
+    std::size_t written = 0;
+    while (written < body.size()) {
+      const ssize_t result =
+          ::send(client, body.data() + written, body.size() - written, MSG_NOSIGNAL);
+      if (result <= 0) {
+        break;
+      }
+      written += static_cast<std::size_t>(result);
+    }
+    ::close(client);
+    served_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace ulak::utils
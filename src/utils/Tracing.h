@@ -0,0 +1,213 @@
+#pragma once
+
+#include "HdrHistogram.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pipeline trace points. Build with ULAK_ENABLE_TRACING defined to compile
+// them in; otherwise ULAK_TRACE_SCOPE expands to nothing and none of this
+// header's runtime is linked into the hot paths.
+namespace ulak::utils {
+
+enum class TraceStage : std::uint8_t {
+  kRecv,
+  kDecode,
+  kBusPublish,
+  kClassify,
+  kCountdown,
+  kGatewaySend,
+  kPanicSend,
+};
+
+inline constexpr std::size_t kTraceStageCount = 7;
+
+const char* ToString(TraceStage stage);
+
+struct TraceRecord {
+  std::uint64_t start_ticks{0};
+  std::uint64_t end_ticks{0};
+  TraceStage stage{TraceStage::kRecv};
+};
+
+// Single-producer (the owning thread) / single-consumer (the collector) ring.
+// A full ring drops the new record rather than blocking the pipeline.
+class TraceRing {
+ public:
+  static constexpr std::size_t kCapacity = 4096;
+
+  explicit TraceRing(std::uint32_t thread_index) : thread_index_(thread_index) {}
+
+  void Push(const TraceRecord& record) {
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kCapacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    records_[head % kCapacity] = record;
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  // Collector only. Appends pending records to `out`.
+  void Drain(std::vector<TraceRecord>* out);
+
+  std::uint32_t thread_index() const { return thread_index_; }
+  std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  const std::uint32_t thread_index_;
+  alignas(64) std::atomic<std::uint64_t> head_{0};
+  alignas(64) std::atomic<std::uint64_t> tail_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::array<TraceRecord, kCapacity> records_{};
+};
+
+struct TraceStageStats {
+  TraceStage stage{TraceStage::kRecv};
+  std::uint64_t count{0};
+  std::uint64_t min_ns{0};
+  std::uint64_t p50_ns{0};
+  std::uint64_t p99_ns{0};
+  std::uint64_t p999_ns{0};
+  std::uint64_t max_ns{0};
+  double mean_ns{0.0};
+};
+
+struct TraceSnapshot {
+  std::array<TraceStageStats, kTraceStageCount> stages{};
+  std::uint64_t dropped{0};
+  bool uses_tsc{false};
+};
+
+// Process-wide collector. Recording threads touch only their own ring;
+// Collect() (stats endpoint, dump, tests) moves records into per-stage
+// histograms and a bounded buffer of recent spans for the Chrome trace.
+class Tracer {
+ public:
+  static constexpr std::size_t kRecentCapacity = 65536;
+
+  static Tracer& Instance();
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  // Raw timestamp: the TSC when it is invariant, steady_clock nanoseconds
+  // otherwise. Convert with TicksToNs.
+  std::uint64_t Now() const {
+#if defined(__x86_64__) || defined(__i386__)
+    if (uses_tsc_) {
+      return __builtin_ia32_rdtsc();
+    }
+#endif
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+  void Record(TraceStage stage, std::uint64_t start_ticks, std::uint64_t end_ticks) {
+    LocalRing().Push({start_ticks, end_ticks, stage});
+  }
+
+  void Collect();
+  TraceSnapshot Snapshot();
+  // {"clock":..., "dropped":N, "stages":[{"name":..., "count":..., ...}]}
+  std::string StatsJson();
+  // Chrome trace-event format (chrome://tracing, Perfetto) of the retained spans.
+  bool WriteChromeTrace(const std::filesystem::path& path, std::string* reason);
+  // Clears histograms and retained spans; rings are drained and discarded.
+  void Reset();
+
+  double TicksToNs(std::uint64_t ticks) const { return static_cast<double>(ticks) * NsPerTick(); }
+
+ private:
+  struct Span {
+    std::uint64_t start_ticks{0};
+    std::uint64_t end_ticks{0};
+    std::uint32_t thread_index{0};
+    TraceStage stage{TraceStage::kRecv};
+  };
+
+  Tracer();
+  double NsPerTick() const;
+  TraceRing& LocalRing();
+  std::shared_ptr<TraceRing> RegisterThread();
+  void CollectLocked();
+
+  bool uses_tsc_{false};
+  // steady_clock and TSC readings taken together at construction.
+  std::uint64_t anchor_ns_{0};
+  std::uint64_t origin_ticks_{0};
+  mutable std::atomic<double> ns_per_tick_{1.0};
+  mutable std::atomic<std::uint64_t> calibrated_ticks_{0};
+
+  std::mutex registry_mutex_;
+  std::vector<std::shared_ptr<TraceRing>> rings_;
+
+  std::mutex collect_mutex_;
+  std::vector<TraceRecord> scratch_;
+  std::array<HdrHistogram, kTraceStageCount> histograms_{};
+  std::deque<Span> recent_;
+};
+
+// Records [construction, destruction) as one span.
+class TraceScope {
+ public:
+  explicit TraceScope(TraceStage stage)
+      : tracer_(Tracer::Instance()), stage_(stage), start_ticks_(tracer_.Now()) {}
+  ~TraceScope() { tracer_.Record(stage_, start_ticks_, tracer_.Now()); }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  Tracer& tracer_;
+  const TraceStage stage_;
+  const std::uint64_t start_ticks_;
+};
+
+// Serves Tracer::StatsJson() to every client of a Unix stream socket, then
+// closes the connection: `socat - UNIX-CONNECT:/run/ulak/trace.sock`.
+class TraceStatsServer {
+ public:
+  explicit TraceStatsServer(std::filesystem::path socket_path);
+  TraceStatsServer(const TraceStatsServer&) = delete;
+  TraceStatsServer& operator=(const TraceStatsServer&) = delete;
+  ~TraceStatsServer();
+
+  bool Start(std::string* reason);
+  void Stop();
+
+  std::uint64_t served() const { return served_.load(std::memory_order_relaxed); }
+
+ private:
+  void Run();
+
+  const std::filesystem::path socket_path_;
+  int listen_fd_{-1};
+  std::atomic<bool> stopping_{false};
+  std::atomic<std::uint64_t> served_{0};
+  std::thread thread_;
+};
+
+}  // namespace ulak::utils
+
+#define ULAK_TRACE_CONCAT_INNER(a, b) a##b
+#define ULAK_TRACE_CONCAT(a, b) ULAK_TRACE_CONCAT_INNER(a, b)
+
+#if defined(ULAK_ENABLE_TRACING)
+#define ULAK_TRACE_SCOPE(stage) \
+  ::ulak::utils::TraceScope ULAK_TRACE_CONCAT(ulak_trace_scope_, __LINE__)(stage)
+#else
+#define ULAK_TRACE_SCOPE(stage) static_cast<void>(0)
+#endif
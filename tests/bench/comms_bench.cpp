@@ -0,0 +1,472 @@
+#include "CommandSendScheduler.h"
+#include "FrameScaler.h"
+#include "LinkHealthMonitor.h"
+#include "NalUnit.h"
+#include "PerceptionOverlayRenderer.h"
+#include "SegmentRecorder.h"
+#include "SharedStateBridge.h"
+#include "VehicleModeMonitor.h"
+#include "VideoDecodePipeline.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+void BM_LinkHealthOnPacket(benchmark::State& state) {
+  ulak::comms::LinkHealthMonitor monitor;
+  std::int64_t now_us = 0;
+  std::uint8_t sequence = 0;
+  for (auto _ : state) {
+    monitor.OnPacket(ulak::comms::LinkChannel::kMavlinkUdp, now_us += 20'000, 40);
+    monitor.OnMavlinkSequence(1, 1, sequence++);
+  }
+}
+BENCHMARK(BM_LinkHealthOnPacket);
+
+// One packet per health period keeps every window non-empty; PauseTiming would
+// cost more than the evaluation itself.
+void BM_LinkHealthEvaluate(benchmark::State& state) {
+  ulak::comms::LinkHealthMonitor monitor;
+  std::int64_t now_us = 0;
+  for (auto _ : state) {
+    now_us += 100'000;
+    monitor.OnPacket(ulak::comms::LinkChannel::kMavlinkUdp, now_us, 40);
+    auto frames = monitor.Evaluate(now_us);
+    benchmark::DoNotOptimize(frames);
+  }
+}
+BENCHMARK(BM_LinkHealthEvaluate);
+
+// There is no telemetry decoder yet; this is the part of the decode path that
+// exists: interning `vehicle_mode` and running the edge detector per frame.
+void BM_TelemetryModePath(benchmark::State& state) {
+  ulak::comms::VehicleModeMonitor monitor;
+  int transitions = 0;
+  monitor.Subscribe([&transitions](const ulak::models::VehicleModeTransition&) { ++transitions; });
+  ulak::models::TelemetryFrame frame;
+  frame.vehicle_mode = "GUIDED";
+  for (auto _ : state) {
+    frame.vehicle_mode_id = ulak::models::InternVehicleMode(frame.vehicle_mode);
+    frame.receive_time_us += 20'000;
+    benchmark::DoNotOptimize(monitor.Observe(frame));
+  }
+  benchmark::DoNotOptimize(transitions);
+}
+BENCHMARK(BM_TelemetryModePath);
+
+std::vector<std::uint8_t> AccessUnitBytes(std::size_t slices, std::size_t slice_size) {
+  std::vector<std::uint8_t> bytes;
+  const auto nal = [&bytes](std::uint8_t header, std::size_t size) {
+    const std::uint8_t start[] = {0, 0, 0, 1, header};
+    bytes.insert(bytes.end(), start, start + sizeof(start));
+    bytes.insert(bytes.end(), size, 0xAA);
+  };
+  nal(0x67, 12);
+  nal(0x68, 4);
+  for (std::size_t i = 0; i < slices; ++i) {
+    nal(0x65, slice_size);
+  }
+  return bytes;
+}
+
+void BM_SplitAnnexB(benchmark::State& state) {
+  const auto bytes = AccessUnitBytes(8, static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto units = ulak::comms::SplitAnnexB(ulak::comms::VideoCodec::kH264, bytes.data(), bytes.size());
+    benchmark::DoNotOptimize(units.data());
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(bytes.size()));
+}
+BENCHMARK(BM_SplitAnnexB)->Arg(1'024)->Arg(32'768);
+
+// Stand-in codec backend (no decoder library is part of the tree): sleeps
+// `decode_us` per picture in place of the codec work and writes every plane of
+// the output, the memory traffic a real decoder's output costs.
+class PlaneWriterDecoder : public ulak::comms::VideoDecoder {
+ public:
+  explicit PlaneWriterDecoder(int decode_us) : decode_us_(decode_us) {}
+
+  ulak::comms::DecodeResult Decode(const ulak::comms::EncodedAccessUnit& unit,
+                                   ulak::comms::YuvFrame* out) override {
+    if (decode_us_ > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(decode_us_));
+    }
+    if (!unit.info.has_vcl) {
+      return ulak::comms::DecodeResult::kNoFrame;
+    }
+    const auto rows = static_cast<std::size_t>(out->height);
+    std::memset(out->planes[0], static_cast<int>(unit.pts_us & 0xFF),
+                static_cast<std::size_t>(out->strides[0]) * rows);
+    std::memset(out->planes[1], 128, static_cast<std::size_t>(out->strides[1]) * ((rows + 1) / 2));
+    std::memset(out->planes[2], 128, static_cast<std::size_t>(out->strides[2]) * ((rows + 1) / 2));
+    out->pts_us = unit.pts_us;
+    out->keyframe = unit.info.keyframe;
+    return ulak::comms::DecodeResult::kFrame;
+  }
+
+ private:
+  const int decode_us_;
+};
+
+ulak::comms::VideoDecoderFactory PlaneWriterFactory(int decode_us) {
+  return [decode_us](const ulak::comms::VideoDecodeConfig&, std::string*) {
+    return std::make_unique<PlaneWriterDecoder>(decode_us);
+  };
+}
+
+// One second of 1080p30 H.264 at about 4 Mbit/s: SPS+PPS+IDR, then reference
+// P and non-reference B pictures alternating.
+std::vector<ulak::comms::EncodedAccessUnit> OneSecondOf1080p30() {
+  std::vector<ulak::comms::EncodedAccessUnit> units;
+  for (int index = 0; index < 30; ++index) {
+    std::vector<std::uint8_t> bytes;
+    const auto nal = [&bytes](std::uint8_t header, std::size_t size) {
+      const std::uint8_t start[] = {0, 0, 0, 1, header};
+      bytes.insert(bytes.end(), start, start + sizeof(start));
+      bytes.insert(bytes.end(), size, 0xAA);
+    };
+    if (index == 0) {
+      nal(0x67, 12);
+      nal(0x68, 4);
+      nal(0x65, 60'000);
+    } else if (index % 2 == 1) {
+      nal(0x41, 15'000);
+    } else {
+      nal(0x01, 6'000);
+    }
+    units.push_back(ulak::comms::MakeAccessUnit(ulak::comms::VideoCodec::kH264, std::move(bytes),
+                                                index * 33'333));
+  }
+  return units;
+}
+
+// Pipeline cost per 1080p picture: queue, pooled frame, full-plane output and
+// the display handoff, one access unit at a time.
+void BM_DecodePipeline1080pFrame(benchmark::State& state) {
+  ulak::comms::VideoDecodeConfig config;
+  config.decoder_threads = 1;
+  ulak::comms::VideoDecodePipeline pipeline(config, PlaneWriterFactory(0));
+  std::string reason;
+  if (!pipeline.Start(&reason)) {
+    state.SkipWithError(reason.c_str());
+    return;
+  }
+  const auto second = OneSecondOf1080p30();
+  std::size_t next = 0;
+  for (auto _ : state) {
+    pipeline.Submit(second[next]);
+    pipeline.WaitIdle();
+    benchmark::DoNotOptimize(pipeline.output().Take());
+    next = next + 1 == second.size() ? 0 : next + 1;
+  }
+  pipeline.Stop();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DecodePipeline1080pFrame)->Unit(benchmark::kMicrosecond);
+
+// A 1080p30 stream submitted in real time for one second per iteration, with
+// range(0) ms of decode work per picture: 20 keeps up with the 33 ms frame
+// interval, 45 does not and has to shed non-reference pictures.
+void BM_DecodePipeline1080p30Paced(benchmark::State& state) {
+  ulak::comms::VideoDecodeConfig config;
+  config.decoder_threads = 1;
+  ulak::comms::VideoDecodePipeline pipeline(
+      config, PlaneWriterFactory(static_cast<int>(state.range(0)) * 1000));
+  std::string reason;
+  if (!pipeline.Start(&reason)) {
+    state.SkipWithError(reason.c_str());
+    return;
+  }
+  const auto second = OneSecondOf1080p30();
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& unit : second) {
+      std::this_thread::sleep_until(start + std::chrono::microseconds(unit.pts_us));
+      pipeline.Submit(unit);
+    }
+    pipeline.WaitIdle();
+  }
+  pipeline.Stop();
+  const auto stats = pipeline.stats();
+  const auto seconds = static_cast<double>(state.iterations());
+  state.counters["published_fps"] = static_cast<double>(stats.published) / seconds;
+  state.counters["dropped_non_ref_per_s"] =
+      static_cast<double>(stats.dropped_non_reference) / seconds;
+  state.counters["resyncs"] = static_cast<double>(stats.keyframe_resyncs);
+  state.counters["smoothed_decode_ms"] = static_cast<double>(stats.smoothed_decode_us) / 1000.0;
+}
+BENCHMARK(BM_DecodePipeline1080p30Paced)
+    ->Arg(20)
+    ->Arg(45)
+    ->Iterations(2)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// A 20-minute 30 fps recording with a 1 s GOP in 60 s segments (36'000 units,
+// 1'200 keyframes). Only segment heads carry SPS/PPS, so most seeks also read
+// the parameter sets back from the segment file.
+class RecordingFixture : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State&) override {
+    directory_ = std::filesystem::temp_directory_path() /
+                 ("ulak_bench_recording_" +
+                  std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(directory_);
+    ulak::comms::RecordingConfig config;
+    config.directory = directory_;
+    config.segment_duration_us = 60'000'000;
+    ulak::comms::SegmentRecorder recorder(config);
+    std::string reason;
+    ok_ = recorder.Open(&reason);
+    for (int n = 0; ok_ && n < kUnits; ++n) {
+      std::vector<std::uint8_t> data;
+      if (n == 0) {
+        data = {0, 0, 0, 1, 0x67, 0x42, 0x00, 0x1F, 0, 0, 0, 1, 0x68, 0xCE};
+      }
+      const bool idr = n % 30 == 0;
+      data.insert(data.end(), {0, 0, 0, 1, static_cast<std::uint8_t>(idr ? 0x65 : 0x41), 0x88,
+                               static_cast<std::uint8_t>(n & 0xFF), 0x80});
+      auto unit = ulak::comms::MakeAccessUnit(ulak::comms::VideoCodec::kH264, std::move(data),
+                                              static_cast<std::int64_t>(n) * kFrameUs);
+      unit.receive_time_us = static_cast<std::int64_t>(n) * kFrameUs;
+      ok_ = recorder.Write(unit, &reason);
+    }
+    recorder.Close();
+    ok_ = ok_ && index_.Load(directory_, "stream", &reason);
+  }
+
+  void TearDown(const benchmark::State&) override {
+    std::error_code error;
+    std::filesystem::remove_all(directory_, error);
+  }
+
+ protected:
+  static constexpr int kUnits = 36'000;
+  static constexpr std::int64_t kFrameUs = 33'333;
+
+  std::filesystem::path directory_;
+  ulak::comms::RecordingIndex index_;
+  bool ok_{false};
+};
+
+// Timeline scrubbing: seeks spread over the whole recording, each landing
+// mid-GOP at a different segment.
+BENCHMARK_F(RecordingFixture, Seek)(benchmark::State& state) {
+  if (!ok_) {
+    state.SkipWithError("recording fixture did not write");
+    return;
+  }
+  const std::int64_t span_us = static_cast<std::int64_t>(kUnits) * kFrameUs;
+  std::int64_t time_us = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index_.Seek(time_us));
+    time_us = (time_us + 7'919'993) % span_us;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Opening a recording for review: reads every segment's index.
+BENCHMARK_F(RecordingFixture, Load)(benchmark::State& state) {
+  if (!ok_) {
+    state.SkipWithError("recording fixture did not write");
+    return;
+  }
+  for (auto _ : state) {
+    ulak::comms::RecordingIndex index;
+    std::string reason;
+    if (!index.Load(directory_, "stream", &reason)) {
+      state.SkipWithError("recording index did not load");
+      break;
+    }
+    benchmark::DoNotOptimize(index.keyframe_count());
+  }
+}
+
+// 1080p I420 to a 1280x720 RGBA staging buffer, per kernel path.
+void BM_FrameScalerI420(benchmark::State& state) {
+  const auto path = static_cast<ulak::comms::PixelKernelPath>(state.range(0));
+  constexpr int kWidth = 1920;
+  constexpr int kHeight = 1080;
+  std::vector<std::uint8_t> luma(static_cast<std::size_t>(kWidth) * kHeight, 120);
+  std::vector<std::uint8_t> cb(static_cast<std::size_t>(kWidth / 2) * (kHeight / 2), 100);
+  std::vector<std::uint8_t> cr(cb.size(), 160);
+  ulak::comms::ImageView source;
+  source.format = ulak::comms::PixelFormat::kI420;
+  source.width = kWidth;
+  source.height = kHeight;
+  source.planes[0] = luma.data();
+  source.planes[1] = cb.data();
+  source.planes[2] = cr.data();
+  source.strides[0] = kWidth;
+  source.strides[1] = kWidth / 2;
+  source.strides[2] = kWidth / 2;
+
+  std::vector<std::uint8_t> pixels(1280u * 720u * 4u);
+  ulak::comms::RgbaImage destination{pixels.data(), 1280, 720, 1280 * 4};
+
+  ulak::comms::FrameScaler scaler;
+  scaler.set_path(path);
+  state.SetLabel(ulak::comms::ToString(path));
+  std::string reason;
+  for (auto _ : state) {
+    if (!scaler.Convert(source, destination, &reason)) {
+      state.SkipWithError("convert failed");
+      break;
+    }
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_FrameScalerI420)
+    ->Arg(static_cast<int>(ulak::comms::PixelKernelPath::kScalar))
+    ->Arg(static_cast<int>(ulak::comms::BestPixelKernelPath()))
+    ->Unit(benchmark::kMillisecond);
+
+void BM_OverlayRender(benchmark::State& state) {
+  ulak::comms::PerceptionOverlayRenderer renderer;
+  ulak::models::PerceptionTarget target;
+  target.color = "red";
+  target.shape = "triangle";
+  target.confidence = 0.9;
+  std::int64_t now_us = 0;
+  for (auto _ : state) {
+    // A new sample every display tick: every Render rebuilds the buffer.
+    target.alignment_dx = (now_us % 2'000'000) / 2'000'000.0 - 0.5;
+    target.receive_time_us = now_us;
+    renderer.OnTarget(target);
+    now_us += 16'667;
+    benchmark::DoNotOptimize(renderer.Render(now_us));
+  }
+}
+BENCHMARK(BM_OverlayRender);
+
+ulak::comms::SharedStateConfig BenchSharedStateConfig() {
+  ulak::comms::SharedStateConfig config;
+  config.name = "/ulak_bench_state";
+  config.frame_width = 0;
+  config.frame_height = 0;
+  return config;
+}
+
+void BM_SharedStatePublishTelemetry(benchmark::State& state) {
+  ulak::comms::SharedStateWriter writer(BenchSharedStateConfig());
+  std::string reason;
+  if (!writer.Open(&reason)) {
+    state.SkipWithError(reason.c_str());
+    return;
+  }
+  ulak::models::TelemetryFrame frame;
+  frame.telemetry_type = "vehicle";
+  frame.frame_id = "map";
+  frame.vehicle_mode = "GUIDED";
+  for (auto _ : state) {
+    frame.receive_time_us += 20'000;
+    writer.PublishTelemetry(frame);
+  }
+}
+BENCHMARK(BM_SharedStatePublishTelemetry);
+
+void BM_SharedStateReadTelemetry(benchmark::State& state) {
+  ulak::comms::SharedStateWriter writer(BenchSharedStateConfig());
+  ulak::comms::SharedStateReader reader;
+  std::string reason;
+  if (!writer.Open(&reason) || !reader.Open(writer.config().name, &reason)) {
+    state.SkipWithError(reason.c_str());
+    return;
+  }
+  writer.PublishTelemetry(ulak::models::TelemetryFrame{});
+  ulak::comms::SharedTelemetry telemetry;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reader.ReadTelemetry(&telemetry));
+  }
+}
+BENCHMARK(BM_SharedStateReadTelemetry);
+
+std::int64_t SteadyNowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// A STOP_MISSION issued while 256 SET_PARAM messages are queued on a loopback
+// command socket drained by another thread; range(0) is max_batch_messages.
+// One iteration sends the whole backlog; the counters are the per-class
+// head-of-line delays.
+void BM_CommandStopBehindTuningBacklog(benchmark::State& state) {
+  constexpr int kBacklog = 256;
+  const int listener = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  listen(listener, 1);
+  getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+  const int client = socket(AF_INET, SOCK_STREAM, 0);
+  if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    state.SkipWithError("loopback connect failed");
+    close(client);
+    close(listener);
+    return;
+  }
+  const int server = accept(listener, nullptr, nullptr);
+  close(listener);
+  std::thread reader([server] {
+    char buffer[64 * 1024];
+    while (read(server, buffer, sizeof(buffer)) > 0) {
+    }
+  });
+
+  ulak::comms::CommandSendConfig config;
+  config.max_batch_messages = static_cast<std::size_t>(state.range(0));
+  config.max_queued[2] = kBacklog;
+  ulak::comms::CommandSendScheduler scheduler(config);
+  std::string reason;
+  scheduler.Attach(client, &reason);
+  const std::string tuning(256, 'p');
+  const std::string stop(128, 's');
+  for (auto _ : state) {
+    for (int i = 0; i < kBacklog; ++i) {
+      scheduler.Enqueue(ulak::comms::CommandPriority::kTuning, tuning, SteadyNowUs());
+    }
+    scheduler.Pump(SteadyNowUs(), &reason);
+    scheduler.Enqueue(ulak::comms::CommandPriority::kSafety, stop, SteadyNowUs());
+    while (scheduler.wants_write()) {
+      if (!scheduler.Pump(SteadyNowUs(), &reason)) {
+        state.SkipWithError(reason.c_str());
+        break;
+      }
+      pollfd writable{client, POLLOUT, 0};
+      poll(&writable, 1, 10);
+    }
+  }
+  const auto stats = scheduler.Stats();
+  state.counters["stop_hol_p99_us"] = static_cast<double>(stats[0].hol_p99_us);
+  state.counters["tuning_hol_p99_us"] = static_cast<double>(stats[2].hol_p99_us);
+  state.counters["writes_per_batch"] =
+      static_cast<double>(stats[2].writes) / static_cast<double>(state.iterations());
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * (kBacklog + 1));
+
+  shutdown(client, SHUT_WR);
+  reader.join();
+  close(client);
+  close(server);
+}
+BENCHMARK(BM_CommandStopBehindTuningBacklog)->Arg(1)->Arg(16)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Compares two sauro_station_bench JSON results.
+
+Usage: compare.py BASELINE.json CANDIDATE.json [--threshold PERCENT] [--metric real_time|cpu_time]
+
+Benchmarks are matched by name. With --benchmark_repetitions the median
+aggregate is used; otherwise the single run. Exits 1 when any benchmark got
+slower by more than the threshold (default 10%), so CI can gate on it.
+"""
+
+import argparse
+import json
+import sys
+
+_TIME_UNITS_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    with open(path, encoding="utf-8") as handle:
+        document = json.load(handle)
+
+    runs = {}
+    medians = {}
+    for entry in document.get("benchmarks", []):
+        if entry.get("error_occurred"):
+            continue
+        value = float(entry[metric]) * _TIME_UNITS_NS[entry.get("time_unit", "ns")]
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[entry["run_name"]] = value
+        else:
+            runs.setdefault(entry.get("run_name", entry["name"]), value)
+    runs.update(medians)
+    return runs
+
+
+def format_ns(value):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if value >= scale:
+            return f"{value / scale:.2f} {unit}"
+    return f"{value:.1f} ns"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="regression threshold in percent (default 10)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="cpu_time")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.metric)
+    candidate = load(args.candidate, args.metric)
+
+    regressions = []
+    width = max((len(name) for name in baseline.keys() | candidate.keys()), default=9)
+    print(f"{'Benchmark':<{width}}  {'Baseline':>12}  {'Candidate':>12}  {'Change':>8}")
+    for name in sorted(baseline.keys() | candidate.keys()):
+        if name not in baseline or name not in candidate:
+            side = "candidate" if name not in baseline else "baseline"
+            print(f"{name:<{width}}  only in {side}")
+            continue
+        before = baseline[name]
+        after = candidate[name]
+        change = (after - before) / before * 100.0 if before > 0 else 0.0
+        marker = ""
+        if change > args.threshold:
+            marker = "  REGRESSION"
+            regressions.append(name)
+        print(f"{name:<{width}}  {format_ns(before):>12}  {format_ns(after):>12}  "
+              f"{change:>+7.1f}%{marker}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than {args.threshold:g}%: "
+              + ", ".join(regressions))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
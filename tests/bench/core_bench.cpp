@@ -0,0 +1,392 @@
+#include "CommandLifecycle.h"
+#include "HdrHistogram.h"
+#include "MissionStateTracker.h"
+#include "PanicAuditLog.h"
+#include "SafetyEventAggregator.h"
+#include "SpatialSafetyMonitor.h"
+#include "TelemetryArchive.h"
+#include "ThreadTopology.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+std::vector<std::string> CorrelationIds(std::size_t count) {
+  std::vector<std::string> ids;
+  ids.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    ids.push_back("bench-" + std::to_string(i));
+  }
+  return ids;
+}
+
+// Track, ACK and complete one command with range(0) others in flight.
+// The audit log is unbounded, so the lifecycle is rebuilt (untimed) every
+// kRebuildEvery iterations to keep memory flat.
+void BM_CommandLifecycleRoundTrip(benchmark::State& state) {
+  constexpr std::int64_t kRebuildEvery = 4096;
+  const auto background = CorrelationIds(static_cast<std::size_t>(state.range(0)));
+  const auto make = [&background] {
+    auto lifecycle = std::make_unique<ulak::core::CommandLifecycle>();
+    for (const auto& id : background) {
+      lifecycle->Track(id, "SET_PARAM", "companion_computer", 0);
+    }
+    return lifecycle;
+  };
+  auto lifecycle = make();
+  const std::string id = "bench-round-trip";
+  std::int64_t now_us = 0;
+  std::int64_t iteration = 0;
+  for (auto _ : state) {
+    if (++iteration % kRebuildEvery == 0) {
+      state.PauseTiming();
+      lifecycle = make();
+      state.ResumeTiming();
+    }
+    lifecycle->Track(id, "START_MISSION", "companion_computer", now_us);
+    lifecycle->OnAck(id, now_us + 20'000);
+    benchmark::DoNotOptimize(lifecycle->OnCompletionEvidence(id, now_us + 500'000));
+    now_us += 1'000;
+  }
+}
+BENCHMARK(BM_CommandLifecycleRoundTrip)->Arg(0)->Arg(64);
+
+void BM_CommandLifecyclePoll(benchmark::State& state) {
+  ulak::core::CommandLifecycle lifecycle;
+  for (const auto& id : CorrelationIds(static_cast<std::size_t>(state.range(0)))) {
+    lifecycle.Track(id, "SET_PARAM", "companion_computer", 0);
+  }
+  for (auto _ : state) {
+    // Before the first ACK deadline: the common case is "nothing due".
+    auto actions = lifecycle.Poll(1'000);
+    benchmark::DoNotOptimize(actions.data());
+  }
+}
+BENCHMARK(BM_CommandLifecyclePoll)->Arg(8)->Arg(64);
+
+// Steady-state `mission/state` at 1 Hz: same state, no transition.
+void BM_MissionStateRepeat(benchmark::State& state) {
+  ulak::core::MissionStateTracker tracker;
+  ulak::models::MissionStateUpdate update;
+  update.state = "MISSION_RUNNING";
+  update.progress = 0.5;
+  update.note = "waypoint 3/7";
+  tracker.OnMissionState(update);
+  for (auto _ : state) {
+    update.receive_time_us += 1'000'000;
+    benchmark::DoNotOptimize(tracker.OnMissionState(update));
+  }
+}
+BENCHMARK(BM_MissionStateRepeat);
+
+void BM_MissionStateTransition(benchmark::State& state) {
+  ulak::core::MissionStateTracker tracker;
+  ulak::models::MissionStateUpdate running;
+  running.state = "MISSION_RUNNING";
+  ulak::models::MissionStateUpdate paused;
+  paused.state = "MISSION_PAUSED";
+  paused.note = "operator pause";
+  std::int64_t now_us = 0;
+  for (auto _ : state) {
+    running.receive_time_us = now_us += 1'000;
+    tracker.OnMissionState(running);
+    paused.receive_time_us = now_us += 1'000;
+    tracker.OnMissionState(paused);
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * 2);
+}
+BENCHMARK(BM_MissionStateTransition);
+
+void BM_PanicAuditRecord(benchmark::State& state) {
+  ulak::core::PanicAuditRing ring;
+  const auto entry = ulak::core::MakePanicAuditEntry(
+      "PANIC_RTL", "7d3c9a52-1f0e-4b8a-9c61-2e5f4d8b0a17", "default",
+      ulak::core::PanicAuditOutcome::kSent, 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ring.Record(entry));
+  }
+}
+BENCHMARK(BM_PanicAuditRecord);
+
+void BM_MakePanicAuditEntry(benchmark::State& state) {
+  for (auto _ : state) {
+    auto entry = ulak::core::MakePanicAuditEntry(
+        "PANIC_RTL", "7d3c9a52-1f0e-4b8a-9c61-2e5f4d8b0a17", "default",
+        ulak::core::PanicAuditOutcome::kConfirmed, 1'000, 250'000);
+    benchmark::DoNotOptimize(entry);
+  }
+}
+BENCHMARK(BM_MakePanicAuditEntry);
+
+// A 10-minute flight at 10 Hz with a mode change per minute.
+class ArchiveFixture : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State&) override {
+    path_ = std::filesystem::temp_directory_path() /
+            ("ulak_bench_archive_" +
+             std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".col");
+    ulak::core::TelemetryArchiveWriter writer;
+    const char* modes[] = {"AUTO", "GUIDED", "LOITER", "RTL"};
+    for (int i = 0; i < 6'000; ++i) {
+      ulak::models::TelemetryFrame frame;
+      frame.frame_id = "map_NED";
+      frame.position_m = {i * 0.1, i * 0.05, -20.0 - (i % 600) * 0.01};
+      frame.vehicle_mode = modes[(i / 600) % 4];
+      frame.battery_percent = 100 - i / 120;
+      frame.receive_time_us = static_cast<std::int64_t>(i) * 100'000;
+      writer.Append(frame);
+    }
+    std::string reason;
+    ok_ = writer.Finish(path_, &reason);
+  }
+
+  void TearDown(const benchmark::State&) override {
+    std::error_code error;
+    std::filesystem::remove(path_, error);
+  }
+
+ protected:
+  std::filesystem::path path_;
+  bool ok_{false};
+};
+
+BENCHMARK_F(ArchiveFixture, OpenAndQuery)(benchmark::State& state) {
+  if (!ok_) {
+    state.SkipWithError("archive fixture did not write");
+    return;
+  }
+  for (auto _ : state) {
+    ulak::core::TelemetryArchive archive;
+    std::string reason;
+    if (!archive.Open(path_, &reason)) {
+      state.SkipWithError("archive did not open");
+      break;
+    }
+    benchmark::DoNotOptimize(archive.MaxAltitudeM());
+    benchmark::DoNotOptimize(archive.TimeInModes().size());
+    benchmark::DoNotOptimize(archive.BatteryDrainPercentPerMinute());
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * 6'000);
+}
+
+// range(0) vehicles at 50 Hz each over a 2 km square with 200 keep-out
+// polygons and one keep-in flight area; one iteration is one Update(), so
+// the reported time is the per-frame cost. Vehicles fly in pairs on shared
+// orbits, so separation alerts are raised and cleared along the way.
+void BM_SpatialSafetyUpdate(benchmark::State& state) {
+  constexpr int kZones = 200;
+  constexpr int kSteps = 500;
+  constexpr double kPi = 3.14159265358979323846;
+  const int vehicles = static_cast<int>(state.range(0));
+
+  std::vector<ulak::core::GeofenceZone> zones;
+  ulak::core::GeofenceZone area;
+  area.id = 0;
+  area.kind = ulak::core::GeofenceKind::kKeepIn;
+  area.polygon = {{-1'000.0, -1'000.0}, {1'000.0, -1'000.0}, {1'000.0, 1'000.0}, {-1'000.0, 1'000.0}};
+  area.floor_m = 0.0;
+  area.ceiling_m = 120.0;
+  zones.push_back(area);
+  for (int i = 0; i < kZones; ++i) {
+    ulak::core::GeofenceZone zone;
+    zone.id = static_cast<std::uint32_t>(i + 1);
+    const double cx = -950.0 + (i % 20) * 100.0;
+    const double cy = -950.0 + (i / 20) * 200.0;
+    for (int k = 0; k < 6; ++k) {
+      const double angle = k * kPi / 3.0;
+      zone.polygon.push_back({cx + 25.0 * std::cos(angle), cy + 25.0 * std::sin(angle)});
+    }
+    zone.ceiling_m = 60.0;
+    zones.push_back(std::move(zone));
+  }
+
+  std::vector<ulak::models::TelemetryFrame> frames(static_cast<std::size_t>(vehicles) * kSteps);
+  for (int v = 0; v < vehicles; ++v) {
+    const int orbit = v / 2;
+    const double cx = -800.0 + (orbit % 8) * 200.0;
+    const double cy = -800.0 + (orbit / 8) * 200.0;
+    const double radius = 60.0 + (orbit % 3) * 20.0;
+    for (int step = 0; step < kSteps; ++step) {
+      const double angle = 2.0 * kPi * step / kSteps + (v % 2) * 0.15 * (1.0 + std::sin(step * 0.05));
+      auto& frame = frames[static_cast<std::size_t>(step) * vehicles + v];
+      frame.frame_id = "LOCAL_NED";
+      frame.position_m.x = cx + radius * std::cos(angle);
+      frame.position_m.y = cy + radius * std::sin(angle);
+      frame.position_m.z = -(40.0 + (v % 4) * 5.0);
+    }
+  }
+
+  ulak::core::SpatialSafetyMonitor monitor;
+  std::string reason;
+  if (!monitor.SetZones(std::move(zones), &reason)) {
+    state.SkipWithError("zones did not load");
+    return;
+  }
+  const std::int64_t step_us = 20'000 / vehicles;
+  std::int64_t now_us = 1;
+  std::size_t next = 0;
+  std::int64_t events = 0;
+  for (auto _ : state) {
+    auto& frame = frames[next];
+    frame.receive_time_us = now_us;
+    const auto vehicle = static_cast<ulak::core::VehicleId>(next % vehicles);
+    events += static_cast<std::int64_t>(monitor.Update(vehicle, frame).size());
+    next = next + 1 == frames.size() ? 0 : next + 1;
+    now_us += step_us;
+  }
+  state.counters["events"] = static_cast<double>(events);
+  state.counters["pair_checks_per_update"] = benchmark::Counter(
+      static_cast<double>(monitor.pair_checks()), benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_SpatialSafetyUpdate)->Arg(50)->Arg(200)->Unit(benchmark::kMicrosecond);
+
+// A flapping link: range(0) distinct codes storming at 1 kHz in total, with a
+// "10 WARNs in 1s -> ERROR" rule and the 100 ms health timer flushing. One
+// iteration is one Submit(); `forwarded_ratio` is what reaches the classifier.
+void BM_SafetyEventStorm(benchmark::State& state) {
+  const int codes = static_cast<int>(state.range(0));
+  ulak::core::SafetyEventAggregator aggregator;
+  ulak::core::SafetyAggregationPolicy policy;
+  policy.escalation.push_back(ulak::core::EscalationRule{
+      "", ulak::models::SafetySeverity::kWarn, 10, 1'000'000,
+      ulak::models::SafetySeverity::kError});
+  std::string reason;
+  aggregator.SetPolicy(policy, &reason);
+
+  std::vector<ulak::models::SafetyEvent> events(static_cast<std::size_t>(codes));
+  for (int i = 0; i < codes; ++i) {
+    events[static_cast<std::size_t>(i)].code = "LINK_FLAP_" + std::to_string(i);
+    events[static_cast<std::size_t>(i)].message = "link flapping";
+  }
+  std::int64_t now_us = 0;
+  std::size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(aggregator.Submit(events[next], now_us));
+    next = next + 1 == events.size() ? 0 : next + 1;
+    now_us += 1'000;
+    if (now_us % 100'000 == 0) {
+      aggregator.Flush(now_us);
+    }
+  }
+  const auto stats = aggregator.Stats();
+  state.counters["forwarded_ratio"] =
+      static_cast<double>(stats.forwarded) / static_cast<double>(stats.received);
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_SafetyEventStorm)->Arg(1)->Arg(20);
+
+// Safety paths against a saturated stream decoder: one CPU-bound "decoder"
+// thread per CPU plus one, and a 1 kHz safety loop that sends a PANIC_RTL
+// sized UDP datagram and then classifies one safety event per tick. Both
+// latencies run from the tick's deadline, so they include the wake-up delay
+// the decoder causes. range(0) = 1 applies DefaultThreadTopology() (safety on
+// SCHED_FIFO, decoder at nice 10); without privileges it falls back to nice
+// levels and `degraded` counts the fallbacks. One iteration is the whole run.
+void BM_SafetyPathJitter(benchmark::State& state) {
+  using Clock = std::chrono::steady_clock;
+  constexpr int kTicks = 3'000;
+  constexpr auto kPeriod = std::chrono::milliseconds(1);
+  ulak::utils::ThreadTopology topology;
+  std::string reason;
+  if (!topology.Configure(state.range(0) != 0 ? ulak::utils::DefaultThreadTopology()
+                                              : ulak::utils::ThreadTopologyConfig{},
+                          &reason)) {
+    state.SkipWithError(reason.c_str());
+    return;
+  }
+
+  const int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+  const int sender = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length);
+  const std::uint8_t command_long[41] = {0xFE, 33, 0, 255, 190, 76};
+
+  ulak::utils::HdrHistogram panic_ns;
+  ulak::utils::HdrHistogram classify_ns;
+  std::size_t degraded = 0;
+  for (auto _ : state) {
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> decoders;
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i <= cpus; ++i) {
+      decoders.emplace_back([&] {
+        topology.EnterSubsystem("stream_decode");
+        std::uint64_t x = 1;
+        while (!stop.load(std::memory_order_relaxed)) {
+          for (int k = 0; k < 10'000; ++k) {
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+          }
+          benchmark::DoNotOptimize(x);
+        }
+      });
+    }
+
+    std::thread safety([&] {
+      degraded = topology.EnterSubsystem("panic_dispatch").degraded.size();
+      ulak::core::SafetyEventAggregator aggregator;
+      ulak::models::SafetyEvent event;
+      event.severity = ulak::models::SafetySeverity::kWarn;
+      event.message = "decoder saturated";
+      const std::string codes[] = {"VISION_LOST", "CC_LINK_LOSS", "STREAM_LOSS"};
+      std::uint8_t drain[64];
+      auto deadline = Clock::now();
+      for (int tick = 0; tick < kTicks; ++tick) {
+        deadline += kPeriod;
+        std::this_thread::sleep_until(deadline);
+        sendto(sender, command_long, sizeof(command_long), 0,
+               reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        const auto sent = Clock::now();
+        event.code = codes[tick % 3];
+        const auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                sent.time_since_epoch())
+                                .count();
+        benchmark::DoNotOptimize(aggregator.Submit(event, now_us));
+        const auto classified = Clock::now();
+        panic_ns.Record(static_cast<std::uint64_t>((sent - deadline).count()));
+        classify_ns.Record(static_cast<std::uint64_t>((classified - deadline).count()));
+        recv(receiver, drain, sizeof(drain), MSG_DONTWAIT);
+      }
+    });
+    safety.join();
+    stop = true;
+    for (auto& decoder : decoders) {
+      decoder.join();
+    }
+  }
+  close(sender);
+  close(receiver);
+
+  state.counters["panic_p50_us"] = panic_ns.ValueAtPercentile(50.0) / 1e3;
+  state.counters["panic_p999_us"] = panic_ns.ValueAtPercentile(99.9) / 1e3;
+  state.counters["classify_p999_us"] = classify_ns.ValueAtPercentile(99.9) / 1e3;
+  state.counters["max_us"] = classify_ns.max() / 1e3;
+  state.counters["degraded"] = static_cast<double>(degraded);
+}
+BENCHMARK(BM_SafetyPathJitter)
+    ->Arg(0)
+    ->Arg(1)
+    ->Iterations(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,94 @@
+#include "WireEnvelope.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+ulak::models::WireEnvelope CompanionEnvelope(ulak::models::MessageCategory category) {
+  ulak::models::WireEnvelope envelope;
+  envelope.category = category;
+  envelope.source = ulak::models::MessageSource::kCompanionComputer;
+  envelope.timestamp_us = 1'770'750'000'000'000;
+  envelope.correlation_id = ulak::utils::GenerateUuidV4();
+  if (category == ulak::models::MessageCategory::kPerceptionOutput) {
+    ulak::models::PerceptionTarget target;
+    target.color = "red";
+    target.shape = "triangle";
+    target.alignment_dx = -0.125;
+    target.alignment_dy = 0.0625;
+    target.confidence = 0.875;
+    envelope.payload = target;
+  } else {
+    ulak::models::SafetyEvent event;
+    event.severity = ulak::models::SafetySeverity::kError;
+    event.code = "VISION_LOST";
+    event.message = "Perception input missing for 1.2s";
+    event.recommended_action = "HOLD";
+    envelope.payload = event;
+  }
+  return envelope;
+}
+
+ulak::models::MessageCategory CategoryArg(const benchmark::State& state) {
+  return state.range(0) == 0 ? ulak::models::MessageCategory::kPerceptionOutput
+                             : ulak::models::MessageCategory::kSafetyEvents;
+}
+
+void BM_EncodeBinaryEnvelope(benchmark::State& state) {
+  const auto envelope = CompanionEnvelope(CategoryArg(state));
+  std::vector<std::uint8_t> bytes;
+  bytes.reserve(256);
+  for (auto _ : state) {
+    bytes.clear();
+    benchmark::DoNotOptimize(ulak::models::EncodeBinaryEnvelope(envelope, &bytes, nullptr));
+  }
+  state.counters["bytes"] = static_cast<double>(bytes.size());
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_EncodeBinaryEnvelope)->Arg(0)->Arg(1);
+
+void BM_DecodeBinaryEnvelope(benchmark::State& state) {
+  std::vector<std::uint8_t> bytes;
+  ulak::models::EncodeBinaryEnvelope(CompanionEnvelope(CategoryArg(state)), &bytes, nullptr);
+  ulak::models::WireEnvelope decoded;
+  for (auto _ : state) {
+    auto result = ulak::models::DecodeBinaryEnvelope(bytes.data(), bytes.size(), &decoded);
+    benchmark::DoNotOptimize(result);
+  }
+  state.counters["bytes"] = static_cast<double>(bytes.size());
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_DecodeBinaryEnvelope)->Arg(0)->Arg(1);
+
+// The JSON side of the comparison, on the same two messages.
+void BM_SerializeJsonEnvelope(benchmark::State& state) {
+  const auto envelope = CompanionEnvelope(CategoryArg(state));
+  std::string json;
+  json.reserve(512);
+  for (auto _ : state) {
+    json.clear();
+    benchmark::DoNotOptimize(ulak::models::SerializeJsonEnvelope(envelope, &json, nullptr));
+  }
+  state.counters["bytes"] = static_cast<double>(json.size());
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * json.size()));
+}
+BENCHMARK(BM_SerializeJsonEnvelope)->Arg(0)->Arg(1);
+
+void BM_ParseJsonEnvelope(benchmark::State& state) {
+  std::string json;
+  ulak::models::SerializeJsonEnvelope(CompanionEnvelope(CategoryArg(state)), &json, nullptr);
+  ulak::models::WireEnvelope parsed;
+  for (auto _ : state) {
+    auto result = ulak::models::ParseJsonEnvelope(json, &parsed);
+    benchmark::DoNotOptimize(result);
+  }
+  state.counters["bytes"] = static_cast<double>(json.size());
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * json.size()));
+}
+BENCHMARK(BM_ParseJsonEnvelope)->Arg(0)->Arg(1);
+
+}  // namespace
@@ -0,0 +1,252 @@
+#include "BinaryLog.h"
+#include "ColumnCodec.h"
+#include "CorrelationId.h"
+#include "HdrHistogram.h"
+#include "PolisherParser.h"
+#include "StringInterner.h"
+#include "Tracing.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Baseline: a conventional per-thread mt19937_64 seeded from
+// std::random_device, formatted with snprintf into a std::string.
+std::string BaselineCorrelationId() {
+  thread_local std::mt19937_64 engine{std::random_device{}()};
+  std::uint64_t hi = engine();
+  std::uint64_t lo = engine();
+  hi = (hi & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;
+  lo = (lo & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+  char text[ulak::utils::kUuidTextLength + 1];
+  std::snprintf(text, sizeof(text), "%08x-%04x-%04x-%04x-%012llx",
+                static_cast<unsigned>(hi >> 32), static_cast<unsigned>((hi >> 16) & 0xFFFF),
+                static_cast<unsigned>(hi & 0xFFFF), static_cast<unsigned>(lo >> 48),
+                static_cast<unsigned long long>(lo & 0xFFFFFFFFFFFFULL));
+  return std::string(text, ulak::utils::kUuidTextLength);
+}
+
+void BM_BaselineCorrelationId(benchmark::State& state) {
+  for (auto _ : state) {
+    auto id = BaselineCorrelationId();
+    benchmark::DoNotOptimize(id.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BaselineCorrelationId);
+
+void BM_GenerateCorrelationId(benchmark::State& state) {
+  for (auto _ : state) {
+    auto id = ulak::utils::GenerateCorrelationId();
+    benchmark::DoNotOptimize(id.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GenerateCorrelationId);
+
+// Generator and formatter without the std::string, as the envelope encoders use it.
+void BM_GenerateUuidIntoBuffer(benchmark::State& state) {
+  char text[ulak::utils::kUuidTextLength];
+  for (auto _ : state) {
+    ulak::utils::FormatUuid(ulak::utils::GenerateUuidV4(), text);
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GenerateUuidIntoBuffer);
+
+void BM_StringInternerHit(benchmark::State& state) {
+  ulak::utils::StringInterner interner;
+  const std::vector<std::string> labels = {"AUTO", "GUIDED", "LOITER", "RTL", "LAND", "BRAKE"};
+  for (const auto& label : labels) {
+    interner.Intern(label);
+  }
+  std::size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interner.Intern(labels[next]));
+    next = next + 1 == labels.size() ? 0 : next + 1;
+  }
+}
+BENCHMARK(BM_StringInternerHit);
+
+void BM_HdrHistogramRecord(benchmark::State& state) {
+  ulak::utils::HdrHistogram histogram;
+  std::uint64_t value = 1;
+  for (auto _ : state) {
+    histogram.Record(value);
+    value = (value * 2'862'933'555'777'941'757ULL + 3'037'000'493ULL) >> 44;
+  }
+  benchmark::DoNotOptimize(histogram.count());
+}
+BENCHMARK(BM_HdrHistogramRecord);
+
+void BM_HdrHistogramPercentile(benchmark::State& state) {
+  ulak::utils::HdrHistogram histogram;
+  for (std::uint64_t i = 1; i <= 100'000; ++i) {
+    histogram.Record(i * 37 % 250'000);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(histogram.ValueAtPercentile(99.0));
+  }
+}
+BENCHMARK(BM_HdrHistogramPercentile);
+
+// Timestamps at 10 Hz with jitter: the archive's most common column.
+std::vector<std::int64_t> TimestampColumn(std::size_t count) {
+  std::vector<std::int64_t> values(count);
+  std::int64_t time_us = 1'760'000'000'000'000;
+  for (std::size_t i = 0; i < count; ++i) {
+    time_us += 100'000 + static_cast<std::int64_t>(i * 7'919 % 2'000) - 1'000;
+    values[i] = time_us;
+  }
+  return values;
+}
+
+void BM_EncodeDeltaColumn(benchmark::State& state) {
+  const auto values = TimestampColumn(static_cast<std::size_t>(state.range(0)));
+  std::vector<std::uint8_t> encoded;
+  for (auto _ : state) {
+    encoded.clear();
+    ulak::utils::EncodeDeltaColumn(values.data(), values.size(), &encoded);
+    benchmark::DoNotOptimize(encoded.data());
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_EncodeDeltaColumn)->Arg(6'000);
+
+void BM_DecodeDeltaColumn(benchmark::State& state) {
+  const auto values = TimestampColumn(static_cast<std::size_t>(state.range(0)));
+  std::vector<std::uint8_t> encoded;
+  ulak::utils::EncodeDeltaColumn(values.data(), values.size(), &encoded);
+  std::vector<std::int64_t> decoded(values.size());
+  for (auto _ : state) {
+    if (!ulak::utils::DecodeDeltaColumn(encoded.data(), encoded.size(), decoded.size(),
+                                        decoded.data())) {
+      state.SkipWithError("decode failed");
+      break;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_DecodeDeltaColumn)->Arg(6'000);
+
+void BM_ParsePolisherSource(benchmark::State& state) {
+  // 64 params followed by a 10k-line script body the parser has to skip.
+  std::string source = "import cv2\n\n@polisher_start\n";
+  for (int i = 0; i < 64; ++i) {
+    source += "@polisher_param(label=\"Param " + std::to_string(i) +
+              "\", type=\"slider\", min=0, max=255)\n";
+    source += "param_" + std::to_string(i) + " = " + std::to_string(i * 3) + "\n";
+  }
+  source += "@polisher_end\n\ndef process(frame):\n";
+  for (int i = 0; i < 10'000; ++i) {
+    source += "    frame = cv2.GaussianBlur(frame, (5, 5), 0)  # step " + std::to_string(i) + "\n";
+  }
+  source += "    return frame\n";
+  if (!ulak::utils::ParsePolisherSource(source).ok) {
+    state.SkipWithError("fixture script did not parse");
+    return;
+  }
+  for (auto _ : state) {
+    auto result = ulak::utils::ParsePolisherSource(source);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(source.size()));
+}
+BENCHMARK(BM_ParsePolisherSource)->Unit(benchmark::kMillisecond);
+
+// Cost of one trace point with tracing compiled in. The collector drains every
+// 1024 spans, as the stats endpoint would, so the ring never fills.
+void BM_TraceScope(benchmark::State& state) {
+  auto& tracer = ulak::utils::Tracer::Instance();
+  std::uint32_t spans = 0;
+  for (auto _ : state) {
+    {
+      ulak::utils::TraceScope scope(ulak::utils::TraceStage::kRecv);
+    }
+    if (++spans % 1024 == 0) {
+      tracer.Collect();
+    }
+  }
+}
+BENCHMARK(BM_TraceScope);
+
+// Cost of one log call on the calling thread. Every 1024 records the ring is
+// flushed untimed, as the logger thread would keep up in flight, so the
+// numbers are for accepted records, not the cheaper drop path.
+template <typename Log>
+void RunLogBenchmark(benchmark::State& state, const char* name, Log log) {
+  auto& logger = ulak::utils::Logger::Instance();
+  ulak::utils::LoggerConfig config;
+  config.path = std::filesystem::temp_directory_path() / (std::string("ulak_bench_") + name + ".bin");
+  std::string reason;
+  if (!logger.Start(config, &reason)) {
+    state.SkipWithError(reason.c_str());
+    return;
+  }
+  const std::uint64_t dropped_before = logger.Stats().dropped;
+  std::uint32_t records = 0;
+  for (auto _ : state) {
+    log(records);
+    if (++records % 1024 == 0) {
+      state.PauseTiming();
+      logger.Flush();
+      state.ResumeTiming();
+    }
+  }
+  logger.Flush();
+  const auto stats = logger.Stats();
+  logger.Stop();
+  std::filesystem::remove(config.path);
+  state.counters["dropped"] = static_cast<double>(stats.dropped - dropped_before);
+  state.counters["file_bytes_per_record"] =
+      stats.records > 0
+          ? static_cast<double>(stats.file_bytes) / static_cast<double>(stats.records)
+          : 0.0;
+}
+
+void BM_LogDebugIntegers(benchmark::State& state) {
+  RunLogBenchmark(state, "ints", [](std::uint32_t i) {
+    ULAK_LOG_DEBUG("frame %u decoded in %d us, mode %u", i, 37, 4u);
+  });
+}
+BENCHMARK(BM_LogDebugIntegers);
+
+void BM_LogDebugMixed(benchmark::State& state) {
+  const std::string frame_id = "LOCAL_NED";
+  RunLogBenchmark(state, "mixed", [&frame_id](std::uint32_t i) {
+    ULAK_LOG_DEBUG("classified %s seq %u at %.3f m", frame_id, i, 12.5);
+  });
+}
+BENCHMARK(BM_LogDebugMixed);
+
+// Call site whose level is filtered out.
+void BM_LogDisabledLevel(benchmark::State& state) {
+  auto& logger = ulak::utils::Logger::Instance();
+  ulak::utils::LoggerConfig config;
+  config.path = std::filesystem::temp_directory_path() / "ulak_bench_disabled.bin";
+  config.min_level = ulak::utils::LogLevel::kInfo;
+  std::string reason;
+  if (!logger.Start(config, &reason)) {
+    state.SkipWithError(reason.c_str());
+    return;
+  }
+  std::uint32_t i = 0;
+  for (auto _ : state) {
+    ULAK_LOG_DEBUG("frame %u", i++);
+  }
+  logger.Stop();
+  std::filesystem::remove(config.path);
+}
+BENCHMARK(BM_LogDisabledLevel);
+
+}  // namespace
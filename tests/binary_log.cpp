@@ -0,0 +1,274 @@
+#include "BinaryLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::utils::DecodedLogEntry;
+using ulak::utils::LogLevel;
+using ulak::utils::Logger;
+using ulak::utils::LoggerConfig;
+
+enum class Mode { kHold = 3 };
+
+std::filesystem::path TempLogPath(const std::string& name) {
+  const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+  return std::filesystem::temp_directory_path() /
+         ("ulak_log_" + name + "_" + std::to_string(stamp) + ".bin");
+}
+
+bool StartLogger(const std::filesystem::path& path, LogLevel level = LogLevel::kDebug) {
+  LoggerConfig config;
+  config.path = path;
+  config.min_level = level;
+  std::string reason;
+  return Expect(Logger::Instance().Start(config, &reason), "Expected the logger to start: " + reason);
+}
+
+std::vector<DecodedLogEntry> Decode(const std::filesystem::path& path) {
+  std::vector<DecodedLogEntry> entries;
+  std::string reason;
+  if (!ulak::utils::DecodeBinaryLog(path, &entries, &reason)) {
+    std::cerr << "[test] decode failed: " << reason << '\n';
+  }
+  return entries;
+}
+
+bool TestRoundTrip() {
+  const auto path = TempLogPath("round_trip");
+  if (!StartLogger(path)) {
+    return false;
+  }
+  const std::string frame_id = "LOCAL_NED";
+  const std::string_view source = "mavlink_udp";
+  ULAK_LOG_INFO("link up");
+  ULAK_LOG_DEBUG("decoded %s frame from %s in %u us", frame_id, source, 42u);
+  ULAK_LOG_WARN("alt %.2f m, delta %+d, seq %llu, mode %d, ok %d, ch %c, 100%%", 12.345, -7,
+                std::numeric_limits<unsigned long long>::max(), Mode::kHold, true, 'x');
+  ULAK_LOG_ERROR("[%5s|%-4d|%08.3f|%x]", "ab", 12, -1.5, 255u);
+  Logger::Instance().Stop();
+
+  const auto entries = Decode(path);
+  std::filesystem::remove(path);
+  return Expect(entries.size() == 4, "Expected every record in the file") &&
+         Expect(entries[0].text == "link up" && entries[0].level == LogLevel::kInfo,
+                "Expected argument-less sites to decode") &&
+         Expect(entries[1].text == "decoded LOCAL_NED frame from mavlink_udp in 42 us",
+                "Expected strings and integers to decode: " + entries[1].text) &&
+         Expect(entries[2].text ==
+                    "alt 12.35 m, delta -7, seq 18446744073709551615, mode 3, ok 1, ch x, 100%",
+                "Expected printf semantics: " + entries[2].text) &&
+         Expect(entries[3].text == "[   ab|12  |-001.500|ff]",
+                "Expected flags, width and precision to be kept: " + entries[3].text) &&
+         Expect(entries[1].file.find("binary_log.cpp") != std::string::npos && entries[1].line > 0,
+                "Expected the call site location") &&
+         Expect(entries[1].elapsed_ns <= entries[3].elapsed_ns, "Expected increasing timestamps");
+}
+
+bool TestLevelsAndStoppedLogger() {
+  ULAK_LOG_ERROR("logged while stopped");
+  const bool disabled = !Logger::Instance().Enabled(LogLevel::kError);
+  const auto path = TempLogPath("levels");
+  if (!StartLogger(path, LogLevel::kWarn)) {
+    return false;
+  }
+  ULAK_LOG_DEBUG("hidden %d", 1);
+  ULAK_LOG_WARN("shown %d", 2);
+  Logger::Instance().SetMinLevel(LogLevel::kDebug);
+  ULAK_LOG_DEBUG("shown %d", 3);
+  Logger::Instance().Stop();
+
+  const auto entries = Decode(path);
+  std::filesystem::remove(path);
+  return Expect(disabled, "Expected a stopped logger to disable every level") &&
+         Expect(entries.size() == 2 && entries[0].text == "shown 2" && entries[1].text == "shown 3",
+                "Expected only enabled levels in the file");
+}
+
+bool TestThreadsKeepTheirOrder() {
+  const auto path = TempLogPath("threads");
+  if (!StartLogger(path)) {
+    return false;
+  }
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 20'000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < kPerThread; ++i) {
+        ULAK_LOG_DEBUG("worker %d item %d", t, i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  Logger::Instance().Flush();
+  const auto stats = Logger::Instance().Stats();
+  Logger::Instance().Stop();
+
+  const auto entries = Decode(path);
+  std::filesystem::remove(path);
+  std::vector<int> next(kThreads, 0);
+  std::uint64_t logged = 0;
+  std::uint64_t dropped = 0;
+  bool ordered = true;
+  for (const auto& entry : entries) {
+    int worker = -1;
+    int item = -1;
+    if (entry.file == "<logger>") {
+      dropped += std::stoull(entry.text);
+    } else if (std::sscanf(entry.text.c_str(), "worker %d item %d", &worker, &item) == 2) {
+      ordered = ordered && item >= next[static_cast<std::size_t>(worker)];
+      next[static_cast<std::size_t>(worker)] = item + 1;
+      ++logged;
+    }
+  }
+  return Expect(ordered, "Expected each thread's records in order") &&
+         Expect(logged + dropped == kThreads * kPerThread,
+                "Expected every record to be written or reported dropped") &&
+         Expect(dropped == stats.dropped, "Expected drop notices to match the counters") &&
+         Expect(stats.file_bytes < stats.raw_bytes, "Expected the file to be smaller than the rings");
+}
+
+bool TestFullRingDrops() {
+  const auto path = TempLogPath("drops");
+  LoggerConfig config;
+  config.path = path;
+  config.flush_interval_us = 1'000'000;
+  std::string reason;
+  if (!Expect(Logger::Instance().Start(config, &reason), "Expected the logger to start: " + reason)) {
+    return false;
+  }
+  const std::string payload(1'000, 'p');
+  const std::uint64_t dropped_before = Logger::Instance().Stats().dropped;
+  for (int i = 0; i < 200; ++i) {
+    ULAK_LOG_DEBUG("%d %s", i, payload);
+  }
+  const std::uint64_t dropped = Logger::Instance().Stats().dropped - dropped_before;
+  Logger::Instance().Stop();
+
+  const auto entries = Decode(path);
+  std::filesystem::remove(path);
+  const bool notice = !entries.empty() && entries.back().file == "<logger>" &&
+                      entries.back().text == std::to_string(dropped) + " records dropped (ring full)";
+  return Expect(dropped > 0, "Expected a full ring to drop instead of blocking") &&
+         Expect(notice && entries.size() == 200 - dropped + 1,
+                "Expected the drops to be reported in the file");
+}
+
+bool TestExitedThreadsAreFreed() {
+  const auto path = TempLogPath("exited");
+  if (!StartLogger(path)) {
+    return false;
+  }
+  ULAK_LOG_DEBUG("%s", "main");
+  Logger::Instance().Flush();
+  const std::uint64_t before = Logger::Instance().Stats().thread_buffers;
+  constexpr int kThreads = 64;
+  for (int t = 0; t < kThreads; ++t) {
+    std::thread([t] { ULAK_LOG_DEBUG("short-lived %d", t); }).join();
+  }
+  Logger::Instance().Flush();
+  const std::uint64_t after = Logger::Instance().Stats().thread_buffers;
+  Logger::Instance().Stop();
+
+  const auto entries = Decode(path);
+  std::filesystem::remove(path);
+  std::vector<std::uint32_t> threads;
+  for (const auto& entry : entries) {
+    if (entry.text.rfind("short-lived", 0) == 0) {
+      threads.push_back(entry.thread_index);
+    }
+  }
+  std::sort(threads.begin(), threads.end());
+  return Expect(after == before, "Expected the rings of exited threads to be freed") &&
+         Expect(threads.size() == kThreads &&
+                    std::unique(threads.begin(), threads.end()) == threads.end(),
+                "Expected every thread's record under its own thread id");
+}
+
+bool TestWriteFailuresAreCounted() {
+  if (!StartLogger("/dev/full")) {
+    return false;
+  }
+  const std::uint64_t before = Logger::Instance().Stats().write_failures;
+  ULAK_LOG_INFO("%s", "nowhere to go");
+  Logger::Instance().Flush();
+  const std::uint64_t failures = Logger::Instance().Stats().write_failures - before;
+  Logger::Instance().Stop();
+  return Expect(failures > 0, "Expected a full device to count a write failure");
+}
+
+bool TestDecoderRejectsBadInput() {
+  const auto path = TempLogPath("bad");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "not a log";
+  }
+  std::vector<DecodedLogEntry> entries;
+  std::string reason;
+  const bool foreign = !ulak::utils::DecodeBinaryLog(path, &entries, &reason);
+  const std::string foreign_reason = reason;
+
+  if (!StartLogger(path)) {
+    return false;
+  }
+  ULAK_LOG_INFO("%s", "a string long enough to cut");
+  Logger::Instance().Stop();
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 5);
+  entries.clear();
+  const bool truncated = !ulak::utils::DecodeBinaryLog(path, &entries, &reason);
+  std::filesystem::remove(path);
+
+  DecodedLogEntry entry;
+  entry.epoch_us = 1'771'632'001'250'000;
+  entry.level = LogLevel::kDebug;
+  entry.thread_index = 3;
+  entry.file = "src/models/TelemetryFrame.cpp";
+  entry.line = 42;
+  entry.text = "decoded";
+  return Expect(foreign && foreign_reason.find("not a binary log") != std::string::npos,
+                "Expected a foreign file to be refused") &&
+         Expect(truncated && entries.empty(), "Expected a truncated record to be reported") &&
+         Expect(ulak::utils::FormatLogEntry(entry) ==
+                    "2026-02-21T00:00:01.250000Z DEBUG [t3] TelemetryFrame.cpp:42 decoded",
+                "Expected the text line format");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestRoundTrip() &&
+                  TestLevelsAndStoppedLogger() &&
+                  TestThreadsKeepTheirOrder() &&
+                  TestFullRingDrops() &&
+                  TestExitedThreadsAreFreed() &&
+                  TestWriteFailuresAreCounted() &&
+                  TestDecoderRejectsBadInput();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Binary log tests passed.\n";
+  return 0;
+}
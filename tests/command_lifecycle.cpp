@@ -0,0 +1,210 @@
+#include "CommandLifecycle.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool TestDefaultTimersMatchProtocol() {
+  ulak::core::CommandLifecycle lifecycle;
+  const auto sent = lifecycle.Track("cmd-1", "STOP_MISSION", "companion_computer", 0);
+  if (!Expect(sent.effective_timeout_us == 2000000, "Expected T_ack=2s without samples")) {
+    return false;
+  }
+
+  std::vector<std::int64_t> retry_delays;
+  std::int64_t now = 0;
+  bool timed_out = false;
+  while (now < 60000000 && !timed_out) {
+    now += 10000;
+    for (const auto& action : lifecycle.Poll(now)) {
+      if (action.kind == ulak::core::CommandLifecycleAction::Kind::kResend) {
+        retry_delays.push_back(action.record.retry_delay_us);
+      } else if (action.kind == ulak::core::CommandLifecycleAction::Kind::kAckTimeout) {
+        timed_out = true;
+        if (!Expect(action.record.attempt == 4, "Expected ACK_TIMEOUT after 3 retries")) {
+          return false;
+        }
+      }
+    }
+  }
+  return Expect(timed_out, "Expected terminal ACK_TIMEOUT") &&
+         Expect(retry_delays == std::vector<std::int64_t>({500000, 1000000, 2000000}),
+                "Expected 500ms / 1s / 2s backoff by default") &&
+         Expect(lifecycle.in_flight() == 0, "Expected no in-flight command after timeout");
+}
+
+bool TestTimeoutAdaptsToMeasuredRtt() {
+  ulak::core::CommandLifecycle lifecycle;
+  std::int64_t now = 0;
+  for (int index = 0; index < 20; ++index) {
+    const std::string id = "fast-" + std::to_string(index);
+    lifecycle.Track(id, "SET_PARAM", "companion_computer", now);
+    lifecycle.OnAck(id, now + 20000);
+    now += 100000;
+  }
+  const auto fast = lifecycle.Track("probe-fast", "SET_PARAM", "companion_computer", now);
+  if (!Expect(fast.effective_timeout_us == 250000,
+              "Expected fast stable link to clamp T_ack to the 250ms floor")) {
+    return false;
+  }
+
+  // Congested Wi-Fi: RTT swings between 50ms and 800ms.
+  for (int index = 0; index < 20; ++index) {
+    const std::string id = "slow-" + std::to_string(index);
+    lifecycle.Track(id, "SET_PARAM", "companion_computer", now);
+    lifecycle.OnAck(id, now + (index % 2 == 0 ? 50000 : 800000));
+    now += 1000000;
+  }
+  const auto slow = lifecycle.Track("probe-slow", "SET_PARAM", "companion_computer", now);
+  const auto plan = lifecycle.estimator().Plan("companion_computer", 1);
+  return Expect(slow.effective_timeout_us > 800000,
+                "Expected T_ack to cover the observed RTT spread") &&
+         Expect(slow.effective_timeout_us <= 5000000, "Expected T_ack to respect the ceiling") &&
+         Expect(plan.from_samples, "Expected estimate to come from samples") &&
+         Expect(lifecycle.estimator().Plan("flight_controller", 1).effective_timeout_us == 2000000,
+                "Expected per-target estimates");
+}
+
+bool TestKarnRuleAndExecTimeout() {
+  ulak::core::CommandLifecyclePolicy policy;
+  policy.exec_timeout_overrides_us["START_MISSION"] = 3000000;
+  ulak::core::CommandLifecycle lifecycle(policy);
+
+  lifecycle.Track("cmd-retry", "START_MISSION", "companion_computer", 0);
+  lifecycle.Poll(2000000);
+  lifecycle.Poll(2500000);
+  if (!Expect(lifecycle.OnAck("cmd-retry", 2600000), "Expected ACK after retry to be accepted")) {
+    return false;
+  }
+  if (!Expect(!lifecycle.estimator().Plan("companion_computer", 1).from_samples,
+              "ACK of a retransmitted request must not feed the estimator")) {
+    return false;
+  }
+  if (!Expect(!lifecycle.OnAck("cmd-retry", 2700000), "Duplicate ACK must be ignored")) {
+    return false;
+  }
+
+  const auto actions = lifecycle.Poll(5600001);
+  if (!Expect(actions.size() == 1 &&
+                  actions.front().kind == ulak::core::CommandLifecycleAction::Kind::kExecTimeout,
+              "Expected EXEC_TIMEOUT using the command override")) {
+    return false;
+  }
+
+  lifecycle.Track("cmd-done", "STOP_MISSION", "companion_computer", 6000000);
+  lifecycle.OnAck("cmd-done", 6010000);
+  if (!Expect(lifecycle.OnCompletionEvidence("cmd-done", 6500000),
+              "Expected completion evidence to resolve the command")) {
+    return false;
+  }
+
+  std::vector<ulak::core::CommandLifecycleRecord> audit;
+  lifecycle.ForEachAuditRecord(
+      [&audit](const ulak::core::CommandLifecycleRecord& record) { audit.push_back(record); });
+  const auto& ack = audit[audit.size() - 2];
+  return Expect(ack.status == ulak::core::CommandLifecycleStatus::kAck && ack.rtt_us == 10000,
+                "Expected ACK audit record with RTT") &&
+         Expect(ack.effective_timeout_us > 0, "Expected effective timeout in audit record") &&
+         Expect(audit.back().status == ulak::core::CommandLifecycleStatus::kCompleted,
+                "Expected COMPLETED audit record");
+}
+
+// Sends one command whose ACK arrives `rtt_us` after the first send, polling
+// every 10ms meanwhile. Returns how many times it was resent.
+int RunCommand(ulak::core::CommandLifecycle* lifecycle, const std::string& id, std::int64_t* now,
+               std::int64_t rtt_us) {
+  const std::int64_t sent = *now;
+  lifecycle->Track(id, "SET_PARAM", "companion_computer", sent);
+  int resends = 0;
+  for (; *now < sent + rtt_us; *now += 10000) {
+    for (const auto& action : lifecycle->Poll(*now)) {
+      resends += action.kind == ulak::core::CommandLifecycleAction::Kind::kResend ? 1 : 0;
+    }
+  }
+  lifecycle->OnAck(id, sent + rtt_us);
+  lifecycle->OnCompletionEvidence(id, sent + rtt_us);
+  *now = sent + rtt_us + 100000;
+  return resends;
+}
+
+// RTT steps from 50ms to 800ms, above the learned T_ack. Every ACK then
+// answers a retried send and is skipped by Karn's rule, so only the backed-off
+// timeout lets a first attempt survive long enough to be sampled.
+bool TestBackoffRecoversFromRttStep() {
+  ulak::core::CommandLifecycle lifecycle;
+  std::int64_t now = 0;
+  for (int index = 0; index < 20; ++index) {
+    RunCommand(&lifecycle, "fast-" + std::to_string(index), &now, 50000);
+  }
+  const auto before = lifecycle.estimator().Plan("companion_computer", 1);
+
+  std::vector<int> resends;
+  for (int index = 0; index < 12; ++index) {
+    resends.push_back(RunCommand(&lifecycle, "slow-" + std::to_string(index), &now, 800000));
+  }
+  const auto after = lifecycle.estimator().Plan("companion_computer", 1);
+  int late_resends = 0;
+  for (std::size_t index = 4; index < resends.size(); ++index) {
+    late_resends += resends[index];
+  }
+  return Expect(before.effective_timeout_us == 250000 && resends.front() > 0,
+                "Expected the RTT step to time out the 250ms T_ack") &&
+         Expect(late_resends == 0, "Expected backoff to stop resends within a few commands") &&
+         Expect(after.srtt_us > 200000 && !after.backed_off &&
+                    after.effective_timeout_us > 800000,
+                "Expected first-attempt samples to raise T_ack above the new RTT");
+}
+
+bool TestAuditLogIsBounded() {
+  ulak::core::CommandLifecyclePolicy policy;
+  policy.audit_capacity = 4;
+  ulak::core::CommandLifecycle lifecycle(policy);
+  for (int index = 0; index < 6; ++index) {
+    lifecycle.Track("cmd-" + std::to_string(index), "START_MISSION", "companion_computer",
+                    index * 1000);
+  }
+  std::vector<std::string> ids;
+  const auto collect = [&ids](const ulak::core::CommandLifecycleRecord& record) {
+    ids.push_back(record.correlation_id);
+  };
+  lifecycle.ForEachAuditRecord(collect);
+  const bool newest = ids == std::vector<std::string>{"cmd-2", "cmd-3", "cmd-4", "cmd-5"} &&
+                     lifecycle.audit_size() == 4;
+
+  policy.audit_capacity = 2;
+  lifecycle.SetPolicy(policy);
+  ids.clear();
+  lifecycle.ForEachAuditRecord(collect);
+  return Expect(newest,
+                "Expected the audit ring to keep the newest records in order") &&
+         Expect(ids == std::vector<std::string>{"cmd-4", "cmd-5"} &&
+                    lifecycle.audit_overwritten() == 4,
+                "Expected a smaller capacity to drop the oldest records");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestDefaultTimersMatchProtocol() &&
+                  TestTimeoutAdaptsToMeasuredRtt() &&
+                  TestKarnRuleAndExecTimeout() &&
+                  TestBackoffRecoversFromRttStep() &&
+                  TestAuditLogIsBounded();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Command lifecycle tests passed.\n";
+  return 0;
+}
@@ -0,0 +1,333 @@
+#include "ConnectionSupervisor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::comms::ConnectionState;
+using ulak::comms::ConnectionStateMachine;
+using ulak::comms::ConnectionTransition;
+using ulak::comms::LinkChannel;
+using ulak::comms::LinkLossEvent;
+using ulak::comms::ReconnectPolicy;
+
+// IPv4 loopback listener on an ephemeral port.
+struct Listener {
+  int fd{-1};
+  std::uint16_t port{0};
+
+  Listener() {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    listen(fd, 4);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    port = ntohs(address.sin_port);
+  }
+  ~Listener() { close(fd); }
+
+  // Accepts one connection and reads its first line, waiting up to 2s.
+  int Accept(std::string* line) {
+    pollfd readable{fd, POLLIN, 0};
+    if (poll(&readable, 1, 2'000) != 1) {
+      return -1;
+    }
+    const int peer = accept(fd, nullptr, nullptr);
+    char byte = 0;
+    pollfd data{peer, POLLIN, 0};
+    while (poll(&data, 1, 2'000) == 1 && read(peer, &byte, 1) == 1 && byte != '\n') {
+      line->push_back(byte);
+    }
+    return peer;
+  }
+};
+
+int IntOption(int fd, int level, int name) {
+  int value = 0;
+  socklen_t length = sizeof(value);
+  getsockopt(fd, level, name, &value, &length);
+  return value;
+}
+
+bool TestBackoffGrowsWithJitter() {
+  ReconnectPolicy policy;
+  policy.initial_backoff_us = 100'000;
+  policy.max_backoff_us = 1'000'000;
+  policy.jitter = 0.2;
+  ConnectionStateMachine machine(LinkChannel::kCompanionTcp, policy, 7);
+
+  bool within = true;
+  bool waits = true;
+  std::vector<std::int64_t> delays;
+  std::int64_t now_us = 0;
+  for (int i = 0; i < 6; ++i) {
+    machine.OnConnectStarted(now_us);
+    machine.OnConnectFailed(now_us, "refused");
+    const std::int64_t delay = machine.next_attempt_us() - now_us;
+    const double base = std::min(100'000.0 * (1 << i), 1'000'000.0);
+    within = within && delay >= base * 0.8 && delay <= base * 1.2;
+    waits = waits && !machine.ShouldConnect(now_us + delay - 1) &&
+            machine.ShouldConnect(now_us + delay);
+    delays.push_back(delay);
+    now_us += delay;
+  }
+
+  ConnectionStateMachine other(LinkChannel::kCompanionTcp, policy, 8);
+  other.OnConnectStarted(0);
+  other.OnConnectFailed(0, "refused");
+
+  machine.OnConnectStarted(now_us);
+  machine.OnConnected(now_us);
+  const bool kept = machine.failures() == 6;
+  machine.OnDisconnected(now_us + policy.stable_after_us, "connection reset");
+  return Expect(within, "Expected doubling delays within the jitter band and the cap") &&
+         Expect(waits, "Expected no attempt before the backoff elapsed") &&
+         Expect(other.next_attempt_us() != delays[0], "Expected seeds to spread retries") &&
+         Expect(kept, "Expected a connect alone not to reset the backoff") &&
+         Expect(machine.failures() == 0 && machine.ShouldConnect(now_us + policy.stable_after_us),
+                "Expected a connection that stayed up to reset the backoff");
+}
+
+// A peer that accepts and closes at once must not be reconnected in a tight
+// loop, and its outage is one link loss, not one per cycle.
+bool TestShortLivedConnectionsBackOff() {
+  ReconnectPolicy policy;
+  policy.initial_backoff_us = 100'000;
+  policy.jitter = 0.0;
+  ConnectionStateMachine machine(LinkChannel::kCompanionTcp, policy, 5);
+  std::vector<LinkLossEvent> losses;
+  machine.SetLossSink([&](const LinkLossEvent& event) { losses.push_back(event); });
+
+  std::vector<std::int64_t> delays;
+  std::int64_t now_us = 0;
+  for (int i = 0; i < 4; ++i) {
+    machine.OnConnectStarted(now_us);
+    machine.OnConnected(now_us + 1'000);
+    machine.OnDisconnected(now_us + 2'000, "peer closed the connection");
+    delays.push_back(machine.next_attempt_us() - (now_us + 2'000));
+    now_us = machine.next_attempt_us();
+  }
+  const std::uint32_t failures = machine.failures();
+  machine.OnConnectStarted(now_us);
+  machine.OnConnected(now_us);
+  machine.OnDisconnected(now_us + policy.stable_after_us, "connection reset");
+
+  return Expect(delays == std::vector<std::int64_t>({100'000, 200'000, 400'000, 800'000}) &&
+                    failures == 4,
+                "Expected each short-lived connection to back off like a failure") &&
+         Expect(losses.size() == 2 && losses[1].raised_time_us == now_us + policy.stable_after_us,
+                "Expected one loss for the crash loop and one for the later drop") &&
+         Expect(machine.failures() == 0, "Expected a stable connection to reset the backoff");
+}
+
+bool TestDropRetriesAtOnceAndRaisesLoss() {
+  ConnectionStateMachine machine(LinkChannel::kCommandTcp, ReconnectPolicy{}, 1);
+  std::vector<ConnectionTransition> transitions;
+  std::vector<LinkLossEvent> losses;
+  machine.SetTransitionSink([&](const ConnectionTransition& t) { transitions.push_back(t); });
+  machine.SetLossSink([&](const LinkLossEvent& event) { losses.push_back(event); });
+
+  machine.OnDisconnected(0, "not connected yet");
+  machine.OnConnectStarted(10);
+  machine.OnConnectFailed(20, "refused");
+  machine.OnConnectStarted(machine.next_attempt_us());
+  machine.OnConnected(machine.next_attempt_us() + 5);
+  machine.OnDisconnected(1'000'000, "connection reset");
+
+  return Expect(transitions.size() == 5, "Expected one transition per edge") &&
+         Expect(transitions[1].to == ConnectionState::kDisconnected &&
+                    transitions[1].reason == "refused" && transitions[1].next_attempt_us > 20,
+                "Expected a failed attempt to report its backoff") &&
+         Expect(transitions[4].from == ConnectionState::kConnected &&
+                    transitions[4].reason == "connection reset",
+                "Expected the drop transition") &&
+         Expect(losses.size() == 1 && losses[0].code == "CC_LINK_LOSS" &&
+                    losses[0].raised_time_us == 1'000'000,
+                "Expected exactly one immediate loss event for the drop") &&
+         Expect(machine.ShouldConnect(1'000'000) && machine.drops() == 1,
+                "Expected a dropped connection to be retried at once");
+}
+
+bool TestConnectAppliesKeepalive() {
+  Listener listener;
+  ReconnectPolicy policy;
+  policy.keepalive_idle_s = 2;
+  policy.keepalive_interval_s = 1;
+  policy.keepalive_count = 4;
+  policy.user_timeout_ms = 2'500;
+  ulak::comms::TcpConnectResult result;
+  std::string reason;
+  // "localhost" may resolve to ::1 first; the listener is IPv4 only, so this
+  // also covers falling through a refused address to the next family.
+  const bool connected = ulak::comms::ConnectTcp("localhost", listener.port, policy, &result,
+                                                 &reason);
+  bool options = false;
+  if (connected) {
+    options = IntOption(result.fd, SOL_SOCKET, SO_KEEPALIVE) == 1 &&
+              IntOption(result.fd, IPPROTO_TCP, TCP_KEEPIDLE) == 2 &&
+              IntOption(result.fd, IPPROTO_TCP, TCP_KEEPINTVL) == 1 &&
+              IntOption(result.fd, IPPROTO_TCP, TCP_KEEPCNT) == 4 &&
+              IntOption(result.fd, IPPROTO_TCP, TCP_USER_TIMEOUT) == 2'500;
+    close(result.fd);
+  }
+  return Expect(connected, "Expected to connect to the local listener: " + reason) &&
+         Expect(result.address == "127.0.0.1:" + std::to_string(listener.port),
+                "Expected the IPv4 address to win: " + result.address) &&
+         Expect(options, "Expected keepalive and user timeout on the socket");
+}
+
+bool TestRefusedFailsFast() {
+  std::uint16_t port = 0;
+  {
+    Listener closed;
+    port = closed.port;
+  }
+  ReconnectPolicy policy;
+  policy.attempt_delay_us = 1'000'000;
+  ulak::comms::TcpConnectResult result;
+  std::string reason;
+  const auto started = std::chrono::steady_clock::now();
+  const bool connected = ulak::comms::ConnectTcp("127.0.0.1", port, policy, &result, &reason);
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+  const bool unresolved = !ulak::comms::ConnectTcp("no-such-host.invalid", 1, policy, &result,
+                                                   &reason) &&
+                          reason.find("cannot resolve") != std::string::npos;
+
+  return Expect(!connected, "Expected a closed port to refuse") &&
+         Expect(elapsed < std::chrono::milliseconds(200),
+                "Expected a refusal not to wait for the attempt delay") &&
+         Expect(unresolved, "Expected resolution failures to be reported");
+}
+
+bool TestSupervisorReconnectsWithSnapshot() {
+  Listener listener;
+  ReconnectPolicy policy;
+  policy.initial_backoff_us = 10'000;
+  ulak::comms::ConnectionSupervisor supervisor(LinkChannel::kCompanionTcp,
+                                               {"127.0.0.1", listener.port}, policy, 3);
+  std::mutex mutex;
+  std::vector<LinkLossEvent> losses;
+  int handled = 0;
+  supervisor.SetLossSink([&](const LinkLossEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    losses.push_back(event);
+  });
+  supervisor.SetConnectedHandler([&](int fd, const ulak::comms::TcpConnectResult&) {
+    std::string request;
+    ulak::models::SerializeJsonEnvelope(ulak::comms::MakeStateSnapshotRequest(0), &request, nullptr);
+    request.push_back('\n');
+    send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+    std::lock_guard<std::mutex> lock(mutex);
+    ++handled;
+  });
+  supervisor.Start();
+
+  std::string first;
+  const int peer = listener.Accept(&first);
+  close(peer);
+  // The channel's reader sees EOF and reports it.
+  supervisor.ReportDisconnected("peer closed the connection");
+  std::string second;
+  const int reconnected = listener.Accept(&second);
+  for (int i = 0; i < 100 && supervisor.state() != ConnectionState::kConnected; ++i) {
+    usleep(1'000);
+  }
+  const bool connected = supervisor.state() == ConnectionState::kConnected;
+  supervisor.Stop();
+  close(reconnected);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  return Expect(peer >= 0 && reconnected >= 0, "Expected a connect and a reconnect") &&
+         Expect(first.find("\"REQUEST_STATE_SNAPSHOT\"") != std::string::npos &&
+                    first.find("\"companion_computer\"") != std::string::npos &&
+                    second.find("\"REQUEST_STATE_SNAPSHOT\"") != std::string::npos,
+                "Expected a snapshot request on every connection: " + first) &&
+         Expect(connected && handled == 2, "Expected the handler once per connection") &&
+         Expect(losses.size() == 1 && losses[0].code == "CC_LINK_LOSS",
+                "Expected the drop to raise the link-loss event");
+}
+
+// Accept-then-close server: the supervisor must back off between cycles.
+bool TestSupervisorBacksOffFromAcceptThenClose() {
+  Listener listener;
+  ReconnectPolicy policy;
+  policy.initial_backoff_us = 20'000;
+  policy.max_backoff_us = 1'000'000;
+  ulak::comms::ConnectionSupervisor supervisor(LinkChannel::kCompanionTcp,
+                                               {"127.0.0.1", listener.port}, policy, 4);
+  std::mutex mutex;
+  std::vector<LinkLossEvent> losses;
+  supervisor.SetLossSink([&](const LinkLossEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    losses.push_back(event);
+  });
+  supervisor.SetConnectedHandler([&supervisor](int fd, const ulak::comms::TcpConnectResult&) {
+    // Stands in for the channel's reader: wait for the peer's close.
+    char byte = 0;
+    pollfd data{fd, POLLIN, 0};
+    poll(&data, 1, 2'000);
+    recv(fd, &byte, 1, 0);
+    supervisor.ReportDisconnected("peer closed the connection");
+  });
+  supervisor.Start();
+
+  int accepted = 0;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(700);
+  while (std::chrono::steady_clock::now() < deadline) {
+    pollfd readable{listener.fd, POLLIN, 0};
+    if (poll(&readable, 1, 10) == 1) {
+      close(accept(listener.fd, nullptr, nullptr));
+      ++accepted;
+    }
+  }
+  supervisor.Stop();
+
+  // 20 + 40 + 80 + 160 + 320 ms (+-20%) fit into 700ms: about six cycles.
+  std::lock_guard<std::mutex> lock(mutex);
+  return Expect(accepted >= 2 && accepted <= 8,
+                "Expected backoff between cycles, got " + std::to_string(accepted) +
+                    " connections") &&
+         Expect(losses.size() == 1, "Expected one link-loss event for the whole crash loop");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestBackoffGrowsWithJitter() &&
+                  TestDropRetriesAtOnceAndRaisesLoss() &&
+                  TestShortLivedConnectionsBackOff() &&
+                  TestConnectAppliesKeepalive() &&
+                  TestRefusedFailsFast() &&
+                  TestSupervisorReconnectsWithSnapshot() &&
+                  TestSupervisorBacksOffFromAcceptThenClose();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Connection supervisor tests passed.\n";
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include "CorrelationId.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool TestKnownFormatting() {
+  const ulak::utils::Uuid128 value{0x2cf42dcad8a246d2ULL, 0xbdfd677ee6a66e8fULL};
+  char buffer[ulak::utils::kUuidTextLength];
+  ulak::utils::FormatUuid(value, buffer);
+  const std::string text(buffer, sizeof(buffer));
+  if (!Expect(text == "2cf42dca-d8a2-46d2-bdfd-677ee6a66e8f",
+              "Unexpected canonical formatting: " + text)) {
+    return false;
+  }
+
+  ulak::utils::Uuid128 parsed;
+  return Expect(ulak::utils::ParseUuid("2CF42DCA-D8A2-46D2-BDFD-677EE6A66E8F", &parsed),
+                "Expected uppercase UUID to parse") &&
+         Expect(parsed == value, "Expected parse to round-trip the binary form") &&
+         Expect(!ulak::utils::ParseUuid("2cf42dca-d8a2-46d2-bdfd-677ee6a66e8", &parsed),
+                "Expected short UUID to be rejected") &&
+         Expect(!ulak::utils::ParseUuid("2cf42dca_d8a2-46d2-bdfd-677ee6a66e8f", &parsed),
+                "Expected misplaced separator to be rejected");
+}
+
+bool TestVersionAndVariant() {
+  for (int index = 0; index < 1000; ++index) {
+    const std::string text = ulak::utils::GenerateCorrelationId();
+    if (!Expect(text.size() == 36, "Expected 36-character correlation id")) {
+      return false;
+    }
+    if (!Expect(text[14] == '4', "Expected UUID version nibble 4: " + text)) {
+      return false;
+    }
+    const char variant = text[19];
+    if (!Expect(variant == '8' || variant == '9' || variant == 'a' || variant == 'b',
+                "Expected RFC 4122 variant: " + text)) {
+      return false;
+    }
+    ulak::utils::Uuid128 parsed;
+    if (!Expect(ulak::utils::ParseUuid(text, &parsed), "Generated id must parse: " + text)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Pass a larger count on the command line for soak runs (e.g. 100000000).
+bool TestNoCollisions(std::size_t count) {
+  const unsigned thread_count = 4;
+  std::vector<std::vector<ulak::utils::Uuid128>> per_thread(thread_count);
+  std::vector<std::thread> threads;
+  for (unsigned thread_index = 0; thread_index < thread_count; ++thread_index) {
+    threads.emplace_back([&per_thread, thread_index, count, thread_count] {
+      auto& out = per_thread[thread_index];
+      out.reserve(count / thread_count + 1);
+      for (std::size_t index = thread_index; index < count; index += thread_count) {
+        out.push_back(ulak::utils::GenerateUuidV4());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<ulak::utils::Uuid128> all;
+  all.reserve(count);
+  for (auto& chunk : per_thread) {
+    all.insert(all.end(), chunk.begin(), chunk.end());
+    chunk.clear();
+    chunk.shrink_to_fit();
+  }
+  std::sort(all.begin(), all.end());
+  const bool unique = std::adjacent_find(all.begin(), all.end()) == all.end();
+  return Expect(all.size() == count, "Expected every generated id to be collected") &&
+         Expect(unique, "Generated correlation ids collided across " + std::to_string(count) +
+                            " ids");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t collision_count = 1000000;
+  if (argc > 1) {
+    collision_count = static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10));
+  }
+
+  const bool ok = TestKnownFormatting() &&
+                  TestVersionAndVariant() &&
+                  TestNoCollisions(collision_count);
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Correlation id generator tests passed.\n";
+  return 0;
+}
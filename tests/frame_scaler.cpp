@@ -0,0 +1,183 @@
+#include "FrameScaler.h"
+#include "SliceWorkerPool.h"
+#include "YuvFramePool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+struct OwnedImage {
+  ulak::comms::ImageView view;
+  std::vector<std::uint8_t> planes[3];
+};
+
+OwnedImage RandomImage(ulak::comms::PixelFormat format, int width, int height, std::uint32_t seed) {
+  std::mt19937 random(seed);
+  OwnedImage image;
+  image.view.format = format;
+  image.view.width = width;
+  image.view.height = height;
+  const int chroma_width = (width + 1) / 2;
+  const int chroma_height = (height + 1) / 2;
+  std::vector<std::pair<int, int>> layout;  // (stride, rows)
+  switch (format) {
+    case ulak::comms::PixelFormat::kI420:
+      layout = {{width + 3, height}, {chroma_width + 1, chroma_height}, {chroma_width + 5, chroma_height}};
+      break;
+    case ulak::comms::PixelFormat::kNv12:
+      layout = {{width, height}, {chroma_width * 2 + 2, chroma_height}};
+      break;
+    default:
+      layout = {{width * 3 + 7, height}};
+      break;
+  }
+  for (std::size_t plane = 0; plane < layout.size(); ++plane) {
+    image.planes[plane].resize(static_cast<std::size_t>(layout[plane].first) * layout[plane].second);
+    for (auto& byte : image.planes[plane]) {
+      byte = static_cast<std::uint8_t>(random());
+    }
+    image.view.planes[plane] = image.planes[plane].data();
+    image.view.strides[plane] = layout[plane].first;
+  }
+  return image;
+}
+
+std::vector<std::uint8_t> Run(ulak::comms::FrameScaler* scaler, const ulak::comms::ImageView& view,
+                              int width, int height) {
+  std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width) * height * 4 + 16, 0xAB);
+  ulak::comms::RgbaImage destination{pixels.data(), width, height, width * 4};
+  std::string reason;
+  if (!scaler->Convert(view, destination, &reason)) {
+    std::cerr << "[test] Convert failed: " << reason << '\n';
+    pixels.clear();
+  }
+  return pixels;
+}
+
+bool TestKnownColors() {
+  ulak::comms::YuvFramePool pool(16, 8, 1);
+  auto frame = pool.Acquire();
+  // BT.601 limited-range red: Y=81, Cb=90, Cr=240; right half mid gray.
+  for (int y = 0; y < 8; ++y) {
+    for (int x = 0; x < 16; ++x) {
+      frame->planes[0][y * frame->strides[0] + x] = x < 8 ? 81 : 126;
+    }
+  }
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      frame->planes[1][y * frame->strides[1] + x] = x < 4 ? 90 : 128;
+      frame->planes[2][y * frame->strides[2] + x] = x < 4 ? 240 : 128;
+    }
+  }
+  ulak::comms::FrameScaler scaler;
+  const auto pixels = Run(&scaler, ulak::comms::ViewOf(*frame), 16, 8);
+  const std::uint8_t* red = pixels.data();
+  const std::uint8_t* gray = pixels.data() + 4 * 15;
+  return Expect(red[0] >= 250 && red[1] <= 4 && red[2] <= 4 && red[3] == 255,
+                "Expected BT.601 red to convert to RGBA red") &&
+         Expect(gray[0] == 127 && gray[1] == 127 && gray[2] == 127, "Expected mid gray") &&
+         Expect(pixels[16 * 8 * 4] == 0xAB, "Expected no write past the destination");
+}
+
+bool TestSimdMatchesScalar() {
+  using ulak::comms::PixelFormat;
+  using ulak::comms::PixelKernelPath;
+  ulak::utils::SliceWorkerPool pool(4);
+  const std::vector<std::pair<int, int>> sources = {{37, 23}, {640, 360}, {1920, 1080}};
+  const std::vector<std::pair<int, int>> targets = {{19, 31}, {1280, 720}, {37, 23}};
+  const std::vector<PixelKernelPath> paths = {PixelKernelPath::kSse2, PixelKernelPath::kAvx2,
+                                              PixelKernelPath::kNeon};
+  std::uint32_t seed = 7;
+  for (const auto format : {PixelFormat::kI420, PixelFormat::kNv12, PixelFormat::kRgb8,
+                            PixelFormat::kBgr8}) {
+    for (const auto& source : sources) {
+      const auto image = RandomImage(format, source.first, source.second, ++seed);
+      for (const auto& target : targets) {
+        ulak::comms::FrameScaler reference;
+        reference.set_path(PixelKernelPath::kScalar);
+        const auto expected = Run(&reference, image.view, target.first, target.second);
+        for (const auto path : paths) {
+          ulak::comms::FrameScaler scaler(&pool);
+          scaler.set_path(path);
+          const auto actual = Run(&scaler, image.view, target.first, target.second);
+          if (!Expect(!expected.empty() && actual == expected,
+                      std::string("Expected ") + ulak::comms::ToString(scaler.path()) +
+                          " output to match scalar for " + std::to_string(source.first) + "x" +
+                          std::to_string(source.second) + " -> " + std::to_string(target.first) +
+                          "x" + std::to_string(target.second))) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool TestRgbChannelOrder() {
+  const std::uint8_t rgb[3] = {10, 20, 30};
+  ulak::comms::ImageView view;
+  view.format = ulak::comms::PixelFormat::kBgr8;
+  view.width = 1;
+  view.height = 1;
+  view.planes[0] = rgb;
+  view.strides[0] = 3;
+  ulak::comms::FrameScaler scaler;
+  const auto bgr = Run(&scaler, view, 2, 2);
+  view.format = ulak::comms::PixelFormat::kRgb8;
+  const auto as_rgb = Run(&scaler, view, 2, 2);
+  std::string reason;
+  view.strides[0] = 2;
+  std::uint8_t out[16];
+  const bool rejected = !scaler.Convert(view, {out, 2, 2, 8}, &reason);
+  return Expect(bgr[0] == 30 && bgr[1] == 20 && bgr[2] == 10 && bgr[3] == 255,
+                "Expected bgr8 swapped to RGBA") &&
+         Expect(as_rgb[0] == 10 && as_rgb[2] == 30, "Expected rgb8 kept in order") &&
+         Expect(rejected && !reason.empty(), "Expected short stride to be rejected");
+}
+
+bool TestSliceWorkerPool() {
+  ulak::utils::SliceWorkerPool pool(4);
+  bool ok = true;
+  for (int round = 0; round < 200 && ok; ++round) {
+    std::vector<std::atomic<int>> hits(37);
+    auto work = [&hits](int slice) { hits[static_cast<std::size_t>(slice)].fetch_add(1); };
+    pool.Run(37, work);
+    for (const auto& hit : hits) {
+      ok = ok && hit.load() == 1;
+    }
+  }
+  return Expect(ok, "Expected every slice to run exactly once per Run") &&
+         Expect(pool.concurrency() == 4, "Expected caller plus three workers");
+}
+
+}  // namespace
+
+int main() {
+  std::cout << "[test] Pixel kernels: " << ulak::comms::ToString(ulak::comms::BestPixelKernelPath())
+            << '\n';
+  const bool ok = TestKnownColors() &&
+                  TestSimdMatchesScalar() &&
+                  TestRgbChannelOrder() &&
+                  TestSliceWorkerPool();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Frame scaler tests passed.\n";
+  return 0;
+}
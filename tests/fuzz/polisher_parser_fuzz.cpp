@@ -0,0 +1,26 @@
+// libFuzzer entry for the Polisher block parser. Build with
+// -DULAK_BUILD_FUZZERS=ON using clang.
+#include "PolisherParser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+  const std::string_view source(reinterpret_cast<const char*>(data), size);
+  const auto result = ulak::utils::ParsePolisherSource(source);
+  if (result.ok) {
+    for (const auto& param : result.params) {
+      if (param.name.empty() || param.label.empty()) {
+        __builtin_trap();
+      }
+      if (param.type != ulak::utils::PolisherParamType::kToggle &&
+          (param.default_value < param.min || param.default_value > param.max)) {
+        __builtin_trap();
+      }
+    }
+  } else if (!result.params.empty()) {
+    __builtin_trap();
+  }
+  return 0;
+}
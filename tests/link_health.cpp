@@ -0,0 +1,129 @@
+#include "HdrHistogram.h"
+#include "LinkHealthMonitor.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool TestHistogramPercentiles() {
+  ulak::utils::HdrHistogram histogram;
+  for (std::uint64_t value = 1; value <= 10000; ++value) {
+    histogram.Record(value);
+  }
+  const auto p50 = histogram.ValueAtPercentile(50.0);
+  const auto p99 = histogram.ValueAtPercentile(99.0);
+  return Expect(histogram.count() == 10000, "Expected 10000 histogram samples") &&
+         Expect(p50 >= 5000 && p50 <= 5080, "p50 outside 1/64 of 5000") &&
+         Expect(p99 >= 9900 && p99 <= 10060, "p99 outside 1/64 of 9900") &&
+         Expect(histogram.ValueAtPercentile(100.0) == 10000, "Expected exact max at p100") &&
+         Expect(histogram.min() == 1, "Expected exact min");
+}
+
+bool TestRateJitterAndSequenceLoss() {
+  ulak::comms::LinkHealthMonitor monitor;
+  const std::int64_t start_us = 1000000;
+
+  // 10 Hz MAVLink stream, one packet in ten missing from the sequence.
+  std::uint8_t sequence = 250;
+  for (int index = 0; index < 10; ++index) {
+    monitor.OnPacket(ulak::comms::LinkChannel::kMavlinkUdp, start_us + index * 100000, 40);
+    monitor.OnMavlinkSequence(1, 1, sequence);
+    sequence = static_cast<std::uint8_t>(sequence + (index == 4 ? 2 : 1));
+  }
+  monitor.Evaluate(start_us + 1000000);
+
+  for (int index = 10; index < 20; ++index) {
+    monitor.OnPacket(ulak::comms::LinkChannel::kMavlinkUdp, start_us + index * 100000, 40);
+    monitor.OnMavlinkSequence(1, 1, sequence);
+    sequence = static_cast<std::uint8_t>(sequence + (index == 15 ? 2 : 1));
+  }
+  const auto frames = monitor.Evaluate(start_us + 2000000);
+  const auto& mavlink = frames[0];
+  return Expect(mavlink.state == ulak::comms::LinkHealthState::kOk, "Expected OK link") &&
+         Expect(mavlink.rate_hz > 9.9 && mavlink.rate_hz < 10.1, "Expected ~10 Hz rate") &&
+         Expect(mavlink.jitter_us < 1000, "Expected near-zero jitter for a regular stream") &&
+         Expect(mavlink.total_lost == 2, "Expected sequence gaps (across wrap) to count as loss") &&
+         Expect(mavlink.loss_ratio > 0.08 && mavlink.loss_ratio < 0.10,
+                "Expected ~1/11 window loss ratio") &&
+         Expect(frames[2].state == ulak::comms::LinkHealthState::kWaiting,
+                "Expected silent command channel to stay WAITING");
+}
+
+// Autopilot and companion share the UDP link, each with its own counter.
+bool TestSequencesTrackedPerSender() {
+  ulak::comms::LinkHealthMonitor monitor;
+  for (int index = 0; index < 20; ++index) {
+    monitor.OnPacket(ulak::comms::LinkChannel::kMavlinkUdp, 1000000 + index * 50000, 40);
+    monitor.OnMavlinkSequence(1, 1, static_cast<std::uint8_t>(index));
+    monitor.OnMavlinkSequence(1, 191, static_cast<std::uint8_t>(200 + index));
+  }
+  monitor.OnMavlinkSequence(1, 191, 222);
+  const auto frames = monitor.Evaluate(2000000);
+  return Expect(frames[0].total_lost == 2,
+                "Expected interleaved senders to count only their own gaps");
+}
+
+bool TestLossEventRaisedOnce() {
+  auto policy = ulak::comms::DefaultLinkHealthPolicy();
+  policy.channels[1].loss_timeout_us = 500000;
+  ulak::comms::LinkHealthMonitor monitor(policy);
+
+  std::vector<ulak::comms::LinkLossEvent> events;
+  monitor.SetLossSink([&events](const ulak::comms::LinkLossEvent& event) {
+    events.push_back(event);
+  });
+  std::vector<std::string> payloads;
+  monitor.SetFrameSink([&payloads](const ulak::comms::LinkHealthFrame& frame) {
+    payloads.push_back(ulak::comms::SerializeLinkHealthPayload(frame));
+  });
+
+  monitor.OnPacket(ulak::comms::LinkChannel::kCompanionTcp, 1000000, 120);
+  monitor.Evaluate(1400000);
+  if (!Expect(events.empty(), "Expected no loss inside the timeout")) {
+    return false;
+  }
+  monitor.Evaluate(1600000);
+  monitor.Evaluate(1800000);
+  if (!Expect(events.size() == 1, "Expected exactly one loss event per edge")) {
+    return false;
+  }
+  if (!Expect(events.front().code == "CC_LINK_LOSS" && events.front().silence_us == 600000,
+              "Expected CC_LINK_LOSS with measured silence")) {
+    return false;
+  }
+
+  monitor.OnPacket(ulak::comms::LinkChannel::kCompanionTcp, 1900000, 120);
+  monitor.Evaluate(2000000);
+  monitor.Evaluate(2600000);
+  return Expect(events.size() == 2, "Expected a new loss event after recovery") &&
+         Expect(payloads.size() == 5 * ulak::comms::kLinkChannelCount,
+                "Expected one health frame per channel per evaluation") &&
+         Expect(payloads[1].find("\"channel\":\"companion_tcp\"") != std::string::npos,
+                "Expected serialized channel name");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestHistogramPercentiles() &&
+                  TestRateJitterAndSequenceLoss() &&
+                  TestSequencesTrackedPerSender() &&
+                  TestLossEventRaisedOnce();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Link health monitor tests passed.\n";
+  return 0;
+}
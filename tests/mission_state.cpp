@@ -0,0 +1,121 @@
+#include "CommandLifecycle.h"
+#include "MissionStateTracker.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+ulak::models::MissionStateUpdate Update(const std::string& state, std::int64_t time_us,
+                                        const std::string& note = {}) {
+  ulak::models::MissionStateUpdate update;
+  update.state = state;
+  update.note = note;
+  update.receive_time_us = time_us;
+  return update;
+}
+
+bool TestHistoryAndAccumulators() {
+  ulak::core::MissionStateTracker tracker(4);
+  tracker.OnMissionState(Update("MISSION_IDLE", 1'000'000));
+  tracker.OnMissionState(Update("MISSION_RUNNING", 3'000'000, "operator start"));
+  const bool repeated = tracker.OnMissionState(Update("MISSION_RUNNING", 3'500'000, "loop 2/4"));
+  tracker.OnMissionState(Update("MISSION_PAUSED", 5'000'000, "vision lost"));
+  tracker.OnMissionState(Update("MISSION_RUNNING", 6'000'000, "resumed"));
+  tracker.OnMissionState(Update("LOITER_SEARCH", 7'000'000,
+                                "custom companion state with a note longer than the slot"));
+  tracker.OnMissionState(Update("MISSION_RUNNING", 7'500'000));
+
+  const auto current = tracker.current();
+  const auto history = tracker.history();
+  const auto custom = tracker.StateId("LOITER_SEARCH");
+  return Expect(!repeated, "Expected repeated state not to be a transition") &&
+         Expect(current.state == ulak::models::kMissionStateRunning &&
+                    current.name == "MISSION_RUNNING" && current.transitions == 6 &&
+                    current.entered_time_us == 7'500'000,
+                "Expected current state snapshot") &&
+         Expect(history.size() == 4 && history.front().sequence == 2 &&
+                    history.front().current == ulak::models::kMissionStatePaused &&
+                    ulak::core::NoteView(history.front()) == "vision lost" &&
+                    history.front().previous_duration_us == 2'000'000,
+                "Expected the ring to keep the newest transitions with notes") &&
+         Expect(ulak::core::NoteView(history[2]).size() ==
+                    ulak::core::MissionTransition::kNoteCapacity &&
+                    history[2].current == custom && custom > ulak::models::kMissionStateCompleted,
+                "Expected custom states interned and long notes truncated") &&
+         Expect(tracker.time_in_state_us(ulak::models::kMissionStateRunning, 8'000'000) ==
+                    2'000'000 + 1'000'000 + 500'000,
+                "Expected time in state including the ongoing interval") &&
+         Expect(tracker.entry_count(ulak::models::kMissionStateRunning) == 3 &&
+                    tracker.entry_count(ulak::models::kMissionStateIdle) == 1,
+                "Expected entry counters");
+}
+
+bool TestCompletionEvidenceResolvesLifecycle() {
+  ulak::core::CommandLifecycle lifecycle;
+  ulak::core::MissionStateTracker tracker;
+  std::vector<std::string> completed;
+  tracker.SetCompletionListener([&](const std::string& correlation_id, std::int64_t time_us) {
+    if (lifecycle.OnCompletionEvidence(correlation_id, time_us)) {
+      completed.push_back(correlation_id);
+    }
+  });
+  tracker.OnMissionState(Update("MISSION_IDLE", 0));
+
+  lifecycle.Track("start", "START_MISSION", "companion_computer", 1'000'000);
+  lifecycle.OnAck("start", 1'020'000);
+  tracker.ExpectCompletion("start", "START_MISSION", 1'000'000);
+  tracker.OnMissionState(Update("MISSION_PAUSED", 1'100'000));
+  const bool early = !completed.empty();
+  tracker.OnMissionState(Update("MISSION_RUNNING", 1'400'000));
+
+  // The FSM reaches MISSION_ABORTED before the ACK arrives.
+  lifecycle.Track("stop", "STOP_MISSION", "companion_computer", 2'000'000);
+  tracker.OnMissionState(Update("MISSION_ABORTED", 2'050'000, "operator stop"));
+  lifecycle.OnAck("stop", 2'080'000);
+  tracker.ExpectCompletion("stop", "STOP_MISSION", 2'000'000);
+
+  const auto timeouts = lifecycle.Poll(30'000'000);
+  return Expect(!early, "Expected no evidence from an unrelated state") &&
+         Expect(completed == std::vector<std::string>{"start", "stop"},
+                "Expected evidence for START_MISSION and a raced STOP_MISSION") &&
+         Expect(timeouts.empty() && lifecycle.in_flight() == 0,
+                "Expected no EXEC_TIMEOUT after completion") &&
+         Expect(tracker.pending_completions() == 0, "Expected expectations consumed") &&
+         Expect(!tracker.ExpectCompletion("x", "SET_PARAM", 0),
+                "Expected no completion rule for SET_PARAM");
+}
+
+bool TestCancelledExpectationDoesNotFire() {
+  ulak::core::MissionStateTracker tracker;
+  int fired = 0;
+  tracker.SetCompletionListener([&](const std::string&, std::int64_t) { ++fired; });
+  tracker.ExpectCompletion("start", "START_MISSION", 0);
+  tracker.CancelCompletion("start");
+  tracker.OnMissionState(Update("MISSION_RUNNING", 10));
+  return Expect(fired == 0 && tracker.pending_completions() == 0,
+                "Expected cancelled expectation to be dropped");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestHistoryAndAccumulators() &&
+                  TestCompletionEvidenceResolvesLifecycle() &&
+                  TestCancelledExpectationDoesNotFire();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Mission state tests passed.\n";
+  return 0;
+}
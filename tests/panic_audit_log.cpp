@@ -0,0 +1,338 @@
+#include "PanicAuditLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool TestRingKeepsNewestEntries() {
+  ulak::core::PanicAuditRing ring(8);
+  for (int index = 0; index < 20; ++index) {
+    ring.Record(ulak::core::MakePanicAuditEntry("PANIC_RTL",
+                                                "panic-test-" + std::to_string(index),
+                                                "default",
+                                                ulak::core::PanicAuditOutcome::kSent,
+                                                index));
+  }
+
+  std::vector<std::uint64_t> sequences;
+  ring.ForEach([&sequences](const ulak::core::PanicAuditEntry& entry) {
+    sequences.push_back(entry.sequence);
+  });
+  if (!Expect(sequences.size() == ring.capacity(), "Expected ring to retain capacity entries")) {
+    return false;
+  }
+  if (!Expect(sequences.front() == 12 && sequences.back() == 19,
+              "Expected oldest-to-newest walk over the newest entries")) {
+    return false;
+  }
+
+  ulak::core::PanicAuditEntry newest;
+  if (!Expect(ring.ReadAt(19, &newest) == ulak::core::PanicAuditRing::ReadStatus::kOk,
+              "Expected newest entry to be readable")) {
+    return false;
+  }
+  return Expect(ulak::core::CorrelationIdView(newest) == "panic-test-19",
+                "Expected correlation id bytes to round-trip") &&
+         Expect(ulak::core::AuditCommandName(newest.command_id) == "PANIC_RTL",
+                "Expected interned command id to resolve") &&
+         Expect(ulak::core::AuditProfileName(newest.profile_id) == "default",
+                "Expected interned profile id to resolve") &&
+         Expect(ring.ReadAt(3, &newest) == ulak::core::PanicAuditRing::ReadStatus::kOverwritten,
+                "Expected overwritten status for evicted entry");
+}
+
+bool TestConcurrentRecordAndSnapshot() {
+  ulak::core::PanicAuditRing ring(64);
+  std::atomic<bool> done{false};
+  std::atomic<bool> torn{false};
+
+  std::thread reader([&ring, &done, &torn] {
+    while (!done.load()) {
+      ring.ForEach([&torn](const ulak::core::PanicAuditEntry& entry) {
+        // Producers mirror the timestamp into the correlation id; a torn read breaks that.
+        if (ulak::core::CorrelationIdView(entry) != std::to_string(entry.timestamp_us)) {
+          torn.store(true);
+        }
+      });
+    }
+  });
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < 4; ++producer) {
+    producers.emplace_back([&ring, producer] {
+      for (int index = 0; index < 5000; ++index) {
+        const std::int64_t stamp = producer * 100000 + index;
+        ring.Record(ulak::core::MakePanicAuditEntry("PANIC_RTL",
+                                                    std::to_string(stamp),
+                                                    "safe",
+                                                    ulak::core::PanicAuditOutcome::kAck,
+                                                    stamp));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  done.store(true);
+  reader.join();
+
+  std::uint64_t visited = 0;
+  ring.ForEach([&visited](const ulak::core::PanicAuditEntry&) { ++visited; });
+  return Expect(!torn.load(), "Snapshot iteration observed a torn record") &&
+         Expect(ring.next_sequence() == 20000, "Expected every record to claim a sequence") &&
+         Expect(visited == ring.capacity(), "Expected a full ring after the producers finished");
+}
+
+// Producers a lap apart share a slot; with a two-slot ring they collide
+// constantly, and each read must still return the record of its own sequence.
+bool TestProducersLapApartShareSlot() {
+  ulak::core::PanicAuditRing ring(2);
+  std::atomic<bool> done{false};
+  std::atomic<bool> mismatched{false};
+
+  std::thread reader([&ring, &done, &mismatched] {
+    ulak::core::PanicAuditEntry entry;
+    while (!done.load()) {
+      const std::uint64_t end = ring.next_sequence();
+      for (std::uint64_t sequence = end > 2 ? end - 2 : 0; sequence < end; ++sequence) {
+        if (ring.ReadAt(sequence, &entry) == ulak::core::PanicAuditRing::ReadStatus::kOk &&
+            (entry.sequence != sequence ||
+             ulak::core::CorrelationIdView(entry) != std::to_string(entry.timestamp_us))) {
+          mismatched.store(true);
+        }
+      }
+    }
+  });
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < 4; ++producer) {
+    producers.emplace_back([&ring, producer] {
+      for (int index = 0; index < 5000; ++index) {
+        const std::int64_t stamp = producer * 100000 + index;
+        ring.Record(ulak::core::MakePanicAuditEntry("PANIC_RTL",
+                                                    std::to_string(stamp),
+                                                    "safe",
+                                                    ulak::core::PanicAuditOutcome::kAck,
+                                                    stamp));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  done.store(true);
+  reader.join();
+
+  std::vector<std::uint64_t> sequences;
+  ring.ForEach([&sequences](const ulak::core::PanicAuditEntry& entry) {
+    sequences.push_back(entry.sequence);
+  });
+  return Expect(!mismatched.load(), "Expected each slot to hold the record of its sequence") &&
+         Expect(sequences.size() == 2 && sequences[0] == 19998 && sequences[1] == 19999,
+                "Expected the last lap to be readable once producers finish");
+}
+
+// Eight producers wrap a four-slot ring thousands of times. Each slot must
+// only ever move to a later sequence, and every record read back must be whole.
+bool TestWrappingUnderContentionStaysMonotonic() {
+  constexpr int kProducers = 8;
+  constexpr int kPerProducer = 4000;
+  ulak::core::PanicAuditRing ring(4);
+  std::atomic<bool> done{false};
+  std::atomic<bool> backwards{false};
+  std::atomic<bool> torn{false};
+
+  std::thread reader([&] {
+    std::vector<std::uint64_t> newest(ring.capacity(), 0);
+    std::vector<bool> seen(ring.capacity(), false);
+    ulak::core::PanicAuditEntry entry;
+    while (!done.load()) {
+      const std::uint64_t end = ring.next_sequence();
+      const std::uint64_t begin = end > ring.capacity() ? end - ring.capacity() : 0;
+      for (std::uint64_t sequence = begin; sequence < end; ++sequence) {
+        if (ring.ReadAt(sequence, &entry) != ulak::core::PanicAuditRing::ReadStatus::kOk) {
+          continue;
+        }
+        if (entry.sequence != sequence ||
+            ulak::core::CorrelationIdView(entry) != std::to_string(entry.timestamp_us)) {
+          torn.store(true);
+        }
+        const std::size_t slot = sequence % ring.capacity();
+        if (seen[slot] && sequence < newest[slot]) {
+          backwards.store(true);
+        }
+        seen[slot] = true;
+        newest[slot] = std::max(newest[slot], sequence);
+      }
+    }
+  });
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kProducers; ++producer) {
+    producers.emplace_back([&ring, producer] {
+      for (int index = 0; index < kPerProducer; ++index) {
+        const std::int64_t stamp = producer * 100000 + index;
+        ring.Record(ulak::core::MakePanicAuditEntry("PANIC_RTL",
+                                                    std::to_string(stamp),
+                                                    "safe",
+                                                    ulak::core::PanicAuditOutcome::kAck,
+                                                    stamp));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  done.store(true);
+  reader.join();
+
+  constexpr std::uint64_t kTotal = kProducers * kPerProducer;
+  std::vector<std::uint64_t> sequences;
+  ring.ForEach([&sequences](const ulak::core::PanicAuditEntry& entry) {
+    sequences.push_back(entry.sequence);
+  });
+  return Expect(!torn.load(), "Expected no torn record while the ring wraps") &&
+         Expect(!backwards.load(), "Expected each slot's sequence to only move forward") &&
+         Expect(ring.lapped() == 0 && sequences.size() == ring.capacity() &&
+                    sequences.front() == kTotal - ring.capacity() && sequences.back() == kTotal - 1,
+                "Expected the last lap intact after the producers finish");
+}
+
+bool TestSpillWriterPersistsEverything(const std::filesystem::path& temp_dir) {
+  const auto spill_path = temp_dir / "panic_audit.bin";
+  ulak::core::PanicAuditRing ring(16);
+  ulak::core::PanicAuditSpillWriter writer(&ring, spill_path, std::chrono::milliseconds(1));
+
+  std::string reason;
+  if (!Expect(writer.Start(&reason), "Expected spill writer to start: " + reason)) {
+    return false;
+  }
+  for (int index = 0; index < 200; ++index) {
+    ring.Record(ulak::core::MakePanicAuditEntry("PANIC_RTL",
+                                                "panic-" + std::to_string(index),
+                                                "aggressive",
+                                                ulak::core::PanicAuditOutcome::kExecTimeout,
+                                                1000 + index));
+    if (index % 8 == 7) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+  writer.Stop();
+
+  std::vector<ulak::core::PanicAuditEntry> loaded;
+  if (!Expect(ulak::core::LoadPanicAuditSpill(spill_path, &loaded, &reason),
+              "Expected spill file to load: " + reason)) {
+    return false;
+  }
+  if (!Expect(loaded.size() + writer.dropped() == 200,
+              "Expected spilled + dropped to cover every record")) {
+    return false;
+  }
+  if (!Expect(loaded.size() == writer.spilled(), "Expected spilled count to match file")) {
+    return false;
+  }
+  for (std::size_t index = 1; index < loaded.size(); ++index) {
+    if (!Expect(loaded[index].sequence > loaded[index - 1].sequence,
+                "Expected spill file in sequence order")) {
+      return false;
+    }
+  }
+  return Expect(ulak::core::CorrelationIdView(loaded.back()) == "panic-199",
+                "Expected final record to be spilled on Stop");
+}
+
+// Entries already in the ring when Start() runs, including those a previous
+// run spilled, must not be appended again.
+bool TestRestartDoesNotRespill(const std::filesystem::path& temp_dir) {
+  const auto spill_path = temp_dir / "panic_audit_restart.bin";
+  ulak::core::PanicAuditRing ring(16);
+  ulak::core::PanicAuditSpillWriter writer(&ring, spill_path, std::chrono::milliseconds(1));
+  const auto record = [&ring](int index) {
+    ring.Record(ulak::core::MakePanicAuditEntry("PANIC_RTL",
+                                                "panic-" + std::to_string(index),
+                                                "default",
+                                                ulak::core::PanicAuditOutcome::kSent,
+                                                index));
+  };
+
+  for (int index = 0; index < 4; ++index) {
+    record(index);
+  }
+  std::string reason;
+  bool started = writer.Start(&reason);
+  for (int index = 4; index < 10; ++index) {
+    record(index);
+  }
+  writer.Stop();
+  started = started && writer.Start(&reason);
+  for (int index = 10; index < 13; ++index) {
+    record(index);
+  }
+  writer.Stop();
+  started = started && writer.Start(&reason);
+  writer.Stop();
+
+  std::vector<ulak::core::PanicAuditEntry> loaded;
+  if (!Expect(started, "Expected spill writer to restart: " + reason) ||
+      !Expect(ulak::core::LoadPanicAuditSpill(spill_path, &loaded, &reason),
+              "Expected spill file to load: " + reason)) {
+    return false;
+  }
+  bool in_order = loaded.size() == 9;
+  for (std::size_t index = 0; in_order && index < loaded.size(); ++index) {
+    in_order = loaded[index].sequence == 4 + index;
+  }
+  return Expect(in_order, "Expected each entry spilled once across restarts, got " +
+                              std::to_string(loaded.size()) + " records");
+}
+
+}  // namespace
+
+int main() {
+  std::error_code ec;
+  const auto temp_dir = std::filesystem::temp_directory_path(ec) / "ulak_gcs_panic_audit_tests";
+  if (ec) {
+    std::cerr << "[test] Failed to access temporary directory: " << ec.message() << '\n';
+    return 1;
+  }
+  std::filesystem::remove_all(temp_dir, ec);
+  std::filesystem::create_directories(temp_dir, ec);
+  if (ec) {
+    std::cerr << "[test] Failed to create temporary directory: " << ec.message() << '\n';
+    return 1;
+  }
+
+  const bool ok = TestRingKeepsNewestEntries() &&
+                  TestConcurrentRecordAndSnapshot() &&
+                  TestProducersLapApartShareSlot() &&
+                  TestWrappingUnderContentionStaysMonotonic() &&
+                  TestSpillWriterPersistsEverything(temp_dir) &&
+                  TestRestartDoesNotRespill(temp_dir);
+
+  std::filesystem::remove_all(temp_dir, ec);
+  if (ec) {
+    std::cerr << "[test] Warning: failed to clean temporary files: " << ec.message() << '\n';
+  }
+
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Panic audit log tests passed.\n";
+  return 0;
+}
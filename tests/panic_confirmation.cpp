@@ -0,0 +1,129 @@
+#include "PanicConfirmationWatcher.h"
+#include "TelemetryFrame.h"
+#include "VehicleModeMonitor.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+ulak::models::TelemetryFrame MakeFrame(const std::string& mode, std::int64_t receive_time_us) {
+  ulak::models::TelemetryFrame frame;
+  frame.vehicle_mode = mode;
+  frame.vehicle_mode_id = ulak::models::InternVehicleMode(mode);
+  frame.receive_time_us = receive_time_us;
+  return frame;
+}
+
+bool TestModeInterning() {
+  if (!Expect(ulak::models::InternVehicleMode("RTL") == ulak::models::kVehicleModeRtl,
+              "Expected RTL to intern to the built-in id")) {
+    return false;
+  }
+  const auto custom = ulak::models::InternVehicleMode("FOLLOW_ME_CUSTOM");
+  if (!Expect(custom == ulak::models::InternVehicleMode("FOLLOW_ME_CUSTOM"),
+              "Expected repeated interning to return a stable id")) {
+    return false;
+  }
+  return Expect(ulak::models::VehicleModeName(custom) == "FOLLOW_ME_CUSTOM",
+                "Expected interned id to resolve back to its name");
+}
+
+bool TestConfirmedOnRtlEdge() {
+  std::vector<ulak::core::PanicConfirmationRecord> outcomes;
+  ulak::core::PanicConfirmationWatcher watcher(
+      [&outcomes](const ulak::core::PanicConfirmationRecord& record) { outcomes.push_back(record); });
+  ulak::comms::VehicleModeMonitor monitor;
+  monitor.Subscribe([&watcher](const ulak::models::VehicleModeTransition& transition) {
+    watcher.OnVehicleModeTransition(transition);
+  });
+
+  const std::int64_t sent_us = 1771632000000000;
+  monitor.Observe(MakeFrame("GUIDED", sent_us - 100));
+  watcher.Arm("default", "panic-1", sent_us, monitor.current_mode());
+  if (!Expect(watcher.state() == ulak::core::PanicConfirmationState::kSent,
+              "Expected SENT after arming")) {
+    return false;
+  }
+
+  if (!Expect(!monitor.Observe(MakeFrame("GUIDED", sent_us + 1000)),
+              "Repeated mode must not produce a transition")) {
+    return false;
+  }
+  monitor.Observe(MakeFrame("LOITER", sent_us + 2000));
+  if (!Expect(watcher.state() == ulak::core::PanicConfirmationState::kSent,
+              "Non-RTL transition must not confirm panic")) {
+    return false;
+  }
+
+  monitor.Observe(MakeFrame("RTL", sent_us + 1250375));
+  monitor.Observe(MakeFrame("RTL", sent_us + 1300000));
+  if (!Expect(outcomes.size() == 1, "Expected exactly one outcome for one trigger")) {
+    return false;
+  }
+  const auto& outcome = outcomes.front();
+  return Expect(outcome.state == ulak::core::PanicConfirmationState::kConfirmed,
+                "Expected CONFIRMED on RTL edge") &&
+         Expect(outcome.correlation_id == "panic-1", "Expected correlation id in outcome") &&
+         Expect(outcome.time_to_confirmation_us.has_value() &&
+                    outcome.time_to_confirmation_us.value() == 1250375,
+                "Expected microsecond time-to-confirmation from packet receive time") &&
+         Expect(outcome.timestamp == "2026-02-21T00:00:01.250375Z",
+                "Expected RFC3339 microsecond timestamp, got " + outcome.timestamp);
+}
+
+bool TestFailedAfterWindow() {
+  ulak::core::PanicConfirmationWatcher watcher;
+  const std::int64_t sent_us = 1771632000000000;
+  watcher.Arm("safe", "panic-2", sent_us, ulak::models::kVehicleModeGuided, 3000000);
+
+  if (!Expect(!watcher.Poll(sent_us + 2999999), "Expected no outcome inside the window")) {
+    return false;
+  }
+  if (!Expect(watcher.Poll(sent_us + 3000001), "Expected FAILED once the window elapsed")) {
+    return false;
+  }
+  watcher.OnVehicleModeTransition(
+      {ulak::models::kVehicleModeGuided, ulak::models::kVehicleModeRtl, sent_us + 3500000});
+
+  const auto outcome = watcher.last_outcome();
+  return Expect(outcome.has_value(), "Expected recorded outcome") &&
+         Expect(outcome->state == ulak::core::PanicConfirmationState::kFailed,
+                "Late RTL edge must not override FAILED") &&
+         Expect(!outcome->time_to_confirmation_us.has_value(),
+                "FAILED outcome must not carry time-to-confirmation");
+}
+
+bool TestAlreadyInRtl() {
+  ulak::core::PanicConfirmationWatcher watcher;
+  watcher.Arm("default", "panic-3", 1000, ulak::models::kVehicleModeRtl);
+  const auto outcome = watcher.last_outcome();
+  return Expect(outcome.has_value() &&
+                    outcome->state == ulak::core::PanicConfirmationState::kConfirmed,
+                "Expected immediate CONFIRMED when vehicle is already in RTL");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestModeInterning() &&
+                  TestConfirmedOnRtlEdge() &&
+                  TestFailedAfterWindow() &&
+                  TestAlreadyInRtl();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Panic confirmation watcher tests passed.\n";
+  return 0;
+}
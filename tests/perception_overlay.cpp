@@ -0,0 +1,119 @@
+#include "PerceptionOverlayRenderer.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+ulak::models::PerceptionTarget MakeTarget(double dx, double dy, double confidence,
+                                          std::int64_t time_us) {
+  ulak::models::PerceptionTarget target;
+  target.color = "red";
+  target.shape = "triangle";
+  target.alignment_dx = dx;
+  target.alignment_dy = dy;
+  target.confidence = confidence;
+  target.receive_time_us = time_us;
+  return target;
+}
+
+struct FrontSnapshot {
+  std::size_t count{0};
+  float centroid_x{0.0f};
+  float centroid_y{0.0f};
+  std::uint32_t marker_rgba{0};
+};
+
+// The triangle marker is the three fans emitted after the two crosshair quads
+// and the alignment line quad.
+FrontSnapshot ReadMarker(const ulak::comms::PerceptionOverlayRenderer& renderer) {
+  FrontSnapshot snapshot;
+  renderer.ReadFront([&snapshot](const ulak::comms::OverlayVertex* vertices, std::size_t count) {
+    snapshot.count = count;
+    if (count < 27) {
+      return;
+    }
+    for (std::size_t index = 18; index < 27; ++index) {
+      snapshot.centroid_x += vertices[index].x / 9.0f;
+      snapshot.centroid_y += vertices[index].y / 9.0f;
+    }
+    snapshot.marker_rgba = vertices[18].rgba;
+  });
+  return snapshot;
+}
+
+bool TestEmptyOverlayHasOnlyCrosshair() {
+  ulak::comms::PerceptionOverlayRenderer renderer;
+  if (!Expect(renderer.Render(0), "Expected first render to publish")) {
+    return false;
+  }
+  const auto snapshot = ReadMarker(renderer);
+  return Expect(snapshot.count == 12, "Expected crosshair only without targets") &&
+         Expect(!renderer.Render(16000), "Expected unchanged frame to be skipped") &&
+         Expect(renderer.generation() == 1, "Expected one published frame");
+}
+
+bool TestInterpolatesBetweenSamples() {
+  ulak::comms::PerceptionOverlayRenderer renderer;
+  renderer.OnTarget(MakeTarget(0.0, 0.0, 1.0, 1'000'000));
+  renderer.OnTarget(MakeTarget(0.5, -0.5, 1.0, 1'100'000));
+
+  // Displayed 100ms behind: halfway between the samples at t=1.15s.
+  renderer.Render(1'150'000);
+  const auto halfway = ReadMarker(renderer);
+  renderer.Render(1'200'000);
+  const auto settled = ReadMarker(renderer);
+  const std::size_t bytes = settled.count * sizeof(ulak::comms::OverlayVertex);
+  return Expect(halfway.centroid_x > 0.24f && halfway.centroid_x < 0.26f,
+                "Expected x interpolated halfway") &&
+         Expect(halfway.centroid_y > 0.24f && halfway.centroid_y < 0.26f,
+                "Expected image dy flipped to clip-space y") &&
+         Expect(settled.centroid_x > 0.49f && settled.centroid_y > 0.49f,
+                "Expected marker on the newest sample once interpolation completes") &&
+         Expect(!renderer.Render(1'216'000), "Expected settled overlay to skip rebuilds") &&
+         Expect(bytes < 2048, "Expected overlay frame under 2 KB");
+}
+
+bool TestStaleTargetIsGrayed() {
+  ulak::comms::PerceptionOverlayRenderer renderer;
+  renderer.OnTarget(MakeTarget(0.2, 0.2, 0.9, 0));
+  renderer.Render(200'000);
+  const auto live = ReadMarker(renderer);
+  renderer.Render(1'500'000);
+  std::size_t stale_count = 0;
+  std::uint32_t stale_rgba = 0;
+  renderer.ReadFront([&](const ulak::comms::OverlayVertex* vertices, std::size_t count) {
+    stale_count = count;
+    stale_rgba = count > 12 ? vertices[12].rgba : 0;
+  });
+  // Out-of-order samples must not move the marker back in time.
+  renderer.OnTarget(MakeTarget(-0.9, -0.9, 0.9, -1));
+  return Expect((live.marker_rgba & 0x00FFFFFFu) == 0x003030E0u,
+                "Expected red marker while live") &&
+         Expect(stale_rgba == 0x80808080u, "Expected gray marker once stale") &&
+         Expect(stale_count == live.count - 6, "Expected alignment line dropped when stale") &&
+         Expect(!renderer.Render(1'516'000), "Expected late sample to be ignored");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestEmptyOverlayHasOnlyCrosshair() &&
+                  TestInterpolatesBetweenSamples() &&
+                  TestStaleTargetIsGrayed();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Perception overlay tests passed.\n";
+  return 0;
+}
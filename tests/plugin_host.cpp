@@ -0,0 +1,340 @@
+#include "PluginHost.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::core::PluginCallResult;
+using ulak::core::PluginEventBatch;
+using ulak::core::PluginHost;
+using ulak::core::PluginManifest;
+using ulak::core::PluginState;
+
+// Stand-in for a script: charges `cost_per_event` instructions per event
+// through the meter, like a Lua count hook would.
+struct FakeScript {
+  std::uint64_t cost_per_event{10};
+  std::chrono::microseconds sleep{0};
+  bool fail{false};
+  std::atomic<int> calls{0};
+  std::atomic<std::size_t> telemetry_seen{0};
+  std::atomic<std::size_t> safety_seen{0};
+  std::atomic<bool> destroyed{false};
+};
+
+class FakeRuntime : public ulak::core::PluginRuntime {
+ public:
+  explicit FakeRuntime(std::shared_ptr<FakeScript> script) : script_(std::move(script)) {}
+  ~FakeRuntime() override { script_->destroyed = true; }
+
+  PluginCallResult OnEvents(const PluginEventBatch& batch, ulak::core::PluginBudgetMeter* meter,
+                            std::string* error) override {
+    ++script_->calls;
+    script_->telemetry_seen += batch.telemetry.size();
+    script_->safety_seen += batch.safety_events.size();
+    if (script_->sleep.count() > 0) {
+      std::this_thread::sleep_for(script_->sleep);
+    }
+    if (script_->fail) {
+      *error = "attempt to index a nil value";
+      return PluginCallResult::kError;
+    }
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      if (!meter->Charge(script_->cost_per_event)) {
+        return PluginCallResult::kBudgetExceeded;
+      }
+    }
+    return PluginCallResult::kOk;
+  }
+
+ private:
+  std::shared_ptr<FakeScript> script_;
+};
+
+struct Registry {
+  std::vector<std::pair<std::string, std::shared_ptr<FakeScript>>> scripts;
+
+  std::shared_ptr<FakeScript> Add(const std::string& name) {
+    auto script = std::make_shared<FakeScript>();
+    scripts.emplace_back(name, script);
+    return script;
+  }
+
+  ulak::core::PluginRuntimeFactory Factory() {
+    return [this](const PluginManifest& manifest, std::string* reason) -> std::unique_ptr<ulak::core::PluginRuntime> {
+      for (const auto& [name, script] : scripts) {
+        if (name == manifest.name) {
+          return std::make_unique<FakeRuntime>(script);
+        }
+      }
+      *reason = "cannot open " + manifest.script_path.string();
+      return nullptr;
+    };
+  }
+};
+
+PluginManifest Manifest(const std::string& name,
+                        std::uint32_t subscriptions = ulak::core::kAllPluginEvents) {
+  PluginManifest manifest;
+  manifest.name = name;
+  manifest.script_path = "plugins/" + name + ".lua";
+  manifest.subscriptions = subscriptions;
+  return manifest;
+}
+
+ulak::core::PluginStats StatsOf(const PluginHost& host, const std::string& name) {
+  for (const auto& stats : host.Stats()) {
+    if (stats.name == name) {
+      return stats;
+    }
+  }
+  return {};
+}
+
+ulak::models::SafetyEvent Event() {
+  ulak::models::SafetyEvent event;
+  event.code = "VISION_LOST";
+  return event;
+}
+
+bool TestEventsArriveInBatches() {
+  Registry registry;
+  auto logger = registry.Add("logger");
+  auto safety_only = registry.Add("safety_only");
+  ulak::core::PluginHostConfig config;
+  config.max_batch_events = 150;
+  PluginHost host(config, registry.Factory());
+  std::string reason;
+  const bool added =
+      host.AddPlugin(Manifest("logger"), &reason) &&
+      host.AddPlugin(Manifest("safety_only", ulak::core::PluginEventBit(ulak::core::PluginEventKind::kSafetyEvent)),
+                     &reason);
+  host.Start(&reason);
+
+  ulak::models::TelemetryFrame frame;
+  for (int i = 0; i < 100; ++i) {
+    host.OnTelemetry(frame);
+  }
+  host.Flush();
+  host.WaitIdle();
+  const int telemetry_only_calls = safety_only->calls;
+
+  host.OnSafetyEvent(Event());
+  host.OnSafetyEvent(Event());
+  // The batch reaches 150 events mid-loop and is sealed without waiting for Poll.
+  for (int i = 0; i < 150; ++i) {
+    host.OnTelemetry(frame);
+  }
+  host.WaitIdle();
+  const int calls_after_full = logger->calls;
+  host.Poll(1'000'000);
+  host.Poll(1'000'000 + config.batch_interval_us);
+  host.WaitIdle();
+
+  const auto stats = StatsOf(host, "logger");
+  return Expect(added, "Expected both plugins to load: " + reason) &&
+         Expect(telemetry_only_calls == 0, "Expected no call without a subscribed event kind") &&
+         Expect(calls_after_full == 2, "Expected a full batch to be sealed right away") &&
+         Expect(logger->calls == 3 && logger->telemetry_seen == 250 && logger->safety_seen == 2,
+                "Expected 252 events in three calls") &&
+         Expect(safety_only->calls == 1 && safety_only->safety_seen == 2,
+                "Expected the safety plugin to see only its batch") &&
+         Expect(stats.batches == 3 && stats.events == 252 && stats.state == PluginState::kActive,
+                "Expected per-plugin batch stats");
+}
+
+bool TestFieldViewsDoNotCopy() {
+  ulak::models::TelemetryFrame frame;
+  frame.vehicle_mode = "GUIDED";
+  frame.attitude_deg.yaw = 271.5;
+  frame.battery_percent = 64;
+  const auto mode = ulak::core::ReadTelemetryField(frame, ulak::core::ParseTelemetryField("vehicle_mode"));
+  const auto yaw = ulak::core::ReadTelemetryField(frame, ulak::core::ParseTelemetryField("attitude_deg.yaw"));
+  const auto battery = ulak::core::ReadTelemetryField(frame, ulak::core::ParseTelemetryField("battery_percent"));
+  const auto* mode_view = std::get_if<std::string_view>(&mode);
+  return Expect(mode_view != nullptr && mode_view->data() == frame.vehicle_mode.data() &&
+                    *mode_view == "GUIDED",
+                "Expected a view into the frame's string") &&
+         Expect(std::get<double>(yaw) == 271.5 && std::get<double>(battery) == 64.0,
+                "Expected numeric fields") &&
+         Expect(ulak::core::ParseTelemetryField("position_m.w") == ulak::core::TelemetryField::kUnknown &&
+                    std::holds_alternative<std::monostate>(
+                        ulak::core::ReadTelemetryField(frame, ulak::core::TelemetryField::kUnknown)),
+                "Expected nil for unknown fields");
+}
+
+bool TestRunawayPluginIsThrottledThenDisabled() {
+  Registry registry;
+  auto runaway = registry.Add("runaway");
+  registry.Add("well_behaved");
+  runaway->cost_per_event = 2'000'000;
+  ulak::core::PluginHostConfig config;
+  config.throttle_cooldown_us = 0;
+  PluginHost host(config, registry.Factory());
+  std::string reason;
+  host.AddPlugin(Manifest("runaway"), &reason);
+  host.AddPlugin(Manifest("well_behaved"), &reason);
+  host.Start(&reason);
+
+  ulak::models::TelemetryFrame frame;
+  host.OnTelemetry(frame);
+  host.Flush();
+  host.WaitIdle();
+  const auto throttled = StatsOf(host, "runaway");
+
+  for (int batch = 0; batch < 5; ++batch) {
+    for (int i = 0; i < 20; ++i) {
+      host.OnTelemetry(frame);
+    }
+    host.Flush();
+    host.WaitIdle();
+  }
+  const auto disabled = StatsOf(host, "runaway");
+  const auto healthy = StatsOf(host, "well_behaved");
+
+  return Expect(throttled.state == PluginState::kThrottled && throttled.overruns == 1,
+                "Expected the first overrun to throttle") &&
+         Expect(disabled.state == PluginState::kDisabled && disabled.overruns == 3 && runaway->calls == 3,
+                "Expected the third consecutive overrun to disable") &&
+         Expect(runaway->destroyed, "Expected a disabled plugin's runtime to be released") &&
+         Expect(healthy.state == PluginState::kActive && healthy.batches == 6 && healthy.overruns == 0,
+                "Expected other plugins to keep every batch");
+}
+
+bool TestSlowPluginIsThrottledByWallTime() {
+  Registry registry;
+  auto slow = registry.Add("slow");
+  slow->sleep = std::chrono::microseconds(3'000);
+  ulak::core::PluginHostConfig config;
+  config.worker_threads = 1;
+  config.default_budget.max_batch_us = 1'000;
+  config.failures_to_disable = 100;
+  config.throttle_cooldown_us = 60'000'000;
+  PluginHost host(config, registry.Factory());
+  std::string reason;
+  host.AddPlugin(Manifest("slow"), &reason);
+  host.Start(&reason);
+
+  ulak::models::TelemetryFrame frame;
+  host.OnTelemetry(frame);
+  host.Flush();
+  host.WaitIdle();
+  // In cooldown: new batches coalesce to the newest instead of queueing up.
+  for (int i = 0; i < 5; ++i) {
+    host.OnTelemetry(frame);
+    host.Flush();
+  }
+  host.WaitIdle();
+  const auto stats = StatsOf(host, "slow");
+  return Expect(stats.state == PluginState::kThrottled && stats.overruns == 1,
+                "Expected a wall-time overrun without a hook abort") &&
+         Expect(slow->calls == 1 && stats.dropped_batches == 4,
+                "Expected a throttled plugin to keep only the newest batch") &&
+         Expect(stats.run_p50_us >= 3'000 && stats.run_max_us >= 3'000 && stats.delivery_p99_us >= 3'000,
+                "Expected run and delivery latency in the stats");
+}
+
+bool TestThrottledPluginRecovers() {
+  Registry registry;
+  auto bursty = registry.Add("bursty");
+  bursty->cost_per_event = 2'000'000;
+  ulak::core::PluginHostConfig config;
+  config.throttle_cooldown_us = 0;
+  config.batches_to_recover = 2;
+  PluginHost host(config, registry.Factory());
+  std::string reason;
+  host.AddPlugin(Manifest("bursty"), &reason);
+  host.Start(&reason);
+
+  const auto run_batch = [&host] {
+    host.OnTelemetry(ulak::models::TelemetryFrame{});
+    host.Flush();
+    host.WaitIdle();
+  };
+  run_batch();
+  const PluginState after_burst = StatsOf(host, "bursty").state;
+  bursty->cost_per_event = 1;
+  run_batch();
+  const PluginState after_one = StatsOf(host, "bursty").state;
+  run_batch();
+  return Expect(after_burst == PluginState::kThrottled, "Expected throttling after the burst") &&
+         Expect(after_one == PluginState::kThrottled, "Expected throttling to hold for one clean batch") &&
+         Expect(StatsOf(host, "bursty").state == PluginState::kActive,
+                "Expected recovery after consecutive clean batches");
+}
+
+bool TestScriptErrorsDisable() {
+  Registry registry;
+  auto broken = registry.Add("broken");
+  broken->fail = true;
+  PluginHost host({}, registry.Factory());
+  std::string reason;
+  host.AddPlugin(Manifest("broken"), &reason);
+  host.Start(&reason);
+  for (int i = 0; i < 4; ++i) {
+    host.OnSafetyEvent(Event());
+    host.Flush();
+    host.WaitIdle();
+  }
+  const auto stats = StatsOf(host, "broken");
+  return Expect(stats.errors == 3 && stats.overruns == 0 && stats.state == PluginState::kDisabled,
+                "Expected consecutive script errors to disable") &&
+         Expect(stats.last_error == "attempt to index a nil value", "Expected the last script error");
+}
+
+bool TestLoading() {
+  Registry registry;
+  registry.Add("present");
+  PluginHost host({}, registry.Factory());
+  std::string missing_reason;
+  std::string duplicate_reason;
+  std::string late_reason;
+  std::string ignored;
+  const bool missing = !host.AddPlugin(Manifest("absent"), &missing_reason);
+  host.AddPlugin(Manifest("present"), &ignored);
+  const bool duplicate = !host.AddPlugin(Manifest("present"), &duplicate_reason);
+  host.Start(&ignored);
+  const bool late = !host.AddPlugin(Manifest("later"), &late_reason);
+  PluginHost no_runtime({}, nullptr);
+  const bool unavailable = !no_runtime.AddPlugin(Manifest("present"), &ignored);
+
+  return Expect(missing && missing_reason.find("plugins/absent.lua") != std::string::npos,
+                "Expected the factory's load error") &&
+         Expect(duplicate && duplicate_reason.find("duplicate") != std::string::npos,
+                "Expected duplicate names to be refused") &&
+         Expect(late, "Expected AddPlugin after Start to be refused") &&
+         Expect(unavailable, "Expected no plugins without a runtime");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestEventsArriveInBatches() &&
+                  TestFieldViewsDoNotCopy() &&
+                  TestRunawayPluginIsThrottledThenDisabled() &&
+                  TestSlowPluginIsThrottledByWallTime() &&
+                  TestThrottledPluginRecovers() &&
+                  TestScriptErrorsDisable() &&
+                  TestLoading();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Plugin host tests passed.\n";
+  return 0;
+}
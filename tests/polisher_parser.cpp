@@ -0,0 +1,176 @@
+#include "PolisherParser.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+const char* kSpecExample =
+    "import cv2\n"
+    "\n"
+    "@polisher_start\n"
+    "\n"
+    "@polisher_param(label=\"Threshold\", type=\"slider\", min=0, max=255)\n"
+    "threshold = 127\n"
+    "\n"
+    "@polisher_param(label=\"Blur Kernel\", type=\"slider\", min=1, max=21, step=2)\n"
+    "blur_kernel = 5\n"
+    "\n"
+    "@polisher_param(label='Canny Sigma', type='slider', min=0.1, max=2.0, step=0.05)\n"
+    "canny_sigma = 0.33  # tuned on field footage\n"
+    "\n"
+    "@polisher_param(label=\"Edge Detection\", type=\"toggle\")\n"
+    "use_edge = True\n"
+    "\n"
+    "@polisher_end\n"
+    "\n"
+    "def process(frame):\n"
+    "    return frame\n";
+
+bool WriteFile(const std::filesystem::path& path, const std::string& contents) {
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  output << contents;
+  return static_cast<bool>(output);
+}
+
+bool TestSpecExample() {
+  const auto result = ulak::utils::ParsePolisherSource(kSpecExample);
+  if (!Expect(result.ok && result.polisher_enabled, "Expected spec example to parse") ||
+      !Expect(result.params.size() == 4, "Expected four params")) {
+    return false;
+  }
+  const auto& threshold = result.params[0];
+  const auto& blur = result.params[1];
+  const auto& sigma = result.params[2];
+  const auto& edge = result.params[3];
+  return Expect(threshold.name == "threshold" && threshold.label == "Threshold",
+                "Expected name and label from decorator/assignment") &&
+         Expect(threshold.type == ulak::utils::PolisherParamType::kIntSlider &&
+                    threshold.min == 0 && threshold.max == 255 && threshold.step == 1 &&
+                    threshold.default_value == 127,
+                "Expected int slider with default step 1") &&
+         Expect(threshold.line == 5, "Expected decorator line number") &&
+         Expect(blur.step == 2 && blur.default_value == 5, "Expected explicit step") &&
+         Expect(sigma.type == ulak::utils::PolisherParamType::kFloatSlider &&
+                    sigma.default_value == 0.33,
+                "Expected float slider inferred from default") &&
+         Expect(edge.type == ulak::utils::PolisherParamType::kToggle && edge.default_toggle,
+                "Expected toggle default True");
+}
+
+bool TestNotEnabledScripts() {
+  const auto no_block = ulak::utils::ParsePolisherSource("def process(frame):\n    return frame\n");
+  const auto empty_block =
+      ulak::utils::ParsePolisherSource("# @polisher_start\nx = 1\n# @polisher_end\n");
+  const auto mention = ulak::utils::ParsePolisherSource("print('@polisher_start')\n");
+  return Expect(no_block.ok && !no_block.polisher_enabled, "Expected no block to be not enabled") &&
+         Expect(empty_block.ok && !empty_block.polisher_enabled,
+                "Expected block without params to be not enabled") &&
+         Expect(mention.ok && !mention.polisher_enabled,
+                "Expected marker inside code not to open a block");
+}
+
+bool ExpectInvalid(const std::string& body, int line, const std::string& what) {
+  const auto result =
+      ulak::utils::ParsePolisherSource("@polisher_start\n" + body + "@polisher_end\n");
+  return Expect(!result.ok && result.error == ulak::utils::PolisherParseError::kInvalidParam &&
+                    result.error_line == line && result.params.empty(),
+                "Expected rejection: " + what + " (" + result.message + ")");
+}
+
+bool TestRejectsContractViolations() {
+  const auto unterminated = ulak::utils::ParsePolisherSource("@polisher_start\nx = 1\n");
+  return Expect(unterminated.error == ulak::utils::PolisherParseError::kUnterminatedBlock,
+                "Expected unterminated block error") &&
+         ExpectInvalid("@polisher_param(type=\"slider\", min=0, max=1)\nx = 0\n", 2,
+                       "missing label") &&
+         ExpectInvalid("@polisher_param(label=\"X\", min=0, max=1)\nx = 0\n", 2, "missing type") &&
+         ExpectInvalid("@polisher_param(label=\"X\", type=\"slider\", max=1)\nx = 0\n", 2,
+                       "slider without min") &&
+         ExpectInvalid("@polisher_param(label=\"X\", type=\"toggle\")\nx = 1\n", 2,
+                       "toggle default not True/False") &&
+         ExpectInvalid("@polisher_param(label=\"X\", type=\"dial\")\nx = 1\n", 2,
+                       "unsupported type") &&
+         ExpectInvalid("@polisher_param(label=\"X\", type=\"slider\", min=0, max=1)\n\n", 2,
+                       "missing assignment") &&
+         ExpectInvalid("\n@polisher_param(label=\"X\", type=\"slider\", min=0, max=9)\nx = foo\n",
+                       4, "non-literal default") &&
+         ExpectInvalid("@polisher_param(label=\"X\", type=\"slider\", min=0, max=9, step=0x1)\n"
+                       "x = 1\n",
+                       2, "hex literal") &&
+         ExpectInvalid("@polisher_param(label=\"X\", type=\"slider\", min=0, max=9)\nx = 10\n", 2,
+                       "default outside range");
+}
+
+bool TestCacheSkipsUnchangedScripts() {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         ("ulak_polisher_" + std::to_string(std::chrono::steady_clock::now()
+                                                                .time_since_epoch()
+                                                                .count()));
+  std::filesystem::create_directories(directory);
+  const auto script = directory / "edge_detect.py";
+  if (!Expect(WriteFile(script, kSpecExample), "Expected script write")) {
+    return false;
+  }
+
+  ulak::utils::PolisherScriptCache cache;
+  const auto first = cache.Load(script);
+  const auto second = cache.Load(script);
+  bool ok = Expect(first->ok && first->params.size() == 4, "Expected cached parse") &&
+            Expect(first == second, "Expected unchanged script to reuse the parsed table") &&
+            Expect(cache.stats().parses == 1 && cache.stats().stat_hits == 1,
+                   "Expected stat hit on unchanged script");
+
+  // Edit outside the block: re-read, but the block hash matches.
+  std::string edited = std::string(kSpecExample) + "    # trailing note\n";
+  ok = ok && Expect(WriteFile(script, edited), "Expected script rewrite");
+  const auto third = cache.Load(script);
+  ok = ok && Expect(third == first && cache.stats().hash_hits == 1,
+                    "Expected edit outside the block to reuse the parsed table");
+
+  // Edit inside the block: re-parse.
+  edited.replace(edited.find("threshold = 127"), 15, "threshold = 99");
+  ok = ok && Expect(WriteFile(script, edited), "Expected script rewrite");
+  const auto fourth = cache.Load(script);
+  ok = ok && Expect(fourth != first && fourth->params[0].default_value == 99 &&
+                        cache.stats().parses == 2,
+                    "Expected edit inside the block to re-parse");
+
+  std::filesystem::remove(script);
+  const auto missing = cache.Load(script);
+  ok = ok && Expect(missing->error == ulak::utils::PolisherParseError::kMissingFile,
+                    "Expected missing file error");
+
+  const auto direct = ulak::utils::ParsePolisherScript(directory / "absent.py");
+  ok = ok && Expect(direct.error == ulak::utils::PolisherParseError::kMissingFile,
+                    "Expected missing file error from direct parse");
+
+  std::filesystem::remove_all(directory);
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestSpecExample() &&
+                  TestNotEnabledScripts() &&
+                  TestRejectsContractViolations() &&
+                  TestCacheSkipsUnchangedScripts();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Polisher parser tests passed.\n";
+  return 0;
+}
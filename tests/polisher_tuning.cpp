@@ -0,0 +1,182 @@
+#include "PolisherTuningSession.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+ulak::core::PolisherTuningSession MakeSession() {
+  return ulak::core::PolisherTuningSession("b9b0b8f2-9c46-4fce-8f8c-d7608f3f1e8a",
+                                           {"threshold", "blur_kernel", "use_edge"});
+}
+
+bool TestSliderDragIsCoalescedTo60Hz() {
+  auto session = MakeSession();
+  // A drag reported at 1 kHz for one second.
+  int frames = 0;
+  double last_value = -1.0;
+  for (std::int64_t now = 0; now < 1'000'000; now += 1000) {
+    const double value = static_cast<double>(now / 4000);
+    session.SetValue(0, value);
+    if (const auto frame = session.Poll(now)) {
+      ++frames;
+      if (!Expect(frame->deltas.size() == 1 && frame->deltas[0].first == 0,
+                  "Expected one delta per frame for a single slider")) {
+        return false;
+      }
+      last_value = frame->deltas[0].second;
+      if (!Expect(last_value == value, "Expected frames to carry the newest value")) {
+        return false;
+      }
+    }
+  }
+  return Expect(frames >= 59 && frames <= 61, "Expected frame rate capped at 60 Hz") &&
+         Expect(session.last_sent_sequence() == static_cast<std::uint32_t>(frames),
+                "Expected one sequence number per frame");
+}
+
+bool TestLatestWinsAndAck() {
+  auto session = MakeSession();
+  session.SetValue(0, 10);
+  session.SetValue(0, 20);
+  session.SetValue(2, 1);
+  const auto first = session.Poll(0);
+  if (!Expect(first && first->deltas.size() == 2 && first->deltas[0].second == 20,
+              "Expected latest value and one entry per param")) {
+    return false;
+  }
+  if (!Expect(ulak::core::SerializePolisherDeltaFrame(*first) ==
+                  "{\"d\":[[0,20],[2,1]],\"q\":1,"
+                  "\"s\":\"b9b0b8f2-9c46-4fce-8f8c-d7608f3f1e8a\"}",
+              "Expected compact delta payload")) {
+    return false;
+  }
+
+  // Value dragged away and back before the next frame: nothing to send.
+  session.SetValue(0, 21);
+  session.SetValue(0, 20);
+  if (!Expect(!session.Poll(20000), "Expected unchanged value to be skipped")) {
+    return false;
+  }
+
+  session.SetValue(1, 0.35);
+  const auto second = session.Poll(40000);
+  if (!Expect(second && second->sequence == 2, "Expected second frame")) {
+    return false;
+  }
+  if (!Expect(ulak::core::SerializePolisherDeltaFrame(*second).find("[1,0.35]") !=
+                  std::string::npos,
+              "Expected short float formatting")) {
+    return false;
+  }
+
+  session.OnAck(1, 0);
+  if (!Expect(session.confirmed_value(0) == 20 && std::isnan(session.confirmed_value(1)),
+              "Expected ACK to confirm only frames up to its sequence")) {
+    return false;
+  }
+  session.OnAck(7, 0);
+  session.OnAck(0, 0);
+  if (!Expect(session.acked_sequence() == 1, "Expected bogus and stale ACKs to be ignored")) {
+    return false;
+  }
+  session.OnAck(2, 0b1);
+  return Expect(session.confirmed_value(1) == 0.35, "Expected periodic ACK to confirm frame 2") &&
+         Expect(!session.stalled(5'000'000), "Expected no stall once everything is acked");
+}
+
+bool TestUnackedValuesAreResent() {
+  auto session = MakeSession();
+  session.SetValue(0, 100);
+  session.SetValue(1, 3);
+  session.Poll(0);
+  session.SetValue(1, 5);
+  session.Poll(20000);
+  session.OnAck(1, 0);
+
+  if (!Expect(!session.Poll(500000), "Expected no frame while waiting for ACK") ||
+      !Expect(session.stalled(1'020'000), "Expected stall after ACK timeout")) {
+    return false;
+  }
+  const auto resend = session.Poll(1'020'000);
+  return Expect(resend && resend->sequence == 3 && resend->deltas.size() == 1 &&
+                    resend->deltas[0].first == 1 && resend->deltas[0].second == 5,
+                "Expected only the unconfirmed param to be resent with its newest value") &&
+         Expect(!session.stalled(1'030'000), "Expected stall to clear after resend");
+}
+
+bool TestGapInAckedRangeIsResent() {
+  auto session = MakeSession();
+  session.SetValue(0, 1);
+  session.Poll(0);
+  // Frame 2 is lost while the link reconnects; frame 3 gets through.
+  session.SetValue(1, 7);
+  session.Poll(20000);
+  session.SetValue(2, 1);
+  session.Poll(40000);
+  // Applied 3 and 1, not 2.
+  session.OnAck(3, 0b10);
+
+  const auto resend = session.Poll(60000);
+  return Expect(session.confirmed_value(0) == 1 && session.confirmed_value(2) == 1,
+                "Expected applied frames to confirm their values") &&
+         Expect(std::isnan(session.confirmed_value(1)),
+                "Expected the lost frame's value to stay unconfirmed") &&
+         Expect(resend && resend->deltas.size() == 1 && resend->deltas[0].first == 1 &&
+                    resend->deltas[0].second == 7,
+                "Expected the lost value resent without waiting for the ACK timeout");
+}
+
+bool TestNonFiniteValuesAreRejected() {
+  auto session = MakeSession();
+  ulak::core::PolisherDeltaFrame frame;
+  frame.sequence = 1;
+  frame.deltas.emplace_back(0, std::nan(""));
+  return Expect(!session.SetValue(0, std::nan("")) && !session.SetValue(0, HUGE_VAL),
+                "Expected NaN and infinity to be refused") &&
+         Expect(!session.Poll(0), "Expected nothing queued by a refused value") &&
+         Expect(ulak::core::SerializePolisherDeltaFrame(frame).find("[0,null]") !=
+                    std::string::npos,
+                "Expected a non-finite value never to serialize as a number");
+}
+
+bool TestSessionControlParams() {
+  const auto session = MakeSession();
+  return Expect(session.SerializeOpenParams() ==
+                    "{\"ack_interval_ms\":250,\"max_rate_hz\":60,"
+                    "\"param_ids\":{\"blur_kernel\":1,\"threshold\":0,\"use_edge\":2},"
+                    "\"tuning_session\":\"open\"}",
+                "Expected deterministic open params") &&
+         Expect(session.SerializeCloseParams() ==
+                    "{\"session_id\":\"b9b0b8f2-9c46-4fce-8f8c-d7608f3f1e8a\","
+                    "\"tuning_session\":\"close\"}",
+                "Expected deterministic close params") &&
+         Expect(!MakeSession().SetValue(3, 1), "Expected unknown param id to be rejected");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestSliderDragIsCoalescedTo60Hz() &&
+                  TestLatestWinsAndAck() &&
+                  TestUnackedValuesAreResent() &&
+                  TestGapInAckedRangeIsResent() &&
+                  TestNonFiniteValuesAreRejected() &&
+                  TestSessionControlParams();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Polisher tuning session tests passed.\n";
+  return 0;
+}
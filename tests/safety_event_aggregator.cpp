@@ -0,0 +1,183 @@
+#include "SafetyEventAggregator.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::core::AggregatedSafetyEvent;
+using ulak::core::EscalationRule;
+using ulak::core::SafetyAggregationPolicy;
+using ulak::core::SafetyEventAggregator;
+using ulak::models::SafetyEvent;
+using ulak::models::SafetySeverity;
+
+SafetyEvent Event(const std::string& code, SafetySeverity severity,
+                  const std::string& message = "") {
+  SafetyEvent event;
+  event.code = code;
+  event.severity = severity;
+  event.message = message;
+  event.recommended_action = "HOLD";
+  return event;
+}
+
+bool TestStormCollapses() {
+  SafetyEventAggregator aggregator;
+  std::vector<AggregatedSafetyEvent> delivered;
+  aggregator.SetEventSink([&](const AggregatedSafetyEvent& event) { delivered.push_back(event); });
+
+  // 500 events/s for one second, two codes interleaved.
+  for (int i = 0; i < 500; ++i) {
+    const std::int64_t now_us = i * 2'000;
+    aggregator.Submit(Event("VISION_LOST", SafetySeverity::kWarn, std::to_string(i)), now_us);
+    aggregator.Submit(Event("CC_LINK_LOSS", SafetySeverity::kWarn), now_us);
+    if (i % 50 == 0) {
+      aggregator.Flush(now_us);
+    }
+  }
+  aggregator.Flush(1'000'000);
+  const auto stats = aggregator.Stats();
+
+  std::uint32_t vision_total = 0;
+  std::size_t vision_forwards = 0;
+  std::string last_message;
+  for (const auto& event : delivered) {
+    if (event.event.code == "VISION_LOST") {
+      vision_total += event.occurrences;
+      ++vision_forwards;
+      last_message = event.event.message;
+    }
+  }
+  return Expect(delivered.size() == 4, "Expected one leading event and one summary per code") &&
+         Expect(vision_forwards == 2 && vision_total == 500,
+                "Expected the occurrence counts to add up to every raw event") &&
+         Expect(delivered[0].occurrences == 1 && delivered[0].first_seen_us == 0,
+                "Expected the first event to go out at once") &&
+         Expect(last_message == "499", "Expected the summary to carry the latest event") &&
+         Expect(stats.received == 1'000 && stats.forwarded == 4 && stats.suppressed == 998,
+                "Expected the counters to account for every event");
+}
+
+bool TestEscalationRule() {
+  SafetyEventAggregator aggregator;
+  SafetyAggregationPolicy policy;
+  policy.coalesce_window_us = 1'000'000;
+  policy.escalation.push_back(
+      EscalationRule{"VISION_LOST", SafetySeverity::kWarn, 5, 2'000'000, SafetySeverity::kError});
+  std::string reason;
+  const bool applied = aggregator.SetPolicy(policy, &reason);
+
+  std::vector<AggregatedSafetyEvent> out;
+  for (int i = 0; i < 5; ++i) {
+    const auto events =
+        aggregator.Submit(Event("VISION_LOST", SafetySeverity::kWarn), i * 100'000);
+    out.insert(out.end(), events.begin(), events.end());
+  }
+  // Slow trickle on another code: never five within the window.
+  std::size_t other_errors = 0;
+  for (int i = 0; i < 10; ++i) {
+    for (const auto& event :
+         aggregator.Submit(Event("OTHER", SafetySeverity::kWarn), 10'000'000 + i * 600'000)) {
+      other_errors += event.event.severity == SafetySeverity::kError ? 1 : 0;
+    }
+  }
+
+  return Expect(applied, "Expected the policy to apply: " + reason) &&
+         Expect(out.size() == 2, "Expected the fifth WARN to break through the coalescing") &&
+         Expect(out[1].event.severity == SafetySeverity::kError &&
+                    out[1].source_severity == SafetySeverity::kWarn && out[1].occurrences == 4,
+                "Expected the escalated event to fold the held-back repeats") &&
+         Expect(out[1].begins_countdown, "Expected the escalation to start a countdown") &&
+         Expect(other_errors == 0, "Expected rules to apply only to their code and window");
+}
+
+bool TestOneCountdownPerCode() {
+  SafetyEventAggregator aggregator;
+  std::size_t countdowns = 0;
+  std::size_t forwarded = 0;
+  std::int64_t now_us = 0;
+  const auto run = [&](int seconds) {
+    for (int i = 0; i < seconds * 100; ++i, now_us += 10'000) {
+      for (const auto& event :
+           aggregator.Submit(Event("CC_LINK_LOSS", SafetySeverity::kError), now_us)) {
+        ++forwarded;
+        countdowns += event.begins_countdown ? 1 : 0;
+      }
+      for (const auto& event : aggregator.Flush(now_us)) {
+        ++forwarded;
+        countdowns += event.begins_countdown ? 1 : 0;
+      }
+    }
+  };
+  run(5);
+  const std::size_t before_release = countdowns;
+  aggregator.ReleaseCountdown("CC_LINK_LOSS");
+  run(2);
+
+  bool critical_passes = false;
+  for (const auto& event :
+       aggregator.Submit(Event("CC_LINK_LOSS", SafetySeverity::kCritical), now_us)) {
+    critical_passes = event.event.severity == SafetySeverity::kCritical && !event.begins_countdown;
+  }
+  return Expect(before_release == 1, "Expected one countdown for a five second ERROR storm") &&
+         Expect(forwarded <= 8, "Expected about one event per coalesce window") &&
+         Expect(countdowns == 2, "Expected a new countdown only after the first was released") &&
+         Expect(critical_passes, "Expected a CRITICAL to go straight through");
+}
+
+bool TestCodeLimitAndPolicyChecks() {
+  SafetyEventAggregator aggregator;
+  SafetyAggregationPolicy policy;
+  policy.max_codes = 2;
+  std::string reason;
+  aggregator.SetPolicy(policy, &reason);
+  aggregator.Submit(Event("A", SafetySeverity::kWarn), 0);
+  aggregator.Submit(Event("B", SafetySeverity::kWarn), 0);
+  std::size_t passed = 0;
+  for (int i = 0; i < 3; ++i) {
+    passed += aggregator.Submit(Event("C", SafetySeverity::kWarn), 10).size();
+  }
+  aggregator.Flush(5'000'000);
+  std::size_t after_forget = aggregator.Submit(Event("C", SafetySeverity::kWarn), 5'000'001).size();
+  after_forget += aggregator.Submit(Event("C", SafetySeverity::kWarn), 5'000'002).size();
+
+  SafetyAggregationPolicy bad;
+  bad.escalation.push_back(
+      EscalationRule{"", SafetySeverity::kError, 3, 1'000'000, SafetySeverity::kWarn});
+  const bool lowering = !aggregator.SetPolicy(bad, &reason) &&
+                        reason.find("does not raise") != std::string::npos;
+  bad.escalation[0] = EscalationRule{"", SafetySeverity::kWarn, 0, 1'000'000,
+                                     SafetySeverity::kError};
+  const bool zero = !aggregator.SetPolicy(bad, &reason);
+
+  return Expect(passed == 3 && aggregator.Stats().untracked == 3,
+                "Expected events beyond the code limit to pass through") &&
+         Expect(after_forget == 1, "Expected quiet codes to be forgotten and the slot reused") &&
+         Expect(lowering && zero, "Expected invalid rules to be refused");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestStormCollapses() &&
+                  TestEscalationRule() &&
+                  TestOneCountdownPerCode() &&
+                  TestCodeLimitAndPolicyChecks();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Safety event aggregator tests passed.\n";
+  return 0;
+}
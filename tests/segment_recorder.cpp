@@ -0,0 +1,138 @@
+#include "SegmentRecorder.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+constexpr std::int64_t kStartUs = 1'770'000'000'000'000;
+constexpr std::int64_t kFrameUs = 33'333;
+
+// Frame n of a 30 fps stream with a 1 s GOP; only the very first IDR carries
+// SPS/PPS. The payload encodes n so units can be told apart on disk.
+ulak::comms::EncodedAccessUnit Frame(int n) {
+  std::vector<std::uint8_t> data;
+  if (n == 0) {
+    data = {0, 0, 0, 1, 0x67, 0x42, 0x00, 0x1F, 0, 0, 0, 1, 0x68, 0xCE};
+  }
+  const bool idr = n % 30 == 0;
+  data.insert(data.end(), {0, 0, 0, 1, static_cast<std::uint8_t>(idr ? 0x65 : 0x41), 0x88,
+                           static_cast<std::uint8_t>(n & 0xFF), static_cast<std::uint8_t>(n >> 8),
+                           0x80});
+  auto unit = ulak::comms::MakeAccessUnit(ulak::comms::VideoCodec::kH264, std::move(data),
+                                          static_cast<std::int64_t>(n) * kFrameUs);
+  unit.receive_time_us = kStartUs + static_cast<std::int64_t>(n) * kFrameUs;
+  return unit;
+}
+
+std::vector<std::uint8_t> ReadAt(const std::filesystem::path& path, std::uint64_t offset,
+                                 std::size_t size) {
+  std::ifstream input(path, std::ios::binary);
+  input.seekg(static_cast<std::streamoff>(offset));
+  std::vector<std::uint8_t> bytes(size);
+  input.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size));
+  return bytes;
+}
+
+bool TestRecordAndSeek(const std::filesystem::path& directory) {
+  ulak::comms::RecordingConfig config;
+  config.directory = directory;
+  config.segment_duration_us = 1'900'000;
+  ulak::comms::SegmentRecorder recorder(config);
+  std::string reason;
+  if (!Expect(recorder.Open(&reason), "Expected recorder to open: " + reason)) {
+    return false;
+  }
+  // Join mid-GOP: the two leading P frames are not recordable on their own.
+  auto late = Frame(28);
+  late.receive_time_us = kStartUs - 2 * kFrameUs;
+  recorder.Write(late, nullptr);
+  recorder.Write(late, nullptr);
+  for (int n = 0; n < 150; ++n) {
+    if (!Expect(recorder.Write(Frame(n), &reason), "Expected write: " + reason)) {
+      return false;
+    }
+  }
+  recorder.Close();
+  if (!Expect(recorder.units_skipped() == 2 && recorder.units_written() == 150,
+              "Expected units before the first keyframe to be skipped") ||
+      !Expect(recorder.segments_started() == 3, "Expected 2 s keyframe-aligned segments")) {
+    return false;
+  }
+
+  ulak::comms::RecordingIndex index;
+  if (!Expect(index.Load(directory, "stream", &reason), "Expected index load: " + reason) ||
+      !Expect(index.entries().size() == 150 && index.keyframe_count() == 5,
+              "Expected every unit and keyframe indexed")) {
+    return false;
+  }
+
+  // The second segment starts at frame 60 whose IDR has no SPS/PPS: the
+  // recorder prefixed the cached ones so the file decodes on its own.
+  const auto& head = index.entries()[60];
+  const auto second = ulak::comms::RecordingSegmentPath(directory, "stream",
+                                                        ulak::comms::VideoCodec::kH264, 1);
+  const auto head_bytes = ReadAt(second, head.offset, head.size);
+  const auto head_info = ulak::comms::ClassifyAccessUnit(ulak::comms::VideoCodec::kH264,
+                                                         head_bytes.data(), head_bytes.size());
+  if (!Expect(head.offset == 0 && head_info.keyframe && head_info.has_parameter_sets,
+              "Expected segment to start with parameter sets and a keyframe")) {
+    return false;
+  }
+
+  // "The frame when TELEMETRY_LOSS was raised", half a frame after frame 100.
+  const auto seek = index.Seek(kStartUs + 100 * kFrameUs + kFrameUs / 2);
+  if (!Expect(seek.has_value(), "Expected seek result")) {
+    return false;
+  }
+  const auto frame_bytes = ReadAt(seek->segment_path, seek->frame_offset, Frame(100).data.size());
+  return Expect(seek->segment_path == second, "Expected frame 100 in the second segment") &&
+         Expect(seek->frame_time_us == kStartUs + 100 * kFrameUs, "Expected frame 100") &&
+         Expect(frame_bytes == Frame(100).data, "Expected untouched unit bytes at frame offset") &&
+         Expect(seek->keyframe_time_us == kStartUs + 90 * kFrameUs && seek->frames_to_decode == 11,
+                "Expected decode to start at the preceding keyframe") &&
+         Expect(seek->parameter_sets.size() == 14,
+                "Expected parameter sets for a mid-segment keyframe") &&
+         Expect(!index.Seek(kStartUs - 1).has_value(), "Expected no frame before the recording");
+}
+
+bool TestTruncatedSegmentIsTrimmed(const std::filesystem::path& directory) {
+  const auto last = ulak::comms::RecordingSegmentPath(directory, "stream",
+                                                      ulak::comms::VideoCodec::kH264, 2);
+  std::filesystem::resize_file(last, std::filesystem::file_size(last) - 20);
+  ulak::comms::RecordingIndex index;
+  std::string reason;
+  return Expect(index.Load(directory, "stream", &reason), "Expected load after crash: " + reason) &&
+         Expect(index.entries().size() == 147, "Expected units past the segment end dropped") &&
+         Expect(!index.Load(directory, "missing", &reason), "Expected missing recording error");
+}
+
+}  // namespace
+
+int main() {
+  const auto directory =
+      std::filesystem::temp_directory_path() /
+      ("ulak_recording_" +
+       std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+  const bool ok = TestRecordAndSeek(directory) && TestTruncatedSegmentIsTrimmed(directory);
+  std::filesystem::remove_all(directory);
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Segment recorder tests passed.\n";
+  return 0;
+}
@@ -0,0 +1,423 @@
+#include "SharedStateBridge.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::comms::SharedStateConfig;
+using ulak::comms::SharedStateReader;
+using ulak::comms::SharedStateWriter;
+using ulak::comms::SharedText;
+
+SharedStateConfig TestConfig(int frame_width = 64, int frame_height = 32) {
+  SharedStateConfig config;
+  config.name = "/ulak_shm_test_" + std::to_string(::getpid()) + "_" +
+                std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+  config.event_capacity = 8;
+  config.frame_width = frame_width;
+  config.frame_height = frame_height;
+  return config;
+}
+
+ulak::models::SafetyEvent Event(int index) {
+  ulak::models::SafetyEvent event;
+  event.severity = ulak::models::SafetySeverity::kWarn;
+  event.code = "EVENT_" + std::to_string(index);
+  event.message = "event " + std::to_string(index);
+  event.recommended_action = "MONITOR";
+  event.receive_time_us = index;
+  return event;
+}
+
+bool TestSnapshotsRoundTrip() {
+  SharedStateWriter writer(TestConfig());
+  std::string reason;
+  if (!Expect(writer.Open(&reason), "Expected writer to open: " + reason)) {
+    return false;
+  }
+  SharedStateReader reader;
+  if (!Expect(reader.Open(writer.config().name, &reason), "Expected reader to open: " + reason)) {
+    return false;
+  }
+
+  ulak::comms::SharedTelemetry telemetry;
+  const bool empty_before_publish = !reader.ReadTelemetry(&telemetry);
+
+  ulak::models::TelemetryFrame frame;
+  frame.telemetry_type = "vehicle";
+  frame.frame_id = "map";
+  frame.position_m = {1.5, -2.0, 10.25};
+  frame.attitude_deg = {1.0, 2.0, 90.0};
+  frame.vehicle_mode = "GUIDED_WITH_A_VERY_LONG_MODE_NAME";
+  frame.vehicle_mode_id = ulak::models::kVehicleModeGuided;
+  frame.battery_percent = 76;
+  frame.receive_time_us = 1'000;
+  writer.PublishTelemetry(frame);
+  frame.receive_time_us = 2'000;
+  writer.PublishTelemetry(frame);
+
+  ulak::models::MissionStateUpdate mission;
+  mission.state = "SEARCH";
+  mission.progress = 0.5;
+  mission.note = "sector 2";
+  writer.PublishMissionState(mission);
+
+  ulak::models::PerceptionTarget target;
+  target.color = "red";
+  target.shape = "triangle";
+  target.confidence = 0.75;
+  writer.PublishPerception(target);
+
+  std::array<ulak::comms::LinkHealthFrame, ulak::comms::kLinkChannelCount> health{};
+  health[1].channel = ulak::comms::LinkChannel::kCompanionTcp;
+  health[1].state = ulak::comms::LinkHealthState::kDegraded;
+  health[1].jitter_us = 4'200;
+  writer.PublishLinkHealth(health);
+  writer.Heartbeat(5'000);
+
+  std::uint64_t version = 0;
+  ulak::comms::SharedMissionState shared_mission;
+  ulak::comms::SharedPerception shared_target;
+  ulak::comms::SharedLinkHealth shared_health;
+  const bool read_telemetry = reader.ReadTelemetry(&telemetry, &version);
+  return Expect(empty_before_publish, "Expected no telemetry before the first publish") &&
+         Expect(read_telemetry && version == 2, "Expected the second telemetry version") &&
+         Expect(telemetry.receive_time_us == 2'000 && telemetry.position_m[2] == 10.25 &&
+                    telemetry.attitude_deg[2] == 90.0 && telemetry.battery_percent == 76 &&
+                    telemetry.vehicle_mode_id == ulak::models::kVehicleModeGuided,
+                "Expected telemetry values") &&
+         Expect(SharedText(telemetry.frame_id) == "map" &&
+                    SharedText(telemetry.vehicle_mode) == "GUIDED_WITH_A_VERY_LONG",
+                "Expected text fields, long ones truncated") &&
+         Expect(reader.ReadMissionState(&shared_mission) && SharedText(shared_mission.state) == "SEARCH" &&
+                    shared_mission.progress == 0.5f && SharedText(shared_mission.note) == "sector 2",
+                "Expected mission state") &&
+         Expect(reader.ReadPerception(&shared_target) && SharedText(shared_target.shape) == "triangle" &&
+                    shared_target.confidence == 0.75f,
+                "Expected perception") &&
+         Expect(reader.ReadLinkHealth(&shared_health) &&
+                    shared_health.channels[1].state ==
+                        static_cast<std::uint8_t>(ulak::comms::LinkHealthState::kDegraded) &&
+                    shared_health.channels[1].jitter_us == 4'200,
+                "Expected link health") &&
+         Expect(reader.heartbeat_us() == 5'000 && !reader.writer_closed(), "Expected heartbeat");
+}
+
+bool TestEventRingNeverBlocksTheWriter() {
+  SharedStateWriter writer(TestConfig());
+  std::string reason;
+  writer.Open(&reason);
+  for (int i = 0; i < 3; ++i) {
+    writer.PublishSafetyEvent(Event(i));
+  }
+  // Attaching late replays what the ring still holds.
+  SharedStateReader reader;
+  reader.Open(writer.config().name, &reason);
+  std::vector<ulak::comms::SharedSafetyEvent> events;
+  std::uint64_t lost = 0;
+  const std::size_t first = reader.ReadSafetyEvents(&events, &lost);
+  const std::uint64_t lost_on_attach = lost;
+
+  // A stalled reader: the writer laps the 8-slot ring instead of waiting.
+  for (int i = 3; i < 16; ++i) {
+    writer.PublishSafetyEvent(Event(i));
+  }
+  std::vector<ulak::comms::SharedSafetyEvent> lapped;
+  reader.ReadSafetyEvents(&lapped, &lost);
+  const std::size_t nothing_new = reader.ReadSafetyEvents(&lapped, &lost);
+
+  return Expect(first == 3 && SharedText(events[2].code) == "EVENT_2" && lost_on_attach == 0,
+                "Expected the retained events on attach") &&
+         Expect(lapped.size() == 8 && SharedText(lapped.front().code) == "EVENT_8" &&
+                    SharedText(lapped.back().code) == "EVENT_15" && lost == 5,
+                "Expected the newest events and a count of the overwritten ones") &&
+         Expect(nothing_new == 0, "Expected no events without new publishes");
+}
+
+bool TestFrameSlotTripleBuffers() {
+  SharedStateWriter writer(TestConfig());
+  std::string reason;
+  writer.Open(&reason);
+  SharedStateReader reader;
+  reader.Open(writer.config().name, &reason);
+
+  ulak::comms::SharedFrameView view;
+  const bool nothing_yet = !reader.AcquireFrame(&view);
+  const bool oversized_refused = writer.BeginFrame(65, 32).data == nullptr;
+
+  // Three commits without a read: the writer keeps going and the reader gets
+  // the newest.
+  for (int i = 1; i <= 3; ++i) {
+    const auto image = writer.BeginFrame(16, 8);
+    for (int y = 0; y < image.height; ++y) {
+      for (int x = 0; x < image.width * 4; ++x) {
+        image.data[y * image.stride + x] = static_cast<std::uint8_t>(i);
+      }
+    }
+    writer.CommitFrame(i * 33'000);
+  }
+  const bool took = reader.AcquireFrame(&view);
+  const ulak::comms::SharedFrameView newest = view;
+  const bool no_repeat = !reader.AcquireFrame(&view);
+
+  // The frame the reader holds is never handed back to the writer.
+  for (int i = 4; i <= 9; ++i) {
+    const auto image = writer.BeginFrame(16, 8);
+    if (image.data == newest.data) {
+      return Expect(false, "Expected the writer to avoid the reader's buffer");
+    }
+    image.data[0] = static_cast<std::uint8_t>(i);
+    writer.CommitFrame(i * 33'000);
+  }
+  const bool newest_intact = newest.data[0] == 3 && newest.data[newest.stride * 7 + 63] == 3;
+  reader.AcquireFrame(&view);
+
+  return Expect(nothing_yet, "Expected no frame before the first commit") &&
+         Expect(oversized_refused, "Expected frames over the slot size to be refused") &&
+         Expect(took && newest.sequence == 3 && newest.pts_us == 99'000 && newest.width == 16 &&
+                    newest.height == 8 && newest.stride == 256,
+                "Expected the newest committed frame") &&
+         Expect(no_repeat, "Expected no frame until the next commit") &&
+         Expect(newest_intact, "Expected the held frame to stay untouched") &&
+         Expect(view.sequence == 9 && view.data[0] == 9, "Expected the latest frame after more commits");
+}
+
+// Writer and reader on separate threads: every snapshot must be internally
+// consistent (all fields from the same publish) and versions monotonic.
+bool TestConcurrentReadsAreNeverTorn() {
+  SharedStateWriter writer(TestConfig(0, 0));
+  std::string reason;
+  writer.Open(&reason);
+  SharedStateReader reader;
+  reader.Open(writer.config().name, &reason);
+
+  constexpr int kPublishes = 200'000;
+  std::atomic<bool> done{false};
+  std::thread producer([&writer, &done] {
+    ulak::models::TelemetryFrame frame;
+    for (int i = 1; i <= kPublishes; ++i) {
+      const double value = static_cast<double>(i);
+      frame.position_m = {value, value, value};
+      frame.velocity_mps = {value, value, value};
+      frame.receive_time_us = i;
+      frame.battery_percent = i;
+      writer.PublishTelemetry(frame);
+      if (i % 64 == 0) {
+        writer.PublishSafetyEvent(Event(i / 64));
+      }
+    }
+    done.store(true);
+  });
+
+  bool consistent = true;
+  std::uint64_t last_version = 0;
+  std::uint64_t lost = 0;
+  std::vector<ulak::comms::SharedSafetyEvent> events;
+  std::int64_t last_event_time = 0;
+  bool events_ordered = true;
+  while (!done.load()) {
+    ulak::comms::SharedTelemetry telemetry;
+    std::uint64_t version = 0;
+    if (reader.ReadTelemetry(&telemetry, &version)) {
+      const double value = static_cast<double>(telemetry.receive_time_us);
+      consistent = consistent && telemetry.position_m[0] == value && telemetry.position_m[2] == value &&
+                   telemetry.velocity_mps[1] == value && telemetry.battery_percent == telemetry.receive_time_us &&
+                   version == static_cast<std::uint64_t>(telemetry.receive_time_us) && version >= last_version;
+      last_version = version;
+    }
+    events.clear();
+    reader.ReadSafetyEvents(&events, &lost);
+    for (const auto& event : events) {
+      events_ordered = events_ordered && event.receive_time_us > last_event_time &&
+                       SharedText(event.code) == "EVENT_" + std::to_string(event.receive_time_us);
+      last_event_time = event.receive_time_us;
+    }
+  }
+  producer.join();
+  events.clear();
+  reader.ReadSafetyEvents(&events, &lost);
+  for (const auto& event : events) {
+    events_ordered = events_ordered && event.receive_time_us > last_event_time;
+    last_event_time = event.receive_time_us;
+  }
+
+  return Expect(consistent, "Expected every telemetry snapshot to be untorn") &&
+         Expect(events_ordered, "Expected events in publish order, each intact") &&
+         Expect(last_event_time == kPublishes / 64, "Expected to end on the last event");
+}
+
+bool TestAnotherProcessMapsTheSegment() {
+  SharedStateWriter writer(TestConfig());
+  std::string reason;
+  writer.Open(&reason);
+  ulak::models::MissionStateUpdate mission;
+  mission.state = "RETURN";
+  writer.PublishMissionState(mission);
+  writer.PublishSafetyEvent(Event(7));
+
+  const pid_t child = ::fork();
+  if (child == 0) {
+    SharedStateReader reader;
+    ulak::comms::SharedMissionState shared;
+    std::vector<ulak::comms::SharedSafetyEvent> events;
+    const bool ok = reader.Open(writer.config().name, nullptr) && reader.ReadMissionState(&shared) &&
+                    SharedText(shared.state) == "RETURN" && reader.ReadSafetyEvents(&events) == 1 &&
+                    SharedText(events[0].code) == "EVENT_7";
+    ::_exit(ok ? 0 : 1);
+  }
+  int status = 0;
+  ::waitpid(child, &status, 0);
+  return Expect(WIFEXITED(status) && WEXITSTATUS(status) == 0,
+                "Expected a second process to read the published state");
+}
+
+bool TestLifecycle() {
+  const SharedStateConfig config = TestConfig();
+  SharedStateReader reader;
+  std::string reason;
+  const bool missing_fails = !reader.Open(config.name, &reason) && !reason.empty();
+
+  SharedStateConfig bad_capacity = TestConfig();
+  bad_capacity.event_capacity = 6;
+  SharedStateConfig bad_name = TestConfig();
+  bad_name.name = "no_slash";
+  const bool rejects_config = !SharedStateWriter(bad_capacity).Open(&reason) &&
+                              !SharedStateWriter(bad_name).Open(&reason);
+
+  bool closed_seen = false;
+  {
+    SharedStateWriter writer(config);
+    writer.Open(&reason);
+    reader.Open(config.name, &reason);
+    writer.Close();
+    closed_seen = reader.writer_closed();
+  }
+  const bool unlinked = !SharedStateReader().Open(config.name, &reason);
+
+  // A second writer must not pull the segment out from under a live one.
+  bool live_refused = false;
+  {
+    SharedStateWriter first(config);
+    first.Open(&reason);
+    std::string refused;
+    live_refused = !SharedStateWriter(config).Open(&refused) &&
+                   refused.find("in use by pid " + std::to_string(::getpid())) != std::string::npos;
+  }
+
+  // A segment left by a crashed writer is replaced on the next Open().
+  const pid_t child = ::fork();
+  if (child == 0) {
+    SharedStateWriter crashed(config);
+    const bool opened = crashed.Open(nullptr);
+    crashed.PublishSafetyEvent(Event(1));
+    ::_exit(opened ? 0 : 1);
+  }
+  int status = 0;
+  ::waitpid(child, &status, 0);
+  const bool crashed_opened = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  SharedStateWriter second(config);
+  const bool reopened = second.Open(&reason);
+  SharedStateReader fresh;
+  std::vector<ulak::comms::SharedSafetyEvent> events;
+  fresh.Open(config.name, &reason);
+
+  return Expect(missing_fails, "Expected Open to fail without a writer") &&
+         Expect(rejects_config, "Expected invalid configs to be rejected") &&
+         Expect(closed_seen, "Expected readers to see the writer close") &&
+         Expect(unlinked, "Expected Close to unlink the segment") &&
+         Expect(live_refused, "Expected Open to refuse a segment with a live writer") &&
+         Expect(crashed_opened, "Expected the crashing writer to open") &&
+         Expect(reopened && fresh.ReadSafetyEvents(&events) == 0,
+                "Expected a fresh segment to replace a stale one: " + reason);
+}
+
+// Leading fields of the layout-version-1 segment header.
+struct HeaderPrefix {
+  std::uint32_t magic;
+  std::uint32_t layout_version;
+  std::uint64_t total_size;
+  std::uint64_t telemetry_offset;
+  std::uint64_t mission_offset;
+  std::uint64_t perception_offset;
+  std::uint64_t link_health_offset;
+  std::uint64_t events_offset;
+  std::uint64_t frames_offset;
+  std::uint32_t event_capacity;
+  std::uint32_t frame_width;
+  std::uint32_t frame_height;
+  std::uint32_t frame_stride;
+  std::uint64_t frame_buffer_size;
+};
+
+// Opens a reader on a segment whose header `corrupt` has rewritten.
+template <typename Corrupt>
+bool ReaderRefuses(Corrupt corrupt) {
+  SharedStateWriter writer(TestConfig());
+  std::string reason;
+  writer.Open(&reason);
+  const int fd = ::shm_open(writer.config().name.c_str(), O_RDWR, 0);
+  void* mapping = ::mmap(nullptr, sizeof(HeaderPrefix), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  corrupt(static_cast<HeaderPrefix*>(mapping));
+  ::munmap(mapping, sizeof(HeaderPrefix));
+  reason.clear();
+  return !SharedStateReader().Open(writer.config().name, &reason) &&
+         reason.find("outside its") != std::string::npos;
+}
+
+bool TestReaderBoundsChecksTheHeader() {
+  return Expect(ReaderRefuses([](HeaderPrefix* header) {
+                  header->events_offset = header->total_size - 64;
+                }),
+                "Expected an event ring past the mapping to be refused") &&
+         Expect(ReaderRefuses([](HeaderPrefix* header) { header->telemetry_offset += 8; }),
+                "Expected a misaligned slot to be refused") &&
+         Expect(ReaderRefuses([](HeaderPrefix* header) { header->event_capacity = 6; }),
+                "Expected a non-power-of-two event capacity to be refused") &&
+         Expect(ReaderRefuses([](HeaderPrefix* header) {
+                  header->frame_buffer_size = header->total_size;
+                }),
+                "Expected frame buffers past the mapping to be refused") &&
+         Expect(ReaderRefuses([](HeaderPrefix* header) { header->frame_width *= 2; }),
+                "Expected a frame wider than its stride to be refused");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestSnapshotsRoundTrip() &&
+                  TestEventRingNeverBlocksTheWriter() &&
+                  TestFrameSlotTripleBuffers() &&
+                  TestConcurrentReadsAreNeverTorn() &&
+                  TestAnotherProcessMapsTheSegment() &&
+                  TestLifecycle() &&
+                  TestReaderBoundsChecksTheHeader();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Shared state bridge tests passed.\n";
+  return 0;
+}
@@ -0,0 +1,539 @@
+#include "SimHarness.h"
+
+#include "NalUnit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+namespace ulak::sim {
+namespace {
+
+constexpr std::uint8_t kMavlinkV2Magic = 0xFD;
+constexpr std::size_t kMavlinkHeaderSize = 10;
+constexpr std::uint8_t kHeartbeatCrcExtra = 50;
+constexpr std::uint8_t kCommandLongCrcExtra = 152;
+
+std::uint16_t CrcAccumulate(std::uint8_t byte, std::uint16_t crc) {
+  std::uint8_t tmp = byte ^ static_cast<std::uint8_t>(crc & 0xFF);
+  tmp ^= static_cast<std::uint8_t>(tmp << 4);
+  return static_cast<std::uint16_t>((crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4));
+}
+
+bool CrcExtraFor(std::uint32_t message_id, std::uint8_t* extra) {
+  switch (message_id) {
+    case kMavlinkHeartbeat:
+      *extra = kHeartbeatCrcExtra;
+      return true;
+    case kMavlinkCommandLong:
+      *extra = kCommandLongCrcExtra;
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::uint16_t FrameCrc(const std::uint8_t* frame, std::size_t length, std::uint8_t extra) {
+  std::uint16_t crc = 0xFFFF;
+  // The magic byte is not covered.
+  for (std::size_t i = 1; i < length; ++i) {
+    crc = CrcAccumulate(frame[i], crc);
+  }
+  return CrcAccumulate(extra, crc);
+}
+
+// Value of `"key":"..."` or `"key":<number>` in a flat JSON text. Enough for
+// the stand-ins' own messages; not a JSON parser.
+std::string JsonField(const std::string& text, const std::string& key) {
+  const std::string needle = "\"" + key + "\":";
+  const auto at = text.find(needle);
+  if (at == std::string::npos) {
+    return {};
+  }
+  auto begin = at + needle.size();
+  if (begin < text.size() && text[begin] == '"') {
+    const auto end = text.find('"', begin + 1);
+    return end == std::string::npos ? std::string{} : text.substr(begin + 1, end - begin - 1);
+  }
+  const auto end = text.find_first_of(",}", begin);
+  return text.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+std::string TextOf(const SimPacket& packet) {
+  return std::string(packet.bytes.begin(), packet.bytes.end());
+}
+
+void PutFloat(float value, std::vector<std::uint8_t>* out) {
+  std::uint8_t bytes[4];
+  std::memcpy(bytes, &value, sizeof(bytes));
+  out->insert(out->end(), bytes, bytes + 4);
+}
+
+}  // namespace
+
+void VirtualClock::At(std::int64_t time_us, Task task) {
+  queue_.emplace(std::make_pair(std::max(time_us, now_us_), next_order_++), std::move(task));
+}
+
+void VirtualClock::Every(std::int64_t start_us, std::int64_t period_us, Task task) {
+  auto shared = std::make_shared<Task>(std::move(task));
+  auto tick = std::make_shared<std::function<void(std::int64_t)>>();
+  *tick = [this, shared, period_us, weak = std::weak_ptr<std::function<void(std::int64_t)>>(tick)](
+              std::int64_t due_us) {
+    (*shared)();
+    if (auto next = weak.lock()) {
+      At(due_us + period_us, [next, due_us, period_us] { (*next)(due_us + period_us); });
+    }
+  };
+  At(start_us, [tick, start_us] { (*tick)(start_us); });
+}
+
+void VirtualClock::RunUntil(std::int64_t time_us) {
+  while (!queue_.empty() && queue_.begin()->first.first <= time_us) {
+    auto node = queue_.extract(queue_.begin());
+    now_us_ = node.key().first;
+    node.mapped()();
+  }
+  now_us_ = std::max(now_us_, time_us);
+}
+
+std::uint64_t SimRandom::Next() {
+  state_ ^= state_ >> 12;
+  state_ ^= state_ << 25;
+  state_ ^= state_ >> 27;
+  return state_ * 0x2545F4914F6CDD1DULL;
+}
+
+double SimRandom::NextUnit() {
+  return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+SimLink::SimLink(VirtualClock* clock, LinkProfile profile, std::uint64_t seed)
+    : clock_(clock), profile_(profile), random_(seed) {}
+
+void SimLink::Send(std::vector<std::uint8_t> bytes) {
+  ++sent_;
+  // Draw both numbers for every packet so a link's schedule does not depend
+  // on whether it was up.
+  const double draw = random_.NextUnit();
+  const std::int64_t jitter =
+      profile_.jitter_us > 0
+          ? static_cast<std::int64_t>(random_.Next() % static_cast<std::uint64_t>(
+                                                           profile_.jitter_us + 1))
+          : 0;
+  if (!up_ || draw < profile_.loss_ratio) {
+    ++dropped_;
+    return;
+  }
+  const std::int64_t now = clock_->now_us();
+  std::int64_t deliver_at = now + profile_.latency_us + jitter;
+  if (profile_.ordered) {
+    deliver_at = std::max(deliver_at, last_delivery_us_);
+    last_delivery_us_ = deliver_at;
+  }
+  clock_->At(deliver_at, [this, packet = SimPacket{std::move(bytes), now}] {
+    if (receiver_) {
+      receiver_(packet);
+    }
+  });
+}
+
+std::vector<std::uint8_t> EncodeMavlink(const MavlinkMessage& message) {
+  const std::uint8_t header[kMavlinkHeaderSize] = {
+      kMavlinkV2Magic,
+      static_cast<std::uint8_t>(message.payload.size()),
+      0,  // incompat_flags
+      0,  // compat_flags
+      message.sequence,
+      message.system_id,
+      message.component_id,
+      static_cast<std::uint8_t>(message.message_id),
+      static_cast<std::uint8_t>(message.message_id >> 8),
+      static_cast<std::uint8_t>(message.message_id >> 16),
+  };
+  std::vector<std::uint8_t> frame;
+  frame.reserve(kMavlinkHeaderSize + message.payload.size() + 2);
+  frame.insert(frame.end(), header, header + kMavlinkHeaderSize);
+  frame.insert(frame.end(), message.payload.begin(), message.payload.end());
+  std::uint8_t extra = 0;
+  CrcExtraFor(message.message_id, &extra);
+  const std::uint16_t crc = FrameCrc(frame.data(), frame.size(), extra);
+  frame.push_back(static_cast<std::uint8_t>(crc));
+  frame.push_back(static_cast<std::uint8_t>(crc >> 8));
+  return frame;
+}
+
+bool DecodeMavlink(const std::vector<std::uint8_t>& bytes, MavlinkMessage* message) {
+  if (bytes.size() < kMavlinkHeaderSize + 2 || bytes[0] != kMavlinkV2Magic ||
+      bytes.size() != kMavlinkHeaderSize + bytes[1] + 2) {
+    return false;
+  }
+  const std::uint32_t message_id = bytes[7] | (bytes[8] << 8) | (bytes[9] << 16);
+  std::uint8_t extra = 0;
+  if (!CrcExtraFor(message_id, &extra)) {
+    return false;
+  }
+  const std::size_t crc_at = kMavlinkHeaderSize + bytes[1];
+  const std::uint16_t crc = FrameCrc(bytes.data(), crc_at, extra);
+  if (bytes[crc_at] != static_cast<std::uint8_t>(crc) ||
+      bytes[crc_at + 1] != static_cast<std::uint8_t>(crc >> 8)) {
+    return false;
+  }
+  message->sequence = bytes[4];
+  message->system_id = bytes[5];
+  message->component_id = bytes[6];
+  message->message_id = message_id;
+  message->payload.assign(bytes.begin() + kMavlinkHeaderSize, bytes.begin() + crc_at);
+  return true;
+}
+
+std::vector<std::uint8_t> HeartbeatPayload(std::uint32_t custom_mode) {
+  return {
+      static_cast<std::uint8_t>(custom_mode),
+      static_cast<std::uint8_t>(custom_mode >> 8),
+      static_cast<std::uint8_t>(custom_mode >> 16),
+      static_cast<std::uint8_t>(custom_mode >> 24),
+      2,     // MAV_TYPE_QUADROTOR
+      3,     // MAV_AUTOPILOT_ARDUPILOTMEGA
+      0x81,  // custom mode enabled, armed
+      4,     // MAV_STATE_ACTIVE
+      3,     // mavlink_version
+  };
+}
+
+std::vector<std::uint8_t> CommandLongPayload(std::uint16_t command) {
+  std::vector<std::uint8_t> payload;
+  for (int i = 0; i < 7; ++i) {
+    PutFloat(0.0f, &payload);
+  }
+  payload.push_back(static_cast<std::uint8_t>(command));
+  payload.push_back(static_cast<std::uint8_t>(command >> 8));
+  payload.push_back(1);  // target_system
+  payload.push_back(1);  // target_component
+  payload.push_back(0);  // confirmation
+  return payload;
+}
+
+std::uint32_t HeartbeatCustomMode(const MavlinkMessage& message) {
+  if (message.payload.size() < 4) {
+    return 0;
+  }
+  return message.payload[0] | (message.payload[1] << 8) | (message.payload[2] << 16) |
+         (static_cast<std::uint32_t>(message.payload[3]) << 24);
+}
+
+std::uint16_t CommandLongCommand(const MavlinkMessage& message) {
+  if (message.payload.size() < 30) {
+    return 0;
+  }
+  return static_cast<std::uint16_t>(message.payload[28] | (message.payload[29] << 8));
+}
+
+const char* CopterModeName(std::uint32_t custom_mode) {
+  switch (custom_mode) {
+    case kCopterModeAuto:
+      return "AUTO";
+    case kCopterModeGuided:
+      return "GUIDED";
+    case kCopterModeLoiter:
+      return "LOITER";
+    case kCopterModeRtl:
+      return "RTL";
+    default:
+      return "";
+  }
+}
+
+VehicleStandIn::VehicleStandIn(VirtualClock* clock, SimLink* downlink, SimLink* uplink,
+                               Config config)
+    : clock_(clock), downlink_(downlink), config_(config), mode_(config.initial_mode) {
+  uplink->SetReceiver([this](const SimPacket& packet) {
+    MavlinkMessage message;
+    if (!DecodeMavlink(packet.bytes, &message) || message.message_id != kMavlinkCommandLong ||
+        CommandLongCommand(message) != kMavCmdNavReturnToLaunch) {
+      return;
+    }
+    if (!rtl_command_time_us_) {
+      rtl_command_time_us_ = clock_->now_us();
+    }
+    clock_->After(config_.mode_switch_delay_us, [this] { mode_ = kCopterModeRtl; });
+  });
+}
+
+void VehicleStandIn::Start(std::int64_t at_us) {
+  const auto period = static_cast<std::int64_t>(std::llround(1e6 / config_.rate_hz));
+  clock_->Every(at_us, period, [this] {
+    downlink_->Send(EncodeMavlink({sequence_++, kMavlinkHeartbeat, HeartbeatPayload(mode_)}));
+  });
+}
+
+CompanionStandIn::CompanionStandIn(VirtualClock* clock, SimLink* command_in, SimLink* command_out,
+                                   SimLink* state_out, Config config)
+    : clock_(clock), command_out_(command_out), state_out_(state_out), config_(std::move(config)) {
+  command_in->SetReceiver([this](const SimPacket& packet) { OnRequest(packet); });
+}
+
+void CompanionStandIn::Start(std::int64_t at_us) {
+  clock_->Every(at_us, 1'000'000, [this] { PublishState(); });
+}
+
+void CompanionStandIn::OnRequest(const SimPacket& packet) {
+  ++requests_received_;
+  const std::string text = TextOf(packet);
+  const std::string correlation_id = JsonField(text, "correlation_id");
+  const std::string command = JsonField(text, "command");
+  const bool rejected = config_.rejected_commands.count(command) != 0;
+  clock_->After(config_.processing_delay_us, [this, correlation_id, rejected] {
+    command_out_->Send(std::string("{\"category\":\"station/commands/ack\",\"correlation_id\":\"") +
+                       correlation_id + "\",\"payload\":{\"status\":\"" +
+                       (rejected ? "REJECT" : "ACK") + "\"}}");
+  });
+  if (rejected) {
+    return;
+  }
+  if (command == "START_MISSION") {
+    clock_->After(config_.mission_start_delay_us,
+                  [this] { Transition("MISSION_RUNNING", "start requested"); });
+  } else if (command == "STOP_MISSION") {
+    clock_->After(config_.processing_delay_us,
+                  [this] { Transition("MISSION_ABORTED", "stop requested"); });
+  }
+}
+
+void CompanionStandIn::Transition(const std::string& state, const std::string& note) {
+  state_ = state;
+  note_ = note;
+  PublishState();
+}
+
+void CompanionStandIn::PublishState() {
+  state_out_->Send("{\"category\":\"mission/state\",\"payload\":{\"note\":\"" + note_ +
+                   "\",\"progress\":-1,\"state\":\"" + state_ + "\"}}");
+}
+
+StreamStandIn::StreamStandIn(VirtualClock* clock, SimLink* link, double fps)
+    : clock_(clock), link_(link), fps_(fps) {}
+
+bool StreamStandIn::Load(const std::filesystem::path& path, std::string* reason) {
+  std::ifstream input(path, std::ios::binary);
+  const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(input)),
+                                        std::istreambuf_iterator<char>());
+  const auto nals = comms::SplitAnnexB(comms::VideoCodec::kH264, bytes.data(), bytes.size());
+  units_.clear();
+  std::vector<std::uint8_t> unit;
+  bool unit_has_vcl = false;
+  for (const auto& nal : nals) {
+    // A new picture starts at any NAL following a VCL NAL (one slice per picture).
+    if (unit_has_vcl) {
+      units_.push_back(std::move(unit));
+      unit.clear();
+      unit_has_vcl = false;
+    }
+    unit.insert(unit.end(), {0, 0, 0, 1});
+    unit.insert(unit.end(), nal.data, nal.data + nal.size);
+    unit_has_vcl = unit_has_vcl || nal.vcl;
+  }
+  if (unit_has_vcl) {
+    units_.push_back(std::move(unit));
+  }
+  if (units_.empty()) {
+    if (reason != nullptr) {
+      *reason = "No H.264 access units in " + path.string();
+    }
+    return false;
+  }
+  return true;
+}
+
+void StreamStandIn::Start(std::int64_t at_us) {
+  const auto period = static_cast<std::int64_t>(std::llround(1e6 / fps_));
+  clock_->Every(at_us, period, [this] { link_->Send(units_[next_++ % units_.size()]); });
+}
+
+SimStation::SimStation(VirtualClock* clock, Links links, Config config)
+    : clock_(clock),
+      links_(links),
+      config_(std::move(config)),
+      panic_([this](const core::PanicConfirmationRecord& record) {
+        Record(std::string("panic ") + core::ToString(record.state));
+      }) {
+  health_.SetLossSink([this](const comms::LinkLossEvent& event) { OnLoss(event); });
+  modes_.Subscribe([this](const models::VehicleModeTransition& transition) {
+    Record("mode " + std::string(models::VehicleModeName(transition.current)));
+    panic_.OnVehicleModeTransition(transition);
+  });
+  mission_.SetCompletionListener([this](const std::string& correlation_id, std::int64_t time_us) {
+    if (lifecycle_.OnCompletionEvidence(correlation_id, time_us)) {
+      Record("completed " + correlation_id);
+    }
+  });
+  links_.mavlink_down->SetReceiver([this](const SimPacket& packet) { OnMavlink(packet); });
+  links_.command_in->SetReceiver([this](const SimPacket& packet) { OnCommandReply(packet); });
+  links_.companion_state->SetReceiver(
+      [this](const SimPacket& packet) { OnCompanionState(packet); });
+  if (links_.stream != nullptr) {
+    links_.stream->SetReceiver([this](const SimPacket& packet) { OnStream(packet); });
+  }
+}
+
+void SimStation::Start(std::int64_t at_us) {
+  clock_->Every(at_us, config_.health_period_us, [this] { Tick(); });
+}
+
+std::string SimStation::SendCommand(const std::string& command) {
+  const std::string correlation_id = "cmd-" + std::to_string(next_command_++);
+  const std::string request = "{\"category\":\"station/commands/request\",\"correlation_id\":\"" +
+                              correlation_id + "\",\"payload\":{\"command\":\"" + command +
+                              "\",\"params\":{},\"target\":\"companion_computer\"}}";
+  commands_[correlation_id] = {command, request, clock_->now_us()};
+  lifecycle_.Track(correlation_id, command, "companion_computer", clock_->now_us());
+  links_.command_out->Send(request);
+  Record("send " + correlation_id + " " + command);
+  return correlation_id;
+}
+
+bool SimStation::CancelCountdown() {
+  if (!countdown_deadline_us_) {
+    return false;
+  }
+  countdown_deadline_us_.reset();
+  Record("countdown cancelled");
+  return true;
+}
+
+void SimStation::Record(const std::string& what) {
+  trace_.push_back({clock_->now_us(), what});
+}
+
+std::optional<std::int64_t> SimStation::FirstEvent(const std::string& prefix) const {
+  for (const auto& event : trace_) {
+    if (event.what.compare(0, prefix.size(), prefix) == 0) {
+      return event.time_us;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string SimStation::TraceDigest() const {
+  std::ostringstream out;
+  for (const auto& event : trace_) {
+    out << event.time_us << ' ' << event.what << '\n';
+  }
+  return out.str();
+}
+
+void SimStation::OnMavlink(const SimPacket& packet) {
+  const std::int64_t now = clock_->now_us();
+  health_.OnPacket(comms::LinkChannel::kMavlinkUdp, now, packet.bytes.size());
+  MavlinkMessage message;
+  if (!DecodeMavlink(packet.bytes, &message)) {
+    return;
+  }
+  health_.OnMavlinkSequence(message.system_id, message.component_id, message.sequence);
+  telemetry_latency_.Record(static_cast<std::uint64_t>(now - packet.sent_time_us));
+  if (message.message_id != kMavlinkHeartbeat) {
+    return;
+  }
+  models::TelemetryFrame frame;
+  frame.telemetry_type = "vehicle";
+  frame.vehicle_mode = CopterModeName(HeartbeatCustomMode(message));
+  frame.vehicle_mode_id = models::InternVehicleMode(frame.vehicle_mode);
+  frame.receive_time_us = now;
+  vehicle_mode_ = frame.vehicle_mode_id;
+  modes_.Observe(frame);
+}
+
+void SimStation::OnCommandReply(const SimPacket& packet) {
+  const std::int64_t now = clock_->now_us();
+  health_.OnPacket(comms::LinkChannel::kCommandTcp, now, packet.bytes.size());
+  const std::string text = TextOf(packet);
+  const std::string correlation_id = JsonField(text, "correlation_id");
+  const auto sent = commands_.find(correlation_id);
+  if (sent == commands_.end()) {
+    return;
+  }
+  if (JsonField(text, "status") == "REJECT") {
+    if (lifecycle_.OnReject(correlation_id, now)) {
+      Record("reject " + correlation_id);
+    }
+    return;
+  }
+  if (!lifecycle_.OnAck(correlation_id, now)) {
+    return;
+  }
+  health_.OnRoundTrip(comms::LinkChannel::kCommandTcp, now - sent->second.sent_time_us);
+  Record("ack " + correlation_id);
+  mission_.ExpectCompletion(correlation_id, sent->second.command, sent->second.sent_time_us);
+}
+
+void SimStation::OnCompanionState(const SimPacket& packet) {
+  const std::int64_t now = clock_->now_us();
+  health_.OnPacket(comms::LinkChannel::kCompanionTcp, now, packet.bytes.size());
+  const std::string text = TextOf(packet);
+  models::MissionStateUpdate update;
+  update.state = JsonField(text, "state");
+  update.note = JsonField(text, "note");
+  update.receive_time_us = now;
+  if (mission_.OnMissionState(update)) {
+    Record("mission " + update.state);
+  }
+}
+
+void SimStation::OnStream(const SimPacket& packet) {
+  const std::int64_t now = clock_->now_us();
+  health_.OnPacket(comms::LinkChannel::kStream, now, packet.bytes.size());
+  stream_latency_.Record(static_cast<std::uint64_t>(now - packet.sent_time_us));
+  stream_bytes_ += packet.bytes.size();
+}
+
+void SimStation::OnLoss(const comms::LinkLossEvent& event) {
+  Record("loss " + event.code);
+  if ((event.code == "TELEMETRY_LOSS" || event.code == "CC_LINK_LOSS") &&
+      !countdown_deadline_us_) {
+    countdown_deadline_us_ = event.raised_time_us + config_.confirm_window_us;
+    Record("countdown start");
+  }
+}
+
+void SimStation::Tick() {
+  const std::int64_t now = clock_->now_us();
+  last_health_ = health_.Evaluate(now);
+  for (const auto& action : lifecycle_.Poll(now)) {
+    const auto& correlation_id = action.record.correlation_id;
+    switch (action.kind) {
+      case core::CommandLifecycleAction::Kind::kResend:
+        links_.command_out->Send(commands_[correlation_id].request);
+        Record("resend " + correlation_id);
+        break;
+      case core::CommandLifecycleAction::Kind::kAckTimeout:
+        mission_.CancelCompletion(correlation_id);
+        Record("ack_timeout " + correlation_id);
+        break;
+      case core::CommandLifecycleAction::Kind::kExecTimeout:
+        mission_.CancelCompletion(correlation_id);
+        Record("exec_timeout " + correlation_id);
+        break;
+    }
+  }
+  panic_.Poll(now);
+  if (countdown_deadline_us_ && now >= *countdown_deadline_us_) {
+    countdown_deadline_us_.reset();
+    DispatchPanic();
+  }
+}
+
+void SimStation::DispatchPanic() {
+  // PANIC_RTL bypasses CommandLifecycle (PROTOCOL.md §7.5).
+  const std::string correlation_id = "panic-" + std::to_string(next_panic_++);
+  // Sent as a GCS: system id 255, MAV_COMP_ID_MISSIONPLANNER.
+  links_.mavlink_up->Send(EncodeMavlink(
+      {0, kMavlinkCommandLong, CommandLongPayload(kMavCmdNavReturnToLaunch), 255, 190}));
+  panic_.Arm(config_.profile_id, correlation_id, clock_->now_us(), vehicle_mode_);
+  Record("panic_rtl " + correlation_id);
+}
+
+}  // namespace ulak::sim
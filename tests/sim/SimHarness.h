@@ -0,0 +1,295 @@
+#pragma once
+
+#include "CommandLifecycle.h"
+#include "HdrHistogram.h"
+#include "LinkHealthMonitor.h"
+#include "MissionStateTracker.h"
+#include "PanicConfirmationWatcher.h"
+#include "VehicleModeMonitor.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Deterministic stand-ins for the vehicle, the companion computer and the
+// camera stream, plus the station core wired the way the app wires it. All of
+// it runs on one virtual clock: a scenario covering minutes of flight runs in
+// milliseconds and produces the same trace on every run.
+namespace ulak::sim {
+
+// Discrete-event clock. Events at the same time run in scheduling order.
+class VirtualClock {
+ public:
+  using Task = std::function<void()>;
+
+  std::int64_t now_us() const { return now_us_; }
+
+  void At(std::int64_t time_us, Task task);
+  void After(std::int64_t delay_us, Task task) { At(now_us_ + delay_us, std::move(task)); }
+  // Runs `task` at start_us, start_us + period_us, ... for the clock's lifetime.
+  void Every(std::int64_t start_us, std::int64_t period_us, Task task);
+
+  // Runs every event due at or before `time_us`, then sets now to `time_us`.
+  void RunUntil(std::int64_t time_us);
+
+ private:
+  std::int64_t now_us_{0};
+  std::uint64_t next_order_{0};
+  std::map<std::pair<std::int64_t, std::uint64_t>, Task> queue_;
+};
+
+// xorshift64*: the only randomness in a scenario, seeded per link.
+class SimRandom {
+ public:
+  explicit SimRandom(std::uint64_t seed) : state_(seed == 0 ? 0x9E3779B97F4A7C15ULL : seed) {}
+  std::uint64_t Next();
+  // Uniform in [0, 1).
+  double NextUnit();
+
+ private:
+  std::uint64_t state_;
+};
+
+struct LinkProfile {
+  std::int64_t latency_us{1'000};
+  // Uniform extra delay in [0, jitter_us].
+  std::int64_t jitter_us{0};
+  double loss_ratio{0.0};
+  // TCP-like: delivery never reorders. Loss still applies (use 0 for TCP).
+  bool ordered{false};
+};
+
+struct SimPacket {
+  std::vector<std::uint8_t> bytes;
+  std::int64_t sent_time_us{0};
+};
+
+// One direction of a loopback link.
+class SimLink {
+ public:
+  using Receiver = std::function<void(const SimPacket&)>;
+
+  SimLink(VirtualClock* clock, LinkProfile profile, std::uint64_t seed);
+
+  void SetReceiver(Receiver receiver) { receiver_ = std::move(receiver); }
+  // A link that is down drops everything (cable cut, companion reboot).
+  void set_up(bool up) { up_ = up; }
+  bool up() const { return up_; }
+
+  void Send(std::vector<std::uint8_t> bytes);
+  void Send(const std::string& text) { Send(std::vector<std::uint8_t>(text.begin(), text.end())); }
+
+  std::uint64_t sent() const { return sent_; }
+  std::uint64_t dropped() const { return dropped_; }
+
+ private:
+  VirtualClock* clock_;
+  LinkProfile profile_;
+  SimRandom random_;
+  Receiver receiver_;
+  bool up_{true};
+  std::int64_t last_delivery_us_{0};
+  std::uint64_t sent_{0};
+  std::uint64_t dropped_{0};
+};
+
+// Minimal MAVLink v2 framing: enough for HEARTBEAT and COMMAND_LONG.
+inline constexpr std::uint32_t kMavlinkHeartbeat = 0;
+inline constexpr std::uint32_t kMavlinkCommandLong = 76;
+inline constexpr std::uint16_t kMavCmdNavReturnToLaunch = 20;
+// ArduCopter custom_mode numbers.
+inline constexpr std::uint32_t kCopterModeAuto = 3;
+inline constexpr std::uint32_t kCopterModeGuided = 4;
+inline constexpr std::uint32_t kCopterModeLoiter = 5;
+inline constexpr std::uint32_t kCopterModeRtl = 6;
+
+struct MavlinkMessage {
+  std::uint8_t sequence{0};
+  std::uint32_t message_id{0};
+  std::vector<std::uint8_t> payload;
+  // Vehicle autopilot by default.
+  std::uint8_t system_id{1};
+  std::uint8_t component_id{1};
+};
+
+std::vector<std::uint8_t> EncodeMavlink(const MavlinkMessage& message);
+// Returns false on bad framing or checksum.
+bool DecodeMavlink(const std::vector<std::uint8_t>& bytes, MavlinkMessage* message);
+std::vector<std::uint8_t> HeartbeatPayload(std::uint32_t custom_mode);
+std::vector<std::uint8_t> CommandLongPayload(std::uint16_t command);
+// Field readers; 0 when the payload is too short.
+std::uint32_t HeartbeatCustomMode(const MavlinkMessage& message);
+std::uint16_t CommandLongCommand(const MavlinkMessage& message);
+const char* CopterModeName(std::uint32_t custom_mode);
+
+// Flight controller: HEARTBEATs on the downlink at `rate_hz`; switches to RTL
+// `mode_switch_delay_us` after a MAV_CMD_NAV_RETURN_TO_LAUNCH on the uplink.
+class VehicleStandIn {
+ public:
+  struct Config {
+    double rate_hz{10.0};
+    std::uint32_t initial_mode{kCopterModeAuto};
+    std::int64_t mode_switch_delay_us{200'000};
+  };
+
+  VehicleStandIn(VirtualClock* clock, SimLink* downlink, SimLink* uplink, Config config);
+
+  void Start(std::int64_t at_us);
+  std::uint32_t mode() const { return mode_; }
+  std::optional<std::int64_t> rtl_command_time_us() const { return rtl_command_time_us_; }
+
+ private:
+  VirtualClock* clock_;
+  SimLink* downlink_;
+  Config config_;
+  std::uint32_t mode_;
+  std::uint8_t sequence_{0};
+  std::optional<std::int64_t> rtl_command_time_us_;
+};
+
+// Companion computer: answers `station/commands/request` with ACK/REJECT
+// after `processing_delay_us`, drives its mission FSM and publishes
+// `mission/state` once per second and on every transition.
+class CompanionStandIn {
+ public:
+  struct Config {
+    std::int64_t processing_delay_us{5'000};
+    std::int64_t mission_start_delay_us{500'000};
+    std::set<std::string> rejected_commands;
+  };
+
+  CompanionStandIn(VirtualClock* clock, SimLink* command_in, SimLink* command_out,
+                   SimLink* state_out, Config config);
+
+  void Start(std::int64_t at_us);
+  const std::string& state() const { return state_; }
+  std::size_t requests_received() const { return requests_received_; }
+
+ private:
+  void OnRequest(const SimPacket& packet);
+  void Transition(const std::string& state, const std::string& note);
+  void PublishState();
+
+  VirtualClock* clock_;
+  SimLink* command_out_;
+  SimLink* state_out_;
+  Config config_;
+  std::string state_{"MISSION_IDLE"};
+  std::string note_;
+  std::size_t requests_received_{0};
+};
+
+// Replays an H.264 Annex B file as access units at `fps`, looping.
+class StreamStandIn {
+ public:
+  StreamStandIn(VirtualClock* clock, SimLink* link, double fps);
+
+  bool Load(const std::filesystem::path& path, std::string* reason);
+  void Start(std::int64_t at_us);
+  std::size_t access_units() const { return units_.size(); }
+
+ private:
+  VirtualClock* clock_;
+  SimLink* link_;
+  double fps_;
+  std::vector<std::vector<std::uint8_t>> units_;
+  std::size_t next_{0};
+};
+
+struct TraceEvent {
+  std::int64_t time_us{0};
+  std::string what;
+};
+
+// The station core under test. The transport layer is replaced by SimLinks;
+// everything behind it is the production code. Failsafe mapping follows
+// docs/spec/exception-handling.md §5.2: TELEMETRY_LOSS and CC_LINK_LOSS are
+// ERROR events with a confirmation countdown whose fallback is PANIC_RTL.
+class SimStation {
+ public:
+  struct Config {
+    std::int64_t health_period_us{100'000};
+    std::int64_t confirm_window_us{5'000'000};
+    std::string profile_id{"default"};
+  };
+
+  struct Links {
+    SimLink* mavlink_down{nullptr};
+    SimLink* mavlink_up{nullptr};
+    SimLink* command_out{nullptr};
+    SimLink* command_in{nullptr};
+    SimLink* companion_state{nullptr};
+    SimLink* stream{nullptr};
+  };
+
+  SimStation(VirtualClock* clock, Links links, Config config);
+
+  void Start(std::int64_t at_us);
+
+  // Sends a command through CommandLifecycle; returns its correlation id.
+  std::string SendCommand(const std::string& command);
+  // Operator cancels a running countdown (exception-handling §5.2).
+  bool CancelCountdown();
+
+  const std::vector<TraceEvent>& trace() const { return trace_; }
+  // Time of the first trace event starting with `prefix`.
+  std::optional<std::int64_t> FirstEvent(const std::string& prefix) const;
+  std::string TraceDigest() const;
+
+  comms::LinkHealthMonitor& health() { return health_; }
+  core::CommandLifecycle& lifecycle() { return lifecycle_; }
+  core::MissionStateTracker& mission() { return mission_; }
+  core::PanicConfirmationWatcher& panic() { return panic_; }
+  const std::array<comms::LinkHealthFrame, comms::kLinkChannelCount>& last_health() const {
+    return last_health_;
+  }
+  // Send-to-receive latency per channel.
+  const utils::HdrHistogram& telemetry_latency() const { return telemetry_latency_; }
+  const utils::HdrHistogram& stream_latency() const { return stream_latency_; }
+  std::uint64_t stream_bytes() const { return stream_bytes_; }
+
+ private:
+  void Record(const std::string& what);
+  void OnMavlink(const SimPacket& packet);
+  void OnCommandReply(const SimPacket& packet);
+  void OnCompanionState(const SimPacket& packet);
+  void OnStream(const SimPacket& packet);
+  void OnLoss(const comms::LinkLossEvent& event);
+  void Tick();
+  void DispatchPanic();
+
+  VirtualClock* clock_;
+  Links links_;
+  Config config_;
+
+  comms::LinkHealthMonitor health_;
+  comms::VehicleModeMonitor modes_;
+  core::CommandLifecycle lifecycle_;
+  core::MissionStateTracker mission_;
+  core::PanicConfirmationWatcher panic_;
+
+  std::vector<TraceEvent> trace_;
+  std::array<comms::LinkHealthFrame, comms::kLinkChannelCount> last_health_{};
+  utils::HdrHistogram telemetry_latency_;
+  utils::HdrHistogram stream_latency_;
+  std::uint64_t stream_bytes_{0};
+  models::VehicleModeId vehicle_mode_{models::kVehicleModeUnknown};
+  struct SentCommand {
+    std::string command;
+    std::string request;
+    std::int64_t sent_time_us{0};
+  };
+  std::map<std::string, SentCommand> commands_;
+  std::uint64_t next_command_{1};
+  std::uint64_t next_panic_{1};
+  std::optional<std::int64_t> countdown_deadline_us_;
+};
+
+}  // namespace ulak::sim
@@ -0,0 +1,249 @@
+#include "SimHarness.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+constexpr std::int64_t kSecond = 1'000'000;
+
+struct WorldConfig {
+  std::uint64_t seed{1};
+  double mavlink_loss{0.0};
+  double telemetry_rate_hz{10.0};
+  bool with_stream{false};
+};
+
+// Vehicle, companion and camera stand-ins wired to one station on one clock.
+struct World {
+  explicit World(const WorldConfig& config, const std::filesystem::path& stream_file = {})
+      : mavlink_down(&clock, {5'000, 2'000, config.mavlink_loss, false}, config.seed),
+        mavlink_up(&clock, {5'000, 0, 0.0, false}, config.seed + 1),
+        command_out(&clock, {10'000, 0, 0.0, true}, config.seed + 2),
+        command_in(&clock, {10'000, 0, 0.0, true}, config.seed + 3),
+        companion_state(&clock, {10'000, 0, 0.0, true}, config.seed + 4),
+        stream(&clock, {15'000, 5'000, 0.0, true}, config.seed + 5),
+        vehicle(&clock, &mavlink_down, &mavlink_up, {config.telemetry_rate_hz, 3, 200'000}),
+        companion(&clock, &command_out, &command_in, &companion_state, CompanionConfig()),
+        streamer(&clock, &stream, 30.0),
+        station(&clock,
+                {&mavlink_down, &mavlink_up, &command_out, &command_in, &companion_state,
+                 config.with_stream ? &stream : nullptr},
+                ulak::sim::SimStation::Config{}) {
+    vehicle.Start(0);
+    companion.Start(0);
+    station.Start(0);
+    if (config.with_stream && streamer.Load(stream_file, nullptr)) {
+      streamer.Start(0);
+    }
+  }
+
+  static ulak::sim::CompanionStandIn::Config CompanionConfig() {
+    ulak::sim::CompanionStandIn::Config config;
+    config.rejected_commands = {"SET_PARAM"};
+    return config;
+  }
+
+  // Takes the companion off the network (both TCP channels).
+  void SetCompanionUp(bool up) {
+    command_out.set_up(up);
+    command_in.set_up(up);
+    companion_state.set_up(up);
+  }
+
+  ulak::sim::VirtualClock clock;
+  ulak::sim::SimLink mavlink_down;
+  ulak::sim::SimLink mavlink_up;
+  ulak::sim::SimLink command_out;
+  ulak::sim::SimLink command_in;
+  ulak::sim::SimLink companion_state;
+  ulak::sim::SimLink stream;
+  ulak::sim::VehicleStandIn vehicle;
+  ulak::sim::CompanionStandIn companion;
+  ulak::sim::StreamStandIn streamer;
+  ulak::sim::SimStation station;
+};
+
+// One IDR (with SPS/PPS) and 29 P pictures: a 1 s GOP at 30 fps.
+bool WriteStreamFile(const std::filesystem::path& path) {
+  std::vector<std::uint8_t> bytes;
+  const auto nal = [&bytes](std::uint8_t header, std::size_t size) {
+    bytes.insert(bytes.end(), {0, 0, 0, 1, header});
+    bytes.insert(bytes.end(), size, 0xAA);
+  };
+  nal(0x67, 12);
+  nal(0x68, 4);
+  nal(0x65, 6000);
+  for (int i = 0; i < 29; ++i) {
+    nal(0x41, 1200);
+  }
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  output.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+  return static_cast<bool>(output);
+}
+
+bool TestThroughputAndLatency(const std::filesystem::path& stream_file) {
+  WorldConfig config;
+  config.mavlink_loss = 0.02;
+  config.telemetry_rate_hz = 50.0;
+  config.with_stream = true;
+  World world(config, stream_file);
+  world.clock.RunUntil(60 * kSecond);
+
+  const auto& mavlink = world.station.last_health()[0];
+  const double loss = static_cast<double>(mavlink.total_lost) /
+                      static_cast<double>(mavlink.total_packets + mavlink.total_lost);
+  const double stream_bps = static_cast<double>(world.station.stream_bytes()) * 8.0 / 60.0;
+  // One GOP per second: payloads plus a start code and header byte per NAL.
+  const double expected_bps = (12 + 4 + 6000 + 29 * 1200 + 32 * 5.0) * 8.0;
+  return Expect(mavlink.total_packets + mavlink.total_lost >= 2990,
+                "Expected 50 Hz telemetry for a minute") &&
+         Expect(loss > 0.01 && loss < 0.03, "Expected measured loss near the configured 2%") &&
+         Expect(world.station.telemetry_latency().max() <= 7'000,
+                "Expected telemetry latency within latency + jitter") &&
+         Expect(world.station.stream_latency().ValueAtPercentile(99.0) <= 20'500 &&
+                    world.station.stream_latency().min() >= 15'000,
+                "Expected stream latency p99 within latency + jitter") &&
+         Expect(stream_bps > expected_bps * 0.97 && stream_bps < expected_bps * 1.03,
+                "Expected stream throughput of the file's bitrate") &&
+         Expect(!world.station.FirstEvent("loss"), "Expected no link loss on a healthy link");
+}
+
+bool TestCommandRoundTripAndCompletion() {
+  World world(WorldConfig{});
+  world.clock.RunUntil(1 * kSecond);
+  const auto start = world.station.SendCommand("START_MISSION");
+  const auto rejected = world.station.SendCommand("SET_PARAM");
+  world.clock.RunUntil(3 * kSecond);
+  const auto stop = world.station.SendCommand("STOP_MISSION");
+  world.clock.RunUntil(30 * kSecond);
+
+  // 10 ms each way plus 5 ms companion processing.
+  const auto ack = world.station.FirstEvent("ack " + start);
+  const auto completed = world.station.FirstEvent("completed " + start);
+  return Expect(ack && *ack == 1 * kSecond + 25'000, "Expected 25 ms command round trip") &&
+         Expect(world.station.FirstEvent("reject " + rejected).has_value(),
+                "Expected REJECT for a rejected command") &&
+         Expect(completed && *completed == 1 * kSecond + 520'000,
+                "Expected completion when MISSION_RUNNING arrives") &&
+         Expect(world.station.FirstEvent("completed " + stop).has_value(),
+                "Expected STOP_MISSION completed by MISSION_ABORTED") &&
+         Expect(!world.station.FirstEvent("exec_timeout") && !world.station.FirstEvent("resend") &&
+                    world.station.lifecycle().in_flight() == 0,
+                "Expected no timeouts or retries on a healthy link");
+}
+
+bool TestCompanionLinkLossFailover() {
+  World world(WorldConfig{});
+  world.clock.RunUntil(10 * kSecond + 500'000);
+  world.SetCompanionUp(false);
+  world.clock.RunUntil(12 * kSecond);
+  const auto orphan = world.station.SendCommand("START_MISSION");
+  world.clock.RunUntil(40 * kSecond);
+
+  // Last mission/state left at 10.0 s and arrived at 10.01 s.
+  const auto loss = world.station.FirstEvent("loss CC_LINK_LOSS");
+  const auto panic = world.station.FirstEvent("panic_rtl");
+  const auto confirmed = world.station.FirstEvent("panic CONFIRMED");
+  return Expect(loss && *loss - (10 * kSecond + 10'000) > 3 * kSecond &&
+                    *loss - (10 * kSecond + 10'000) <= 3 * kSecond + 100'000,
+                "Expected CC_LINK_LOSS within loss timeout + one health period") &&
+         Expect(panic && *panic - *loss == 5 * kSecond,
+                "Expected PANIC_RTL exactly when the 5 s countdown expires") &&
+         Expect(confirmed && *confirmed - *panic < 500'000,
+                "Expected RTL confirmed from telemetry within 500 ms") &&
+         Expect(world.station.FirstEvent("resend " + orphan).has_value() &&
+                    world.station.FirstEvent("ack_timeout " + orphan).has_value(),
+                "Expected retries then ACK_TIMEOUT while the companion is gone");
+}
+
+bool TestTelemetryLossFailover() {
+  World world(WorldConfig{});
+  world.clock.RunUntil(10 * kSecond);
+  world.mavlink_down.set_up(false);
+  world.clock.RunUntil(19 * kSecond);
+  world.mavlink_down.set_up(true);
+  world.clock.RunUntil(30 * kSecond);
+
+  const auto loss = world.station.FirstEvent("loss TELEMETRY_LOSS");
+  const auto panic = world.station.FirstEvent("panic_rtl");
+  const auto confirmed = world.station.FirstEvent("panic CONFIRMED");
+  const auto rtl_sent = world.vehicle.rtl_command_time_us();
+  return Expect(loss && *loss > 12 * kSecond && *loss <= 12 * kSecond + 100'000,
+                "Expected TELEMETRY_LOSS 2 s after the last heartbeat") &&
+         Expect(panic && *panic - *loss == 5 * kSecond, "Expected PANIC_RTL after the countdown") &&
+         Expect(rtl_sent && *rtl_sent == *panic + 5'000,
+                "Expected the uplink to carry the RTL command") &&
+         Expect(confirmed && *confirmed > 19 * kSecond && *confirmed < 19 * kSecond + 200'000,
+                "Expected confirmation on the first heartbeat after the link returns");
+}
+
+bool TestOperatorCancelStopsCountdown() {
+  World world(WorldConfig{});
+  world.clock.RunUntil(10 * kSecond);
+  world.mavlink_down.set_up(false);
+  world.clock.RunUntil(13 * kSecond);
+  const bool cancelled = world.station.CancelCountdown();
+  world.clock.RunUntil(30 * kSecond);
+  return Expect(cancelled, "Expected a running countdown to cancel") &&
+         Expect(!world.station.FirstEvent("panic_rtl") && !world.vehicle.rtl_command_time_us(),
+                "Expected no PANIC_RTL after the operator cancels");
+}
+
+std::string LossyFailoverTrace(std::uint64_t seed) {
+  WorldConfig config;
+  config.seed = seed;
+  config.mavlink_loss = 0.05;
+  World world(config);
+  world.clock.RunUntil(5 * kSecond);
+  world.station.SendCommand("START_MISSION");
+  world.clock.RunUntil(10 * kSecond);
+  world.mavlink_down.set_up(false);
+  world.clock.RunUntil(30 * kSecond);
+  return world.station.TraceDigest() + std::to_string(world.station.last_health()[0].total_lost);
+}
+
+bool TestScenariosAreDeterministic() {
+  const auto first = LossyFailoverTrace(7);
+  return Expect(first == LossyFailoverTrace(7), "Expected identical traces for the same seed") &&
+         Expect(first != LossyFailoverTrace(8), "Expected the seed to drive link loss");
+}
+
+}  // namespace
+
+int main() {
+  const auto directory =
+      std::filesystem::temp_directory_path() /
+      ("ulak_sim_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+  std::filesystem::create_directories(directory);
+  const auto stream_file = directory / "gop.h264";
+  const bool ok = Expect(WriteStreamFile(stream_file), "Expected stream file write") &&
+                  TestThroughputAndLatency(stream_file) &&
+                  TestCommandRoundTripAndCompletion() &&
+                  TestCompanionLinkLossFailover() &&
+                  TestTelemetryLossFailover() &&
+                  TestOperatorCancelStopsCountdown() &&
+                  TestScenariosAreDeterministic();
+  std::filesystem::remove_all(directory);
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Simulation scenario tests passed.\n";
+  return 0;
+}
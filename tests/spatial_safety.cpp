@@ -0,0 +1,291 @@
+#include "SpatialSafetyMonitor.h"
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::core::GeofenceKind;
+using ulak::core::GeofenceZone;
+using ulak::core::SpatialSafetyEvent;
+using ulak::core::SpatialSafetyMonitor;
+using ulak::models::TelemetryFrame;
+
+TelemetryFrame Frame(double x, double y, double z, std::int64_t time_us,
+                     const std::string& frame_id = "LOCAL_ENU") {
+  TelemetryFrame frame;
+  frame.frame_id = frame_id;
+  frame.position_m.x = x;
+  frame.position_m.y = y;
+  frame.position_m.z = z;
+  frame.receive_time_us = time_us;
+  return frame;
+}
+
+GeofenceZone Square(std::uint32_t id, GeofenceKind kind, double min, double max) {
+  GeofenceZone zone;
+  zone.id = id;
+  zone.name = "zone-" + std::to_string(id);
+  zone.kind = kind;
+  zone.polygon = {{min, min}, {max, min}, {max, max}, {min, max}};
+  return zone;
+}
+
+bool TestSeparationRaisesOnceAndRearms() {
+  SpatialSafetyMonitor monitor;
+  monitor.Update(1, Frame(0.0, 0.0, 10.0, 1'000));
+  const auto raised = monitor.Update(2, Frame(10.0, 0.0, 10.0, 2'000));
+  const auto repeated = monitor.Update(2, Frame(8.0, 0.0, 10.0, 3'000));
+  // Between warn (15 m) and clear (20 m): still the same violation.
+  const auto in_band = monitor.Update(2, Frame(17.0, 0.0, 10.0, 4'000));
+  const auto back_in = monitor.Update(2, Frame(12.0, 0.0, 10.0, 5'000));
+  monitor.Update(2, Frame(25.0, 0.0, 10.0, 6'000));
+  const auto again = monitor.Update(1, Frame(12.0, 0.0, 10.0, 7'000));
+
+  return Expect(raised.size() == 1 && raised[0].code == ulak::core::kSeparationWarnCode,
+                "Expected SEPARATION_WARN when vehicles close in") &&
+         Expect(raised[0].vehicle == 2 && raised[0].other_vehicle == 1 &&
+                    raised[0].distance_m > 9.9 && raised[0].distance_m < 10.1,
+                "Expected the pair and distance in the event") &&
+         Expect(repeated.empty() && in_band.empty() && back_in.empty(),
+                "Expected one event until the pair is clear") &&
+         Expect(again.size() == 1 && again[0].vehicle == 1 && again[0].other_vehicle == 2,
+                "Expected a new event after the pair cleared");
+}
+
+bool TestSeparationUsesAltitude() {
+  SpatialSafetyMonitor monitor;
+  monitor.Update(1, Frame(0.0, 0.0, 10.0, 1'000));
+  const auto stacked = monitor.Update(2, Frame(0.0, 0.0, 40.0, 2'000));
+  // NED: z = -12 is 12 m up, 2 m from vehicle 1.
+  const auto ned = monitor.Update(3, Frame(0.0, 0.0, -12.0, 3'000, "LOCAL_NED"));
+
+  return Expect(stacked.empty(), "Expected vertical separation to count") &&
+         Expect(ned.size() == 1 && ned[0].other_vehicle == 1,
+                "Expected NED z to be read as depth");
+}
+
+bool TestStaleVehiclesAreIgnored() {
+  SpatialSafetyMonitor monitor;
+  monitor.Update(1, Frame(0.0, 0.0, 10.0, 1'000));
+  const auto events = monitor.Update(2, Frame(5.0, 0.0, 10.0, 5'000'000));
+  return Expect(events.empty(), "Expected no alert against a vehicle that went silent");
+}
+
+bool TestDistantVehiclesAreNotCompared() {
+  SpatialSafetyMonitor monitor;
+  constexpr int kVehicles = 100;
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < kVehicles; ++i) {
+      monitor.Update(static_cast<std::uint32_t>(i),
+                     Frame(i * 100.0, (i % 10) * 100.0, 20.0, 1'000 + round * 20'000 + i));
+    }
+  }
+  return Expect(monitor.vehicle_count() == kVehicles, "Expected every vehicle to be tracked") &&
+         Expect(monitor.pair_checks() == 0, "Expected spread-out vehicles to skip distance checks");
+}
+
+bool TestKeepOutBreachIsDebounced() {
+  ulak::core::SpatialSafetyPolicy policy;
+  policy.geofence_rearm_us = 1'000'000;
+  SpatialSafetyMonitor monitor;
+  std::string reason;
+  monitor.SetPolicy(policy, &reason);
+  GeofenceZone tower = Square(7, GeofenceKind::kKeepOut, 100.0, 120.0);
+  tower.ceiling_m = 50.0;
+  const bool loaded = monitor.SetZones({tower}, &reason);
+
+  const auto outside = monitor.Update(1, Frame(90.0, 110.0, 20.0, 100'000));
+  const auto above = monitor.Update(1, Frame(110.0, 110.0, 60.0, 200'000));
+  const auto entered = monitor.Update(1, Frame(110.0, 110.0, 20.0, 300'000));
+  const auto inside = monitor.Update(1, Frame(112.0, 110.0, 20.0, 400'000));
+  // Edge jitter: out and back in before re-arming.
+  monitor.Update(1, Frame(99.0, 110.0, 20.0, 500'000));
+  const auto jitter = monitor.Update(1, Frame(101.0, 110.0, 20.0, 600'000));
+  monitor.Update(1, Frame(90.0, 110.0, 20.0, 700'000));
+  monitor.Update(1, Frame(90.0, 110.0, 20.0, 1'800'000));
+  const auto reentered = monitor.Update(1, Frame(110.0, 110.0, 20.0, 1'900'000));
+
+  return Expect(loaded, "Expected the zone to load: " + reason) &&
+         Expect(outside.empty() && above.empty(), "Expected no breach outside the zone volume") &&
+         Expect(entered.size() == 1 && entered[0].code == ulak::core::kGeofenceBreachCode &&
+                    entered[0].zone_id == 7 && entered[0].message.find("zone-7") != std::string::npos,
+                "Expected GEOFENCE_BREACH on entry") &&
+         Expect(inside.empty() && jitter.empty(), "Expected one event per violation") &&
+         Expect(reentered.size() == 1, "Expected a new breach after re-arming");
+}
+
+bool TestKeepInBreach() {
+  SpatialSafetyMonitor monitor;
+  std::string reason;
+  GeofenceZone area = Square(1, GeofenceKind::kKeepIn, -500.0, 500.0);
+  area.floor_m = 0.0;
+  area.ceiling_m = 120.0;
+  GeofenceZone large_keep_out = Square(2, GeofenceKind::kKeepOut, 1'000.0, 100'000.0);
+  monitor.SetZones({area, large_keep_out}, &reason);
+
+  const auto inside = monitor.Update(1, Frame(0.0, 0.0, 50.0, 1'000));
+  const auto too_high = monitor.Update(1, Frame(0.0, 0.0, 150.0, 2'000));
+  const auto outside = monitor.Update(2, Frame(600.0, 0.0, 50.0, 3'000));
+  const auto far_out = monitor.Update(3, Frame(5'000.0, 5'000.0, 50.0, 4'000));
+
+  return Expect(inside.empty(), "Expected no breach inside the flight area") &&
+         Expect(too_high.size() == 1 && too_high[0].zone_id == 1, "Expected the ceiling to count") &&
+         Expect(outside.size() == 1 && outside[0].zone_id == 1,
+                "Expected a breach when leaving the flight area") &&
+         Expect(far_out.size() == 2, "Expected large keep-out zones to be checked too");
+}
+
+bool TestZoneValidation() {
+  SpatialSafetyMonitor monitor;
+  std::string reason;
+  GeofenceZone line = Square(1, GeofenceKind::kKeepOut, 0.0, 10.0);
+  line.polygon.resize(2);
+  const bool short_polygon = !monitor.SetZones({line}, &reason);
+  const std::string short_reason = reason;
+  GeofenceZone band = Square(2, GeofenceKind::kKeepOut, 0.0, 10.0);
+  band.floor_m = 50.0;
+  band.ceiling_m = 10.0;
+  const bool empty_band = !monitor.SetZones({band}, &reason);
+  const bool duplicate = !monitor.SetZones(
+      {Square(3, GeofenceKind::kKeepOut, 0.0, 10.0), Square(3, GeofenceKind::kKeepOut, 20.0, 30.0)},
+      &reason);
+  const std::string duplicate_reason = reason;
+
+  return Expect(short_polygon && short_reason.find("3 vertices") != std::string::npos,
+                "Expected polygons with fewer than 3 vertices to be refused") &&
+         Expect(empty_band, "Expected an empty altitude band to be refused") &&
+         Expect(duplicate && duplicate_reason.find("duplicate") != std::string::npos,
+                "Expected duplicate zone ids to be refused");
+}
+
+bool TestPolicyValidation() {
+  const auto refused = [](double warn, double clear, double cell, const std::string& expected) {
+    ulak::core::SpatialSafetyPolicy policy;
+    policy.separation_warn_m = warn;
+    policy.separation_clear_m = clear;
+    policy.fence_cell_m = cell;
+    SpatialSafetyMonitor monitor;
+    std::string reason;
+    return !monitor.SetPolicy(policy, &reason) && reason.find(expected) != std::string::npos;
+  };
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+  return Expect(refused(15.0, 0.0, 50.0, "separation_clear_m"),
+                "Expected a zero clear distance refused") &&
+         Expect(refused(15.0, 10.0, 50.0, "separation_clear_m"),
+                "Expected a clear distance below the warn distance refused") &&
+         Expect(refused(15.0, inf, 50.0, "separation_clear_m"),
+                "Expected an infinite clear distance refused") &&
+         Expect(refused(nan, 20.0, 50.0, "separation_warn_m"),
+                "Expected a NaN warn distance refused") &&
+         Expect(refused(15.0, 20.0, 0.0, "fence_cell_m"), "Expected a zero fence cell refused") &&
+         Expect(refused(15.0, 20.0, nan, "fence_cell_m"), "Expected a NaN fence cell refused");
+}
+
+// A profile switch re-indexes vehicles and zones under the new cell sizes
+// without forgetting what was already raised.
+bool TestPolicyChangeKeepsState() {
+  SpatialSafetyMonitor monitor;
+  std::string reason;
+  monitor.SetZones({Square(3, GeofenceKind::kKeepOut, 100.0, 120.0)}, &reason);
+  monitor.Update(1, Frame(0.0, 0.0, 10.0, 1'000));
+  monitor.Update(2, Frame(10.0, 0.0, 10.0, 2'000));
+  monitor.Update(3, Frame(110.0, 110.0, 10.0, 3'000));
+
+  ulak::core::SpatialSafetyPolicy wider;
+  wider.separation_warn_m = 40.0;
+  wider.separation_clear_m = 60.0;
+  wider.fence_cell_m = 7.0;
+  const bool applied = monitor.SetPolicy(wider, &reason);
+  const auto same_pair = monitor.Update(2, Frame(30.0, 0.0, 10.0, 4'000));
+  const auto still_inside = monitor.Update(3, Frame(115.0, 115.0, 10.0, 5'000));
+  // 50 m from vehicle 1: only a warning under the new thresholds.
+  const auto newcomer = monitor.Update(4, Frame(-35.0, 0.0, 10.0, 6'000));
+  monitor.Update(5, Frame(500.0, 500.0, 10.0, 7'000));
+  bool breached = false;
+  for (const auto& event : monitor.Update(5, Frame(101.0, 119.0, 10.0, 8'000))) {
+    breached = breached || (event.code == ulak::core::kGeofenceBreachCode && event.zone_id == 3);
+  }
+
+  return Expect(applied, "Expected the policy to apply: " + reason) &&
+         Expect(same_pair.empty() && still_inside.empty(),
+                "Expected raised pairs and breaches to survive the switch") &&
+         Expect(newcomer.size() == 1 && newcomer[0].other_vehicle == 1,
+                "Expected the new warn distance through the re-built vehicle index") &&
+         Expect(breached, "Expected the zone found through the re-built fence index");
+}
+
+bool TestRemoveVehicleAndSink() {
+  SpatialSafetyMonitor monitor;
+  std::vector<SpatialSafetyEvent> delivered;
+  monitor.SetEventSink([&delivered](const SpatialSafetyEvent& event) { delivered.push_back(event); });
+  monitor.Update(1, Frame(0.0, 0.0, 10.0, 1'000));
+  monitor.Update(2, Frame(5.0, 0.0, 10.0, 2'000));
+  monitor.RemoveVehicle(1);
+  const auto after_remove = monitor.Update(2, Frame(6.0, 0.0, 10.0, 3'000));
+  // Vehicle 1 reconnects: a new pair, so a new event.
+  const auto rejoined = monitor.Update(1, Frame(0.0, 0.0, 10.0, 4'000));
+
+  return Expect(delivered.size() == 2, "Expected the sink to receive every event") &&
+         Expect(after_remove.empty() && monitor.vehicle_count() == 2,
+                "Expected removed vehicles to drop out of the index") &&
+         Expect(rejoined.size() == 1, "Expected a rejoining vehicle to be checked again");
+}
+
+bool TestNonFinitePositionsAreIgnored() {
+  constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+  constexpr double kInf = std::numeric_limits<double>::infinity();
+  SpatialSafetyMonitor monitor;
+  std::string reason;
+  monitor.SetZones({Square(1, GeofenceKind::kKeepOut, 0.0, 50.0)}, &reason);
+  const auto unknown = monitor.Update(1, Frame(kNaN, 0.0, 10.0, 1'000));
+  const bool skipped = unknown.empty() && monitor.vehicle_count() == 0;
+
+  monitor.Update(1, Frame(-100.0, -100.0, 10.0, 2'000));
+  const auto lost_fix = monitor.Update(1, Frame(0.0, kNaN, 10.0, 3'000));
+  const auto infinite = monitor.Update(1, Frame(kInf, 0.0, -kInf, 4'000));
+  // Finite but far outside the cell range: clamped, still checked.
+  const auto far = monitor.Update(2, Frame(1e300, -1e300, 10.0, 5'000));
+  const auto near = monitor.Update(3, Frame(-90.0, -100.0, 10.0, 6'000));
+
+  return Expect(skipped, "Expected a NaN position not to register the vehicle") &&
+         Expect(lost_fix.empty() && infinite.empty(), "Expected non-finite frames to be ignored") &&
+         Expect(far.empty() && monitor.vehicle_count() == 3,
+                "Expected huge coordinates to be indexed without events") &&
+         Expect(near.size() == 1 && near[0].other_vehicle == 1,
+                "Expected the last good position to stand after a NaN frame");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestSeparationRaisesOnceAndRearms() &&
+                  TestSeparationUsesAltitude() &&
+                  TestStaleVehiclesAreIgnored() &&
+                  TestDistantVehiclesAreNotCompared() &&
+                  TestKeepOutBreachIsDebounced() &&
+                  TestKeepInBreach() &&
+                  TestZoneValidation() &&
+                  TestPolicyValidation() &&
+                  TestPolicyChangeKeepsState() &&
+                  TestRemoveVehicleAndSink() &&
+                  TestNonFinitePositionsAreIgnored();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Spatial safety tests passed.\n";
+  return 0;
+}
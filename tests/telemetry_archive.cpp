@@ -0,0 +1,169 @@
+#include "ColumnCodec.h"
+#include "TelemetryArchive.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool RoundTrips(const std::vector<std::int64_t>& values) {
+  std::vector<std::uint8_t> encoded;
+  ulak::utils::EncodeDeltaColumn(values.data(), values.size(), &encoded);
+  std::vector<std::int64_t> decoded(values.size());
+  return ulak::utils::DecodeDeltaColumn(encoded.data(), encoded.size(), values.size(),
+                                        decoded.data()) &&
+         decoded == values;
+}
+
+bool TestColumnCodec() {
+  constexpr auto kMin = std::numeric_limits<std::int64_t>::min();
+  constexpr auto kMax = std::numeric_limits<std::int64_t>::max();
+  std::vector<std::int64_t> ramp;
+  std::vector<std::int64_t> noisy;
+  for (int i = 0; i < 1000; ++i) {
+    ramp.push_back(1'770'000'000'000'000 + i * 100'000);
+    noisy.push_back((i * 7919) % 613 - 300);
+  }
+  std::vector<std::uint8_t> ramp_bytes;
+  ulak::utils::EncodeDeltaColumn(ramp.data(), ramp.size(), &ramp_bytes);
+  std::vector<std::int64_t> out(ramp.size());
+
+  return Expect(ulak::utils::ZigZagDecode(ulak::utils::ZigZagEncode(kMin)) == kMin &&
+                    ulak::utils::ZigZagEncode(-1) == 1 && ulak::utils::ZigZagEncode(1) == 2,
+                "Expected zigzag mapping") &&
+         Expect(RoundTrips({}) && RoundTrips({42}) && RoundTrips(ramp) && RoundTrips(noisy),
+                "Expected columns to round-trip") &&
+         Expect(RoundTrips({kMin, kMax, kMin, 0, kMax, -1, kMin}),
+                "Expected 64-bit deltas to round-trip") &&
+         Expect(ramp_bytes.size() <= 9 + 8 * 4, "Expected fixed-rate timestamps to pack to 0 bits") &&
+         Expect(!ulak::utils::DecodeDeltaColumn(ramp_bytes.data(), ramp_bytes.size() - 1,
+                                                ramp.size(), out.data()),
+                "Expected truncated column to be rejected");
+}
+
+constexpr std::int64_t kStartUs = 1'770'000'000'000'000;
+constexpr std::int64_t kPeriodUs = 100'000;
+
+// Two-hour sortie at 10 Hz: 10 min AUTO climbing to 120 m, LOITER, a 30 s
+// telemetry gap, then RTL. Battery drains 0.5 %/min from 100 %.
+bool WriteFlight(const std::filesystem::path& path, std::size_t* raw_bytes) {
+  ulak::core::TelemetryArchiveWriter writer;
+  const int frames = 2 * 3600 * 10;
+  for (int i = 0; i < frames; ++i) {
+    if (i >= 3600 * 10 && i < 3600 * 10 + 300) {
+      continue;  // link loss
+    }
+    ulak::models::TelemetryFrame frame;
+    frame.frame_id = "ARDUPILOT_LOCAL_NED";
+    frame.receive_time_us = kStartUs + i * kPeriodUs;
+    const double minutes = static_cast<double>(i) / 600.0;
+    const double altitude = minutes < 10.0 ? 12.0 * minutes : 120.0 + 2.0 * std::sin(i * 0.01);
+    frame.position_m = {40.0 * std::cos(i * 0.001), 40.0 * std::sin(i * 0.001), -altitude};
+    frame.velocity_mps = {-0.04 * std::sin(i * 0.001), 0.04 * std::cos(i * 0.001), 0.0};
+    frame.attitude_deg = {1.5 * std::sin(i * 0.05), -2.0, std::fmod(i * 0.0573, 360.0)};
+    frame.vehicle_mode_id = i < 6000    ? ulak::models::kVehicleModeAuto
+                            : i < 60000 ? ulak::models::kVehicleModeLoiter
+                                        : ulak::models::kVehicleModeRtl;
+    frame.battery_percent = 100 - static_cast<int>(minutes * 0.5);
+    writer.Append(frame);
+  }
+  ulak::models::SafetyEvent loss;
+  loss.severity = ulak::models::SafetySeverity::kError;
+  loss.code = "TELEMETRY_LOSS";
+  loss.receive_time_us = kStartUs + 3600 * 10 * kPeriodUs;
+  writer.Append(loss);
+  loss.severity = ulak::models::SafetySeverity::kWarn;
+  loss.code = "VISION_LOST";
+  loss.receive_time_us += 600'000'000;
+  writer.Append(loss);
+
+  *raw_bytes = writer.frame_count() * sizeof(ulak::models::TelemetryFrame);
+  std::string reason;
+  return Expect(writer.Finish(path, &reason), "Expected archive write: " + reason);
+}
+
+bool TestFlightQueries(const std::filesystem::path& directory) {
+  const auto path = directory / "sortie.ulakcol";
+  std::size_t raw_bytes = 0;
+  if (!WriteFlight(path, &raw_bytes)) {
+    return false;
+  }
+
+  ulak::core::TelemetryArchive archive;
+  std::string reason;
+  if (!Expect(archive.Open(path, &reason), "Expected archive open: " + reason) ||
+      !Expect(archive.frame_count() == 71700 && archive.event_count() == 2,
+              "Expected row counts")) {
+    return false;
+  }
+  const auto altitude = archive.MaxAltitudeM();
+  const auto modes = archive.TimeInModes();
+  const auto drain = archive.BatteryDrainPercentPerMinute();
+  const auto events = archive.EventsBetween(kStartUs + 3599 * 1'000'000LL,
+                                            kStartUs + 3601 * 1'000'000LL);
+  const auto* time = archive.Column(ulak::core::TelemetryColumn::kTime);
+
+  const bool modes_ok =
+      modes.size() == 3 && modes[0].mode == "AUTO" && modes[0].duration_us == 600'000'000 &&
+      modes[1].mode == "LOITER" && modes[2].mode == "RTL" &&
+      modes[1].duration_us == (60000 - 6000 - 300) * kPeriodUs - kPeriodUs &&
+      modes[2].duration_us == (72000 - 60000 - 1) * kPeriodUs;
+  return Expect(altitude.has_value() && std::abs(*altitude - 122.0) < 0.002,
+                "Expected up-positive max altitude from NED z") &&
+         Expect(modes_ok, "Expected time per mode excluding the telemetry gap") &&
+         Expect(drain.has_value() && std::abs(*drain - 0.5) < 0.01,
+                "Expected battery drain of 0.5 %/min") &&
+         Expect(events.size() == 1 && events[0].code == "TELEMETRY_LOSS" &&
+                    events[0].severity == ulak::models::SafetySeverity::kError,
+                "Expected safety event lookup by time") &&
+         Expect(time != nullptr && time->back() == kStartUs + 71999 * kPeriodUs,
+                "Expected exact timestamps") &&
+         Expect(std::filesystem::file_size(path) * 10 < raw_bytes,
+                "Expected better than 10x compression over in-memory frames");
+}
+
+bool TestRejectsBadFiles(const std::filesystem::path& directory) {
+  ulak::core::TelemetryArchive archive;
+  std::string reason;
+  const auto path = directory / "sortie.ulakcol";
+  const bool missing = !archive.Open(directory / "absent.ulakcol", &reason);
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 64);
+  const bool opened = archive.Open(path, &reason);
+  return Expect(missing, "Expected missing archive error") &&
+         Expect(!opened || archive.Column(ulak::core::TelemetryColumn::kEventCode) == nullptr,
+                "Expected truncated archive to be rejected");
+}
+
+}  // namespace
+
+int main() {
+  const auto directory =
+      std::filesystem::temp_directory_path() /
+      ("ulak_archive_" +
+       std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+  std::filesystem::create_directories(directory);
+  const bool ok = TestColumnCodec() &&
+                  TestFlightQueries(directory) &&
+                  TestRejectsBadFiles(directory);
+  std::filesystem::remove_all(directory);
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Telemetry archive tests passed.\n";
+  return 0;
+}
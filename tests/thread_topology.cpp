@@ -0,0 +1,212 @@
+#include "ThreadTopology.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::utils::ExecutorSpec;
+using ulak::utils::SchedulingPolicy;
+using ulak::utils::ThreadTopology;
+using ulak::utils::ThreadTopologyConfig;
+using ulak::utils::TopologyApplyReport;
+
+// Runs `fn` on a fresh thread so scheduling changes do not leak into the test.
+template <typename Fn>
+void OnThread(Fn fn) {
+  std::thread thread(fn);
+  thread.join();
+}
+
+int FirstAllowedCpu() {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  sched_getaffinity(0, sizeof(allowed), &allowed);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      return cpu;
+    }
+  }
+  return 0;
+}
+
+bool Rejects(ThreadTopologyConfig config, const std::string& expected) {
+  std::string reason;
+  return !ulak::utils::ValidateThreadTopology(config, &reason) &&
+         reason.find(expected) != std::string::npos;
+}
+
+bool TestValidation() {
+  std::string reason;
+  const ThreadTopologyConfig defaults = ulak::utils::DefaultThreadTopology();
+  const bool valid = ulak::utils::ValidateThreadTopology(defaults, &reason);
+
+  ThreadTopologyConfig duplicate = defaults;
+  duplicate.executors.push_back(duplicate.executors[0]);
+  ThreadTopologyConfig priority = defaults;
+  priority.executors[0].fifo_priority = 0;
+  ThreadTopologyConfig nice = defaults;
+  nice.executors[2].nice = 20;
+  ThreadTopologyConfig cpu = defaults;
+  cpu.executors[0].cpus = {-1};
+  ThreadTopologyConfig unknown = defaults;
+  unknown.assignments.push_back({"video_magic", "bulk"});
+  ThreadTopologyConfig twice = defaults;
+  twice.assignments.push_back({"panic_dispatch", "bulk"});
+  ThreadTopologyConfig missing = defaults;
+  missing.assignments[0].second = "nowhere";
+
+  return Expect(valid, "Expected the default topology to validate: " + reason) &&
+         Expect(Rejects(duplicate, "duplicate executor 'safety'"), "Expected duplicates refused") &&
+         Expect(Rejects(priority, "fifo priority"), "Expected FIFO priority 0 refused") &&
+         Expect(Rejects(nice, "nice level"), "Expected nice 20 refused") &&
+         Expect(Rejects(cpu, "invalid CPU -1"), "Expected negative CPUs refused") &&
+         Expect(Rejects(unknown, "unknown subsystem 'video_magic'"),
+                "Expected unknown subsystems refused") &&
+         Expect(Rejects(twice, "assigned twice"), "Expected double assignments refused") &&
+         Expect(Rejects(missing, "missing executor 'nowhere'"),
+                "Expected assignments to missing executors refused");
+}
+
+bool TestPinningAndNice() {
+  const int cpu = FirstAllowedCpu();
+  ThreadTopologyConfig config;
+  config.executors.push_back({"bulk", {cpu}, SchedulingPolicy::kOther, 0, 7});
+  config.assignments.push_back({"stream_decode", "bulk"});
+  ThreadTopology topology;
+  std::string reason;
+  const bool configured = topology.Configure(config, &reason);
+
+  const auto main_tid = static_cast<id_t>(syscall(SYS_gettid));
+  const int main_before = getpriority(PRIO_PROCESS, main_tid);
+  TopologyApplyReport report;
+  TopologyApplyReport unassigned;
+  int cpus = 0;
+  bool on_cpu = false;
+  int niceness = 0;
+  OnThread([&] {
+    report = topology.EnterSubsystem("stream_decode");
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    cpus = CPU_COUNT(&set);
+    on_cpu = CPU_ISSET(cpu, &set);
+    niceness = getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)));
+    unassigned = topology.EnterSubsystem("ui_bridge");
+  });
+
+  return Expect(configured, "Expected the topology to configure: " + reason) &&
+         Expect(report.affinity_applied && cpus == 1 && on_cpu,
+                "Expected the thread pinned to the executor's CPU") &&
+         Expect(report.nice_applied && niceness == 7 && report.degraded.empty(),
+                "Expected the nice level on the thread only") &&
+         Expect(getpriority(PRIO_PROCESS, main_tid) == main_before,
+                "Expected other threads to be unaffected") &&
+         Expect(!unassigned.affinity_applied && !unassigned.nice_applied &&
+                    topology.ExecutorFor("ui_bridge") == nullptr,
+                "Expected unassigned subsystems to run unchanged");
+}
+
+// Decode threads are spawned from whatever thread starts the pipeline; a
+// pinned SCHED_FIFO parent must not leak its placement into `stream_decode`.
+bool TestResetsInheritedScheduling() {
+  cpu_set_t process;
+  CPU_ZERO(&process);
+  sched_getaffinity(0, sizeof(process), &process);
+  const int cpu = FirstAllowedCpu();
+
+  ThreadTopologyConfig config;
+  config.executors.push_back({"bulk", {}, SchedulingPolicy::kOther, 0, 5});
+  config.assignments.push_back({"stream_decode", "bulk"});
+  ThreadTopology topology;
+  std::string reason;
+  const bool configured = topology.Configure(config, &reason);
+
+  TopologyApplyReport parent;
+  TopologyApplyReport report;
+  int policy = -1;
+  int cpus = 0;
+  int niceness = 0;
+  OnThread([&] {
+    parent = ulak::utils::ApplyExecutorToCurrentThread(
+        {"safety", {cpu}, SchedulingPolicy::kFifo, 80, 0});
+    OnThread([&] {
+      report = topology.EnterSubsystem("stream_decode");
+      sched_param param{};
+      pthread_getschedparam(pthread_self(), &policy, &param);
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+      cpus = CPU_COUNT(&set);
+      niceness = getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)));
+    });
+  });
+
+  // Without CAP_SYS_NICE the parent stays SCHED_OTHER; the reset is still checked.
+  return Expect(configured, "Expected the topology to configure: " + reason) &&
+         Expect(parent.affinity_applied, "Expected the parent thread pinned") &&
+         Expect(policy == SCHED_OTHER,
+                std::string("Expected stream_decode on SCHED_OTHER under a ") +
+                    (parent.realtime_applied ? "SCHED_FIFO" : "SCHED_OTHER") + " parent") &&
+         Expect(report.affinity_applied && cpus == CPU_COUNT(&process),
+                "Expected the parent's pinning replaced by every allowed CPU") &&
+         Expect(report.nice_applied && niceness == 5 && report.degraded.empty(),
+                "Expected the executor's nice level");
+}
+
+bool TestDegradesWithoutResources() {
+  ExecutorSpec offline{"offline", {CPU_SETSIZE - 1}, SchedulingPolicy::kOther, 0, 0};
+  ExecutorSpec realtime{"safety", {}, SchedulingPolicy::kFifo, 80, 3};
+  TopologyApplyReport offline_report;
+  TopologyApplyReport realtime_report;
+  int policy = -1;
+  OnThread([&] { offline_report = ulak::utils::ApplyExecutorToCurrentThread(offline); });
+  OnThread([&] {
+    realtime_report = ulak::utils::ApplyExecutorToCurrentThread(realtime);
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &policy, &param);
+  });
+
+  // SCHED_FIFO needs CAP_SYS_NICE or RLIMIT_RTPRIO; either outcome is valid,
+  // but a refusal must fall back to the nice level and say so.
+  const bool realtime_ok =
+      realtime_report.realtime_applied
+          ? policy == SCHED_FIFO
+          : policy == SCHED_OTHER && realtime_report.nice_applied &&
+                realtime_report.degraded.size() == 1 &&
+                realtime_report.degraded[0].find("SCHED_FIFO refused") != std::string::npos;
+  return Expect(!offline_report.affinity_applied && offline_report.degraded.size() == 1 &&
+                    offline_report.degraded[0].find("none of its CPUs") != std::string::npos,
+                "Expected unavailable CPUs to leave the affinity unchanged") &&
+         Expect(realtime_ok, "Expected SCHED_FIFO or a reported nice fallback");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestValidation() &&
+                  TestPinningAndNice() &&
+                  TestResetsInheritedScheduling() &&
+                  TestDegradesWithoutResources();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Thread topology tests passed.\n";
+  return 0;
+}
@@ -0,0 +1,195 @@
+#include "Tracing.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if !defined(ULAK_ENABLE_TRACING)
+#error "tracing tests are built with ULAK_ENABLE_TRACING"
+#endif
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::utils::TraceStage;
+using ulak::utils::Tracer;
+
+const ulak::utils::TraceStageStats& StatsFor(const ulak::utils::TraceSnapshot& snapshot,
+                                              TraceStage stage) {
+  return snapshot.stages[static_cast<std::size_t>(stage)];
+}
+
+bool TestSpansLandInStageHistograms() {
+  auto& tracer = Tracer::Instance();
+  tracer.Reset();
+  // 1 ms of ticks, measured the same way the scope does.
+  const std::uint64_t start = tracer.Now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  const std::uint64_t end = tracer.Now();
+  const std::uint64_t span_ns = static_cast<std::uint64_t>(tracer.TicksToNs(end - start));
+  for (int i = 0; i < 100; ++i) {
+    tracer.Record(TraceStage::kClassify, start, end);
+  }
+  {
+    ULAK_TRACE_SCOPE(TraceStage::kPanicSend);
+  }
+  const auto snapshot = tracer.Snapshot();
+  const auto& classify = StatsFor(snapshot, TraceStage::kClassify);
+  return Expect(classify.count == 100, "Expected every classify span collected") &&
+         Expect(span_ns >= 1'000'000 && span_ns < 200'000'000, "Expected ticks converted to ns") &&
+         Expect(classify.p50_ns >= span_ns - span_ns / 64 && classify.p50_ns <= span_ns + span_ns / 64,
+                "Expected the histogram to keep the span length") &&
+         Expect(StatsFor(snapshot, TraceStage::kPanicSend).count == 1,
+                "Expected the scope macro to record one span") &&
+         Expect(StatsFor(snapshot, TraceStage::kRecv).count == 0, "Expected untouched stages empty");
+}
+
+bool TestThreadsRecordIndependently() {
+  auto& tracer = Tracer::Instance();
+  tracer.Reset();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&tracer] {
+      for (int i = 0; i < 1'000; ++i) {
+        ULAK_TRACE_SCOPE(TraceStage::kRecv);
+        if (i % 256 == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  // Collect concurrently with the writers.
+  for (int i = 0; i < 20; ++i) {
+    tracer.Collect();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const auto snapshot = tracer.Snapshot();
+  return Expect(StatsFor(snapshot, TraceStage::kRecv).count + snapshot.dropped >= 4'000,
+                "Expected every recv span either collected or counted as dropped") &&
+         Expect(StatsFor(snapshot, TraceStage::kRecv).count > 0, "Expected recv spans collected");
+}
+
+bool TestFullRingDropsInsteadOfBlocking() {
+  auto& tracer = Tracer::Instance();
+  tracer.Reset();
+  const auto before = tracer.Snapshot().dropped;
+  const std::uint64_t now = tracer.Now();
+  for (std::size_t i = 0; i < ulak::utils::TraceRing::kCapacity + 10; ++i) {
+    tracer.Record(TraceStage::kCountdown, now, now + 1);
+  }
+  const auto snapshot = tracer.Snapshot();
+  return Expect(snapshot.dropped - before == 10, "Expected the overflow counted as dropped") &&
+         Expect(StatsFor(snapshot, TraceStage::kCountdown).count == ulak::utils::TraceRing::kCapacity,
+                "Expected a full ring of countdown spans");
+}
+
+bool TestChromeTraceDump(const std::filesystem::path& directory) {
+  auto& tracer = Tracer::Instance();
+  tracer.Reset();
+  {
+    ULAK_TRACE_SCOPE(TraceStage::kGatewaySend);
+  }
+  const std::uint64_t now = tracer.Now();
+  tracer.Record(TraceStage::kDecode, now, now + 10);
+
+  const auto path = directory / "trace.json";
+  std::string reason;
+  if (!Expect(tracer.WriteChromeTrace(path, &reason), "Expected trace dump: " + reason)) {
+    return false;
+  }
+  std::ifstream input(path);
+  std::stringstream contents;
+  contents << input.rdbuf();
+  const std::string json = contents.str();
+  return Expect(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0,
+                "Expected a Chrome trace-event document") &&
+         Expect(json.find("\"name\":\"gateway_send\",\"cat\":\"ulak\",\"ph\":\"X\"") !=
+                    std::string::npos,
+                "Expected a complete event for the gateway span") &&
+         Expect(json.find("\"name\":\"decode\"") != std::string::npos, "Expected the decode span") &&
+         Expect(json.size() > 2 && json.compare(json.size() - 3, 3, "]}\n") == 0,
+                "Expected a closed document");
+}
+
+std::string ReadStats(const std::filesystem::path& socket_path) {
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  const std::string path = socket_path.string();
+  path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+  std::string body;
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+    char buffer[512];
+    ssize_t read = 0;
+    while ((read = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+      body.append(buffer, static_cast<std::size_t>(read));
+    }
+  }
+  ::close(fd);
+  return body;
+}
+
+bool TestStatsEndpoint(const std::filesystem::path& directory) {
+  auto& tracer = Tracer::Instance();
+  tracer.Reset();
+  for (int i = 0; i < 3; ++i) {
+    ULAK_TRACE_SCOPE(TraceStage::kClassify);
+  }
+
+  const auto socket_path = directory / "trace.sock";
+  ulak::utils::TraceStatsServer server(socket_path);
+  std::string reason;
+  if (!Expect(server.Start(&reason), "Expected stats server start: " + reason)) {
+    return false;
+  }
+  const std::string first = ReadStats(socket_path);
+  const std::string second = ReadStats(socket_path);
+  server.Stop();
+  return Expect(first.find("\"stages\":[{\"name\":\"recv\",\"count\":0") != std::string::npos,
+                "Expected per-stage stats JSON") &&
+         Expect(first.find("{\"name\":\"classify\",\"count\":3,") != std::string::npos,
+                "Expected the classify spans in the stats") &&
+         Expect(!second.empty(), "Expected the endpoint to serve repeat clients") &&
+         Expect(server.served() == 2, "Expected two clients served") &&
+         Expect(!std::filesystem::exists(socket_path), "Expected the socket removed on stop");
+}
+
+}  // namespace
+
+int main() {
+  const auto directory =
+      std::filesystem::temp_directory_path() /
+      ("ulak_trace_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+  std::filesystem::create_directories(directory);
+  const bool ok = TestSpansLandInStageHistograms() &&
+                  TestThreadsRecordIndependently() &&
+                  TestFullRingDropsInsteadOfBlocking() &&
+                  TestChromeTraceDump(directory) &&
+                  TestStatsEndpoint(directory);
+  std::filesystem::remove_all(directory);
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Tracing tests passed.\n";
+  return 0;
+}
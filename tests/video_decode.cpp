@@ -0,0 +1,265 @@
+#include "NalUnit.h"
+#include "VideoDecodePipeline.h"
+#include "YuvFramePool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+// H.264 access units: SPS+PPS+IDR, reference P (nal_ref_idc=2), non-reference B.
+std::vector<std::uint8_t> Idr() {
+  return {0, 0, 0, 1, 0x67, 0x42, 0x00, 0x1F, 0, 0, 0, 1, 0x68, 0xCE,
+          0, 0, 1,    0x65, 0x88, 0x80, 0x10, 0x00};
+}
+std::vector<std::uint8_t> RefP() {
+  return {0, 0, 0, 1, 0x41, 0x9A, 0x02, 0x00, 0x00};
+}
+std::vector<std::uint8_t> NonRefB() {
+  return {0, 0, 0, 1, 0x01, 0x9E, 0x04};
+}
+
+// Stand-in backend: writes the pts into the luma plane and costs `delay_us`.
+class FakeDecoder : public ulak::comms::VideoDecoder {
+ public:
+  explicit FakeDecoder(std::shared_ptr<std::atomic<int>> delay_us) : delay_us_(std::move(delay_us)) {}
+
+  ulak::comms::DecodeResult Decode(const ulak::comms::EncodedAccessUnit& unit,
+                                   ulak::comms::YuvFrame* out) override {
+    const int delay = delay_us_->load();
+    if (delay > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(delay));
+    }
+    if (!unit.info.has_vcl) {
+      return ulak::comms::DecodeResult::kNoFrame;
+    }
+    out->pts_us = unit.pts_us;
+    out->keyframe = unit.info.keyframe;
+    out->planes[0][0] = static_cast<std::uint8_t>(unit.pts_us / 1000);
+    return ulak::comms::DecodeResult::kFrame;
+  }
+
+ private:
+  std::shared_ptr<std::atomic<int>> delay_us_;
+};
+
+ulak::comms::VideoDecoderFactory FakeFactory(std::shared_ptr<std::atomic<int>> delay_us) {
+  return [delay_us](const ulak::comms::VideoDecodeConfig&, std::string*) {
+    return std::make_unique<FakeDecoder>(delay_us);
+  };
+}
+
+ulak::comms::VideoDecodeConfig SmallConfig() {
+  ulak::comms::VideoDecodeConfig config;
+  config.width = 64;
+  config.height = 36;
+  config.decoder_threads = 1;
+  return config;
+}
+
+bool TestNalClassification() {
+  using ulak::comms::VideoCodec;
+  const auto idr = Idr();
+  const auto units = ulak::comms::SplitAnnexB(VideoCodec::kH264, idr.data(), idr.size());
+  const auto idr_info = ulak::comms::ClassifyAccessUnit(VideoCodec::kH264, idr.data(), idr.size());
+  const auto b = NonRefB();
+  const auto b_info = ulak::comms::ClassifyAccessUnit(VideoCodec::kH264, b.data(), b.size());
+
+  const std::vector<std::uint8_t> hevc = {0, 0, 1, 0x40, 0x01, 0x0C, 0, 0, 1, 0x26, 0x01, 0xAF,
+                                          0, 0, 1, 0x00, 0x01, 0xD0, 0, 0, 1, 0x02, 0x01, 0xD0};
+  const auto hevc_units = ulak::comms::SplitAnnexB(VideoCodec::kH265, hevc.data(), hevc.size());
+  return Expect(units.size() == 3 && units[0].type == 7 && units[1].type == 8 &&
+                    units[2].type == 5,
+                "Expected SPS/PPS/IDR split across 3- and 4-byte start codes") &&
+         Expect(units[1].size == 2, "Expected trailing start-code zero excluded") &&
+         Expect(idr_info.keyframe && idr_info.reference && idr_info.has_parameter_sets,
+                "Expected IDR access unit classification") &&
+         Expect(b_info.has_vcl && !b_info.reference, "Expected nal_ref_idc=0 to be non-reference") &&
+         Expect(hevc_units.size() == 4 && hevc_units[0].parameter_set && hevc_units[1].keyframe &&
+                    !hevc_units[2].reference && hevc_units[3].reference,
+                "Expected H.265 VPS/IDR/TRAIL_N/TRAIL_R classification");
+}
+
+bool TestPoolAndLatestSlot() {
+  ulak::comms::YuvFramePool pool(1920, 1080, 3);
+  auto a = pool.Acquire();
+  auto b = pool.Acquire();
+  auto c = pool.Acquire();
+  const bool aligned = reinterpret_cast<std::uintptr_t>(a->planes[0]) % 64 == 0 &&
+                       reinterpret_cast<std::uintptr_t>(a->planes[1]) % 64 == 0 &&
+                       a->strides[0] % 64 == 0 && a->strides[1] == 960;
+  if (!Expect(aligned, "Expected 64-byte aligned planes and strides") ||
+      !Expect(!pool.Acquire(), "Expected exhausted pool to return an empty ref")) {
+    return false;
+  }
+
+  ulak::comms::LatestFrameSlot slot;
+  a->pts_us = 1;
+  b->pts_us = 2;
+  ulak::comms::YuvFrame* raw_b = b.get();
+  const bool replaced_first = slot.Publish(std::move(a));
+  const bool replaced_second = slot.Publish(std::move(b));
+  if (!Expect(!replaced_first && replaced_second, "Expected second publish to replace the first") ||
+      !Expect(pool.available() == 1, "Expected replaced frame to return to the free list")) {
+    return false;
+  }
+  auto shown = slot.Take();
+  const bool newest = shown.get() == raw_b;
+  auto copy = shown;
+  shown.reset();
+  const bool still_held = pool.available() == 1;
+  copy.reset();
+  c.reset();
+  return Expect(!slot.Take(), "Expected slot to be empty after Take") &&
+         Expect(still_held, "Expected copies to keep the frame alive") &&
+         Expect(pool.available() == 3, "Expected all frames back in the pool") &&
+         Expect(newest, "Expected newest frame handed to the display");
+}
+
+bool TestDecodesAndDropsNonReferenceWhenBehind() {
+  auto delay = std::make_shared<std::atomic<int>>(0);
+  auto config = SmallConfig();
+  config.max_queue = 64;
+  ulak::comms::VideoDecodePipeline pipeline(config, FakeFactory(delay));
+  std::string reason;
+  if (!Expect(pipeline.Start(&reason), "Expected pipeline start: " + reason)) {
+    return false;
+  }
+
+  using ulak::comms::MakeAccessUnit;
+  using ulak::comms::VideoCodec;
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, RefP(), 0));  // Before any keyframe.
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, Idr(), 33000));
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, NonRefB(), 66000));
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, RefP(), 99000));
+  pipeline.WaitIdle();
+  auto stats = pipeline.stats();
+  auto latest = pipeline.output().Take();
+  if (!Expect(stats.dropped_before_keyframe == 1 && stats.decoded == 3,
+              "Expected decode to start at the keyframe") ||
+      !Expect(latest && latest->pts_us == 99000 && latest->planes[0][0] == 99,
+              "Expected latest slot to hold the newest picture")) {
+    return false;
+  }
+  latest.reset();
+
+  // Decode slower than the 33ms frame interval: once the smoothed decode time
+  // catches up with it, B pictures are skipped.
+  delay->store(50000);
+  std::int64_t pts = 132000;
+  for (int index = 0; index < 10; ++index) {
+    pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, RefP(), pts));
+    pts += 33000;
+  }
+  pipeline.WaitIdle();
+  if (!Expect(pipeline.dropping_non_reference(), "Expected drop mode while decode is slow")) {
+    return false;
+  }
+  for (int index = 0; index < 5; ++index) {
+    pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, RefP(), pts));
+    pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, NonRefB(), pts + 33000));
+    pts += 66000;
+  }
+  pipeline.WaitIdle();
+  stats = pipeline.stats();
+  if (!Expect(stats.dropped_non_reference == 5 && stats.decoded == 18,
+              "Expected every reference picture decoded and B pictures dropped")) {
+    return false;
+  }
+
+  // Decode becomes cheap again: drop mode ends once the average recovers.
+  delay->store(0);
+  for (int index = 0; index < 12; ++index) {
+    pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, RefP(), pts));
+    pts += 33000;
+    pipeline.WaitIdle();
+  }
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, NonRefB(), pts));
+  pipeline.WaitIdle();
+  const auto recovered = pipeline.stats();
+  pipeline.Stop();
+  return Expect(!pipeline.dropping_non_reference(), "Expected drop mode to end") &&
+         Expect(recovered.dropped_non_reference == stats.dropped_non_reference,
+                "Expected B pictures decoded again after recovery");
+}
+
+bool TestOverflowResyncsAtKeyframe() {
+  auto delay = std::make_shared<std::atomic<int>>(20000);
+  auto config = SmallConfig();
+  config.max_queue = 2;
+  ulak::comms::VideoDecodePipeline pipeline(config, FakeFactory(delay));
+  pipeline.Start(nullptr);
+
+  using ulak::comms::MakeAccessUnit;
+  using ulak::comms::VideoCodec;
+  bool discarded = false;
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, Idr(), 0));
+  for (int index = 1; index <= 6; ++index) {
+    discarded = !pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, RefP(), index * 33000)) ||
+                discarded;
+  }
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, Idr(), 7 * 33000));
+  pipeline.WaitIdle();
+  const auto stats = pipeline.stats();
+  auto latest = pipeline.output().Take();
+  pipeline.Stop();
+  return Expect(discarded && stats.keyframe_resyncs >= 1 && stats.dropped_overflow >= 2,
+                "Expected reference-only backlog to be flushed") &&
+         Expect(latest && latest->pts_us == 7 * 33000 && latest->keyframe,
+                "Expected decoding to resume at the next keyframe");
+}
+
+bool TestDisplayHoldingFramesDoesNotStallDecode() {
+  auto delay = std::make_shared<std::atomic<int>>(0);
+  auto config = SmallConfig();
+  config.pool_frames = 2;
+  ulak::comms::VideoDecodePipeline pipeline(config, FakeFactory(delay));
+  pipeline.Start(nullptr);
+
+  using ulak::comms::MakeAccessUnit;
+  using ulak::comms::VideoCodec;
+  std::vector<ulak::comms::YuvFrameRef> held;
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, Idr(), 0));
+  pipeline.WaitIdle();
+  held.push_back(pipeline.output().Take());
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, RefP(), 33000));
+  pipeline.WaitIdle();
+  held.push_back(pipeline.output().Take());
+  pipeline.Submit(MakeAccessUnit(VideoCodec::kH264, RefP(), 66000));
+  pipeline.WaitIdle();
+  const auto stats = pipeline.stats();
+  pipeline.Stop();
+  return Expect(held[0] && held[1], "Expected display to hold two frames") &&
+         Expect(stats.decoded == 3 && stats.pool_exhausted == 1,
+                "Expected reference picture decoded into scratch when the pool is empty");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestNalClassification() &&
+                  TestPoolAndLatestSlot() &&
+                  TestDecodesAndDropsNonReferenceWhenBehind() &&
+                  TestOverflowResyncsAtKeyframe() &&
+                  TestDisplayHoldingFramesDoesNotStallDecode();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Video decode pipeline tests passed.\n";
+  return 0;
+}
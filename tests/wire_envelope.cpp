@@ -0,0 +1,480 @@
+#include "WireEnvelope.h"
+#include "WireFormatNegotiator.h"
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "[test] " << message << '\n';
+    return false;
+  }
+  return true;
+}
+
+using ulak::models::EnvelopeParseError;
+using ulak::models::MessageCategory;
+using ulak::models::MessageSource;
+using ulak::models::WireEnvelope;
+
+// 2026-02-10T19:00:00Z
+constexpr std::int64_t kTimestampUs = 1'770'750'000'000'000;
+
+WireEnvelope BaseEnvelope(MessageCategory category, MessageSource source) {
+  WireEnvelope envelope;
+  envelope.category = category;
+  envelope.source = source;
+  envelope.timestamp_us = kTimestampUs;
+  ulak::utils::ParseUuid("2cf42dca-d8a2-46d2-bdfd-677ee6a66e8f", &envelope.correlation_id);
+  return envelope;
+}
+
+WireEnvelope PerceptionEnvelope() {
+  auto envelope = BaseEnvelope(MessageCategory::kPerceptionOutput, MessageSource::kCompanionComputer);
+  ulak::models::PerceptionTarget target;
+  target.color = "red";
+  target.shape = "triangle";
+  target.alignment_dx = -0.125;
+  target.alignment_dy = 0.0625;
+  target.confidence = 0.875;
+  envelope.payload = target;
+  return envelope;
+}
+
+WireEnvelope SafetyEnvelope() {
+  auto envelope = BaseEnvelope(MessageCategory::kSafetyEvents, MessageSource::kCompanionComputer);
+  ulak::models::SafetyEvent event;
+  event.severity = ulak::models::SafetySeverity::kError;
+  event.code = "VISION_LOST";
+  event.message = "Perception input missing for 1.2s";
+  event.recommended_action = "HOLD";
+  envelope.payload = event;
+  return envelope;
+}
+
+std::vector<std::uint8_t> Encode(const WireEnvelope& envelope) {
+  std::vector<std::uint8_t> bytes;
+  std::string reason;
+  if (!ulak::models::EncodeBinaryEnvelope(envelope, &bytes, &reason)) {
+    std::cerr << "[test] encode failed: " << reason << '\n';
+  }
+  return bytes;
+}
+
+std::string Json(const WireEnvelope& envelope) {
+  std::string json;
+  std::string reason;
+  if (!ulak::models::SerializeJsonEnvelope(envelope, &json, &reason)) {
+    std::cerr << "[test] serialize failed: " << reason << '\n';
+  }
+  return json;
+}
+
+EnvelopeParseError ParseError(const std::string& json) {
+  WireEnvelope parsed;
+  return ulak::models::ParseJsonEnvelope(json, &parsed).error;
+}
+
+EnvelopeParseError DecodeError(const std::vector<std::uint8_t>& bytes) {
+  WireEnvelope decoded;
+  return ulak::models::DecodeBinaryEnvelope(bytes.data(), bytes.size(), &decoded).error;
+}
+
+bool TestRoundTripKeepsEveryField() {
+  const auto perception = PerceptionEnvelope();
+  const auto bytes = Encode(perception);
+  WireEnvelope decoded;
+  const auto result = ulak::models::DecodeBinaryEnvelope(bytes.data(), bytes.size(), &decoded);
+  const auto* target = std::get_if<ulak::models::PerceptionTarget>(&decoded.payload);
+  if (!Expect(result.ok, "Expected perception frame to decode: " + result.message) ||
+      !Expect(target != nullptr, "Expected a perception payload")) {
+    return false;
+  }
+
+  auto request = BaseEnvelope(MessageCategory::kCommandRequest, MessageSource::kStation);
+  request.payload = ulak::models::CommandPayload{"START_MISSION", "companion_computer",
+                                                 "{\"mission_id\":\"mission_1\"}"};
+  const auto request_bytes = Encode(request);
+  WireEnvelope decoded_request;
+  const bool request_ok =
+      ulak::models::DecodeBinaryEnvelope(request_bytes.data(), request_bytes.size(), &decoded_request).ok;
+  const auto* command = std::get_if<ulak::models::CommandPayload>(&decoded_request.payload);
+
+  return Expect(decoded.category == MessageCategory::kPerceptionOutput &&
+                    decoded.source == MessageSource::kCompanionComputer &&
+                    decoded.timestamp_us == kTimestampUs &&
+                    decoded.correlation_id == perception.correlation_id &&
+                    decoded.schema_major == 1 && decoded.schema_minor == 1,
+                "Expected envelope fields to survive the round trip") &&
+         Expect(target->color == "red" && target->shape == "triangle" &&
+                    target->alignment_dx == -0.125 && target->alignment_dy == 0.0625 &&
+                    target->confidence == 0.875,
+                "Expected perception payload to survive the round trip") &&
+         Expect(request_ok && command != nullptr && command->command == "START_MISSION" &&
+                    command->params_json == "{\"mission_id\":\"mission_1\"}",
+                "Expected command request to survive the round trip") &&
+         Expect(ulak::models::BinaryEnvelopeFrameSize(bytes.data(), 5) == 0 &&
+                    ulak::models::BinaryEnvelopeFrameSize(bytes.data(), bytes.size()) == bytes.size(),
+                "Expected the frame size from the header");
+}
+
+bool TestJsonMatchesTheProtocolShape() {
+  const std::string json = Json(SafetyEnvelope());
+  const std::string expected =
+      "{\"category\":\"safety/events\","
+      "\"correlation_id\":\"2cf42dca-d8a2-46d2-bdfd-677ee6a66e8f\","
+      "\"payload\":{\"code\":\"VISION_LOST\",\"message\":\"Perception input missing for 1.2s\","
+      "\"recommended_action\":\"HOLD\",\"severity\":\"ERROR\"},"
+      "\"schema_version\":\"1.1.0\","
+      "\"source\":\"companion_computer\","
+      "\"timestamp\":\"2026-02-10T19:00:00.000000Z\"}";
+  if (!Expect(json == expected, "Expected deterministic JSON envelope")) {
+    std::cerr << "[test] Serialized output: " << json << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool TestJsonRoundTripMatchesBinary() {
+  auto mission = BaseEnvelope(MessageCategory::kMissionState, MessageSource::kCompanionComputer);
+  mission.payload = ulak::models::MissionStateUpdate{"SEARCHING", 0.5, "line \"2\"\n\u00e7"};
+  auto request = BaseEnvelope(MessageCategory::kCommandRequest, MessageSource::kStation);
+  request.payload = ulak::models::CommandPayload{"START_MISSION", "companion_computer",
+                                                 "{\"mission_id\":\"mission_1\",\"laps\":[1,2]}"};
+  auto ack = BaseEnvelope(MessageCategory::kCommandAck, MessageSource::kCompanionComputer);
+  ack.payload = ulak::models::CommandReplyPayload{"ACCEPTED", "companion_computer", "", ""};
+
+  bool same = true;
+  for (const auto& envelope : {PerceptionEnvelope(), SafetyEnvelope(), mission, request, ack}) {
+    WireEnvelope from_json;
+    WireEnvelope from_binary;
+    const auto bytes = Encode(envelope);
+    const auto json_result = ulak::models::ParseJsonEnvelope(Json(envelope), &from_json);
+    const auto binary_result =
+        ulak::models::DecodeBinaryEnvelope(bytes.data(), bytes.size(), &from_binary);
+    if (!Expect(json_result.ok, "Expected JSON envelope to parse: " + json_result.message) ||
+        !Expect(binary_result.ok, "Expected binary envelope to decode")) {
+      return false;
+    }
+    // Both encoders produce the same envelope again, byte for byte.
+    same = same && Json(from_json) == Json(from_binary) && Encode(from_json) == bytes;
+  }
+
+  // Foreign whitespace, key order, escapes and unknown keys.
+  const std::string foreign =
+      "{ \"payload\" : {\"severity\":\"CRITICAL\",\"extra\":[true,null,{\"a\":-1.5e3}],"
+      "\"code\":\"LINK\\u00e7\\ud83d\\ude80\",\"message\":\"\",\"recommended_action\":\"RTL\"},\n"
+      "\"timestamp\":\"2026-02-10T19:00:00.25Z\",\"source\":\"flight_controller\","
+      "\"schema_version\":\"1.4.2\",\"category\":\"safety/events\","
+      "\"correlation_id\":\"2CF42DCA-D8A2-46D2-BDFD-677EE6A66E8F\"}  ";
+  WireEnvelope parsed;
+  const auto foreign_result = ulak::models::ParseJsonEnvelope(foreign, &parsed);
+  const auto* event = std::get_if<ulak::models::SafetyEvent>(&parsed.payload);
+
+  return Expect(same, "Expected JSON and binary to decode into the same envelope") &&
+         Expect(foreign_result.ok && event != nullptr, "Expected foreign JSON to parse: " +
+                                                           foreign_result.message) &&
+         Expect(event->severity == ulak::models::SafetySeverity::kCritical &&
+                    event->code == "LINK\xc3\xa7\xf0\x9f\x9a\x80" && parsed.schema_minor == 4 &&
+                    parsed.timestamp_us == kTimestampUs + 250'000 &&
+                    parsed.source == MessageSource::kFlightController,
+                "Expected escapes, fractions and minor versions decoded");
+}
+
+bool TestJsonValidationMatchesBinary() {
+  const std::string good = Json(SafetyEnvelope());
+  const auto replace = [&good](const std::string& from, const std::string& to) {
+    std::string json = good;
+    json.replace(json.find(from), from.size(), to);
+    return json;
+  };
+  return Expect(ParseError(good.substr(0, good.size() - 1)) == EnvelopeParseError::kMalformed,
+                "Expected kMalformed for truncated JSON") &&
+         Expect(ParseError(good + "x") == EnvelopeParseError::kMalformed,
+                "Expected kMalformed for trailing bytes") &&
+         Expect(ParseError(replace("\"1.1.0\"", "\"2.0.0\"")) ==
+                    EnvelopeParseError::kUnsupportedSchema,
+                "Expected kUnsupportedSchema for major version 2") &&
+         Expect(ParseError(replace("safety/events", "telemetry/vehicle")) ==
+                    EnvelopeParseError::kUnsupportedCategory,
+                "Expected kUnsupportedCategory without a typed payload") &&
+         Expect(ParseError(replace("companion_computer", "ground")) ==
+                    EnvelopeParseError::kInvalidValue,
+                "Expected kInvalidValue for an unknown source") &&
+         Expect(ParseError(replace("2026-02-10T19", "2026-02-30T19")) ==
+                    EnvelopeParseError::kInvalidValue,
+                "Expected kInvalidValue for an impossible date") &&
+         Expect(ParseError(replace("\"correlation_id\":", "\"id\":")) ==
+                    EnvelopeParseError::kMissingField,
+                "Expected kMissingField without a correlation id") &&
+         Expect(ParseError(replace("\"ERROR\"", "\"FATAL\"")) == EnvelopeParseError::kInvalidValue,
+                "Expected kInvalidValue for an unknown severity") &&
+         Expect(ParseError(replace("\"recommended_action\"", "\"action\"")) ==
+                    EnvelopeParseError::kMissingField,
+                "Expected kMissingField for an absent payload key") &&
+         Expect(ParseError(replace("\"VISION_LOST\"", "42")) == EnvelopeParseError::kInvalidValue,
+                "Expected kInvalidValue for a number where a string belongs");
+}
+
+// JSON has no literal for NaN or infinity and f32 none for values past
+// FLT_MAX: such envelopes are refused by both encoders instead of being sent.
+bool TestNonFiniteNumbersAreRefused() {
+  auto not_a_number = PerceptionEnvelope();
+  std::get<ulak::models::PerceptionTarget>(not_a_number.payload).alignment_dx =
+      std::numeric_limits<double>::quiet_NaN();
+  auto infinite = BaseEnvelope(MessageCategory::kMissionState, MessageSource::kStation);
+  infinite.payload =
+      ulak::models::MissionStateUpdate{"SEARCHING", std::numeric_limits<double>::infinity(), ""};
+  auto huge = PerceptionEnvelope();
+  std::get<ulak::models::PerceptionTarget>(huge.payload).alignment_dy = 1e300;
+
+  std::vector<std::uint8_t> bytes = {1, 2, 3};
+  std::string json = "{";
+  std::string reason;
+  ulak::comms::WireFormatNegotiator negotiator;
+  negotiator.Offer("f", 0);
+  negotiator.OnHelloAck("ulak-bin/1");
+  std::vector<std::uint8_t> sent;
+  const auto format = negotiator.Encode(not_a_number, &sent);
+
+  WireEnvelope parsed;
+  const auto nan_text = ulak::models::ParseJsonEnvelope(
+      "{\"category\":\"mission/state\",\"correlation_id\":\"2cf42dca-d8a2-46d2-bdfd-677ee6a66e8f\","
+      "\"payload\":{\"note\":\"\",\"progress\":nan,\"state\":\"S\"},\"schema_version\":\"1.1.0\","
+      "\"source\":\"station\",\"timestamp\":\"2026-02-10T19:00:00.000000Z\"}",
+      &parsed);
+
+  return Expect(!ulak::models::EncodeBinaryEnvelope(not_a_number, &bytes, &reason) &&
+                    !ulak::models::EncodeBinaryEnvelope(infinite, &bytes, &reason) &&
+                    !ulak::models::EncodeBinaryEnvelope(huge, &bytes, &reason) && bytes.size() == 3,
+                "Expected binary to refuse non-finite and out-of-range numbers") &&
+         Expect(!ulak::models::SerializeJsonEnvelope(not_a_number, &json, &reason) &&
+                    !ulak::models::SerializeJsonEnvelope(infinite, &json, &reason) && json == "{",
+                "Expected JSON to refuse NaN and infinity: " + reason) &&
+         Expect(!Json(huge).empty(), "Expected JSON to carry values binary cannot") &&
+         Expect(!format && sent.empty(), "Expected the negotiator to send nothing") &&
+         Expect(nan_text.error == EnvelopeParseError::kMalformed,
+                "Expected a nan literal to be invalid JSON");
+}
+
+bool TestBinaryIsSmallerOnCompanionTraffic() {
+  const auto perception = PerceptionEnvelope();
+  const auto safety = SafetyEnvelope();
+  const std::size_t perception_json = Json(perception).size();
+  const std::size_t safety_json = Json(safety).size();
+  return Expect(Encode(perception).size() * 4 < perception_json,
+                "Expected perception/output under a quarter of its JSON size") &&
+         Expect(Encode(safety).size() * 2 < safety_json,
+                "Expected safety/events under half of its JSON size");
+}
+
+bool TestValidationMatchesCommandParseErrors() {
+  const auto good = Encode(SafetyEnvelope());
+
+  auto bad_magic = good;
+  bad_magic[0] = '{';
+  auto major_two = good;
+  major_two[1] = 2;
+  auto telemetry = good;
+  telemetry[6] = static_cast<std::uint8_t>(MessageCategory::kTelemetryVehicle);
+  auto bad_source = good;
+  bad_source[7] = 9;
+  auto zero_time = good;
+  for (int i = 8; i < 16; ++i) {
+    zero_time[i] = 0;
+  }
+  auto no_correlation = good;
+  for (int i = 16; i < 32; ++i) {
+    no_correlation[i] = 0;
+  }
+  auto bad_severity = good;
+  bad_severity[32] = 7;
+  // Truncated payload with a consistent length field: recommended_action absent.
+  auto truncated = good;
+  truncated.resize(truncated.size() - 5);
+  const std::size_t body = truncated.size() - 6;
+  truncated[4] = static_cast<std::uint8_t>(body);
+  truncated[5] = static_cast<std::uint8_t>(body >> 8);
+  auto short_buffer = good;
+  short_buffer.pop_back();
+
+  return Expect(DecodeError(bad_magic) == EnvelopeParseError::kMalformed,
+                "Expected kMalformed without the magic byte") &&
+         Expect(DecodeError(short_buffer) == EnvelopeParseError::kMalformed,
+                "Expected kMalformed when the frame is cut short") &&
+         Expect(DecodeError(major_two) == EnvelopeParseError::kUnsupportedSchema,
+                "Expected kUnsupportedSchema for major version 2") &&
+         Expect(DecodeError(telemetry) == EnvelopeParseError::kUnsupportedCategory,
+                "Expected kUnsupportedCategory for a category without a layout") &&
+         Expect(DecodeError(bad_source) == EnvelopeParseError::kInvalidValue,
+                "Expected kInvalidValue for an unknown source") &&
+         Expect(DecodeError(zero_time) == EnvelopeParseError::kInvalidValue,
+                "Expected kInvalidValue for a missing timestamp") &&
+         Expect(DecodeError(no_correlation) == EnvelopeParseError::kMissingField,
+                "Expected kMissingField for a zero correlation id") &&
+         Expect(DecodeError(bad_severity) == EnvelopeParseError::kInvalidValue,
+                "Expected kInvalidValue for an unknown severity") &&
+         Expect(DecodeError(truncated) == EnvelopeParseError::kMissingField,
+                "Expected kMissingField for a truncated payload");
+}
+
+bool TestMinorAdditionsAreIgnored() {
+  auto bytes = Encode(PerceptionEnvelope());
+  bytes[2] = 7;
+  bytes.insert(bytes.end(), {0xDE, 0xAD, 0xBE, 0xEF});
+  const std::size_t body = bytes.size() - 6;
+  bytes[4] = static_cast<std::uint8_t>(body);
+  bytes[5] = static_cast<std::uint8_t>(body >> 8);
+  WireEnvelope decoded;
+  const auto result = ulak::models::DecodeBinaryEnvelope(bytes.data(), bytes.size(), &decoded);
+  return Expect(result.ok && decoded.schema_minor == 7,
+                "Expected a newer minor version with trailing fields to decode");
+}
+
+bool TestEncodeRefusesWhatBinaryCannotCarry() {
+  auto telemetry = BaseEnvelope(MessageCategory::kTelemetryVehicle, MessageSource::kCompanionComputer);
+  auto mismatched = BaseEnvelope(MessageCategory::kSafetyEvents, MessageSource::kCompanionComputer);
+  mismatched.payload = ulak::models::PerceptionTarget{};
+  auto long_code = SafetyEnvelope();
+  std::get<ulak::models::SafetyEvent>(long_code.payload).code.assign(300, 'X');
+
+  std::vector<std::uint8_t> bytes = {1, 2, 3};
+  std::string reason;
+  return Expect(!ulak::models::EncodeBinaryEnvelope(telemetry, &bytes, &reason),
+                "Expected no binary layout for telemetry") &&
+         Expect(!ulak::models::EncodeBinaryEnvelope(mismatched, &bytes, &reason),
+                "Expected a payload/category mismatch to fail") &&
+         Expect(!ulak::models::EncodeBinaryEnvelope(long_code, &bytes, &reason),
+                "Expected an over-long string to fail") &&
+         Expect(bytes.size() == 3, "Expected a failed encode to leave the buffer untouched");
+}
+
+bool TestDetectWireFormat() {
+  const std::uint8_t binary[] = {ulak::models::kBinaryEnvelopeMagic, 1, 1, 0};
+  const std::string json = "  \n{\"category\":\"mission/state\"}";
+  const std::string garbage = "hello";
+  const auto* json_bytes = reinterpret_cast<const std::uint8_t*>(json.data());
+  const auto* garbage_bytes = reinterpret_cast<const std::uint8_t*>(garbage.data());
+  return Expect(ulak::comms::DetectWireFormat(binary, sizeof(binary)) ==
+                    ulak::comms::WireFormat::kBinaryV1,
+                "Expected the magic byte to mark binary") &&
+         Expect(ulak::comms::DetectWireFormat(json_bytes, json.size()) == ulak::comms::WireFormat::kJson,
+                "Expected '{' after whitespace to mark JSON") &&
+         Expect(!ulak::comms::DetectWireFormat(garbage_bytes, garbage.size()),
+                "Expected neither format for other bytes") &&
+         Expect(!ulak::comms::DetectWireFormat(json_bytes, 2), "Expected no verdict on whitespace only");
+}
+
+bool TestNegotiation() {
+  using ulak::comms::WireFormat;
+  using ulak::comms::WireFormatNegotiator;
+
+  WireFormatNegotiator agreed;
+  const std::string hello = agreed.Offer("2cf42dca-d8a2-46d2-bdfd-677ee6a66e8f", kTimestampUs);
+  const bool json_before_reply = agreed.send_format() == WireFormat::kJson;
+  agreed.OnHelloAck("ulak-bin/1");
+
+  WireFormatNegotiator legacy;
+  legacy.Offer("a", 0);
+  legacy.OnHelloRejected();
+
+  WireFormatNegotiator silent;
+  silent.Offer("b", 0);
+  silent.Poll(1'999'999);
+  const bool waiting = silent.state() == WireFormatNegotiator::State::kOffered;
+  silent.Poll(2'000'000);
+
+  WireFormatNegotiator not_offered(false);
+  not_offered.Offer("c", 0);
+  not_offered.OnHelloAck("ulak-bin/1");
+
+  // A late ACK after the timeout must not switch formats mid-stream.
+  silent.OnHelloAck("ulak-bin/1");
+
+  return Expect(hello ==
+                    "{\"category\":\"station/hello\","
+                    "\"correlation_id\":\"2cf42dca-d8a2-46d2-bdfd-677ee6a66e8f\","
+                    "\"payload\":{\"wire_formats\":[\"ulak-bin/1\",\"json\"]},"
+                    "\"schema_version\":\"1.1.0\",\"source\":\"station\","
+                    "\"timestamp\":\"2026-02-10T19:00:00.000000Z\"}",
+                "Expected the hello envelope") &&
+         Expect(json_before_reply, "Expected JSON until the peer answers") &&
+         Expect(agreed.state() == WireFormatNegotiator::State::kAgreed &&
+                    agreed.send_format() == WireFormat::kBinaryV1,
+                "Expected binary after a hello_ack choosing it") &&
+         Expect(legacy.state() == WireFormatNegotiator::State::kFallback &&
+                    legacy.send_format() == WireFormat::kJson,
+                "Expected JSON when a 1.0 peer rejects the hello") &&
+         Expect(waiting, "Expected to wait until the reply timeout") &&
+         Expect(silent.state() == WireFormatNegotiator::State::kFallback &&
+                    silent.send_format() == WireFormat::kJson,
+                "Expected JSON after the reply timeout") &&
+         Expect(not_offered.send_format() == WireFormat::kJson,
+                "Expected a format we did not offer to be refused");
+}
+
+bool TestNegotiatedEncodeFallsBackPerMessage() {
+  using ulak::comms::WireFormat;
+  ulak::comms::WireFormatNegotiator negotiator;
+  negotiator.Offer("d", 0);
+  negotiator.OnHelloAck("ulak-bin/1");
+
+  std::vector<std::uint8_t> perception;
+  std::vector<std::uint8_t> telemetry;
+  const auto perception_format = negotiator.Encode(PerceptionEnvelope(), &perception);
+  const auto telemetry_format = negotiator.Encode(
+      BaseEnvelope(MessageCategory::kTelemetryHealth, MessageSource::kStation), &telemetry);
+  return Expect(perception_format == WireFormat::kBinaryV1 &&
+                    perception[0] == ulak::models::kBinaryEnvelopeMagic,
+                "Expected binary for perception/output") &&
+         Expect(telemetry_format == WireFormat::kJson && telemetry[0] == '{',
+                "Expected JSON for a category without a binary layout");
+}
+
+bool TestPeerSelection() {
+  using ulak::comms::WireFormat;
+  const std::vector<WireFormat> both = {WireFormat::kBinaryV1, WireFormat::kJson};
+  const std::vector<WireFormat> json_only = {WireFormat::kJson};
+  const std::string ack = ulak::comms::BuildHelloAck(
+      WireFormat::kBinaryV1, "e", MessageSource::kCompanionComputer, kTimestampUs);
+  return Expect(ulak::comms::SelectWireFormat({"ulak-bin/2", "ulak-bin/1", "json"}, both) ==
+                    WireFormat::kBinaryV1,
+                "Expected the first mutually supported format") &&
+         Expect(ulak::comms::SelectWireFormat({"ulak-bin/1", "json"}, json_only) == WireFormat::kJson,
+                "Expected JSON from a JSON-only peer") &&
+         Expect(ulak::comms::SelectWireFormat({}, both) == WireFormat::kJson,
+                "Expected JSON when nothing was offered") &&
+         Expect(ack.find("\"category\":\"station/hello_ack\"") != std::string::npos &&
+                    ack.find("\"payload\":{\"wire_format\":\"ulak-bin/1\"}") != std::string::npos &&
+                    ack.find("\"source\":\"companion_computer\"") != std::string::npos,
+                "Expected the hello_ack envelope");
+}
+
+}  // namespace
+
+int main() {
+  const bool ok = TestRoundTripKeepsEveryField() &&
+                  TestJsonMatchesTheProtocolShape() &&
+                  TestJsonRoundTripMatchesBinary() &&
+                  TestJsonValidationMatchesBinary() &&
+                  TestNonFiniteNumbersAreRefused() &&
+                  TestBinaryIsSmallerOnCompanionTraffic() &&
+                  TestValidationMatchesCommandParseErrors() &&
+                  TestMinorAdditionsAreIgnored() &&
+                  TestEncodeRefusesWhatBinaryCannotCarry() &&
+                  TestDetectWireFormat() &&
+                  TestNegotiation() &&
+                  TestNegotiatedEncodeFallsBackPerMessage() &&
+                  TestPeerSelection();
+  if (!ok) {
+    return 1;
+  }
+
+  std::cout << "[test] Wire envelope tests passed.\n";
+  return 0;
+}